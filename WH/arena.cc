@@ -0,0 +1,227 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* arena.cc : monotonic arena of temporaries */
+
+#include "arena.h"
+
+#include <new>
+
+
+
+/* class WH_CountingResource */
+
+WH_CountingResource
+::WH_CountingResource
+(pmr::memory_resource* upstream)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(upstream != WH_NULL);
+
+  _upstream = upstream;
+  _nAllocations = 0;
+  _nBytes = 0;
+}
+
+WH_CountingResource
+::~WH_CountingResource ()
+{
+}
+
+long long WH_CountingResource
+::nAllocations () const
+{
+  return _nAllocations;
+}
+
+long long WH_CountingResource
+::nBytes () const
+{
+  return _nBytes;
+}
+
+void* WH_CountingResource
+::do_allocate
+(size_t bytes, size_t alignment)
+{
+  _nAllocations++;
+  _nBytes += (long long)bytes;
+  return _upstream->allocate (bytes, alignment);
+}
+
+void WH_CountingResource
+::do_deallocate
+(void* pointer, size_t bytes, size_t alignment)
+{
+  _upstream->deallocate (pointer, bytes, alignment);
+}
+
+bool WH_CountingResource
+::do_is_equal
+(const pmr::memory_resource& other) const noexcept
+{
+  return this == &other;
+}
+
+
+
+/* class WH_Arena */
+
+atomic<long long> WH_Arena::_nTotalAllocations (0);
+
+atomic<long long> WH_Arena::_nTotalHeapAllocations (0);
+
+WH_Arena
+::WH_Arena
+(size_t initialSize)
+  : _heapResource (pmr::new_delete_resource ()),
+    _initialSize (initialSize),
+    _initialBuffer (_heapResource.allocate (initialSize)),
+    _ownsInitialBuffer (true),
+    _monotonicResource (_initialBuffer, initialSize, &_heapResource),
+    _servedResource (&_monotonicResource)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < initialSize);
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(this->checkInvariant ());
+#endif
+}
+
+WH_Arena
+::WH_Arena
+(void* buffer, size_t size)
+  : _heapResource (pmr::new_delete_resource ()),
+    _initialSize (size),
+    _initialBuffer (buffer),
+    _ownsInitialBuffer (false),
+    _monotonicResource (buffer, size, &_heapResource),
+    _servedResource (&_monotonicResource)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(buffer != WH_NULL);
+  WH_ASSERT(0 < size);
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(this->checkInvariant ());
+#endif
+}
+
+WH_Arena
+::~WH_Arena ()
+{
+  _monotonicResource.release ();
+  if (_ownsInitialBuffer) {
+    _heapResource.deallocate (_initialBuffer, _initialSize);
+  }
+
+  _nTotalAllocations.fetch_add
+    (this->nAllocations (), memory_order_relaxed);
+  _nTotalHeapAllocations.fetch_add
+    (this->nHeapAllocations (), memory_order_relaxed);
+}
+
+bool WH_Arena
+::checkInvariant () const
+{
+  WH_ASSERT(_initialBuffer != WH_NULL);
+  WH_ASSERT(0 < _initialSize);
+
+  return true;
+}
+
+bool WH_Arena
+::assureInvariant () const
+{
+  this->checkInvariant ();
+
+  return true;
+}
+
+pmr::memory_resource* WH_Arena
+::resource ()
+{
+  return &_servedResource;
+}
+
+void* WH_Arena
+::allocate (size_t size, size_t alignment)
+{
+  return _servedResource.allocate (size, alignment);
+}
+
+void WH_Arena
+::release ()
+{
+  _monotonicResource.release ();
+}
+
+long long WH_Arena
+::nAllocations () const
+{
+  return _servedResource.nAllocations ();
+}
+
+long long WH_Arena
+::nHeapAllocations () const
+{
+  return _heapResource.nAllocations ();
+}
+
+long long WH_Arena
+::nTotalAllocations ()
+{
+  return _nTotalAllocations.load (memory_order_relaxed);
+}
+
+long long WH_Arena
+::nTotalHeapAllocations ()
+{
+  return _nTotalHeapAllocations.load (memory_order_relaxed);
+}
+
+
+
+/* free functions */
+
+#ifdef WH_HEAP_COUNTER_ENABLED
+
+static atomic<long long> NProcessHeapAllocations (0);
+
+void* operator new (size_t size)
+{
+  NProcessHeapAllocations.fetch_add (1, memory_order_relaxed);
+  void* result = malloc ((size == 0) ? 1 : size);
+  if (result == WH_NULL) throw bad_alloc ();
+  return result;
+}
+
+void operator delete (void* pointer) noexcept
+{
+  free (pointer);
+}
+
+void operator delete (void* pointer, size_t) noexcept
+{
+  free (pointer);
+}
+
+long long WH_nProcessHeapAllocations ()
+{
+  return NProcessHeapAllocations.load (memory_order_relaxed);
+}
+
+#else
+
+long long WH_nProcessHeapAllocations ()
+{
+  return -1;
+}
+
+#endif
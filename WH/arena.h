@@ -0,0 +1,133 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* header file for arena.cc */
+
+#pragma once
+#ifndef WH_INCLUDED_WH_COMMON
+#include <WH/common.h>
+#define WH_INCLUDED_WH_COMMON
+#endif
+
+#include <atomic>
+#include <memory_resource>
+#include <type_traits>
+
+class WH_CountingResource;
+class WH_Arena;
+
+/* memory resource which counts the allocations passed to <upstream> */
+class WH_CountingResource : public pmr::memory_resource {
+ public:
+  WH_CountingResource
+    (pmr::memory_resource* upstream);
+  virtual ~WH_CountingResource ();
+
+  /* base */
+  long long nAllocations () const;
+
+  long long nBytes () const;
+
+  /* derived */
+
+ protected:
+  pmr::memory_resource* _upstream;  /* not own */
+
+  long long _nAllocations;
+
+  long long _nBytes;
+
+  /* base */
+
+  /* derived */
+  virtual void* do_allocate
+    (size_t bytes, size_t alignment) override;
+  virtual void do_deallocate
+    (void* pointer, size_t bytes, size_t alignment) override;
+  virtual bool do_is_equal
+    (const pmr::memory_resource& other) const noexcept override;
+};
+
+/* value-based class */
+/* heavy weight */
+/* no inheritance */
+/* monotonic arena of the temporaries of an operation.  deallocation
+   is a no-op, and all the temporaries are freed at once by release ()
+   or by the destruction of the arena.  the objects made by create ()
+   are never destructed */
+class WH_Arena {
+ public:
+  WH_Arena
+    (size_t initialSize = 16 * 1024);
+  /* <initialSize> bytes are kept through release () */
+  WH_Arena
+    (void* buffer, size_t size);
+  /* the arena starts on <buffer> of the caller, e.g. on the stack, so
+     that a small operation allocates nothing from the heap */
+  ~WH_Arena ();
+  bool checkInvariant () const;
+  bool assureInvariant () const;
+
+  /* base */
+  pmr::memory_resource* resource ();
+  /* for pmr containers on the arena */
+
+  void* allocate (size_t size, size_t alignment);
+
+  template <class Type, class... Args>
+  Type* create (Args&&... args) {
+    static_assert(is_trivially_destructible<Type>::value,
+		  "objects on WH_Arena are never destructed");
+    return new (this->allocate (sizeof (Type), alignof (Type)))
+      Type (std::forward<Args>(args)...);
+  }
+
+  void release ();
+
+  long long nAllocations () const;
+  /* requests served by the arena */
+
+  long long nHeapAllocations () const;
+  /* allocations of the arena from the heap */
+
+  /* totals of the destructed arenas */
+  static long long nTotalAllocations ();
+  static long long nTotalHeapAllocations ();
+
+  /* derived */
+
+ protected:
+  static atomic<long long> _nTotalAllocations;
+  static atomic<long long> _nTotalHeapAllocations;
+
+  WH_CountingResource _heapResource;
+
+  size_t _initialSize;
+
+  void* _initialBuffer;  /* own if <_ownsInitialBuffer> */
+
+  bool _ownsInitialBuffer;
+
+  pmr::monotonic_buffer_resource _monotonicResource;
+
+  WH_CountingResource _servedResource;
+
+  /* no implementation */
+  WH_Arena (const WH_Arena& arena);
+  const WH_Arena& operator= (const WH_Arena& arena);
+
+  /* base */
+
+  /* derived */
+
+};
+
+/* free functions */
+
+long long WH_nProcessHeapAllocations ();
+/* calls of the global operator new of the whole process so far, or -1
+   unless the library is built with WH_HEAP_COUNTER_ENABLED, which
+   replaces the global operator new and delete to count them */
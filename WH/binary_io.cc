@@ -0,0 +1,94 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* binary_io.cc : values of the binary files of the library */
+
+#include "binary_io.h"
+
+
+
+/* module procedures */
+
+/* MAGIC NUMBER : bound of a count in a file, against a broken one */
+static const int MAX_COUNT_IN_FILE = 1 << 24;
+
+/* length of a tag */
+static const int TAG_LENGTH = 4;
+
+template <class Type>
+static void WriteValue
+(ostream& out, const Type& value)
+{
+  out.write ((const char*)&value, sizeof (value));
+}
+
+template <class Type>
+static bool ReadValue
+(istream& in, Type& value_OUT)
+{
+  in.read ((char*)&value_OUT, sizeof (value_OUT));
+  return (bool)in;
+}
+
+
+
+/* free functions */
+
+void WH_writeBinary (ostream& out, int value)
+{
+  WriteValue (out, value);
+}
+
+void WH_writeBinary (ostream& out, double value)
+{
+  WriteValue (out, value);
+}
+
+void WH_writeBinary (ostream& out, unsigned long long value)
+{
+  WriteValue (out, value);
+}
+
+bool WH_readBinary (istream& in, int& value_OUT)
+{
+  return ReadValue (in, value_OUT);
+}
+
+bool WH_readBinary (istream& in, double& value_OUT)
+{
+  return ReadValue (in, value_OUT);
+}
+
+bool WH_readBinary (istream& in, unsigned long long& value_OUT)
+{
+  return ReadValue (in, value_OUT);
+}
+
+bool WH_readBinaryCount (istream& in, int& count_OUT)
+{
+  return ReadValue (in, count_OUT)
+    && 0 <= count_OUT && count_OUT <= MAX_COUNT_IN_FILE;
+}
+
+void WH_writeBinaryTag (ostream& out, const char* tag)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(tag != WH_NULL);
+  WH_ASSERT(strlen (tag) == TAG_LENGTH);
+
+  out.write (tag, TAG_LENGTH);
+}
+
+bool WH_readBinaryTag (istream& in, const char* tag)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(tag != WH_NULL);
+  WH_ASSERT(strlen (tag) == TAG_LENGTH);
+
+  char tagInFile[TAG_LENGTH];
+  in.read (tagInFile, TAG_LENGTH);
+  return in && memcmp (tagInFile, tag, TAG_LENGTH) == 0;
+}
@@ -0,0 +1,35 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* header file for binary_io.cc */
+
+#pragma once
+#ifndef WH_INCLUDED_WH_COMMON
+#include <WH/common.h>
+#define WH_INCLUDED_WH_COMMON
+#endif
+
+/* free functions */
+
+/* values of the binary files of the library (the body cache,
+   checkpoints).  they are in the byte order of the machine, as the
+   files are local to it.  a read function returns false on the end
+   of <in> or on a broken value */
+
+void WH_writeBinary (ostream& out, int value);
+void WH_writeBinary (ostream& out, double value);
+void WH_writeBinary (ostream& out, unsigned long long value);
+
+bool WH_readBinary (istream& in, int& value_OUT);
+bool WH_readBinary (istream& in, double& value_OUT);
+bool WH_readBinary (istream& in, unsigned long long& value_OUT);
+
+bool WH_readBinaryCount (istream& in, int& count_OUT);
+/* a count of items in a file.  a negative or huge one is broken */
+
+void WH_writeBinaryTag (ostream& out, const char* tag);
+bool WH_readBinaryTag (istream& in, const char* tag);
+/* 4 characters which mark a file or a section of it */
@@ -217,6 +217,23 @@ void WH_Bucket2D_A
 ::getItemsWithin_A 
 (const WH_Vector2D& minRange, const WH_Vector2D& maxRange, 
  vector<void*>& allTheItem_s_OUT) const
+{
+  this->collectItemsWithin_A (minRange, maxRange, allTheItem_s_OUT);
+}
+
+void WH_Bucket2D_A
+::getItemsWithin_A 
+(const WH_Vector2D& minRange, const WH_Vector2D& maxRange, 
+ pmr::vector<void*>& allTheItem_s_OUT) const
+{
+  this->collectItemsWithin_A (minRange, maxRange, allTheItem_s_OUT);
+}
+
+template <class ItemVector>
+void WH_Bucket2D_A
+::collectItemsWithin_A 
+(const WH_Vector2D& minRange, const WH_Vector2D& maxRange, 
+ ItemVector& allTheItem_s_OUT) const
 {
   /* PRE-CONDITION */
   WH_ASSERT(WH_le (minRange, maxRange));
@@ -276,7 +293,7 @@ void WH_Bucket2D_A
 	       i_item != item_s.end ();
 	       i_item++) {
 	    void* item_i = (*i_item);
-	    vector<void*>::reverse_iterator i_item1 
+	    typename ItemVector::reverse_iterator i_item1 
 	      = find (allTheItem_s_OUT.rbegin (), 
 		      allTheItem_s_OUT.rend (), 
 		      item_i);
@@ -296,7 +313,7 @@ void WH_Bucket2D_A
 	   i_item != item_s.end ();
 	   i_item++) {
 	void* item_i = (*i_item);
-	vector<void*>::reverse_iterator i_item1 
+	typename ItemVector::reverse_iterator i_item1 
 	  = find (allTheItem_s_OUT.rbegin (), 
 		  allTheItem_s_OUT.rend (), 
 		  item_i);
@@ -12,6 +12,8 @@
 #define WH_INCLUDED_WH_FIELD2D
 #endif
 
+#include <memory_resource>
+
 class WH_Bucket2D_A;
 template <class Type> class WH_Bucket2D;
 
@@ -93,10 +95,18 @@ class WH_Bucket2D_A {
   void getItemsWithin_A 
     (const WH_Vector2D& minRange, const WH_Vector2D& maxRange, 
      vector<void*>& allTheItem_s_OUT) const;
+  void getItemsWithin_A 
+    (const WH_Vector2D& minRange, const WH_Vector2D& maxRange, 
+     pmr::vector<void*>& allTheItem_s_OUT) const;
   void getItemsOn_A 
     (const WH_Vector2D& position, 
      vector<void*>& allTheItem_s_OUT) const;
 
+  template <class ItemVector>
+  void collectItemsWithin_A 
+    (const WH_Vector2D& minRange, const WH_Vector2D& maxRange, 
+     ItemVector& allTheItem_s_OUT) const;
+
   /* derived */
 
 };
@@ -182,6 +192,15 @@ class WH_Bucket2D : public WH_Bucket2D_A {
   }
   /* returns all items in <allTheItem_s_OUT> without duplication */
 
+  void getItemsWithin 
+    (const WH_Vector2D& minRange, const WH_Vector2D& maxRange, 
+     pmr::vector<Type*>& allTheItem_s_OUT) const {
+    this->getItemsWithin_A 
+      (minRange, maxRange, 
+       (pmr::vector<void*>&)allTheItem_s_OUT);
+  }
+  /* on the memory resource of <allTheItem_s_OUT>, e.g. a WH_Arena */
+
   void getItemsOn 
     (const WH_Vector2D& position, 
      vector<Type*>& allTheItem_s_OUT) const {
@@ -22,10 +22,22 @@ WH_Bucket3D_A
  int xCells, int yCells, int zCells)
 : _field (minRange, maxRange, xCells, yCells, zCells)
 {
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < xCells);
+  WH_ASSERT(0 < yCells);
+  WH_ASSERT(0 < zCells);
+
   WH_CVR_LINE;
 
-  _list_s.resize (xCells * yCells * zCells + 1);
-  _indexOutOfRange = xCells * yCells * zCells;
+  _indexOutOfRange = (long long)xCells * yCells * zCells;
+  _isSparse = (MAX_DENSE_CELLS < _indexOutOfRange);
+  if (_isSparse) {
+    WH_CVR_LINE;
+    _list_s.resize (1);
+  } else {
+    WH_CVR_LINE;
+    _list_s.resize (_indexOutOfRange + 1);
+  }
 
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
@@ -48,10 +60,16 @@ bool WH_Bucket3D_A
   WH_ASSERT(0 < this->xCells ());
   WH_ASSERT(0 < this->yCells ());
   WH_ASSERT(0 < this->zCells ());
-  WH_ASSERT(this->nLists () 
-	    == this->xCells () * this->yCells () * this->zCells () + 1);
-  WH_ASSERT(this->indexOutOfRange () 
-	    == this->xCells () * this->yCells () * this->zCells ());
+  WH_ASSERT(this->nCells () 
+	    == (long long)this->xCells () * this->yCells () * this->zCells ());
+  WH_ASSERT(this->indexOutOfRange () == this->nCells ());
+  if (this->isSparse ()) {
+    WH_ASSERT(MAX_DENSE_CELLS < this->nCells ());
+    WH_ASSERT(this->nLists () == 1);
+  } else {
+    WH_ASSERT(this->nLists () == this->nCells () + 1);
+    WH_ASSERT(_sparseList_s.size () == 0);
+  }
   
   return true;
 }
@@ -63,11 +81,22 @@ bool WH_Bucket3D_A
 
   this->checkInvariant ();
   
-  _field.assureInvariant ();
+  if (!this->isSparse ()) {
+    /* the cell indexs of the field are int */
+    _field.assureInvariant ();
+  }
 
   WH_ASSERT(WH_lt (WH_Vector3D (0, 0, 0), this->cellSize ()));
 
-  vector<int> index_s;
+  for (unordered_map< long long, list<void*> >::const_iterator 
+	 i_list = _sparseList_s.begin ();
+       i_list != _sparseList_s.end ();
+       i_list++) {
+    WH_ASSERT(0 <= i_list->first);
+    WH_ASSERT(i_list->first < this->indexOutOfRange ());
+  }
+
+  vector<long long> index_s;
   
   this->allocateIndexsOn 
     (this->minRange (),
@@ -206,10 +235,34 @@ bool WH_Bucket3D_A
   return true;
 }
 
+long long WH_Bucket3D_A
+::nOccupiedCells () const
+{
+  WH_CVR_LINE;
+
+  if (this->isSparse ()) {
+    WH_CVR_LINE;
+    return (long long)_sparseList_s.size () 
+      + (this->listOutOfRange ().empty () ? 0 : 1);
+  }
+
+  long long result = 0;
+  for (vector< list<void*> >::const_iterator 
+	 i_list = _list_s.begin ();
+       i_list != _list_s.end ();
+       i_list++) {
+    if (!i_list->empty ()) {
+      WH_CVR_LINE;
+      result++;
+    }
+  }
+  return result;
+}
+
 void WH_Bucket3D_A
 ::allocateIndexsWithin 
 (const WH_Vector3D& minRange, const WH_Vector3D& maxRange, 
- vector<int>& index_s_OUT) const
+ vector<long long>& index_s_OUT) const
 {
   /* PRE-CONDITION */
   WH_ASSERT(WH_le (minRange, maxRange));
@@ -238,15 +291,15 @@ void WH_Bucket3D_A
   WH_ASSERT(cy0 <= cy1);
   WH_ASSERT(cz0 <= cz1);
 
-  int maxIndexs 
-    = (cx1 - cx0 + 1) * (cy1 - cy0 + 1) * (cz1 - cz0 + 1) + 1;
+  long long maxIndexs 
+    = (long long)(cx1 - cx0 + 1) * (cy1 - cy0 + 1) * (cz1 - cz0 + 1) + 1;
   index_s_OUT.reserve (maxIndexs);
   
   bool outOfRangeExists = false;
   for (int cx = cx0; cx <= cx1; cx++) {
     for (int cy = cy0; cy <= cy1; cy++) {
       for (int cz = cz0; cz <= cz1; cz++) {
-	int index = this->indexIn (cx, cy, cz);
+	long long index = this->indexIn (cx, cy, cz);
 	if (index == _indexOutOfRange) {
 	  WH_CVR_LINE;
 	  outOfRangeExists = true;
@@ -323,7 +376,7 @@ void WH_Bucket3D_A
     for (int cx = cx0; cx <= cx1; cx++) {
       for (int cy = cy0; cy <= cy1; cy++) {
 	for (int cz = cz0; cz <= cz1; cz++) {
-	  int index = this->indexIn (cx, cy, cz);
+	  long long index = this->indexIn (cx, cy, cz);
 	  if (index == _indexOutOfRange) {
 	    WH_CVR_LINE;
 	    outOfRangeExists = true;
@@ -384,7 +437,7 @@ void WH_Bucket3D_A
 
   WH_CVR_LINE;
 
-  vector<int> index_s;
+  vector<long long> index_s;
   this->allocateIndexsWithin 
     (minRange, maxRange, 
      index_s);
@@ -404,7 +457,7 @@ void WH_Bucket3D_A
 
   WH_CVR_LINE;
 
-  vector<int> index_s;
+  vector<long long> index_s;
   this->allocateIndexsWithin 
     (minRange, maxRange, 
      index_s);
@@ -424,7 +477,7 @@ void WH_Bucket3D_A
 
   WH_CVR_LINE;
 
-  vector<int> index_s;
+  vector<long long> index_s;
   this->allocateIndexsWithin 
     (minRange, maxRange, 
      index_s);
@@ -435,6 +488,7 @@ void WH_Bucket3D_A
 	      item);
     WH_ASSERT(i_item1 != item_s.end ());
     item_s.erase (i_item1);
+    this->releaseListAt (index_s[i]);
   }
 }
 
@@ -449,7 +503,7 @@ void WH_Bucket3D_A
 
   WH_CVR_LINE;
 
-  vector<int> index_s;
+  vector<long long> index_s;
   this->allocateIndexsWithin 
     (minRange, maxRange, 
      index_s);
@@ -471,6 +525,7 @@ void WH_Bucket3D_A
     WH_ASSERT(found);
     WH_ASSERT(i_item1 != item_s.end ());
     item_s.erase (i_item1);
+    this->releaseListAt (index_s[i]);
   }
 }
 
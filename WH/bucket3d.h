@@ -18,6 +18,9 @@ template <class Type> class WH_Bucket3D;
 /* value-based class */
 /* heavy weight */
 /* for base class of template version */
+/* a grid of more than MAX_DENSE_CELLS cells is sparse : only the
+   cells which have any item are kept in a hash map, so that the memory
+   scales with the items rather than with the volume of the range */
 class WH_Bucket3D_A {
  public:
   WH_Bucket3D_A 
@@ -35,12 +38,27 @@ class WH_Bucket3D_A {
   int yCells () const;
   int zCells () const;
 
+  enum {
+    MAX_DENSE_CELLS = 1 << 18
+  };
+  bool isSparse () const;
+
+  long long nCells () const;
+
+  long long nOccupiedCells () const;
+  /* cells which have any item, out of range included */
+
   /* derived */
 
  protected:
   WH_UssField3D _field;
+  bool _isSparse;
   vector< list<void*> > _list_s;   /* OWN */
-  int _indexOutOfRange;
+  /* every cell and then out of range, or only out of range if
+     <_isSparse> */
+  unordered_map< long long, list<void*> > _sparseList_s;   /* OWN */
+  /* occupied cells by index if <_isSparse> */
+  long long _indexOutOfRange;
   
   /* base */
 
@@ -48,23 +66,25 @@ class WH_Bucket3D_A {
   WH_Bucket3D_A (const WH_Bucket3D_A& bucket);
   const WH_Bucket3D_A& operator= (const WH_Bucket3D_A& bucket);
 
-  list<void*>& listAt (int index);
+  list<void*>& listAt (long long index);
   list<void*>& listIn (int cx, int cy, int cz);
   list<void*>& listOutOfRange ();
+  void releaseListAt (long long index);
+  /* drops the list of a sparse cell if it is empty */
 
   int nLists () const;
-  int indexOutOfRange () const;
-  int indexIn (int cx, int cy, int cz) const;
-  const list<void*>& listAt (int index) const;
+  long long indexOutOfRange () const;
+  long long indexIn (int cx, int cy, int cz) const;
+  const list<void*>& listAt (long long index) const;
   const list<void*>& listIn (int cx, int cy, int cz) const;
   const list<void*>& listOutOfRange () const;
 
   void allocateIndexsWithin 
     (const WH_Vector3D& minRange, const WH_Vector3D& maxRange, 
-     vector<int>& index_s_OUT) const;
+     vector<long long>& index_s_OUT) const;
   void allocateIndexsOn 
     (const WH_Vector3D& position, 
-     vector<int>& index_s_OUT) const;
+     vector<long long>& index_s_OUT) const;
   
   /* public interface in derived template class */
   void addItemFirstWithin_A 
@@ -46,27 +46,41 @@ WH_INLINE int WH_Bucket3D_A
   return _field.zCells ();
 }
 
+WH_INLINE bool WH_Bucket3D_A
+::isSparse () const
+{
+  return _isSparse;
+}
+
+WH_INLINE long long WH_Bucket3D_A
+::nCells () const
+{
+  return _indexOutOfRange;
+}
+
 WH_INLINE int WH_Bucket3D_A
 ::nLists () const
 {
   return (int)_list_s.size ();
 }
 
-WH_INLINE int WH_Bucket3D_A
+WH_INLINE long long WH_Bucket3D_A
 ::indexOutOfRange () const
 {
   return _indexOutOfRange;
 }
 
-WH_INLINE int WH_Bucket3D_A
+WH_INLINE long long WH_Bucket3D_A
 ::indexIn (int cx, int cy, int cz) const
 {
-  int result;
+  long long result;
 
   if (_field.isOutOfRangeIn (cx, cy, cz)) {
     result = _indexOutOfRange;
   } else {
-    result = _field.cellIndexIn (cx, cy, cz);
+    /* same order as WH_Field3D_A::cellIndexIn (), without overflow */
+    result = ((long long)cx * _field.yCells () + cy) 
+      * _field.zCells () + cz;
   }
 
   /* POST-CONDITION */
@@ -79,53 +93,84 @@ WH_INLINE int WH_Bucket3D_A
 }
 
 WH_INLINE const list<void*>& WH_Bucket3D_A
-::listAt (int index) const
+::listAt (long long index) const
 {
   /* PRE-CONDITION */
   WH_ASSERT(0 <= index);
   WH_ASSERT(index <= _indexOutOfRange);
 
-  return _list_s[index]; 
+  if (!_isSparse) {
+    return _list_s[index]; 
+  } else if (index == _indexOutOfRange) {
+    return _list_s[0];
+  } else {
+    static const list<void*> emptyList;
+    unordered_map< long long, list<void*> >::const_iterator i_list 
+      = _sparseList_s.find (index);
+    return (i_list == _sparseList_s.end ()) ? emptyList : i_list->second;
+  }
 }
 
 WH_INLINE list<void*>& WH_Bucket3D_A
-::listAt (int index)
+::listAt (long long index)
 {
   /* PRE-CONDITION */
   WH_ASSERT(0 <= index);
   WH_ASSERT(index <= _indexOutOfRange);
 
-  return _list_s[index]; 
+  if (!_isSparse) {
+    return _list_s[index]; 
+  } else if (index == _indexOutOfRange) {
+    return _list_s[0];
+  } else {
+    return _sparseList_s[index];
+  }
+}
+
+WH_INLINE void WH_Bucket3D_A
+::releaseListAt (long long index)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= index);
+  WH_ASSERT(index <= _indexOutOfRange);
+
+  if (_isSparse && index != _indexOutOfRange) {
+    unordered_map< long long, list<void*> >::iterator i_list 
+      = _sparseList_s.find (index);
+    if (i_list != _sparseList_s.end () && i_list->second.empty ()) {
+      _sparseList_s.erase (i_list);
+    }
+  }
 }
 
 WH_INLINE const list<void*>& WH_Bucket3D_A
 ::listIn (int cx, int cy, int cz) const
 {
-  return _list_s[this->indexIn (cx, cy, cz)]; 
+  return this->listAt (this->indexIn (cx, cy, cz)); 
 }
 
 WH_INLINE list<void*>& WH_Bucket3D_A
 ::listIn (int cx, int cy, int cz)
 {
-  return _list_s[this->indexIn (cx, cy, cz)]; 
+  return this->listAt (this->indexIn (cx, cy, cz)); 
 }
 
 WH_INLINE const list<void*>& WH_Bucket3D_A
 ::listOutOfRange () const
 { 
-  return _list_s[_indexOutOfRange]; 
+  return this->listAt (_indexOutOfRange); 
 }
 
 WH_INLINE list<void*>& WH_Bucket3D_A
 ::listOutOfRange ()
 { 
-  return _list_s[_indexOutOfRange]; 
+  return this->listAt (_indexOutOfRange); 
 }
 
 WH_INLINE void WH_Bucket3D_A
 ::allocateIndexsOn 
 (const WH_Vector3D& position, 
- vector<int>& index_s_OUT) const
+ vector<long long>& index_s_OUT) const
 {
   this->allocateIndexsWithin 
     (position, position, 
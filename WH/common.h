@@ -25,6 +25,7 @@
 #include <list>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <stdexcept>
 
@@ -0,0 +1,161 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* context.cc : settings of the library for a job */
+
+#include "context.h"
+#include "gm3d_io.h"
+#include "gm3d_setop.h"
+#include "debug_levels.h"
+
+
+
+/* class WH_Context */
+
+WH_Context
+::WH_Context ()
+{
+  _eps = WH::eps;
+  _debugLevel = g_debugLevel;
+  _inOutCheckerType = WH_InOutChecker3D::checkerType ();
+  _keepsFacetForm = WH_GM3D_IO::keepsFacetForm ();
+  _usesLocality = WH_GM3D_SetOperator::usesLocality ();
+  _bodyCache = WH_GM3D_IO::bodyCache ();
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(this->checkInvariant ());
+#endif
+}
+
+WH_Context
+::~WH_Context ()
+{
+}
+
+bool WH_Context
+::checkInvariant () const
+{
+  WH_ASSERT(0 < _eps);
+
+  return true;
+}
+
+bool WH_Context
+::assureInvariant () const
+{
+  this->checkInvariant ();
+
+  return true;
+}
+
+double WH_Context
+::eps () const
+{
+  return _eps;
+}
+
+void WH_Context
+::setEps (double eps)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < eps);
+
+  _eps = eps;
+}
+
+int WH_Context
+::debugLevel () const
+{
+  return _debugLevel;
+}
+
+void WH_Context
+::setDebugLevel (int debugLevel)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(WH_DEBUG_SILENT <= debugLevel);
+  WH_ASSERT(debugLevel <= WH_DEBUG_TRACE);
+
+  _debugLevel = debugLevel;
+}
+
+WH_InOutChecker3D::CheckerType WH_Context
+::inOutCheckerType () const
+{
+  return _inOutCheckerType;
+}
+
+void WH_Context
+::setInOutCheckerType (WH_InOutChecker3D::CheckerType checkerType)
+{
+  _inOutCheckerType = checkerType;
+}
+
+bool WH_Context
+::keepsFacetForm () const
+{
+  return _keepsFacetForm;
+}
+
+void WH_Context
+::setKeepsFacetForm (bool keepsFacetForm)
+{
+  _keepsFacetForm = keepsFacetForm;
+}
+
+bool WH_Context
+::usesLocality () const
+{
+  return _usesLocality;
+}
+
+void WH_Context
+::setUsesLocality (bool usesLocality)
+{
+  _usesLocality = usesLocality;
+}
+
+WH_GM3D_BodyCache* WH_Context
+::bodyCache () const
+{
+  return _bodyCache;
+}
+
+void WH_Context
+::setBodyCache (WH_GM3D_BodyCache* cache)
+{
+  _bodyCache = cache;
+}
+
+void WH_Context
+::install () const
+{
+  WH::eps = _eps;
+  WH_SetDebugLevel (_debugLevel);
+  WH_InOutChecker3D::setCheckerType (_inOutCheckerType);
+  WH_GM3D_IO::setKeepsFacetForm (_keepsFacetForm);
+  WH_GM3D_SetOperator::setUsesLocality (_usesLocality);
+  WH_GM3D_IO::setBodyCache (_bodyCache);
+}
+
+
+
+/* class WH_ContextScope */
+
+WH_ContextScope
+::WH_ContextScope
+(const WH_Context& context)
+  : _savedContext ()
+{
+  context.install ();
+}
+
+WH_ContextScope
+::~WH_ContextScope ()
+{
+  _savedContext.install ();
+}
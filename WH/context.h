@@ -0,0 +1,103 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* header file for context.cc */
+
+#pragma once
+#ifndef WH_INCLUDED_WH_INOUT3D
+#include <WH/inout3d.h>
+#define WH_INCLUDED_WH_INOUT3D
+#endif
+
+class WH_GM3D_BodyCache;
+class WH_Context;
+class WH_ContextScope;
+
+/* value-based class */
+/* settings of the library for a job.  the library keeps them, and its
+   counters, per thread, so that jobs on different threads do not
+   share any mutable state.  a job runs under its context through
+   WH_ContextScope */
+class WH_Context {
+ public:
+  WH_Context ();
+  /* settings of the calling thread */
+  virtual ~WH_Context ();
+  virtual bool checkInvariant () const;
+  virtual bool assureInvariant () const;
+
+  /* base */
+  double eps () const;
+  void setEps (double eps);
+  /* WH::eps */
+
+  int debugLevel () const;
+  void setDebugLevel (int debugLevel);
+  /* g_debugLevel */
+
+  WH_InOutChecker3D::CheckerType inOutCheckerType () const;
+  void setInOutCheckerType (WH_InOutChecker3D::CheckerType checkerType);
+
+  bool keepsFacetForm () const;
+  void setKeepsFacetForm (bool keepsFacetForm);
+
+  bool usesLocality () const;
+  void setUsesLocality (bool usesLocality);
+
+  WH_GM3D_BodyCache* bodyCache () const;
+  void setBodyCache (WH_GM3D_BodyCache* cache);
+  /* shared by the contexts which refer to it */
+
+  void install () const;
+  /* make the settings those of the calling thread */
+
+  /* derived */
+
+ protected:
+  double _eps;
+
+  int _debugLevel;
+
+  WH_InOutChecker3D::CheckerType _inOutCheckerType;
+
+  bool _keepsFacetForm;
+
+  bool _usesLocality;
+
+  WH_GM3D_BodyCache* _bodyCache;
+
+  /* base */
+
+  /* derived */
+
+};
+
+/* value-based class */
+/* no inheritance */
+/* installs a context to the calling thread for its lifetime, and
+   restores the settings before */
+class WH_ContextScope {
+ public:
+  WH_ContextScope
+    (const WH_Context& context);
+  ~WH_ContextScope ();
+
+  /* base */
+
+  /* derived */
+
+ protected:
+  WH_Context _savedContext;
+
+  /* no implementation */
+  WH_ContextScope (const WH_ContextScope& scope);
+  const WH_ContextScope& operator= (const WH_ContextScope& scope);
+
+  /* base */
+
+  /* derived */
+
+};
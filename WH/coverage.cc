@@ -359,3 +359,107 @@ protected:
 };
 
 static WH_CVR_CoverageMonitorSingleton Singleton;
+
+
+
+/* class WH_CVR_HitCounter */
+
+static const char* HitCounterFileName = "WH_CVR_HITS";
+
+/* bounds of the section "wh_cvr_hits" given by the linker.  they are
+   null if no site is compiled in the hit counter mode */
+extern "C" {
+  extern WH_CVR_HitSite __start_wh_cvr_hits[] __attribute__((weak));
+  extern WH_CVR_HitSite __stop_wh_cvr_hits[] __attribute__((weak));
+}
+
+WH_CVR_HitCounter
+::WH_CVR_HitCounter ()
+{
+}
+
+WH_CVR_HitCounter
+::~WH_CVR_HitCounter ()
+{
+  if (nSites () == 0) return;
+
+  ofstream out (HitCounterFileName);
+  if (!out) return;
+  report (out);
+}
+
+int WH_CVR_HitCounter
+::nSites ()
+{
+  if (__start_wh_cvr_hits == WH_NULL) return 0;
+  return (int)(__stop_wh_cvr_hits - __start_wh_cvr_hits);
+}
+
+unsigned long long WH_CVR_HitCounter
+::nTotalHits ()
+{
+  unsigned long long result = 0;
+  for (int iSite = 0; iSite < nSites (); iSite++) {
+    result += __start_wh_cvr_hits[iSite].nHits.load 
+      (memory_order_relaxed);
+  }
+  return result;
+}
+
+void WH_CVR_HitCounter
+::report (ostream& out)
+{
+  /* the counts are taken once, since other threads may be running */
+  vector<pair<unsigned long long, int> > hitSite_s;
+  for (int iSite = 0; iSite < nSites (); iSite++) {
+    unsigned long long nHits 
+      = __start_wh_cvr_hits[iSite].nHits.load (memory_order_relaxed);
+    if (0 < nHits) {
+      hitSite_s.push_back (make_pair (nHits, iSite));
+    }
+  }
+  sort (hitSite_s.begin (), hitSite_s.end (), 
+	[] (const pair<unsigned long long, int>& hitSite0,
+	    const pair<unsigned long long, int>& hitSite1) {
+	  if (hitSite0.first != hitSite1.first) {
+	    return hitSite0.first > hitSite1.first;
+	  }
+	  return hitSite0.second < hitSite1.second;
+	});
+
+  unsigned long long nTotal = 0;
+  for (vector<pair<unsigned long long, int> >::const_iterator 
+	 i_hitSite = hitSite_s.begin ();
+       i_hitSite != hitSite_s.end ();
+       i_hitSite++) {
+    nTotal += (*i_hitSite).first;
+  }
+
+  out << "# hottest lines : " << hitSite_s.size () 
+      << " of " << nSites () << " sites executed, " 
+      << nTotal << " hits" << endl;
+  out << "# hits  percent  cumulative  file line" << endl;
+
+  unsigned long long nCumulative = 0;
+  for (vector<pair<unsigned long long, int> >::const_iterator 
+	 i_hitSite = hitSite_s.begin ();
+       i_hitSite != hitSite_s.end ();
+       i_hitSite++) {
+    const WH_CVR_HitSite& site = __start_wh_cvr_hits[(*i_hitSite).second];
+    unsigned long long nHits = (*i_hitSite).first;
+    nCumulative += nHits;
+    out << nHits << " " 
+	<< fixed << setprecision (2) 
+	<< 100.0 * nHits / nTotal << " "
+	<< 100.0 * nCumulative / nTotal << " "
+	<< site.fileNameCstr << " " << site.lineId << endl;
+  }
+}
+
+void WH_CVR_HitCounter
+::reset ()
+{
+  for (int iSite = 0; iSite < nSites (); iSite++) {
+    __start_wh_cvr_hits[iSite].nHits.store (0, memory_order_relaxed);
+  }
+}
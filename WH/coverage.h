@@ -12,9 +12,12 @@
 #define WH_INCLUDED_WH_COMMON
 #endif
 
+#include <atomic>
+
 class WH_CVR_Record;
 class WH_CVR_CoverageMonitor;
 class WH_CVR_Line;
+class WH_CVR_HitCounter;
 
 /* value-based class */
 /* heavy weight */
@@ -114,7 +117,50 @@ class WH_CVR_Line {
   
 };
 
-#ifdef WH_COVERAGE_ENABLED
+/* a site of WH_CVR_LINE in the hit counter mode.  the sites are
+   placed in the section "wh_cvr_hits", so that all the sites of the
+   program make a contiguous array.  the size is fixed at 32 bytes,
+   since the compiler aligns static objects of 32 bytes at 32 bytes
+   and of 16 bytes or more at 16 bytes */
+struct alignas(32) WH_CVR_HitSite {
+  const char* fileNameCstr;
+  int lineId;
+  atomic<unsigned long long> nHits;
+};
+static_assert(sizeof (WH_CVR_HitSite) == 32, "stride of wh_cvr_hits");
+
+/* singleton pattern */
+class WH_CVR_HitCounter {
+ public:
+  WH_CVR_HitCounter ();
+  virtual ~WH_CVR_HitCounter ();
+  /* write the report to "WH_CVR_HITS" in the current directory */
+  
+  /* base */
+  static int nSites ();
+
+  static unsigned long long nTotalHits ();
+
+  static void report (ostream& out);
+  /* the sites which are executed, in decreasing order of the hit
+     counts */
+
+  static void reset ();
+
+  /* derived */
+  
+ protected:
+  /* no implementation */
+  WH_CVR_HitCounter (const WH_CVR_HitCounter& counter);
+  const WH_CVR_HitCounter& operator= (const WH_CVR_HitCounter& counter);
+  
+  /* base */
+  
+  /* derived */
+  
+};
+
+#if defined(WH_COVERAGE_ENABLED)
 
 #define WH_CVR_LINE \
 { \
@@ -122,6 +168,23 @@ static WH_CVR_Line cvrLine (__FILE__, __LINE__);  \
 cvrLine.execute (); \
 }
 
+#elif defined(WH_HIT_COUNTER_ENABLED)
+
+#if !defined(__GNUC__)
+#error "WH_HIT_COUNTER_ENABLED needs named sections of GCC or Clang"
+#endif
+
+/* reports the hit counts at exit */
+inline WH_CVR_HitCounter WH_CVR_hitCounter;
+
+#define WH_CVR_LINE \
+{ \
+static WH_CVR_HitSite cvrHitSite \
+__attribute__((section ("wh_cvr_hits"), used)) \
+= { __FILE__, __LINE__, { 0 } }; \
+cvrHitSite.nHits.fetch_add (1, memory_order_relaxed); \
+}
+
 #else
 
 #define WH_CVR_LINE 
@@ -2,8 +2,8 @@
 #include <cstdlib>
 #include <cstring>
 
-// Global debug level - defaults to SILENT
-int g_debugLevel = WH_DEBUG_SILENT;
+// Debug level of the calling thread - defaults to SILENT
+thread_local int g_debugLevel = WH_DEBUG_SILENT;
 
 void WH_InitDebugLevel() {
     const char* env_level = getenv("DEBUG_LEVEL");
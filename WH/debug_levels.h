@@ -11,8 +11,8 @@ enum WH_DebugLevel {
     WH_DEBUG_TRACE = 3      // + full trace including loops and arrays
 };
 
-// Global debug level - defaults to SILENT
-extern int g_debugLevel;
+// Debug level of the calling thread - defaults to SILENT
+extern thread_local int g_debugLevel;
 
 // Initialization and control functions
 void WH_InitDebugLevel();
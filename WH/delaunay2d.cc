@@ -184,6 +184,11 @@ WH_DLN2D_Triangle
     _radiusOfCircle = WH_max(minEdge * 0.1, 1e-10); 
     cerr << "   Using fallback radius: " << _radiusOfCircle << endl;
   }
+  double orientation = WH_RobustPredicates::orient2d_robust
+    (_points[0]->position (), 
+     _points[1]->position (), 
+     _points[2]->position ());
+  _orientation = (0 < orientation) - (orientation < 0);
 
   for (int e = 0; e < 3; e++) _neighbors[e] = WH_NULL;
   _markFlag = false;
@@ -279,6 +284,7 @@ void WH_DLN2D_Triangle
     WH_DLN2D_Triangle* neighbor = _neighbors[0];
     _neighbors[0] = _neighbors[1];  
     _neighbors[1] = neighbor;
+    _orientation = -_orientation;
   }
 }
 
@@ -644,9 +650,8 @@ WH_DLN2D_Triangle* WH_DLN2D_Triangulator
       return tri_i;
     }
   }
-  cerr <<  " WH_DLN2D_Triangulator : first triangle is not found "
-       << endl;
-  WH_ASSERT_NO_REACH;
+  /* <_currentPoint> is out of the dummy points */
+  WH_CVR_LINE;
   return WH_NULL;
 }
 
@@ -672,7 +677,7 @@ void WH_DLN2D_Triangulator
       = tri->point 
       (WH_Triangle2D_A::edgeVertexMap[edgeNumber][1]);
     WH_DLN2D_Segment* seg 
-      = new WH_DLN2D_Segment (point0, point1);
+      = _arena.create<WH_DLN2D_Segment> (point0, point1);
     WH_ASSERT(seg != WH_NULL);
     _surroundingSegment_s.push_back (seg);
     seg->setFront (neighbor);
@@ -710,9 +715,12 @@ bool WH_DLN2D_Triangulator
        i_seg++) {
     WH_DLN2D_Segment* seg_i = (*i_seg);
     
-    WH_Line2D line (seg_i->point0 ()->position (),
-		    seg_i->point1 ()->position ());
-    if (WH_eq (line.valueAt (_currentPoint->position ()), 0)) {
+    /* exact test.  with the exact incircle test this happens only for
+       a duplicated point */
+    if (WH_RobustPredicates::orient2d_robust
+	(seg_i->point0 ()->position (),
+	 seg_i->point1 ()->position (),
+	 _currentPoint->position ()) == 0) {
       WH_CVR_LINE;
       return false;
     }
@@ -816,8 +824,8 @@ void WH_DLN2D_Triangulator
   }
 
   /* delete surrounding segments */
-  WH_T_Delete (_surroundingSegment_s);
   _surroundingSegment_s.clear ();
+  _arena.release ();
 }
 
 bool WH_DLN2D_Triangulator
@@ -834,8 +842,15 @@ bool WH_DLN2D_Triangulator
 
   _currentPoint = point;
 
-  this->markTriangle 
-    (this->pickUpFirstTriangle ());
+  WH_DLN2D_Triangle* firstTri = this->pickUpFirstTriangle ();
+  if (firstTri == WH_NULL) {
+    WH_CVR_LINE;
+    cerr <<  " WH_DLN2D_Triangulator : first triangle is not found "
+	 << endl;
+    return false;
+  }
+
+  this->markTriangle (firstTri);
   if (this->checkSegment ()) {
     WH_CVR_LINE;
     /* perform addition of the point */
@@ -858,8 +873,8 @@ bool WH_DLN2D_Triangulator
     }
     _deletedTriangle_s.clear ();
     
-    WH_T_Delete (_surroundingSegment_s);
     _surroundingSegment_s.clear ();  
+    _arena.release ();
   }
 
   /* POST-CONDITION */
@@ -880,6 +895,9 @@ void WH_DLN2D_Triangulator
 
   WH_CVR_LINE;
 
+  WH_RobustPredicates::FilterCounters counters 
+    = WH_RobustPredicates::filter_counters ();
+
   vector<bool> checkMarks (_point_s.size ());
   for (int i_point = 0; 
        i_point < (int)checkMarks.size (); 
@@ -934,6 +952,20 @@ void WH_DLN2D_Triangulator
       }
     }
   }
+
+  int nCancelled = 0;
+  for (int i_point = 0; 
+       i_point < (int)checkMarks.size (); 
+       i_point++) {
+    if (!checkMarks[i_point]) nCancelled++;
+  }
+  if (0 < nCancelled) {
+    WH_CVR_LINE;
+    cerr << " WH_DLN2D_Triangulator : " << nCancelled 
+	 << " points are not inserted " << endl;
+  }
+  WH_RobustPredicates::print_filter_counters 
+    ("WH_DLN2D_Triangulator", counters);
 }
 
 void WH_DLN2D_Triangulator
@@ -12,6 +12,16 @@
 #define WH_INCLUDED_WH_SPACE2D
 #endif
 
+#ifndef WH_INCLUDED_WH_ROBUST_PREDICATES
+#include <WH/robust_predicates.h>
+#define WH_INCLUDED_WH_ROBUST_PREDICATES
+#endif
+
+#ifndef WH_INCLUDED_WH_ARENA
+#include <WH/arena.h>
+#define WH_INCLUDED_WH_ARENA
+#endif
+
 class WH_DLN2D_Point;
 class WH_DLN2D_Segment;
 class WH_DLN2D_Triangle;
@@ -145,6 +155,9 @@ class WH_DLN2D_Triangle {
 
   double _radiusOfCircle;
 
+  int _orientation;
+  /* exact sign of orient2d () of the vertices, 0 if flat */
+
   WH_DLN2D_Point* _points[3];
 
   WH_DLN2D_Triangle* _neighbors[3];
@@ -199,7 +212,10 @@ class WH_DLN2D_Triangulator {
   /* not own */
 
   vector<WH_DLN2D_Segment*> _surroundingSegment_s;  
-  /* not own */
+  /* on <_arena> */
+
+  WH_Arena _arena;
+  /* the temporaries of the insertion of a point */
 
   /* base */
 
@@ -225,6 +241,7 @@ class WH_DLN2D_Triangulator {
 
   virtual WH_DLN2D_Triangle* 
     pickUpFirstTriangle () const;
+  /* WH_NULL if <_currentPoint> is out of the dummy points */
 
   virtual void searchNeighbor 
     (WH_DLN2D_Triangle* tri, int edgeNumber);
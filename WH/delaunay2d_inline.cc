@@ -198,15 +198,22 @@ WH_INLINE bool WH_DLN2D_Triangle
   /* PRE-CONDITION */
   WH_ASSERT(point != WH_NULL);
   
-  double sum = WH_squareSum (point->position (), _centerOfCircle);
-  double sum2 = _radiusOfCircle * _radiusOfCircle;
-  
-  /* NEED TO REDEFINE : numerical error */
-#if 0
-  return WH_le2 (sum, sum2);
-#else
-  return WH_le (sum, sum2);
-#endif
+  if (_orientation == 0) {
+    /* flat triangle left by constraint recovery */
+    double sum = WH_squareSum (point->position (), _centerOfCircle);
+    double sum2 = _radiusOfCircle * _radiusOfCircle;
+    return WH_le (sum, sum2);
+  }
+
+  /* inside or on the circle, evaluated exactly.  then the cavity of a
+     point is star-shaped, and none of its edges is collinear with the
+     point unless it coincides with a vertex */
+  double value = WH_RobustPredicates::incircle_robust
+    (_points[0]->position (), 
+     _points[1]->position (), 
+     _points[2]->position (), 
+     point->position ());
+  return 0 <= _orientation * value;
 }
 
 
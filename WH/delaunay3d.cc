@@ -166,13 +166,12 @@ WH_DLN3D_Tetrahedron
   _points[1] = point1;  
   _points[2] = point2;  
   _points[3] = point3;
-  _centerOfSphere 
-    = WH_circumcenterAmong (_points[0]->position (), 
-			    _points[1]->position (), 
-			    _points[2]->position (), 
-			    _points[3]->position ());
-  _radiusOfSphere 
-    = WH_distance (_centerOfSphere, _points[0]->position ());
+  double orientation = WH_RobustPredicates::orient3d_robust
+    (_points[0]->position (), 
+     _points[1]->position (), 
+     _points[2]->position (), 
+     _points[3]->position ());
+  _orientation = (0 < orientation) - (orientation < 0);
 
   for (int f = 0; f < 4; f++) _neighbors[f] = WH_NULL;
   _markFlag = false;
@@ -189,7 +188,7 @@ bool WH_DLN3D_Tetrahedron
 {
   WH_CVR_LINE;
 
-  WH_ASSERT(WH_lt (0, _radiusOfSphere));
+  WH_ASSERT(_orientation != 0);
 
   WH_ASSERT(this->point (0) != WH_NULL);
   WH_ASSERT(this->point (1) != WH_NULL);
@@ -270,6 +269,7 @@ void WH_DLN3D_Tetrahedron
     WH_DLN3D_Tetrahedron* neighbor = _neighbors[0];
     _neighbors[0] = _neighbors[1];  
     _neighbors[1] = neighbor;
+    _orientation = -_orientation;
   }
 }
 
@@ -767,9 +767,8 @@ WH_DLN3D_Tetrahedron* WH_DLN3D_Triangulator
       return tetra_i;
     }
   }
-  cerr << " WH_DLN3D_Triangulator : first tetrahedron is not found "
-       << endl;
-  WH_ASSERT_NO_REACH;
+  /* <_currentPoint> is out of the dummy points */
+  WH_CVR_LINE;
   return WH_NULL;
 }
 
@@ -800,7 +799,7 @@ void WH_DLN3D_Triangulator
       = tetra->point 
       (WH_Tetrahedron3D_A::faceVertexMap[faceNumber][2]);
     WH_DLN3D_Triangle* tri 
-      = new WH_DLN3D_Triangle
+      = _arena.create<WH_DLN3D_Triangle>
       (point0, point1, point2, tetra, faceNumber);
     WH_ASSERT(tri != WH_NULL);
     _surroundingTriangle_s.push_back (tri);
@@ -839,24 +838,17 @@ bool WH_DLN3D_Triangulator
        i_tri++) {
     WH_DLN3D_Triangle* tri_i = (*i_tri);
 
-    WH_Plane3D plane (tri_i->point (0)->position (),
-		      tri_i->point (1)->position (),
-		      tri_i->point (2)->position ());
-
-    /* NEED TO REDEFINE : numerical error */
-#if 0
-    if (WH_eq (plane.valueAt (_currentPoint->position ()), 0)) {
-      cerr << " checkTriangle CANCEL \n";
-      return false;
-    }
-#else
-    /* MAGIC NUMBER */
-    if (fabs (plane.valueAt (_currentPoint->position ())) < 0.00001) {
+    /* exact test.  with the exact insphere test this happens only for
+       a duplicated point */
+    if (WH_RobustPredicates::orient3d_robust
+	(tri_i->point (0)->position (),
+	 tri_i->point (1)->position (),
+	 tri_i->point (2)->position (),
+	 _currentPoint->position ()) == 0) {
       WH_CVR_LINE;
       cerr << " checkTriangle CANCEL \n";
       return false;
     }
-#endif
   }
   return true;
 }
@@ -908,9 +900,8 @@ void WH_DLN3D_Triangulator
 	  tri_i->setEdgeAt (iEdge, seg_i->triangle);
 	  seg_i->triangle->setEdgeAt (seg_i->edgeNumber, tri_i);
 	  
-	  /* invalidate <i_seg> and delete <seg_i> */
+	  /* invalidate <i_seg>.  <seg_i> is on <_arena> */
 	  seg_s.erase (i_seg);
-	  delete seg_i;
 	  seg_i = WH_NULL;
 
 #ifndef NDEBUG
@@ -925,7 +916,7 @@ void WH_DLN3D_Triangulator
       if (!sameSegmentIsFound) {
 	WH_CVR_LINE;
 
-	Segment* seg = new Segment (tri_i, iEdge, point0, point1);
+	Segment* seg = _arena.create<Segment> (tri_i, iEdge, point0, point1);
 	WH_ASSERT(seg != WH_NULL);
 	seg_s.push_front (seg);
 
@@ -1009,8 +1000,8 @@ void WH_DLN3D_Triangulator
   }
 
   /* delete surrounding triangles */
-  WH_T_Delete (_surroundingTriangle_s);
   _surroundingTriangle_s.clear ();
+  _arena.release ();
 }
 
 bool WH_DLN3D_Triangulator
@@ -1027,8 +1018,15 @@ bool WH_DLN3D_Triangulator
 
   _currentPoint = point;
 
-  this->markTetrahedron 
-    (this->pickUpFirstTetrahedron ());
+  WH_DLN3D_Tetrahedron* firstTetra = this->pickUpFirstTetrahedron ();
+  if (firstTetra == WH_NULL) {
+    WH_CVR_LINE;
+    cerr << " WH_DLN3D_Triangulator : first tetrahedron is not found "
+	 << endl;
+    return false;
+  }
+
+  this->markTetrahedron (firstTetra);
   if (this->checkTriangle ()) {
     WH_CVR_LINE;
     /* perform addition of the point */
@@ -1051,8 +1049,8 @@ bool WH_DLN3D_Triangulator
     }
     _deletedTetrahedron_s.clear ();
     
-    WH_T_Delete (_surroundingTriangle_s);
     _surroundingTriangle_s.clear ();  
+    _arena.release ();
   }
 
   /* POST-CONDITION */
@@ -1073,6 +1071,9 @@ void WH_DLN3D_Triangulator
 
   WH_CVR_LINE;
 
+  WH_RobustPredicates::FilterCounters counters 
+    = WH_RobustPredicates::filter_counters ();
+
   /* add other dummy points near the 6 faces of a cube */
   /* surrounding the domain  */
   for (vector<WH_DLN3D_Point*>::const_iterator 
@@ -1137,6 +1138,20 @@ void WH_DLN3D_Triangulator
       }
     }
   }
+
+  int nCancelled = 0;
+  for (int i_point = 0; 
+       i_point < (int)checkMarks.size (); 
+       i_point++) {
+    if (!checkMarks[i_point]) nCancelled++;
+  }
+  if (0 < nCancelled) {
+    WH_CVR_LINE;
+    cerr << " WH_DLN3D_Triangulator : " << nCancelled 
+	 << " points are not inserted " << endl;
+  }
+  WH_RobustPredicates::print_filter_counters 
+    ("WH_DLN3D_Triangulator", counters);
 }
 
 void WH_DLN3D_Triangulator
@@ -12,6 +12,16 @@
 #define WH_INCLUDED_WH_SPACE3D
 #endif
 
+#ifndef WH_INCLUDED_WH_ROBUST_PREDICATES
+#include <WH/robust_predicates.h>
+#define WH_INCLUDED_WH_ROBUST_PREDICATES
+#endif
+
+#ifndef WH_INCLUDED_WH_ARENA
+#include <WH/arena.h>
+#define WH_INCLUDED_WH_ARENA
+#endif
+
 class WH_DLN3D_Point;
 class WH_DLN3D_Triangle;
 class WH_DLN3D_Tetrahedron;
@@ -162,14 +172,17 @@ class WH_DLN3D_Tetrahedron {
   /* derived */
 
  protected:
-  WH_Vector3D _centerOfSphere;
-
-  double _radiusOfSphere;
+  /* the circumsphere is not cached.  includesWithinSphere () evaluates
+     insphere from the vertices, since most of tetrahedrons are deleted
+     by later cavities before they are tested many times */
 
   WH_DLN3D_Point* _points[4];
 
   WH_DLN3D_Tetrahedron* _neighbors[4];
 
+  int _orientation;
+  /* exact sign of orient3d () of the vertices, 0 if flat */
+
   bool _markFlag;
 
   list<WH_DLN3D_Tetrahedron*>::iterator _iterator;
@@ -241,7 +254,10 @@ class WH_DLN3D_Triangulator {
   /* not own */
 
   vector<WH_DLN3D_Triangle*> _surroundingTriangle_s;  
-  /* not own */
+  /* on <_arena> */
+
+  WH_Arena _arena;
+  /* the temporaries of the insertion of a point */
 
   /* base */
 
@@ -268,6 +284,7 @@ class WH_DLN3D_Triangulator {
 
   virtual WH_DLN3D_Tetrahedron* 
     pickUpFirstTetrahedron () const;
+  /* WH_NULL if <_currentPoint> is out of the dummy points */
 
   virtual void searchNeighbor 
     (WH_DLN3D_Tetrahedron* tetra, int faceNumber);
@@ -226,15 +226,18 @@ WH_INLINE bool WH_DLN3D_Tetrahedron
   /* PRE-CONDITION */
   WH_ASSERT(point != WH_NULL);
   
-  double sum = WH_squareSum (point->position (), _centerOfSphere);
-  double sum2 = _radiusOfSphere * _radiusOfSphere;
-  
-  /* NEED TO REDEFINE : numerical error */
-#if 0
-  return WH_le2 (sum, sum2);
-#else
-  return WH_le (sum, sum2);
-#endif
+  if (_orientation == 0) return false;
+
+  /* inside or on the sphere, evaluated exactly.  then the cavity of a
+     point in a Delaunay triangulation is star-shaped, and none of its
+     faces is coplanar with the point unless it coincides with a vertex */
+  double value = WH_RobustPredicates::insphere_robust
+    (_points[0]->position (), 
+     _points[1]->position (), 
+     _points[2]->position (), 
+     _points[3]->position (), 
+     point->position ());
+  return 0 <= _orientation * value;
 }
 
 
@@ -17,6 +17,97 @@
 
 /* class WH_GM2D_SegmentFacet */
 
+static void CollectCrossingCandidates
+(const vector<WH_Segment2D>& segmentBy_s,
+ const vector<WH_GM2D_SegmentFacet*>& facet_s,
+ vector<vector<int> >& segmentIndex_s_s_OUT)
+{
+  /* broad phase : sweep the ranges of the facets and the segments in
+     increasing order of their min X, and report each pair of a facet
+     and a segment whose ranges overlap once, at the start of the
+     later one */
+
+  WH_CVR_LINE;
+
+  int nFacets = (int)facet_s.size ();
+  int nSegments = (int)segmentBy_s.size ();
+
+  /* ranges of the facets come first, then those of the segments */
+  vector<WH_Vector2D> minRange_s (nFacets + nSegments);
+  vector<WH_Vector2D> maxRange_s (nFacets + nSegments);
+  for (int iFacet = 0; iFacet < nFacets; iFacet++) {
+    facet_s[iFacet]->getRange 
+      (minRange_s[iFacet], maxRange_s[iFacet]);
+  }
+  for (int iSeg = 0; iSeg < nSegments; iSeg++) {
+    minRange_s[nFacets + iSeg] = segmentBy_s[iSeg].minRange ();
+    maxRange_s[nFacets + iSeg] = segmentBy_s[iSeg].maxRange ();
+  }
+
+  vector<int> item_s (nFacets + nSegments);
+  for (int iItem = 0; iItem < nFacets + nSegments; iItem++) {
+    item_s[iItem] = iItem;
+  }
+  stable_sort (item_s.begin (), item_s.end (),
+	       [&minRange_s] (int item0, int item1) {
+		 return minRange_s[item0].x < minRange_s[item1].x;
+	       });
+
+  segmentIndex_s_s_OUT.assign (nFacets, vector<int> ());
+
+  vector<int> activeFacet_s;
+  vector<int> activeSegment_s;
+  for (vector<int>::const_iterator 
+	 i_item = item_s.begin ();
+       i_item != item_s.end ();
+       i_item++) {
+    int item_i = (*i_item);
+    bool isFacet = item_i < nFacets;
+
+    /* the items of the other kind which are still active */
+    vector<int>& active_s = isFacet ? activeSegment_s : activeFacet_s;
+    int nActives = 0;
+    for (vector<int>::const_iterator 
+	   i_active = active_s.begin ();
+	 i_active != active_s.end ();
+	 i_active++) {
+      int active_i = (*i_active);
+      if (WH_lt (maxRange_s[active_i].x, minRange_s[item_i].x)) {
+	WH_CVR_LINE;
+	/* <active_i> ends before <item_i> and all the later items */
+	continue;
+      }
+      active_s[nActives++] = active_i;
+
+      if (WH_minMaxPairsOverlap 
+	  (minRange_s[item_i], maxRange_s[item_i],
+	   minRange_s[active_i], maxRange_s[active_i])) {
+	WH_CVR_LINE;
+	if (isFacet) {
+	  segmentIndex_s_s_OUT[item_i].push_back (active_i - nFacets);
+	} else {
+	  segmentIndex_s_s_OUT[active_i].push_back (item_i - nFacets);
+	}
+      }
+    }
+    active_s.resize (nActives);
+
+    if (isFacet) {
+      activeFacet_s.push_back (item_i);
+    } else {
+      activeSegment_s.push_back (item_i);
+    }
+  }
+
+  /* keep the order of <segmentBy_s> for each facet */
+  for (vector<vector<int> >::iterator 
+	 i_index_s = segmentIndex_s_s_OUT.begin ();
+       i_index_s != segmentIndex_s_s_OUT.end ();
+       i_index_s++) {
+    sort ((*i_index_s).begin (), (*i_index_s).end ());
+  }
+}
+
 void WH_GM2D_SegmentFacet
 ::divideFacetsBySegments 
 (const vector<WH_Segment2D>& segmentBy_s,
@@ -27,45 +118,42 @@ void WH_GM2D_SegmentFacet
 
   WH_CVR_LINE;
 
-  for (vector<WH_Segment2D>::const_iterator 
-	 i_seg = segmentBy_s.begin ();
-       i_seg != segmentBy_s.end ();
-       i_seg++) {
-    WH_Segment2D segmentBy_i = (*i_seg);
-    
-    vector<WH_GM2D_SegmentFacet*> remainingFacet_s;
-    vector<WH_GM2D_SegmentFacet*> deletedFacet_s;
-    vector<WH_GM2D_SegmentFacet*> newFacet_s;
-    for (vector<WH_GM2D_SegmentFacet*>::const_iterator 
-	   i_facet = facet_s_IO.begin ();
-	 i_facet != facet_s_IO.end ();
-	 i_facet++) {
-      WH_GM2D_SegmentFacet* facet_i = (*i_facet);
-
-      vector<WH_GM2D_SegmentFacet*> facet_s;
-      if (facet_i->createDividedFacetsBySegment (segmentBy_i,
-						 facet_s)) {
-	WH_CVR_LINE;
-	deletedFacet_s.push_back (facet_i);
-	WH_T_Add (facet_s, newFacet_s);
-      } else {
-	WH_CVR_LINE;
-	remainingFacet_s.push_back (facet_i);
-      }
+  /* each facet is divided only by the segments found by the broad
+     phase, at all of their dividing points in one pass.  the divided
+     facets replace the original one in the same place */
+
+  vector<vector<int> > segmentIndex_s_s;
+  CollectCrossingCandidates (segmentBy_s, facet_s_IO, 
+			     segmentIndex_s_s);
+
+  vector<WH_GM2D_SegmentFacet*> resultFacet_s;
+  resultFacet_s.reserve (facet_s_IO.size ());
+  vector<WH_Segment2D> candidate_s;
+  vector<WH_GM2D_SegmentFacet*> facet_s;
+  for (int iFacet = 0; iFacet < (int)facet_s_IO.size (); iFacet++) {
+    WH_GM2D_SegmentFacet* facet_i = facet_s_IO[iFacet];
+
+    candidate_s.clear ();
+    for (vector<int>::const_iterator 
+	   i_index = segmentIndex_s_s[iFacet].begin ();
+	 i_index != segmentIndex_s_s[iFacet].end ();
+	 i_index++) {
+      candidate_s.push_back (segmentBy_s[*i_index]);
     }
-    WH_ASSERT(deletedFacet_s.size () + remainingFacet_s.size ()
-	      == facet_s_IO.size ());
-    
-    if (0 < newFacet_s.size ()) {
+
+    if (0 < candidate_s.size ()
+	&& facet_i->createDividedFacetsBySegments (candidate_s,
+						   facet_s)) {
       WH_CVR_LINE;
-      WH_ASSERT(0 < deletedFacet_s.size ());
-      WH_ASSERT(2 <= newFacet_s.size ());
-      WH_T_Delete (deletedFacet_s);
-      deletedFacet_s.clear ();
-      WH_T_Move (remainingFacet_s, facet_s_IO);
-      WH_T_Add (newFacet_s, facet_s_IO);
+      WH_ASSERT(2 <= facet_s.size ());
+      delete facet_i;
+      WH_T_Add (facet_s, resultFacet_s);
+    } else {
+      WH_CVR_LINE;
+      resultFacet_s.push_back (facet_i);
     }
   }
+  facet_s_IO.swap (resultFacet_s);
 
   /* PRE-CONDITION */
 #ifndef WH_PRE_ONLY
@@ -367,6 +455,113 @@ bool WH_GM2D_SegmentFacet
   return result;
 }
 
+bool WH_GM2D_SegmentFacet
+::createDividedFacetsBySegments 
+(const vector<WH_Segment2D>& segmentBy_s, 
+ vector<WH_GM2D_SegmentFacet*>& facet_s_OUT)
+{
+  WH_CVR_LINE;
+
+  bool result = false;
+
+  facet_s_OUT.clear ();
+
+  WH_Segment2D segment = this->segment ();
+
+  /* collect the dividing points of all the segments, in the same way
+     as createDividedFacetsBySegment () */
+  vector<WH_Vector2D> point_s;
+  for (vector<WH_Segment2D>::const_iterator 
+	 i_seg = segmentBy_s.begin ();
+       i_seg != segmentBy_s.end ();
+       i_seg++) {
+    const WH_Segment2D& segmentBy_i = (*i_seg);
+
+    WH_Vector2D intersectionPoint;
+    WH_Segment2D::WithSegmentIntersectionType intersectionFlag 
+      = segment.checkIntersectionWith (segmentBy_i,
+				       intersectionPoint);
+    if (intersectionFlag == WH_Segment2D::POINT_WITH_SEGMENT) {
+      WH_CVR_LINE;
+      if (WH_ne (intersectionPoint, segment.p0 ())
+	  && WH_ne (intersectionPoint, segment.p1 ())) {
+	WH_CVR_LINE;
+	point_s.push_back (intersectionPoint);
+      }
+    } else if (intersectionFlag 
+	       == WH_Segment2D::COINCIDENT_WITH_SEGMENT) {
+      WH_CVR_LINE;
+      WH_Segment2D::WithSegmentOverlapType overlapFlag 
+	= segment.checkOverlapWith (segmentBy_i);
+      if (overlapFlag == WH_Segment2D::OVERLAP_WITH_SEGMENT) {
+	WH_CVR_LINE;
+	if (segment.justContains (segmentBy_i.p0 ())) {
+	  WH_CVR_LINE;
+	  point_s.push_back (segmentBy_i.p0 ());
+	} else if (segment.justContains (segmentBy_i.p1 ())) {
+	  WH_CVR_LINE;
+	  point_s.push_back (segmentBy_i.p1 ());
+	}
+      } else if (overlapFlag == WH_Segment2D::CONTAINS_WITH_SEGMENT) {
+	WH_CVR_LINE;
+	for (int iPoint = 0; iPoint < 2; iPoint++) {
+	  WH_Vector2D pointBy = (iPoint == 0) 
+	    ? segmentBy_i.p0 () : segmentBy_i.p1 ();
+	  if (WH_ne (pointBy, segment.p0 ())
+	      && WH_ne (pointBy, segment.p1 ())) {
+	    WH_CVR_LINE;
+	    point_s.push_back (pointBy);
+	  }
+	}
+      }
+    }
+  }
+
+  if (0 < point_s.size ()) {
+    WH_CVR_LINE;
+
+    /* <this> is divided at the points in order from its first point */
+    WH_Vector2D p0 = segment.p0 ();
+    stable_sort (point_s.begin (), point_s.end (),
+		 [&p0] (const WH_Vector2D& point0, 
+			const WH_Vector2D& point1) {
+		   return WH_squareSum (p0, point0) 
+		     < WH_squareSum (p0, point1);
+		 });
+
+    result = true;
+    WH_Vector2D previousPoint = segment.p0 ();
+    for (vector<WH_Vector2D>::const_iterator 
+	   i_point = point_s.begin ();
+	 i_point != point_s.end ();
+	 i_point++) {
+      WH_Vector2D point_i = (*i_point);
+      if (WH_ne (point_i, previousPoint)
+	  && WH_ne (point_i, segment.p1 ())) {
+	WH_CVR_LINE;
+	WH_GM2D_SegmentFacet* newFacet
+	  = this->createCopyBetween (previousPoint, point_i);
+	facet_s_OUT.push_back (newFacet);
+	previousPoint = point_i;
+      }
+    }
+    WH_GM2D_SegmentFacet* newFacet
+      = this->createCopyBetween (previousPoint, segment.p1 ());
+    facet_s_OUT.push_back (newFacet);
+  }
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  if (result) {
+    WH_ASSERT(2 <= facet_s_OUT.size ());
+  } else {
+    WH_ASSERT(facet_s_OUT.size () == 0);
+  }
+#endif
+
+  return result;
+}
+
 bool WH_GM2D_SegmentFacet
 ::createDividedFacetsByPoint 
 (const WH_Vector2D& pointBy, 
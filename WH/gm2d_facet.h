@@ -48,6 +48,12 @@ class WH_GM2D_SegmentFacet {
     (const WH_Segment2D& segmentBy, 
      vector<WH_GM2D_SegmentFacet*>& facet_s_OUT  /* CREATE */);
 
+  virtual bool createDividedFacetsBySegments 
+    (const vector<WH_Segment2D>& segmentBy_s, 
+     vector<WH_GM2D_SegmentFacet*>& facet_s_OUT  /* CREATE */);
+  /* divide at the dividing points of all of <segmentBy_s> at once.
+     the divided facets are in order from the first point */
+
   virtual bool createDividedFacetsByPoint 
     (const WH_Vector2D& pointBy, 
      vector<WH_GM2D_SegmentFacet*>& facet_s_OUT  /* CREATE */);
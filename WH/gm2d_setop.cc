@@ -142,12 +142,12 @@ void WH_GM2D_SetOperator
     segmentBy_s.push_back(facet_i->segment());
   }  
 
+  /* all the facets are divided at once, so that the crossing pairs
+     are found by a single sweep */
   for (auto* facet_i : bodyFrom->segmentFacet_s()) {
-    vector<WH_GM2D_SegmentFacet*> dividedFacet_s;
-    dividedFacet_s.push_back(facet_i->createCopy());
-    WH_GM2D_SegmentFacet::divideFacetsBySegments(segmentBy_s, dividedFacet_s);
-    WH_T_Add(dividedFacet_s, facet_s_OUT);
+    facet_s_OUT.push_back(facet_i->createCopy());
   }
+  WH_GM2D_SegmentFacet::divideFacetsBySegments(segmentBy_s, facet_s_OUT);
 
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
@@ -17,10 +17,24 @@
 #include "gm3d_sheetsetop.h"
 #include "gm3d_stitch.h"
 
+#include <chrono>
+
 
 
 /* module procedures */
 
+static thread_local int NConversions = 0;
+
+static thread_local double ConversionSeconds = 0;
+
+static void CountConversion 
+(const chrono::steady_clock::time_point& startTime)
+{
+  NConversions++;
+  ConversionSeconds += chrono::duration<double> 
+    (chrono::steady_clock::now () - startTime).count ();
+}
+
 static WH_GM3D_Body* CreateBrepFromFacet 
 (WH_GM3D_FacetBody* facetBody)
 {
@@ -29,12 +43,17 @@ static WH_GM3D_Body* CreateBrepFromFacet
   
   WH_CVR_LINE;
 
+  chrono::steady_clock::time_point startTime 
+    = chrono::steady_clock::now ();
+
   WH_GM3D_Body* result 
     = new WH_GM3D_Body (facetBody->isRegular ());
   WH_ASSERT(result != WH_NULL);
   
   WH_GM3D_ConverterFromFacetToBrep converter (result, facetBody);
   converter.perform ();
+
+  CountConversion (startTime);
   
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
@@ -56,12 +75,17 @@ static WH_GM3D_FacetBody* CreateFacetFromBrep
   
   WH_CVR_LINE;
 
+  chrono::steady_clock::time_point startTime 
+    = chrono::steady_clock::now ();
+
   WH_GM3D_FacetBody* result 
     = new WH_GM3D_FacetBody (facetBodyIsRegular);
   WH_ASSERT(result != WH_NULL);
   
   WH_GM3D_ConverterFromBrepToFacet converter (brepBody, result);
   converter.perform ();
+
+  CountConversion (startTime);
   
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
@@ -72,8 +96,9 @@ static WH_GM3D_FacetBody* CreateFacetFromBrep
   return result;
 }
 
-static WH_GM3D_Body* CreateVolumeOfTwo 
-(WH_GM3D_Body* body0, WH_GM3D_Body* body1,
+static WH_GM3D_FacetBody* CreateFacetVolumeOfTwo 
+(WH_GM3D_FacetBody* body0  /* DELETE */, 
+ WH_GM3D_FacetBody* body1  /* DELETE */,
  WH_GM3D_SetOperator::OperationType operatorType)
 {
   /* PRE-CONDITION */
@@ -84,24 +109,52 @@ static WH_GM3D_Body* CreateVolumeOfTwo
 
   WH_CVR_LINE;
 
-  WH_GM3D_FacetBody* facetBody0 = CreateFacetFromBrep (body0, true);
-  WH_GM3D_FacetBody* facetBody1 = CreateFacetFromBrep (body1, true);
-
-  WH_GM3D_FacetBody* resultFacetBody 
+  WH_GM3D_FacetBody* result 
     = new WH_GM3D_FacetBody (true);
-  WH_ASSERT(resultFacetBody != WH_NULL);
+  WH_ASSERT(result != WH_NULL);
 
   WH_GM3D_SetOperator setOperator 
-    (operatorType, facetBody0, facetBody1, resultFacetBody);
+    (operatorType, body0, body1, result);
   setOperator.perform ();
 
-  WH_GM3D_Body* result = CreateBrepFromFacet (resultFacetBody);
+  /* the result shares most of its facets with the blank <body0>, so
+     that its in-out checker is updated instead of built */
+  result->takeInOutChecker (body0);
 
-  delete facetBody0;
-  facetBody0 = WH_NULL;
+  delete body0;  /* DELETE */
+  body0 = WH_NULL;
 
-  delete facetBody1;
-  facetBody1 = WH_NULL;
+  delete body1;  /* DELETE */
+  body1 = WH_NULL;
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(result != WH_NULL);
+  WH_ASSERT(result->assureInvariant ());
+#endif
+
+  return result;
+}
+
+static WH_GM3D_Body* CreateVolumeOfTwo 
+(WH_GM3D_Body* body0, WH_GM3D_Body* body1,
+ WH_GM3D_SetOperator::OperationType operatorType)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(body0 != WH_NULL);
+  WH_ASSERT(body0->isRegular ());
+  WH_ASSERT(body1 != WH_NULL);
+  WH_ASSERT(body1->isRegular ());
+
+  WH_CVR_LINE;
+
+  WH_GM3D_FacetBody* facetBody0 = CreateFacetFromBrep (body0, true);
+  WH_GM3D_FacetBody* facetBody1 = CreateFacetFromBrep (body1, true);
+
+  WH_GM3D_FacetBody* resultFacetBody = CreateFacetVolumeOfTwo 
+    (facetBody0, facetBody1, operatorType);
+
+  WH_GM3D_Body* result = CreateBrepFromFacet (resultFacetBody);
 
   delete resultFacetBody;
   resultFacetBody = WH_NULL;
@@ -589,7 +642,8 @@ WH_GM3D_Body* WH_GM3D
     for (int iPoly = 0; 
 	 iPoly < (int)profileFacet->innerLoopParameterPolygon_s ().size ();
 	 iPoly++) {
-      WH_Polygon2D poly = profileFacet->innerLoopParameterPolygon_s ()[iPoly];
+      const WH_Polygon2D& poly 
+	= profileFacet->innerLoopParameterPolygon_s ()[iPoly];
       facet->addInnerLoop (poly);
     }
 
@@ -598,7 +652,7 @@ WH_GM3D_Body* WH_GM3D
 
   /* top face */
   {
-    WH_Polygon3D outerProfilePoly = profileFacet->outerLoopPolygon ();
+    const WH_Polygon3D& outerProfilePoly = profileFacet->outerLoopPolygon ();
     vector<WH_Vector3D> vertex_s;
     for (int iVertex = 0; iVertex < outerProfilePoly.nVertexs (); iVertex++) {
       vertex_s.push_back (outerProfilePoly.vertex (iVertex) + offset);
@@ -629,7 +683,8 @@ WH_GM3D_Body* WH_GM3D
     for (int iPoly = 0; 
 	 iPoly < (int)profileFacet->innerLoopPolygon_s ().size ();
 	 iPoly++) {
-      WH_Polygon3D profilePoly = profileFacet->innerLoopPolygon_s ()[iPoly];
+      const WH_Polygon3D& profilePoly 
+	= profileFacet->innerLoopPolygon_s ()[iPoly];
       vector<WH_Vector3D> vertex_s;
       for (int iVertex = 0; iVertex < profilePoly.nVertexs (); iVertex++) {
 	vertex_s.push_back (profilePoly.vertex (iVertex) + offset);
@@ -651,8 +706,8 @@ WH_GM3D_Body* WH_GM3D
     WH_Plane3D basePlane = profileFacet->outerLoopPolygon ().plane ();
 
     {
-      WH_Polygon3D profilePoly = profileFacet->outerLoopPolygon ();
-      WH_Polygon2D paramProfilePoly 
+      const WH_Polygon3D& profilePoly = profileFacet->outerLoopPolygon ();
+      const WH_Polygon2D& paramProfilePoly 
 	= profileFacet->outerLoopParameterPolygon ();
 
       bool frontSideIsInsideVolume = false;
@@ -703,8 +758,9 @@ WH_GM3D_Body* WH_GM3D
     for (int iPoly = 0; 
 	 iPoly < (int)profileFacet->innerLoopPolygon_s ().size ();
 	 iPoly++) {
-      WH_Polygon3D profilePoly = profileFacet->innerLoopPolygon_s ()[iPoly];
-      WH_Polygon2D paramProfilePoly 
+      const WH_Polygon3D& profilePoly 
+	= profileFacet->innerLoopPolygon_s ()[iPoly];
+      const WH_Polygon2D& paramProfilePoly 
 	= profileFacet->innerLoopParameterPolygon_s ()[iPoly];
 
       bool frontSideIsInsideVolume = true;
@@ -803,7 +859,7 @@ WH_GM3D_Body* WH_GM3D
   WH_GM3D_FacetBody* body = new WH_GM3D_FacetBody (true);
   WH_ASSERT(body != WH_NULL);
 
-  WH_Polygon3D profilePoly = profileFacet->outerLoopPolygon ();
+  const WH_Polygon3D& profilePoly = profileFacet->outerLoopPolygon ();
 
   /* find any vertex point off <axis> into <anyPointOffAxis> */
   bool anyPointOffAxisIsFound = false;
@@ -830,7 +886,8 @@ WH_GM3D_Body* WH_GM3D
     = WH_lt (0, WH_scalarProduct (yAxisDir, profilePoly.plane ().normal ()));
 
   bool directionIsReverse = false;
-  WH_Polygon2D profileParamPoly = profileFacet->outerLoopParameterPolygon ();
+  const WH_Polygon2D& profileParamPoly 
+    = profileFacet->outerLoopParameterPolygon ();
   if (profileParamPoly.isClockWise ()) {
     WH_CVR_LINE;
     if (yAxisIsSameDirectionAsProfilePoly) {
@@ -1136,6 +1193,79 @@ void WH_GM3D
 }
 
 
+WH_GM3D_FacetBody* WH_GM3D
+::createFacetBody 
+(WH_GM3D_Body* body)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(body != WH_NULL);
+  WH_ASSERT(body->isRegular ());
+
+  WH_CVR_LINE;
+
+  return CreateFacetFromBrep (body, true);
+}
+
+WH_GM3D_Body* WH_GM3D
+::createBody 
+(WH_GM3D_FacetBody* facetBody)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(facetBody != WH_NULL);
+  WH_ASSERT(facetBody->isRegular ());
+
+  WH_CVR_LINE;
+
+  return CreateBrepFromFacet (facetBody);
+}
+
+WH_GM3D_FacetBody* WH_GM3D
+::add 
+(WH_GM3D_FacetBody* blankBody  /* DELETE */,
+ WH_GM3D_FacetBody* toolBody  /* DELETE */)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(blankBody != WH_NULL);
+  WH_ASSERT(blankBody->isRegular ());
+  WH_ASSERT(toolBody != WH_NULL);
+  WH_ASSERT(toolBody->isRegular ());
+
+  WH_CVR_LINE;
+
+  return CreateFacetVolumeOfTwo 
+    (blankBody, toolBody, WH_GM3D_SetOperator::UNION);
+}
+
+WH_GM3D_FacetBody* WH_GM3D
+::subtract 
+(WH_GM3D_FacetBody* blankBody  /* DELETE */,
+ WH_GM3D_FacetBody* toolBody  /* DELETE */)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(blankBody != WH_NULL);
+  WH_ASSERT(blankBody->isRegular ());
+  WH_ASSERT(toolBody != WH_NULL);
+  WH_ASSERT(toolBody->isRegular ());
+
+  WH_CVR_LINE;
+
+  return CreateFacetVolumeOfTwo 
+    (blankBody, toolBody, WH_GM3D_SetOperator::SUBTRACTION);
+}
+
+int WH_GM3D
+::nConversions ()
+{
+  return NConversions;
+}
+
+double WH_GM3D
+::conversionSeconds ()
+{
+  return ConversionSeconds;
+}
+
+
 
 /* test coverage completed */
 
@@ -13,6 +13,7 @@
 #define WH_INCLUDED_WH_GM3D_BREP
 #endif
 
+class WH_GM3D_FacetBody;
 
 
 class WH_GM3D {
@@ -54,6 +55,29 @@ class WH_GM3D {
     (WH_GM3D_Body* blankBody,
      WH_GM3D_Body* toolBody  /* DELETE */);
 
+  /* facet form of volumes, to run consecutive set operations without
+     the B-rep in between */
+
+  static WH_GM3D_FacetBody* createFacetBody 
+    (WH_GM3D_Body* body);
+
+  static WH_GM3D_Body* createBody 
+    (WH_GM3D_FacetBody* facetBody);
+
+  static WH_GM3D_FacetBody* add 
+    (WH_GM3D_FacetBody* blankBody  /* DELETE */,
+     WH_GM3D_FacetBody* toolBody  /* DELETE */);
+
+  static WH_GM3D_FacetBody* subtract 
+    (WH_GM3D_FacetBody* blankBody  /* DELETE */,
+     WH_GM3D_FacetBody* toolBody  /* DELETE */);
+
+  static int nConversions ();
+  /* number of conversions between B-rep and facet form so far */
+
+  static double conversionSeconds ();
+  /* wall clock time spent in the conversions so far */
+
   /* base */
 
   /* derived */
@@ -0,0 +1,471 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* gm3d_cache.cc : on-disk cache of the results of set operations */
+
+#include "gm3d_cache.h"
+#include "binary_io.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+
+
+/* module procedures */
+
+/* a file is the header, the polygon facets, and the trailer.  the
+   values are in the byte order of the machine, as the cache is local
+   to it */
+static const char* BODY_FILE_MAGIC = "WHBC";
+
+static const char* BODY_FILE_END = "END.";
+
+static const int BODY_FILE_VERSION = 1;
+
+static const char* BODY_FILE_EXTENSION = ".body";
+
+static void WriteVector2D
+(ostream& out, const WH_Vector2D& value)
+{
+  WH_writeBinary (out, value.x);
+  WH_writeBinary (out, value.y);
+}
+
+static void WritePolygon2D
+(ostream& out, const WH_Polygon2D& poly)
+{
+  WH_writeBinary (out, poly.nVertexs ());
+  for (int iVertex = 0; iVertex < poly.nVertexs (); iVertex++) {
+    WriteVector2D (out, poly.vertex (iVertex));
+  }
+}
+
+static bool ReadVector2D
+(istream& in, WH_Vector2D& value_OUT)
+{
+  return WH_readBinary (in, value_OUT.x) && WH_readBinary (in, value_OUT.y);
+}
+
+static bool ReadPolygon2D
+(istream& in, WH_Polygon2D& poly_OUT)
+{
+  int nVertexs;
+  if (!WH_readBinaryCount (in, nVertexs) || nVertexs < 3) return false;
+  vector<WH_Vector2D> vertex_s (nVertexs);
+  for (int iVertex = 0; iVertex < nVertexs; iVertex++) {
+    if (!ReadVector2D (in, vertex_s[iVertex])) return false;
+  }
+  poly_OUT = WH_Polygon2D (vertex_s);
+  return true;
+}
+
+static void WritePolygonFacet
+(ostream& out, const WH_GM3D_PolygonFacet* facet)
+{
+  WH_Plane3D plane = facet->plane ();
+  WH_writeBinary (out, plane.a ());
+  WH_writeBinary (out, plane.b ());
+  WH_writeBinary (out, plane.c ());
+  WH_writeBinary (out, plane.d ());
+  WH_writeBinary (out, facet->frontSideIsInsideVolume () ? 1 : 0);
+  WH_writeBinary (out, facet->backSideIsInsideVolume () ? 1 : 0);
+
+  WritePolygon2D (out, facet->outerLoopParameterPolygon ());
+
+  const vector<WH_Polygon2D>& innerLoop_s
+    = facet->innerLoopParameterPolygon_s ();
+  WH_writeBinary (out, (int)innerLoop_s.size ());
+  for (vector<WH_Polygon2D>::const_iterator
+	 i_poly = innerLoop_s.begin ();
+       i_poly != innerLoop_s.end ();
+       i_poly++) {
+    WritePolygon2D (out, (*i_poly));
+  }
+
+  const vector<WH_Segment2D>& seg_s
+    = facet->offLoopParameterEdgeSegment_s ();
+  WH_writeBinary (out, (int)seg_s.size ());
+  for (vector<WH_Segment2D>::const_iterator
+	 i_seg = seg_s.begin ();
+       i_seg != seg_s.end ();
+       i_seg++) {
+    WriteVector2D (out, (*i_seg).p0 ());
+    WriteVector2D (out, (*i_seg).p1 ());
+  }
+
+  const vector<WH_Vector2D>& point_s
+    = facet->offLoopParameterVertexPoint_s ();
+  WH_writeBinary (out, (int)point_s.size ());
+  for (vector<WH_Vector2D>::const_iterator
+	 i_point = point_s.begin ();
+       i_point != point_s.end ();
+       i_point++) {
+    WriteVector2D (out, (*i_point));
+  }
+}
+
+static bool ReadPolygonFacet
+(istream& in, WH_GM3D_FacetBody* body_IO)
+{
+  /* the facet is made again in the steps of a set operation, on the
+     same plane and parameters, so that it is the same to the bit */
+  double a, b, c, d;
+  int isFrontInside, isBackInside;
+  if (!WH_readBinary (in, a) || !WH_readBinary (in, b)
+      || !WH_readBinary (in, c) || !WH_readBinary (in, d)
+      || !WH_readBinary (in, isFrontInside) || !WH_readBinary (in, isBackInside)) {
+    return false;
+  }
+  if (!WH_eq (WH_Vector3D (a, b, c).length (), 1)) return false;
+  WH_Plane3D plane = WH_Plane3D::normalizedPlane (a, b, c, d);
+
+  WH_Polygon2D outerLoop;
+  if (!ReadPolygon2D (in, outerLoop)) return false;
+
+  WH_GM3D_PolygonFacet* facet = body_IO->createPolygonFacet
+    (plane, outerLoop, isFrontInside != 0, isBackInside != 0);
+  body_IO->addPolygonFacet (facet);
+
+  int nInnerLoops;
+  if (!WH_readBinaryCount (in, nInnerLoops)) return false;
+  for (int iLoop = 0; iLoop < nInnerLoops; iLoop++) {
+    WH_Polygon2D innerLoop;
+    if (!ReadPolygon2D (in, innerLoop)) return false;
+    facet->addInnerLoop (innerLoop);
+  }
+
+  int nSegs;
+  if (!WH_readBinaryCount (in, nSegs)) return false;
+  for (int iSeg = 0; iSeg < nSegs; iSeg++) {
+    WH_Vector2D p0;
+    WH_Vector2D p1;
+    if (!ReadVector2D (in, p0) || !ReadVector2D (in, p1)) return false;
+    facet->addOffLoopEdgeSegment (WH_Segment2D (p0, p1));
+  }
+
+  int nPoints;
+  if (!WH_readBinaryCount (in, nPoints)) return false;
+  for (int iPoint = 0; iPoint < nPoints; iPoint++) {
+    WH_Vector2D point;
+    if (!ReadVector2D (in, point)) return false;
+    facet->addOffLoopVertexPoint (point);
+  }
+
+  return true;
+}
+
+static WH_GM3D_FacetBody* CreateBodyFromStream
+(istream& in, unsigned long long key)
+{
+  int version;
+  unsigned long long keyInFile;
+  int nFacets;
+  if (!WH_readBinaryTag (in, BODY_FILE_MAGIC)
+      || !WH_readBinary (in, version) || version != BODY_FILE_VERSION) {
+    return WH_NULL;
+  }
+  if (!WH_readBinary (in, keyInFile) || keyInFile != key
+      || !WH_readBinaryCount (in, nFacets)) {
+    return WH_NULL;
+  }
+
+  WH_GM3D_FacetBody* result = new WH_GM3D_FacetBody (true);
+  WH_ASSERT(result != WH_NULL);
+
+  bool isRead = true;
+  for (int iFacet = 0; iFacet < nFacets && isRead; iFacet++) {
+    isRead = ReadPolygonFacet (in, result);
+  }
+  if (isRead) {
+    isRead = WH_readBinaryTag (in, BODY_FILE_END);
+  }
+  if (!isRead) {
+    delete result;
+    return WH_NULL;
+  }
+
+  result->generateTriangleFacets ();
+  return result;
+}
+
+
+
+/* class WH_GM3D_BodyCache */
+
+WH_GM3D_BodyCache
+::WH_GM3D_BodyCache
+(const string& directory,
+ long long maxBytes)
+  : _directory (directory),
+    _maxBytes (maxBytes)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < directory.length ());
+  WH_ASSERT(0 < maxBytes);
+
+  _nBytes = 0;
+  _nHits = 0;
+  _nMisses = 0;
+  _nStores = 0;
+  _nEvictions = 0;
+
+  std::error_code error;
+  filesystem::create_directories (_directory, error);
+
+  /* count the files left by earlier runs, and keep within the limit
+     in case it is smaller now */
+  {
+    lock_guard<mutex> guard (_lock);
+    this->evict ();
+  }
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(this->checkInvariant ());
+#endif
+}
+
+WH_GM3D_BodyCache
+::~WH_GM3D_BodyCache ()
+{
+}
+
+bool WH_GM3D_BodyCache
+::checkInvariant () const
+{
+  WH_ASSERT(0 < _directory.length ());
+  WH_ASSERT(0 < _maxBytes);
+
+  return true;
+}
+
+bool WH_GM3D_BodyCache
+::assureInvariant () const
+{
+  this->checkInvariant ();
+
+  return true;
+}
+
+string WH_GM3D_BodyCache
+::pathOf (unsigned long long key) const
+{
+  char name[32];
+  snprintf (name, sizeof (name), "%016llx", key);
+  return (filesystem::path (_directory)
+	  / (string (name) + BODY_FILE_EXTENSION)).string ();
+}
+
+void WH_GM3D_BodyCache
+::evict ()
+{
+  /* on <_lock> */
+
+  struct CachedFile {
+    filesystem::file_time_type time;
+    long long size;
+    filesystem::path path;
+  };
+  vector<CachedFile> file_s;
+  long long nBytes = 0;
+
+  std::error_code error;
+  for (filesystem::directory_iterator i_entry (_directory, error);
+       !error && i_entry != filesystem::directory_iterator ();
+       i_entry.increment (error)) {
+    const filesystem::path& path = i_entry->path ();
+    if (path.extension () != BODY_FILE_EXTENSION) continue;
+    CachedFile file;
+    file.path = path;
+    file.size = (long long)filesystem::file_size (path, error);
+    file.time = filesystem::last_write_time (path, error);
+    if (error) {
+      /* removed by another process */
+      error.clear ();
+      continue;
+    }
+    nBytes += file.size;
+    file_s.push_back (file);
+  }
+
+  if (_maxBytes < nBytes) {
+    WH_CVR_LINE;
+    sort (file_s.begin (), file_s.end (),
+	  [] (const CachedFile& file0, const CachedFile& file1) {
+	    return file0.time < file1.time;
+	  });
+    for (vector<CachedFile>::const_iterator
+	   i_file = file_s.begin ();
+	 i_file != file_s.end () && _maxBytes < nBytes;
+	 i_file++) {
+      if (filesystem::remove ((*i_file).path, error)) {
+	nBytes -= (*i_file).size;
+	_nEvictions++;
+      }
+    }
+  }
+  _nBytes = nBytes;
+}
+
+WH_GM3D_FacetBody* WH_GM3D_BodyCache
+::createBody (unsigned long long key)
+{
+  WH_CVR_LINE;
+
+  string path = this->pathOf (key);
+  WH_GM3D_FacetBody* result = WH_NULL;
+  {
+    ifstream in (path.c_str (), ios::binary);
+    if (in) {
+      WH_CVR_LINE;
+      result = CreateBodyFromStream (in, key);
+    }
+  }
+
+  std::error_code error;
+  lock_guard<mutex> guard (_lock);
+  if (result != WH_NULL) {
+    WH_CVR_LINE;
+    _nHits++;
+    /* most recently used */
+    filesystem::last_write_time
+      (path, filesystem::file_time_type::clock::now (), error);
+  } else {
+    WH_CVR_LINE;
+    _nMisses++;
+  }
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  if (result != WH_NULL) {
+    WH_ASSERT(result->isRegular ());
+  }
+#endif
+
+  return result;
+}
+
+bool WH_GM3D_BodyCache
+::storeBody
+(unsigned long long key,
+ const WH_GM3D_FacetBody* body)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(body != WH_NULL);
+
+  WH_CVR_LINE;
+
+  if (!body->isRegular () || body->normalIsReversed ()
+      || 0 < body->vertexPoint_s ().size ()
+      || 0 < body->segmentFacet_s ().size ()
+      || 0 < body->triangleFacet_s ().size ()) {
+    WH_CVR_LINE;
+    return false;
+  }
+
+  /* written aside and renamed, so that no one reads a part of it */
+  string path = this->pathOf (key);
+  string temporaryPath;
+  {
+    static thread_local mt19937_64 generator (random_device {} ());
+    char suffix[32];
+    snprintf (suffix, sizeof (suffix), ".%016llx",
+	      (unsigned long long)generator ());
+    temporaryPath = path + suffix;
+  }
+
+  long long size = 0;
+  {
+    ofstream out (temporaryPath.c_str (), ios::binary);
+    if (!out) return false;
+
+    WH_writeBinaryTag (out, BODY_FILE_MAGIC);
+    WH_writeBinary (out, BODY_FILE_VERSION);
+    WH_writeBinary (out, key);
+    const vector<WH_GM3D_PolygonFacet*>& facet_s = body->polygonFacet_s ();
+    WH_writeBinary (out, (int)facet_s.size ());
+    for (vector<WH_GM3D_PolygonFacet*>::const_iterator
+	   i_facet = facet_s.begin ();
+	 i_facet != facet_s.end ();
+	 i_facet++) {
+      WritePolygonFacet (out, (*i_facet));
+    }
+    WH_writeBinaryTag (out, BODY_FILE_END);
+    size = (long long)out.tellp ();
+    out.close ();
+    if (!out) {
+      std::error_code error;
+      filesystem::remove (temporaryPath, error);
+      return false;
+    }
+  }
+
+  std::error_code error;
+  filesystem::rename (temporaryPath, path, error);
+  if (error) {
+    filesystem::remove (temporaryPath, error);
+    return false;
+  }
+
+  lock_guard<mutex> guard (_lock);
+  _nStores++;
+  _nBytes += size;
+  if (_maxBytes < _nBytes) {
+    WH_CVR_LINE;
+    this->evict ();
+  }
+
+  return true;
+}
+
+const string& WH_GM3D_BodyCache
+::directory () const
+{
+  return _directory;
+}
+
+long long WH_GM3D_BodyCache
+::maxBytes () const
+{
+  return _maxBytes;
+}
+
+long long WH_GM3D_BodyCache
+::nBytes () const
+{
+  lock_guard<mutex> guard (_lock);
+  return _nBytes;
+}
+
+int WH_GM3D_BodyCache
+::nHits () const
+{
+  lock_guard<mutex> guard (_lock);
+  return _nHits;
+}
+
+int WH_GM3D_BodyCache
+::nMisses () const
+{
+  lock_guard<mutex> guard (_lock);
+  return _nMisses;
+}
+
+int WH_GM3D_BodyCache
+::nStores () const
+{
+  lock_guard<mutex> guard (_lock);
+  return _nStores;
+}
+
+int WH_GM3D_BodyCache
+::nEvictions () const
+{
+  lock_guard<mutex> guard (_lock);
+  return _nEvictions;
+}
@@ -0,0 +1,93 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* header file for gm3d_cache.cc */
+
+#pragma once
+#ifndef WH_INCLUDED_WH_GM3D_FACET
+#include <WH/gm3d_facet.h>
+#define WH_INCLUDED_WH_GM3D_FACET
+#endif
+
+#include <mutex>
+
+class WH_GM3D_BodyCache;
+
+/* no inheritance */
+/* heavy weight */
+/* on-disk cache of the results of set operations of a script, keyed
+   by the commands which made them (see WH_GM3D_IO).  a result is
+   stored in facet form, one file per key, and the least recently
+   used files are removed beyond the size limit.  it may be shared by
+   threads and by processes */
+class WH_GM3D_BodyCache {
+ public:
+  WH_GM3D_BodyCache
+    (const string& directory,
+     long long maxBytes);
+  ~WH_GM3D_BodyCache ();
+  bool checkInvariant () const;
+  bool assureInvariant () const;
+
+  /* base */
+  WH_GM3D_FacetBody* createBody (unsigned long long key);
+  /* body stored by <key>, or WH_NULL on a miss */
+
+  bool storeBody
+    (unsigned long long key,
+     const WH_GM3D_FacetBody* body);
+  /* false if <body> is not a regular body of polygon facets only, as
+     left by a set operation */
+
+  const string& directory () const;
+
+  long long maxBytes () const;
+
+  long long nBytes () const;
+
+  int nHits () const;
+
+  int nMisses () const;
+
+  int nStores () const;
+
+  int nEvictions () const;
+
+  /* derived */
+
+ protected:
+  string _directory;
+
+  long long _maxBytes;
+
+  mutable mutex _lock;
+  /* for the members below */
+
+  long long _nBytes;
+  /* of the files in <_directory>, as known to this cache */
+
+  int _nHits;
+
+  int _nMisses;
+
+  int _nStores;
+
+  int _nEvictions;
+
+  /* base */
+  string pathOf (unsigned long long key) const;
+
+  void evict ();
+  /* remove the least recently used files down to <_maxBytes> */
+
+  /* derived */
+
+ private:
+  /* no implementation */
+  WH_GM3D_BodyCache (const WH_GM3D_BodyCache& cache);
+  const WH_GM3D_BodyCache& operator= (const WH_GM3D_BodyCache& cache);
+
+};
@@ -347,7 +347,7 @@ void WH_GM3D_ConverterFromFacetToBrep
 	   i_poly = facet_i->innerLoopPolygon_s ().begin ();
 	 i_poly != facet_i->innerLoopPolygon_s ().end ();
 	 i_poly++) {
-      WH_Polygon3D poly_i = (*i_poly);
+      const WH_Polygon3D& poly_i = (*i_poly);
       WH_GM3D_Loop* loop = this->brepBody ()->createLoop (face);
       this->makeLoop (loop, poly_i);
       face->addInnerLoop (loop); 
@@ -12,6 +12,8 @@
 
 #include "gm3d_facet.h"
 #include "connector2d.h"
+#include "arena.h"
+#include "debug_levels.h"
 
 
 
@@ -507,7 +509,13 @@ const vector<WH_GM3D_TriangleFacet*>& WH_GM3D_NonRegularFacetGroup
 
 /* class WH_GM3D_FacetBody */
 
-int WH_GM3D_FacetBody::_faceCount = 0;
+thread_local int WH_GM3D_FacetBody::_faceCount = 0;
+
+thread_local int WH_GM3D_FacetBody::_nInOutCheckHits = 0;
+
+thread_local int WH_GM3D_FacetBody::_nInOutCheckUpdates = 0;
+
+thread_local int WH_GM3D_FacetBody::_nInOutCheckBuilds = 0;
 
 WH_GM3D_FacetBody
 ::WH_GM3D_FacetBody (bool isRegular) 
@@ -517,6 +525,8 @@ WH_GM3D_FacetBody
   _isRegular = isRegular;
   _normalIsReversed = false;
   _inOutChecker = WH_NULL;
+  _version = 0;
+  _inOutCheckerVersion = -1;
 }
 
 WH_GM3D_FacetBody
@@ -733,6 +743,7 @@ void WH_GM3D_FacetBody
 #endif
 
   _vertexPoint_s.push_back (point);
+  this->bumpVersion ();
 }
 
 void WH_GM3D_FacetBody
@@ -746,6 +757,7 @@ void WH_GM3D_FacetBody
 #endif
   
   _segmentFacet_s.push_back (facet);
+  this->bumpVersion ();
 }
 
 void WH_GM3D_FacetBody
@@ -766,6 +778,7 @@ void WH_GM3D_FacetBody
   _polygonFacet_s.push_back (facet);
   facet->setFaceId (_faceCount);
   _faceCount++;
+  this->bumpVersion ();
 }
 
 void WH_GM3D_FacetBody
@@ -776,13 +789,17 @@ void WH_GM3D_FacetBody
 
   WH_CVR_LINE;
 
+  /* the temporaries of each tessellation are freed at once */
+  WH_Arena arena;
   for (vector<WH_GM3D_PolygonFacet*>::const_iterator 
 	 i_facet = _polygonFacet_s.begin ();
        i_facet != _polygonFacet_s.end ();
        i_facet++) {
     WH_GM3D_PolygonFacet* facet_i = (*i_facet);
-    facet_i->generateTriangleFacets ();
+    facet_i->generateTriangleFacets (&arena);
+    arena.release ();
   }
+  this->bumpVersion ();
 }
 
 void WH_GM3D_FacetBody
@@ -801,6 +818,7 @@ void WH_GM3D_FacetBody
 #endif
   
   _triangleFacet_s.push_back (facet);
+  this->bumpVersion ();
 }
 
 void WH_GM3D_FacetBody
@@ -879,7 +897,7 @@ void WH_GM3D_FacetBody
     WH_GM3D_PolygonFacet* facet_i = (*i_facet);
     
     {
-      WH_Polygon3D poly = facet_i->outerLoopPolygon ();
+      const WH_Polygon3D& poly = facet_i->outerLoopPolygon ();
       for (int iVertex = 0; iVertex < poly.nVertexs (); iVertex++) {
 	WH_Vector3D vertexPoint = poly.vertex (iVertex);
 	if (!WH_contains (allVertexPoint_s, vertexPoint)) {
@@ -892,7 +910,7 @@ void WH_GM3D_FacetBody
 	   i_poly = facet_i->innerLoopPolygon_s ().begin ();
 	 i_poly != facet_i->innerLoopPolygon_s ().end ();
 	 i_poly++) {
-      WH_Polygon3D poly = (*i_poly);
+      const WH_Polygon3D& poly = (*i_poly);
       for (int iVertex = 0; iVertex < poly.nVertexs (); iVertex++) {
 	WH_Vector3D vertexPoint = poly.vertex (iVertex);
 	if (!WH_contains (allVertexPoint_s, vertexPoint)) {
@@ -1081,6 +1099,89 @@ void WH_GM3D_FacetBody
     WH_CVR_LINE;
     _normalIsReversed = true;
   }
+  this->bumpVersion ();
+}
+
+void WH_GM3D_FacetBody
+::bumpVersion ()
+{
+  _version++;
+}
+
+void WH_GM3D_FacetBody
+::collectInOutCheckFaces 
+(vector<WH_GM3D_TriangleFacet*>& facet_s_OUT,
+ vector<WH_Vector3D>& normal_s_OUT) const
+{
+  WH_CVR_LINE;
+
+  facet_s_OUT.clear ();
+  normal_s_OUT.clear ();
+
+  for (vector<WH_GM3D_PolygonFacet*>::const_iterator 
+	 i_pfacet = this->polygonFacet_s ().begin ();
+       i_pfacet != this->polygonFacet_s ().end ();
+       i_pfacet++) {
+    WH_GM3D_PolygonFacet* pfacet_i = (*i_pfacet);
+    
+    if (pfacet_i->faceType () == WH_GM3D_PolygonFacet::OUTER_BOUNDARY) {
+      WH_Vector3D normal;
+      pfacet_i->getNormalToOutsideVolume 
+	(normal);
+      if (this->normalIsReversed ()) {
+	WH_CVR_LINE;
+	normal = -normal;
+      }
+
+      WH_ASSERT(0 < pfacet_i->triangleFacet_s ().size ());
+      for (vector<WH_GM3D_TriangleFacet*>::const_iterator 
+	     i_facet = pfacet_i->triangleFacet_s ().begin ();
+	   i_facet != pfacet_i->triangleFacet_s ().end ();
+	   i_facet++) {
+	WH_GM3D_TriangleFacet* facet_i = (*i_facet);
+	facet_s_OUT.push_back (facet_i);
+	normal_s_OUT.push_back (normal);
+      }
+    }
+  }
+}
+
+static unsigned long long InOutTriangleKeyOf 
+(const WH_Triangle3D& triangle)
+{
+  /* FNV-1a on the coordinates.  a copy of a facet has them exactly */
+  unsigned long long result = 14695981039346656037ULL;
+  for (int iVertex = 0; iVertex < 3; iVertex++) {
+    WH_Vector3D v = triangle.vertex (iVertex);
+    double coordinate_s[3] = { v.x, v.y, v.z };
+    const unsigned char* byte_s = (const unsigned char*)coordinate_s;
+    for (size_t i = 0; i < sizeof (coordinate_s); i++) {
+      result ^= byte_s[i];
+      result *= 1099511628211ULL;
+    }
+  }
+  return result;
+}
+
+static bool InOutTriangleIsSameAs 
+(const WH_Triangle3D_IOC3D* tri,
+ const WH_Triangle3D& triangle,
+ const WH_Vector3D& normal)
+{
+  WH_CVR_LINE;
+
+  if (WH_ne (tri->plane ().normal (), normal.normalize ())) {
+    WH_CVR_LINE;
+    return false;
+  }
+  
+  /* WH_InOutChecker3D::addFace () may swap vertex 1 and 2 */
+  WH_Vector3D v0 = triangle.vertex (0);
+  WH_Vector3D v1 = triangle.vertex (1);
+  WH_Vector3D v2 = triangle.vertex (2);
+  return WH_eq (tri->vertex (0), v0)
+    && ((WH_eq (tri->vertex (1), v1) && WH_eq (tri->vertex (2), v2))
+	|| (WH_eq (tri->vertex (1), v2) && WH_eq (tri->vertex (2), v1)));
 }
 
 void WH_GM3D_FacetBody
@@ -1089,12 +1190,88 @@ void WH_GM3D_FacetBody
   /* PRE-CONDITION */
   WH_ASSERT(this->bodyType () == VOLUME
 	    || this->bodyType () == OTHER);
-  WH_ASSERT(_inOutChecker == WH_NULL);
   WH_ASSERT(0 < this->polygonFacet_s ().size ());
   WH_ASSERT(this->triangleFacet_s ().size () == 0);
   
   WH_CVR_LINE;
 
+  if (_inOutChecker != WH_NULL 
+      && _inOutCheckerVersion == _version) {
+    WH_CVR_LINE;
+    _nInOutCheckHits++;
+    WH_PRINTF_VERBOSE("in-out check of body: cache hit "
+		      "(hits %d, updates %d, builds %d)",
+		      _nInOutCheckHits, _nInOutCheckUpdates, 
+		      _nInOutCheckBuilds);
+    return;
+  }
+
+  vector<WH_GM3D_TriangleFacet*> facet_s;
+  vector<WH_Vector3D> normal_s;
+  this->collectInOutCheckFaces 
+    (facet_s, normal_s);
+
+  if (_inOutChecker != WH_NULL) {
+    WH_CVR_LINE;
+
+    /* update <_inOutChecker> by the changed triangle facets only */
+
+    unordered_multimap<unsigned long long, WH_Triangle3D_IOC3D*> 
+      triangleMap;
+    triangleMap.reserve (facet_s.size ());
+    int nAdded = 0;
+    for (int iFacet = 0; iFacet < (int)facet_s.size (); iFacet++) {
+      WH_GM3D_TriangleFacet* facet_i = facet_s[iFacet];
+      WH_Triangle3D tri = facet_i->triangle ();
+      unsigned long long key = InOutTriangleKeyOf (tri);
+
+      pair<unordered_multimap<unsigned long long, 
+	WH_Triangle3D_IOC3D*>::iterator,
+	unordered_multimap<unsigned long long, 
+	WH_Triangle3D_IOC3D*>::iterator> 
+	range = _inOutTriangleMap.equal_range (key);
+      unordered_multimap<unsigned long long, 
+	WH_Triangle3D_IOC3D*>::iterator i_entry = range.first;
+      for (; i_entry != range.second; i_entry++) {
+	if (InOutTriangleIsSameAs 
+	    (i_entry->second, tri, normal_s[iFacet])) break;
+      }
+      if (i_entry != range.second) {
+	WH_CVR_LINE;
+	triangleMap.insert (make_pair (key, i_entry->second));
+	_inOutTriangleMap.erase (i_entry);
+      } else {
+	WH_CVR_LINE;
+	triangleMap.insert (make_pair 
+	  (key, _inOutChecker->addFace 
+	   (tri.vertex (0), tri.vertex (1), tri.vertex (2), 
+	    normal_s[iFacet])));
+	nAdded++;
+      }
+    }
+
+    /* remaining entries are of removed or modified facets */
+    int nRemoved = (int)_inOutTriangleMap.size ();
+    for (unordered_multimap<unsigned long long, 
+	   WH_Triangle3D_IOC3D*>::iterator 
+	   i_entry = _inOutTriangleMap.begin ();
+	 i_entry != _inOutTriangleMap.end ();
+	 i_entry++) {
+      _inOutChecker->removeFace (i_entry->second);
+    }
+    _inOutTriangleMap.swap (triangleMap);
+
+    _inOutCheckerVersion = _version;
+    _nInOutCheckUpdates++;
+    WH_PRINTF_VERBOSE("in-out check of body: updated, "
+		      "%d triangles kept, %d added, %d removed "
+		      "(hits %d, updates %d, builds %d)",
+		      (int)facet_s.size () - nAdded, nAdded, nRemoved,
+		      _nInOutCheckHits, _nInOutCheckUpdates, 
+		      _nInOutCheckBuilds);
+    return;
+  }
+
   double minLength = WH::HUGE_VALUE;
   for (vector<WH_GM3D_PolygonFacet*>::const_iterator 
 	 i_pfacet = this->polygonFacet_s ().begin ();
@@ -1115,42 +1292,60 @@ void WH_GM3D_FacetBody
     }
   }
   
-  _inOutChecker = new WH_InOutChecker3D (minLength);
+  _inOutChecker = WH_InOutChecker3D::create (minLength);
   WH_ASSERT(_inOutChecker != WH_NULL);
   
-  for (vector<WH_GM3D_PolygonFacet*>::const_iterator 
-	 i_pfacet = this->polygonFacet_s ().begin ();
-       i_pfacet != this->polygonFacet_s ().end ();
-       i_pfacet++) {
-    WH_GM3D_PolygonFacet* pfacet_i = (*i_pfacet);
-    
-    if (pfacet_i->faceType () == WH_GM3D_PolygonFacet::OUTER_BOUNDARY) {
-      WH_Vector3D normal;
-      pfacet_i->getNormalToOutsideVolume 
-	(normal);
-      if (this->normalIsReversed ()) {
-	WH_CVR_LINE;
-	normal = -normal;
-      }
-
-      WH_ASSERT(0 < pfacet_i->triangleFacet_s ().size ());
-      for (vector<WH_GM3D_TriangleFacet*>::const_iterator 
-	     i_facet = pfacet_i->triangleFacet_s ().begin ();
-	   i_facet != pfacet_i->triangleFacet_s ().end ();
-	   i_facet++) {
-	WH_GM3D_TriangleFacet* facet_i = (*i_facet);
-	WH_Triangle3D tri = facet_i->triangle ();
-	_inOutChecker->addFace 
-	  (tri.vertex (0), tri.vertex (1), tri.vertex (2), 
-	   normal);
-      }
-    }
+  for (int iFacet = 0; iFacet < (int)facet_s.size (); iFacet++) {
+    WH_GM3D_TriangleFacet* facet_i = facet_s[iFacet];
+    WH_Triangle3D tri = facet_i->triangle ();
+    _inOutTriangleMap.insert (make_pair 
+      (InOutTriangleKeyOf (tri),
+       _inOutChecker->addFace 
+       (tri.vertex (0), tri.vertex (1), tri.vertex (2), 
+	normal_s[iFacet])));
   }
   _inOutChecker->setUp ();
 
+  _inOutCheckerVersion = _version;
+  _nInOutCheckBuilds++;
+  WH_PRINTF_VERBOSE("in-out check of body: built from %zu triangles "
+		    "(hits %d, updates %d, builds %d)",
+		    facet_s.size (),
+		    _nInOutCheckHits, _nInOutCheckUpdates, 
+		    _nInOutCheckBuilds);
+
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
   WH_ASSERT(_inOutChecker != WH_NULL);
+  WH_ASSERT(_inOutCheckerVersion == this->version ());
+#endif
+}
+
+void WH_GM3D_FacetBody
+::takeInOutChecker 
+(WH_GM3D_FacetBody* body)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(body != WH_NULL);
+  WH_ASSERT(body != this);
+
+  WH_CVR_LINE;
+
+  if (body->_inOutChecker == WH_NULL) return;
+
+  delete _inOutChecker;
+  _inOutChecker = body->_inOutChecker;
+  body->_inOutChecker = WH_NULL;
+  _inOutTriangleMap.swap (body->_inOutTriangleMap);
+  body->_inOutTriangleMap.clear ();
+  body->_inOutCheckerVersion = -1;
+
+  /* to be updated by the facets of this body */
+  _inOutCheckerVersion = -1;
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(body->_inOutChecker == WH_NULL);
 #endif
 }
 
@@ -1235,6 +1430,30 @@ bool WH_GM3D_FacetBody
   return _normalIsReversed;
 }
 
+int WH_GM3D_FacetBody
+::version () const
+{
+  return _version;
+}
+
+int WH_GM3D_FacetBody
+::nInOutCheckHits ()
+{
+  return _nInOutCheckHits;
+}
+
+int WH_GM3D_FacetBody
+::nInOutCheckUpdates ()
+{
+  return _nInOutCheckUpdates;
+}
+
+int WH_GM3D_FacetBody
+::nInOutCheckBuilds ()
+{
+  return _nInOutCheckBuilds;
+}
+
 const vector<WH_Vector3D>& WH_GM3D_FacetBody
 ::vertexPoint_s () const
 {
@@ -1373,6 +1592,44 @@ WH_GM3D_FacetBody::BodyType WH_GM3D_FacetBody
   return result;
 }
 
+void WH_GM3D_FacetBody
+::getRange 
+(WH_Vector3D& minRange_OUT, 
+ WH_Vector3D& maxRange_OUT) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < this->polygonFacet_s ().size ());
+  
+  WH_CVR_LINE;
+  
+  minRange_OUT = WH_Vector3D::hugeValue ();
+  maxRange_OUT = -WH_Vector3D::hugeValue ();
+  
+  for (vector<WH_GM3D_PolygonFacet*>::const_iterator 
+	 i_facet = this->polygonFacet_s ().begin ();
+       i_facet != this->polygonFacet_s ().end ();
+       i_facet++) {
+    WH_GM3D_PolygonFacet* facet_i = (*i_facet);
+
+    for (vector<WH_GM3D_TriangleFacet*>::const_iterator 
+	   i_tfacet = facet_i->triangleFacet_s ().begin ();
+	 i_tfacet != facet_i->triangleFacet_s ().end ();
+	 i_tfacet++) {
+      WH_GM3D_TriangleFacet* tfacet_i = (*i_tfacet);
+      WH_Vector3D minRange;
+      WH_Vector3D maxRange;
+      tfacet_i->getRange (minRange, maxRange);
+      minRange_OUT = WH_min (minRange_OUT, minRange);
+      maxRange_OUT = WH_max (maxRange_OUT, maxRange);
+    }
+  }
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(WH_le (minRange_OUT, maxRange_OUT));
+#endif  
+}
+
 WH_InOutChecker3D::ContainmentType WH_GM3D_FacetBody
 ::checkContainmentAt 
 (const WH_Vector3D& point) const
@@ -1458,7 +1715,7 @@ WH_GM3D_PolygonFacet* WH_GM3D_FacetBody
        i_facet != this->polygonFacet_s ().end ();
        i_facet++) {
     WH_GM3D_PolygonFacet* facet_i = (*i_facet);
-    WH_Polygon3D poly = facet_i->outerLoopPolygon ();
+    const WH_Polygon3D& poly = facet_i->outerLoopPolygon ();
     if (poly.hasVertexAtEveryPointIn (point_s)) {
       WH_CVR_LINE;
       result = facet_i;
@@ -19,6 +19,7 @@
 
 class WH_CNCT2D_SegmentCluster;
 class WH_CNCT2D_TriangleCluster;
+class WH_Arena;
 
 class WH_GM3D_SegmentFacet;
 class WH_GM3D_TriangleFacet;
@@ -258,17 +259,24 @@ class WH_GM3D_PolygonFacet {
   virtual void insertVertexPoint 
     (const WH_Vector3D& point);
   
-  virtual void generateTriangleFacets ();
+  virtual void generateTriangleFacets 
+    (WH_Arena* arena = WH_NULL);
+  /* the tessellation is done on <arena>, or on an own arena if it is
+     WH_NULL */
   
   virtual void reverseNormal ();
   
   WH_Plane3D plane () const;
   
-  WH_Polygon3D outerLoopPolygon () const; 
-  WH_Polygon2D outerLoopParameterPolygon () const; 
+  const WH_Polygon3D& outerLoopPolygon () const; 
+  const WH_Polygon2D& outerLoopParameterPolygon () const; 
   
   const vector<WH_Polygon3D>& innerLoopPolygon_s () const; 
   const vector<WH_Polygon2D>& innerLoopParameterPolygon_s () const; 
+
+  bool outerLoopIsClockWise () const;
+  bool innerLoopIsClockWise (int iLoop) const;
+  /* orientation of the parameter polygon of the loop */
   
   const vector<WH_Segment3D>& offLoopEdgeSegment_s () const; 
   const vector<WH_Segment2D>& offLoopParameterEdgeSegment_s () const; 
@@ -342,7 +350,19 @@ class WH_GM3D_PolygonFacet {
   
   int _faceId;
 
+  struct LoopData {
+    bool isClockWise;
+    WH_Vector2D parameterMinRange;
+    WH_Vector2D parameterMaxRange;
+  };
+  mutable vector<LoopData> _loopData_s;
+  /* derived data of the outer loop and then of the inner loops, made
+     lazily on the first query and cleared whenever a loop changes */
+
   /* base */
+  const LoopData& loopDataAt (int iLoop) const;
+  /* <iLoop> is 0 for the outer loop, 1 + i for inner loop i */
+
   virtual bool insertVertexPointOnEdgeOfLoop 
     (const WH_Vector2D& parameter,
      WH_Polygon3D& poly_IO,
@@ -475,6 +495,15 @@ class WH_GM3D_FacetBody {
   virtual void reverseNormal ();
 
   virtual void setUpInOutCheck ();
+  /* the in-out checker is kept with the version at which it was set
+     up.  it is reused as it is while the version stays, and updated
+     by the changed triangle facets after the body is modified */
+
+  virtual void takeInOutChecker 
+    (WH_GM3D_FacetBody* body);
+  /* takes over the in-out checker of <body>, of which this body is
+     made by a set operation.  the next setUpInOutCheck () updates it
+     by the triangle facets which differ from those of <body> */
 
   /* factory method */
   virtual WH_GM3D_SegmentFacet* createSegmentFacet 
@@ -497,6 +526,13 @@ class WH_GM3D_FacetBody {
 
   bool normalIsReversed () const;
 
+  int version () const;
+  /* incremented on each modification of the body */
+
+  static int nInOutCheckHits ();
+  static int nInOutCheckUpdates ();
+  static int nInOutCheckBuilds ();
+
   const vector<WH_Vector3D>& vertexPoint_s () const;
   
   const vector<WH_GM3D_SegmentFacet*>& segmentFacet_s () const;
@@ -515,6 +551,11 @@ class WH_GM3D_FacetBody {
   };
   virtual BodyType bodyType () const;
 
+  virtual void getRange 
+    (WH_Vector3D& minRange_OUT, 
+     WH_Vector3D& maxRange_OUT) const;
+  /* range of the triangle facets of the polygon facets */
+
   virtual WH_InOutChecker3D::ContainmentType 
     checkContainmentAt 
     (const WH_Vector3D& point) const;
@@ -529,7 +570,14 @@ class WH_GM3D_FacetBody {
   /* derived */
   
  protected:
-  static int _faceCount;
+  /* per thread, as a body is built by a single thread */
+  static thread_local int _faceCount;
+
+  static thread_local int _nInOutCheckHits;
+
+  static thread_local int _nInOutCheckUpdates;
+
+  static thread_local int _nInOutCheckBuilds;
 
   bool _isRegular;
 
@@ -545,7 +593,23 @@ class WH_GM3D_FacetBody {
 
   WH_InOutChecker3D* _inOutChecker;  /* own */
 
+  int _version;
+
+  int _inOutCheckerVersion;
+
+  unordered_multimap<unsigned long long, WH_Triangle3D_IOC3D*> 
+    _inOutTriangleMap;
+  /* by the coordinates of the triangle facets, so that it matches the
+     copies of the facets in a body made of this one */
+
   /* base */
+  virtual void bumpVersion ();
+
+  virtual void collectInOutCheckFaces 
+    (vector<WH_GM3D_TriangleFacet*>& facet_s_OUT,
+     vector<WH_Vector3D>& normal_s_OUT) const;
+  /* triangle facets of outer boundary, and their normals to outside */
+
   virtual void generateRegularPolygonFacets ();
 
   virtual void generateNonRegularPolygonFacets ();
@@ -15,6 +15,32 @@
 
 
 
+static WH_Polygon3D PolygonOnPlane
+(const WH_Plane3D& plane,
+ const WH_Polygon2D& parameterPolygon)
+{
+  WH_CVR_LINE;
+
+  int nVertexs = parameterPolygon.nVertexs ();
+  const WH_Vector2D* params = parameterPolygon.vertexs ();
+  if (nVertexs <= WH_Polygon3D::N_INLINE_VERTEXS) {
+    WH_CVR_LINE;
+    WH_Vector3D vertexs[WH_Polygon3D::N_INLINE_VERTEXS];
+    for (int iVertex = 0; iVertex < nVertexs; iVertex++) {
+      vertexs[iVertex] = plane.positionAt (params[iVertex]);
+    }
+    return WH_Polygon3D (nVertexs, vertexs);
+  }
+
+  vector<WH_Vector3D> vertex_s;
+  for (int iVertex = 0; iVertex < nVertexs; iVertex++) {
+    vertex_s.push_back (plane.positionAt (params[iVertex]));
+  }
+  return WH_Polygon3D (vertex_s);
+}
+
+
+
 /* class WH_GM3D_PolygonFacet */
 
 WH_GM3D_PolygonFacet
@@ -28,13 +54,7 @@ WH_GM3D_PolygonFacet
 {
   WH_CVR_LINE;
   
-  vector<WH_Vector3D> vertex_s;
-  int nVertexs = outerLoopParameterPolygon.nVertexs ();
-  for (int iVertex = 0; iVertex < nVertexs; iVertex++) {
-    vertex_s.push_back 
-      (plane.positionAt (outerLoopParameterPolygon.vertex (iVertex)));
-  }
-  _outerLoopPolygon = WH_Polygon3D (vertex_s); 
+  _outerLoopPolygon = PolygonOnPlane (plane, outerLoopParameterPolygon); 
 
   _frontSideIsInsideVolume = frontSideIsInsideVolume;
   _backSideIsInsideVolume = backSideIsInsideVolume;
@@ -100,30 +120,29 @@ bool WH_GM3D_PolygonFacet
     (outerParamMinRange, outerParamMaxRange);
   WH_ASSERT(WH_lt (outerParamMinRange, outerParamMaxRange));
 
-  WH_Polygon3D outerPoly = this->outerLoopPolygon ();
-  WH_ASSERT(outerPoly.isRegular ());
-  WH_ASSERT(WH_eq (outerPoly.plane (), this->plane ()) 
-	    || WH_isReverse (outerPoly.plane (), this->plane ()));
-  WH_ASSERT(WH_eq (outerPoly.minRange (), outerMinRange));
-  WH_ASSERT(WH_eq (outerPoly.maxRange (), outerMaxRange));
+  WH_ASSERT(this->outerLoopPolygon ().isRegular ());
+  WH_ASSERT(WH_eq (this->outerLoopPolygon ().plane (), this->plane ()) 
+	    || WH_isReverse (this->outerLoopPolygon ().plane (), 
+			     this->plane ()));
+  WH_ASSERT(WH_eq (this->outerLoopPolygon ().minRange (), outerMinRange));
+  WH_ASSERT(WH_eq (this->outerLoopPolygon ().maxRange (), outerMaxRange));
   
-  WH_Polygon2D outerParamPoly 
-    = this->outerLoopParameterPolygon ();
-  WH_ASSERT(outerParamPoly.isRegular ());
-  WH_ASSERT(WH_eq (outerParamPoly.minRange (), outerParamMinRange));
-  WH_ASSERT(WH_eq (outerParamPoly.maxRange (), outerParamMaxRange));
+  WH_ASSERT(this->outerLoopParameterPolygon ().isRegular ());
+  WH_ASSERT(WH_eq (this->outerLoopParameterPolygon ().minRange (), 
+		   outerParamMinRange));
+  WH_ASSERT(WH_eq (this->outerLoopParameterPolygon ().maxRange (), 
+		   outerParamMaxRange));
   
   for (vector<WH_Polygon3D>::const_iterator 
 	 i_poly = this->innerLoopPolygon_s ().begin ();
        i_poly != this->innerLoopPolygon_s ().end ();
        i_poly++) {
-    WH_Polygon3D poly_i = (*i_poly);
-    WH_ASSERT(poly_i.isRegular ());
-    WH_ASSERT(WH_eq (poly_i.plane (), this->plane ()) 
-	      || WH_isReverse (poly_i.plane (), this->plane ()));
-    WH_ASSERT(WH_between (poly_i.minRange (), 
+    WH_ASSERT(i_poly->isRegular ());
+    WH_ASSERT(WH_eq (i_poly->plane (), this->plane ()) 
+	      || WH_isReverse (i_poly->plane (), this->plane ()));
+    WH_ASSERT(WH_between (i_poly->minRange (), 
 			  outerMinRange, outerMaxRange));
-    WH_ASSERT(WH_between (poly_i.maxRange (), 
+    WH_ASSERT(WH_between (i_poly->maxRange (), 
 			  outerMinRange, outerMaxRange));
   }
 
@@ -131,7 +150,7 @@ bool WH_GM3D_PolygonFacet
 	 i_poly = this->innerLoopParameterPolygon_s ().begin ();
        i_poly != this->innerLoopParameterPolygon_s ().end ();
        i_poly++) {
-    WH_Polygon2D poly_i = (*i_poly);
+    const WH_Polygon2D& poly_i = (*i_poly);
     WH_ASSERT(poly_i.isRegular ());
     WH_ASSERT(WH_justBetween (poly_i.minRange (), 
 			      outerParamMinRange, outerParamMaxRange));
@@ -140,7 +159,7 @@ bool WH_GM3D_PolygonFacet
 
     for (int iVertex = 0; iVertex < poly_i.nVertexs (); iVertex++) {
       WH_Vector2D point = poly_i.vertex (iVertex);
-      WH_ASSERT(outerParamPoly.checkContainmentAt (point)
+      WH_ASSERT(this->outerLoopParameterPolygon ().checkContainmentAt (point)
 		== WH_Polygon2D::IN);
     }
   }
@@ -256,6 +275,7 @@ bool WH_GM3D_PolygonFacet
       }
       paramPoly_IO = WH_Polygon2D (param_s);
       poly_IO = WH_Polygon3D (point_s);
+      _loopData_s.clear ();
       
       result = true;
       break;
@@ -418,17 +438,10 @@ void WH_GM3D_PolygonFacet
   WH_CVR_LINE;
 
   _innerLoopParameterPolygon_s.push_back (parameterPolygon);
+  _innerLoopPolygon_s.push_back 
+    (PolygonOnPlane (this->plane (), parameterPolygon));
 
-  WH_Plane3D plane = this->plane ();
-  vector<WH_Vector3D> vertex_s;
-  int nVertexs = parameterPolygon.nVertexs ();
-  for (int iVertex = 0; iVertex < nVertexs; iVertex++) {
-    vertex_s.push_back 
-      (plane.positionAt (parameterPolygon.vertex (iVertex)));
-  }
-  WH_Polygon3D polygon (vertex_s); 
-
-  _innerLoopPolygon_s.push_back (polygon);
+  _loopData_s.clear ();
 }
   
 void WH_GM3D_PolygonFacet
@@ -565,7 +578,7 @@ void WH_GM3D_PolygonFacet
 }
 
 void WH_GM3D_PolygonFacet
-::generateTriangleFacets ()
+::generateTriangleFacets (WH_Arena* arena)
 {
   /* PRE-CONDITION */
   WH_ASSERT(this->triangleFacet_s ().size () == 0);
@@ -573,46 +586,48 @@ void WH_GM3D_PolygonFacet
 
   WH_CVR_LINE;
 
-  WH_TSLT_Tessellator2D tessellator;
+  WH_TSLT_Tessellator2D tessellator 
+    (WH_TSLT_Tessellator2D::MONOTONE, arena);
 
   {
-    WH_Polygon2D poly = this->outerLoopParameterPolygon ();
+    const WH_Polygon2D& poly = this->outerLoopParameterPolygon ();
+    const WH_Vector2D* vertexs = poly.vertexs ();
 
     /* outer loop is counter clock-wise */
     int nVertexs = poly.nVertexs ();
     tessellator.beginLoop ();
-    if (poly.isClockWise ()) {
+    if (this->outerLoopIsClockWise ()) {
       WH_CVR_LINE;
       for (int iVertex = nVertexs - 1; 0 <= iVertex; iVertex--) {
-	tessellator.addLoopVertex (poly.vertex (iVertex));
+	tessellator.addLoopVertex (vertexs[iVertex]);
       }
     } else {
       WH_CVR_LINE;
       for (int iVertex = 0; iVertex < nVertexs; iVertex++) {
-	tessellator.addLoopVertex (poly.vertex (iVertex));
+	tessellator.addLoopVertex (vertexs[iVertex]);
       }
     }
     tessellator.endLoop ();
   }
   
-  for (vector<WH_Polygon2D>::const_iterator 
-	 i_poly = this->innerLoopParameterPolygon_s ().begin ();
-       i_poly != this->innerLoopParameterPolygon_s ().end ();
-       i_poly++) {
-    WH_Polygon2D poly_i = (*i_poly);
+  int nLoops = (int)this->innerLoopParameterPolygon_s ().size ();
+  for (int iLoop = 0; iLoop < nLoops; iLoop++) {
+    const WH_Polygon2D& poly_i 
+      = this->innerLoopParameterPolygon_s ()[iLoop];
+    const WH_Vector2D* vertexs = poly_i.vertexs ();
 
     /* inner loop is clock-wise */
     int nVertexs = poly_i.nVertexs ();
     tessellator.beginLoop ();
-    if (poly_i.isClockWise ()) {
+    if (this->innerLoopIsClockWise (iLoop)) {
       WH_CVR_LINE;
       for (int iVertex = 0; iVertex < nVertexs; iVertex++) {
-	tessellator.addLoopVertex (poly_i.vertex (iVertex));
+	tessellator.addLoopVertex (vertexs[iVertex]);
       }
     } else {
       WH_CVR_LINE;
       for (int iVertex = nVertexs - 1; 0 <= iVertex; iVertex--) {
-	tessellator.addLoopVertex (poly_i.vertex (iVertex));
+	tessellator.addLoopVertex (vertexs[iVertex]);
       }
     }
     tessellator.endLoop ();
@@ -690,13 +705,13 @@ WH_Plane3D WH_GM3D_PolygonFacet
   return _plane;
 }
 
-WH_Polygon3D WH_GM3D_PolygonFacet
+const WH_Polygon3D& WH_GM3D_PolygonFacet
 ::outerLoopPolygon () const
 {
   return _outerLoopPolygon;
 }
 
-WH_Polygon2D WH_GM3D_PolygonFacet
+const WH_Polygon2D& WH_GM3D_PolygonFacet
 ::outerLoopParameterPolygon () const
 {
   return _outerLoopParameterPolygon;
@@ -714,6 +729,47 @@ const vector<WH_Polygon2D>& WH_GM3D_PolygonFacet
   return _innerLoopParameterPolygon_s;
 }
 
+const WH_GM3D_PolygonFacet::LoopData& WH_GM3D_PolygonFacet
+::loopDataAt (int iLoop) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= iLoop);
+  WH_ASSERT(iLoop <= (int)this->innerLoopParameterPolygon_s ().size ());
+
+  if (_loopData_s.size () == 0) {
+    WH_CVR_LINE;
+    int nLoops = 1 + (int)this->innerLoopParameterPolygon_s ().size ();
+    _loopData_s.resize (nLoops);
+    for (int iLoop2 = 0; iLoop2 < nLoops; iLoop2++) {
+      const WH_Polygon2D& poly = (iLoop2 == 0) 
+	? this->outerLoopParameterPolygon ()
+	: this->innerLoopParameterPolygon_s ()[iLoop2 - 1];
+      LoopData& data = _loopData_s[iLoop2];
+      data.isClockWise = poly.isClockWise ();
+      data.parameterMinRange = poly.minRange ();
+      data.parameterMaxRange = poly.maxRange ();
+    }
+  }
+
+  return _loopData_s[iLoop];
+}
+
+bool WH_GM3D_PolygonFacet
+::outerLoopIsClockWise () const
+{
+  return this->loopDataAt (0).isClockWise;
+}
+
+bool WH_GM3D_PolygonFacet
+::innerLoopIsClockWise (int iLoop) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= iLoop);
+  WH_ASSERT(iLoop < (int)this->innerLoopParameterPolygon_s ().size ());
+
+  return this->loopDataAt (1 + iLoop).isClockWise;
+}
+
 const vector<WH_Segment3D>& WH_GM3D_PolygonFacet
 ::offLoopEdgeSegment_s () const
 {
@@ -857,7 +913,7 @@ WH_Polygon2D::ContainmentType WH_GM3D_PolygonFacet
   if (WH_between (parameter, minRange, maxRange)) {
     WH_CVR_LINE;
     
-    WH_Polygon2D outerParamPoly 
+    const WH_Polygon2D& outerParamPoly 
       = this->outerLoopParameterPolygon ();
     WH_Polygon2D::ContainmentType outerFlag 
       = outerParamPoly.checkContainmentAt (parameter);
@@ -866,12 +922,17 @@ WH_Polygon2D::ContainmentType WH_GM3D_PolygonFacet
       WH_CVR_LINE;
       {
 	result = WH_Polygon2D::IN;
-	for (vector<WH_Polygon2D>::const_iterator 
-	       i_poly = this->innerLoopParameterPolygon_s ().begin ();
-	     i_poly != this->innerLoopParameterPolygon_s ().end ();
-	     i_poly++) {
-	  WH_Polygon2D poly_i = (*i_poly);
+	int nLoops = (int)this->innerLoopParameterPolygon_s ().size ();
+	for (int iLoop = 0; iLoop < nLoops; iLoop++) {
+	  const LoopData& data = this->loopDataAt (1 + iLoop);
+	  if (!WH_between (parameter, 
+			   data.parameterMinRange, data.parameterMaxRange)) {
+	    WH_CVR_LINE;
+	    continue;
+	  }
 
+	  const WH_Polygon2D& poly_i 
+	    = this->innerLoopParameterPolygon_s ()[iLoop];
 	  WH_Polygon2D::ContainmentType flag 
 	    = poly_i.checkContainmentAt (parameter);
 	  if (flag == WH_Polygon2D::IN) {
@@ -11,53 +11,346 @@
 #endif
 
 #include "gm3d_io.h"
+#include "gm3d_facet.h"
+#include "gm3d_cache.h"
+#include "binary_io.h"
+#include "debug_levels.h"
 
 
 
 /* module procedures */
 
+/* a body on the stack of a script, either as a B-rep or in facet
+   form.  just one of them is not WH_NULL */
+struct WH_GM3D_StackedBody {
+  WH_GM3D_Body* body;  /* own */
+  WH_GM3D_FacetBody* facetBody;  /* own */
+  bool isCached;
+  /* loaded from WH_GM3D_BodyCache, not made by the script */
+};
+
+/* counts of set operations of volumes in facet form, and of the
+   conversions of bodies on the stack for or after them, per thread */
+static thread_local int NFacetFormOperations = 0;
+
+static thread_local int NFacetFormConversions = 0;
+
+/* conversions of bodies loaded from the cache, which are left out of
+   the counts above, per thread */
+static thread_local int NCachedBodyConversions = 0;
+
+static thread_local double CachedBodyConversionSeconds = 0;
+
+static void PushBody 
+(vector<WH_GM3D_StackedBody>& bodyStack_IO,
+ WH_GM3D_Body* body  /* ADOPT */)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(body != WH_NULL);
+
+  WH_GM3D_StackedBody stackedBody;
+  stackedBody.body = body;
+  stackedBody.facetBody = WH_NULL;
+  stackedBody.isCached = false;
+  bodyStack_IO.push_back (stackedBody);
+}
+
+static void PushFacetBody 
+(vector<WH_GM3D_StackedBody>& bodyStack_IO,
+ WH_GM3D_FacetBody* facetBody  /* ADOPT */)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(facetBody != WH_NULL);
+
+  WH_GM3D_StackedBody stackedBody;
+  stackedBody.body = WH_NULL;
+  stackedBody.facetBody = facetBody;
+  stackedBody.isCached = false;
+  bodyStack_IO.push_back (stackedBody);
+}
+
+static bool IsRegular 
+(const WH_GM3D_StackedBody& stackedBody)
+{
+  if (stackedBody.body != WH_NULL) {
+    return stackedBody.body->isRegular ();
+  } else {
+    return stackedBody.facetBody->isRegular ();
+  }
+}
+
+static void MakeBrep 
+(WH_GM3D_StackedBody& stackedBody_IO)
+{
+  if (stackedBody_IO.body == WH_NULL) {
+    WH_CVR_LINE;
+    double secondsBefore = WH_GM3D::conversionSeconds ();
+    stackedBody_IO.body = WH_GM3D::createBody (stackedBody_IO.facetBody);
+    if (stackedBody_IO.isCached) {
+      WH_CVR_LINE;
+      NCachedBodyConversions++;
+      CachedBodyConversionSeconds 
+	+= WH_GM3D::conversionSeconds () - secondsBefore;
+    } else {
+      NFacetFormConversions++;
+    }
+    delete stackedBody_IO.facetBody;
+    stackedBody_IO.facetBody = WH_NULL;
+  }
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(stackedBody_IO.body != WH_NULL);
+  WH_ASSERT(stackedBody_IO.facetBody == WH_NULL);
+#endif
+}
+
+static void MakeFacetBody 
+(WH_GM3D_StackedBody& stackedBody_IO)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(IsRegular (stackedBody_IO));
+
+  if (stackedBody_IO.facetBody == WH_NULL) {
+    WH_CVR_LINE;
+    stackedBody_IO.facetBody 
+      = WH_GM3D::createFacetBody (stackedBody_IO.body);
+    NFacetFormConversions++;
+    delete stackedBody_IO.body;
+    stackedBody_IO.body = WH_NULL;
+  }
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(stackedBody_IO.body == WH_NULL);
+  WH_ASSERT(stackedBody_IO.facetBody != WH_NULL);
+#endif
+}
+
+static WH_GM3D_Body* PopBody 
+(vector<WH_GM3D_StackedBody>& bodyStack_IO)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(1 <= bodyStack_IO.size ());
+
+  MakeBrep (bodyStack_IO.back ());
+  WH_GM3D_Body* result = bodyStack_IO.back ().body;
+  bodyStack_IO.pop_back ();
+  return result;
+}
+
+/* the two top bodies in facet form for a set operation of volumes,
+   or false to operate on their B-reps */
+static bool PopFacetBodies 
+(vector<WH_GM3D_StackedBody>& bodyStack_IO,
+ WH_GM3D_FacetBody*& blankBody_OUT,
+ WH_GM3D_FacetBody*& toolBody_OUT)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(2 <= bodyStack_IO.size ());
+
+  WH_GM3D_StackedBody& blank = bodyStack_IO[bodyStack_IO.size () - 2];
+  WH_GM3D_StackedBody& tool = bodyStack_IO[bodyStack_IO.size () - 1];
+  if (!WH_GM3D_IO::keepsFacetForm () 
+      || !IsRegular (blank) || !IsRegular (tool)) {
+    WH_CVR_LINE;
+    return false;
+  }
+
+  WH_CVR_LINE;
+
+  /* in the order of the conversions by WH_GM3D::add () */
+  MakeFacetBody (blank);
+  MakeFacetBody (tool);
+
+  toolBody_OUT = tool.facetBody;
+  bodyStack_IO.pop_back ();
+  blankBody_OUT = bodyStack_IO.back ().facetBody;
+  bodyStack_IO.pop_back ();
+
+  NFacetFormOperations++;
+
+  return true;
+}
+
+/* a command of a script, with its arguments as read */
+struct WH_GM3D_ScriptCommand {
+  string word;
+  vector<double> value_s;
+  /* arguments in the order of the script, counts included */
+  vector<int> operand_s;
+  /* commands of the bodies it takes from the stack, bottom first */
+  unsigned long long key;
+  /* of the command and of the commands of its operands, for
+     WH_GM3D_BodyCache */
+};
+
+static unsigned long long HashBytes 
+(unsigned long long hash, const void* bytes, size_t nBytes)
+{
+  /* FNV-1a */
+  const unsigned char* byte_s = (const unsigned char*)bytes;
+  for (size_t i = 0; i < nBytes; i++) {
+    hash ^= byte_s[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static unsigned long long KeyBase ()
+{
+  /* the settings which change the results of a script */
+  unsigned long long result = 14695981039346656037ULL;
+  int version = 1;
+  result = HashBytes (result, &version, sizeof (version));
+  result = HashBytes (result, &WH::eps, sizeof (WH::eps));
+  int checkerType = (int)WH_InOutChecker3D::checkerType ();
+  result = HashBytes (result, &checkerType, sizeof (checkerType));
+  bool keepsFacetForm = WH_GM3D_IO::keepsFacetForm ();
+  result = HashBytes (result, &keepsFacetForm, sizeof (keepsFacetForm));
+  return result;
+}
+
+static void ReadValues 
+(ifstream& in, int nValues, WH_GM3D_ScriptCommand& command_IO)
+{
+  for (int iValue = 0; iValue < nValues; iValue++) {
+    double value;
+    in >> value;
+    command_IO.value_s.push_back (value);
+  }
+}
+
+static int ReadCount 
+(ifstream& in, WH_GM3D_ScriptCommand& command_IO)
+{
+  int result;
+  in >> result;
+  command_IO.value_s.push_back (result);
+  return result;
+}
+
+static void ReadScript 
+(ifstream& in, vector<WH_GM3D_ScriptCommand>& command_s_OUT)
+{
+  WH_CVR_LINE;
+
+  unsigned long long keyBase = KeyBase ();
+
+  /* commands of the bodies on the stack */
+  vector<int> commandStack;
+
+  for (;;) {
+    string word;
+    in >> word;
+
+    if (word[0] == '#') {
+      string line;
+      getline (in, line);
+
+      cerr << line << endl;
+      continue;
+    }
+
+    WH_GM3D_ScriptCommand command;
+    command.word = word;
+    int nOperands = 0;
+    if (word == "sheet") {
+      int nVertexs = ReadCount (in, command);
+      WH_ASSERT(2 < nVertexs);
+      ReadValues (in, nVertexs * 3, command);
+    } else if (word == "circle") {
+      ReadValues (in, 9, command);
+      ReadCount (in, command);
+    } else if (word == "box") {
+      ReadValues (in, 6, command);
+    } else if (word == "extrude") {
+      ReadValues (in, 3, command);
+      nOperands = 1;
+    } else if (word == "revolve") {
+      ReadValues (in, 6, command);
+      ReadCount (in, command);
+      nOperands = 1;
+    } else if (word == "add" || word == "subtract") {
+      nOperands = 2;
+    } else {
+      break;
+    }
+    WH_ASSERT(nOperands <= (int)commandStack.size ());
+
+    command.operand_s.assign (commandStack.end () - nOperands,
+			      commandStack.end ());
+    commandStack.resize (commandStack.size () - nOperands);
+    commandStack.push_back ((int)command_s_OUT.size ());
+
+    unsigned long long key = keyBase;
+    key = HashBytes (key, word.c_str (), word.length () + 1);
+    if (0 < command.value_s.size ()) {
+      key = HashBytes (key, &command.value_s[0], 
+		       command.value_s.size () * sizeof (double));
+    }
+    for (vector<int>::const_iterator 
+	   i_operand = command.operand_s.begin ();
+	 i_operand != command.operand_s.end ();
+	 i_operand++) {
+      key = HashBytes (key, &command_s_OUT[*i_operand].key, 
+		       sizeof (unsigned long long));
+    }
+    command.key = key;
+
+    command_s_OUT.push_back (command);
+  }
+
+  WH_ASSERT(commandStack.size () == 1);
+  WH_ASSERT(commandStack[0] == (int)command_s_OUT.size () - 1);
+}
+
+static bool IsSetOperation 
+(const WH_GM3D_ScriptCommand& command)
+{
+  return command.word == "add" || command.word == "subtract";
+}
+
 static void PushSheet 
-(ifstream& in, vector<WH_GM3D_Body*>& bodyStack_IO)
+(const WH_GM3D_ScriptCommand& command, 
+ vector<WH_GM3D_StackedBody>& bodyStack_IO)
 {
   WH_CVR_LINE;
 
-  int nVertexs;
-  in >> nVertexs;
-  WH_ASSERT(2 < nVertexs);
+  int nVertexs = (int)command.value_s[0];
   
   vector<WH_Vector3D> vertex_s;
   for (int iVertex = 0; iVertex < nVertexs; iVertex++) {
     WH_Vector3D vertex;
-    in >> vertex.x;
-    in >> vertex.y;
-    in >> vertex.z;
+    vertex.x = command.value_s[1 + iVertex * 3];
+    vertex.y = command.value_s[2 + iVertex * 3];
+    vertex.z = command.value_s[3 + iVertex * 3];
     vertex_s.push_back (vertex);
   }
   
   WH_Polygon3D poly (vertex_s);
   WH_GM3D_Body* body 
     = WH_GM3D::createSheet (poly);
-  bodyStack_IO.push_back (body);
+  PushBody (bodyStack_IO, body);
 }
 
 static void PushCircle 
-(ifstream& in, vector<WH_GM3D_Body*>& bodyStack_IO)
+(const WH_GM3D_ScriptCommand& command, 
+ vector<WH_GM3D_StackedBody>& bodyStack_IO)
 {
   WH_CVR_LINE;
 
-  WH_Vector3D center;
-  in >> center.x >> center.y >> center.z;
+  const vector<double>& value_s = command.value_s;
+
+  WH_Vector3D center (value_s[0], value_s[1], value_s[2]);
   
-  WH_Vector3D xAxis;
-  in >> xAxis.x >> xAxis.y >> xAxis.z;
+  WH_Vector3D xAxis (value_s[3], value_s[4], value_s[5]);
   WH_ASSERT(WH_ne (xAxis, WH_Vector3D::zero ()));
   
-  WH_Vector3D normal;
-  in >> normal.x >> normal.y >> normal.z;
+  WH_Vector3D normal (value_s[6], value_s[7], value_s[8]);
   WH_ASSERT(WH_ne (normal, WH_Vector3D::zero ()));
   
-  int nDivisions;
-  in >> nDivisions;
+  int nDivisions = (int)value_s[9];
   WH_ASSERT(1 < nDivisions);
   
   double radius = xAxis.length ();
@@ -75,117 +368,421 @@ static void PushCircle
   WH_Polygon3D poly (vertex_s);
   WH_GM3D_Body* body 
     = WH_GM3D::createSheet (poly);
-  bodyStack_IO.push_back (body);
+  PushBody (bodyStack_IO, body);
 }
 
 static void PushBox 
-(ifstream& in, vector<WH_GM3D_Body*>& bodyStack_IO)
+(const WH_GM3D_ScriptCommand& command, 
+ vector<WH_GM3D_StackedBody>& bodyStack_IO)
 {
   WH_CVR_LINE;
 
-  WH_Vector3D origin;
-  in >> origin.x >> origin.y >> origin.z;
+  const vector<double>& value_s = command.value_s;
+
+  WH_Vector3D origin (value_s[0], value_s[1], value_s[2]);
   
-  WH_Vector3D extent;
-  in >> extent.x >> extent.y >> extent.z;
+  WH_Vector3D extent (value_s[3], value_s[4], value_s[5]);
   WH_ASSERT(WH_ne (extent, WH_Vector3D::zero ()));
   
   WH_GM3D_Body* body 
     = WH_GM3D::createBox (origin, extent);
-  bodyStack_IO.push_back (body);
+  PushBody (bodyStack_IO, body);
 }
 
 static void ExtrudeFirst 
-(ifstream& in, vector<WH_GM3D_Body*>& bodyStack_IO)
+(const WH_GM3D_ScriptCommand& command, 
+ vector<WH_GM3D_StackedBody>& bodyStack_IO)
 {
   /* PRE-CONDITION */
   WH_ASSERT(1 <= bodyStack_IO.size ());
   
   WH_CVR_LINE;
 
-  WH_Vector3D offset;
-  in >> offset.x >> offset.y >> offset.z;
+  const vector<double>& value_s = command.value_s;
+
+  WH_Vector3D offset (value_s[0], value_s[1], value_s[2]);
   WH_ASSERT(WH_ne (offset, WH_Vector3D::zero ()));
   
-  WH_GM3D_Body* profileBody = bodyStack_IO.back ();
-  bodyStack_IO.pop_back ();
+  WH_GM3D_Body* profileBody = PopBody (bodyStack_IO);
   
   WH_GM3D_Body* solidBody 
     = WH_GM3D::extrude (profileBody, offset);
-  bodyStack_IO.push_back (solidBody);
+  PushBody (bodyStack_IO, solidBody);
   
   delete profileBody;
   profileBody = WH_NULL;
 }
 
 static void RevolveFirst 
-(ifstream& in, vector<WH_GM3D_Body*>& bodyStack_IO)
+(const WH_GM3D_ScriptCommand& command, 
+ vector<WH_GM3D_StackedBody>& bodyStack_IO)
 {
   /* PRE-CONDITION */
   WH_ASSERT(1 <= bodyStack_IO.size ());
   
   WH_CVR_LINE;
 
-  WH_Vector3D point0;
-  WH_Vector3D point1;
-  in >> point0.x >> point0.y >> point0.z;
-  in >> point1.x >> point1.y >> point1.z;
+  const vector<double>& value_s = command.value_s;
+
+  WH_Vector3D point0 (value_s[0], value_s[1], value_s[2]);
+  WH_Vector3D point1 (value_s[3], value_s[4], value_s[5]);
   WH_ASSERT(WH_ne (point0, point1));
   WH_Line3D axis (point0, point1);
   
-  int nDivisions;
-  in >> nDivisions;
+  int nDivisions = (int)value_s[6];
   WH_ASSERT(1 < nDivisions);
   
-  WH_GM3D_Body* profileBody = bodyStack_IO.back ();
-  bodyStack_IO.pop_back ();
+  WH_GM3D_Body* profileBody = PopBody (bodyStack_IO);
   
   WH_GM3D_Body* solidBody 
     = WH_GM3D::revolve (profileBody, axis, nDivisions);
-  bodyStack_IO.push_back (solidBody);
+  PushBody (bodyStack_IO, solidBody);
   
   delete profileBody;
   profileBody = WH_NULL;
 }
 
 static void AddFirstAndSecond 
-(ifstream& in, vector<WH_GM3D_Body*>& bodyStack_IO)
+(vector<WH_GM3D_StackedBody>& bodyStack_IO)
 {
   /* PRE-CONDITION */
   WH_ASSERT(2 <= bodyStack_IO.size ());
   
   WH_CVR_LINE;
 
-  WH_GM3D_Body* toolBody = bodyStack_IO.back ();
-  bodyStack_IO.pop_back ();
-  WH_GM3D_Body* blankBody = bodyStack_IO.back ();
-  bodyStack_IO.pop_back ();
+  WH_GM3D_FacetBody* blankFacetBody;
+  WH_GM3D_FacetBody* toolFacetBody;
+  if (PopFacetBodies (bodyStack_IO, blankFacetBody, toolFacetBody)) {
+    WH_CVR_LINE;
+    PushFacetBody (bodyStack_IO, 
+		   WH_GM3D::add (blankFacetBody, toolFacetBody));
+    return;
+  }
+
+  WH_GM3D_Body* toolBody = PopBody (bodyStack_IO);
+  WH_GM3D_Body* blankBody = PopBody (bodyStack_IO);
   
   WH_GM3D::add (blankBody, toolBody);
-  bodyStack_IO.push_back (blankBody);
+  PushBody (bodyStack_IO, blankBody);
 }
 
 static void SubtractFirstFromSecond 
-(ifstream& in, vector<WH_GM3D_Body*>& bodyStack_IO)
+(vector<WH_GM3D_StackedBody>& bodyStack_IO)
 {
   /* PRE-CONDITION */
   WH_ASSERT(2 <= bodyStack_IO.size ());
   
   WH_CVR_LINE;
 
-  WH_GM3D_Body* toolBody = bodyStack_IO.back ();
-  bodyStack_IO.pop_back ();
-  WH_GM3D_Body* blankBody = bodyStack_IO.back ();
-  bodyStack_IO.pop_back ();
+  WH_GM3D_FacetBody* blankFacetBody;
+  WH_GM3D_FacetBody* toolFacetBody;
+  if (PopFacetBodies (bodyStack_IO, blankFacetBody, toolFacetBody)) {
+    WH_CVR_LINE;
+    PushFacetBody (bodyStack_IO, 
+		   WH_GM3D::subtract (blankFacetBody, toolFacetBody));
+    return;
+  }
+
+  WH_GM3D_Body* toolBody = PopBody (bodyStack_IO);
+  WH_GM3D_Body* blankBody = PopBody (bodyStack_IO);
   
   WH_GM3D::subtract (blankBody, toolBody);
-  bodyStack_IO.push_back (blankBody);
+  PushBody (bodyStack_IO, blankBody);
+}
+
+static void LoadCachedBodies 
+(const vector<WH_GM3D_ScriptCommand>& command_s,
+ WH_GM3D_BodyCache* cache,
+ vector<bool>& isRun_s_OUT,
+ vector<WH_GM3D_FacetBody*>& cachedBody_s_OUT)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < command_s.size ());
+
+  WH_CVR_LINE;
+
+  /* from the last command down to the commands whose bodies are
+     cached, so that the script resumes from the deepest ones */
+  int nCommands = (int)command_s.size ();
+  isRun_s_OUT.assign (nCommands, false);
+  cachedBody_s_OUT.assign (nCommands, WH_NULL);
+
+  vector<int> commandToVisit_s;
+  commandToVisit_s.push_back (nCommands - 1);
+  while (0 < commandToVisit_s.size ()) {
+    int iCommand = commandToVisit_s.back ();
+    commandToVisit_s.pop_back ();
+    const WH_GM3D_ScriptCommand& command = command_s[iCommand];
+
+    if (cache != WH_NULL && IsSetOperation (command)) {
+      cachedBody_s_OUT[iCommand] = cache->createBody (command.key);
+      if (cachedBody_s_OUT[iCommand] != WH_NULL) {
+	WH_CVR_LINE;
+	continue;
+      }
+    }
+    isRun_s_OUT[iCommand] = true;
+    commandToVisit_s.insert (commandToVisit_s.end (), 
+			     command.operand_s.begin (), 
+			     command.operand_s.end ());
+  }
+}
+
+static void RunScript 
+(const vector<WH_GM3D_ScriptCommand>& command_s,
+ vector<WH_GM3D_StackedBody>& bodyStack_IO)
+{
+  WH_CVR_LINE;
+
+  WH_GM3D_BodyCache* cache = WH_GM3D_IO::bodyCache ();
+
+  vector<bool> isRun_s;
+  vector<WH_GM3D_FacetBody*> cachedBody_s;
+  LoadCachedBodies (command_s, cache, isRun_s, cachedBody_s);
+
+  int nCommands = (int)command_s.size ();
+  int nRunCommands = 0;
+  int nCachedBodies = 0;
+  int nStoredBodies = 0;
+  for (int iCommand = 0; iCommand < nCommands; iCommand++) {
+    const WH_GM3D_ScriptCommand& command = command_s[iCommand];
+
+    if (cachedBody_s[iCommand] != WH_NULL) {
+      WH_CVR_LINE;
+      PushFacetBody (bodyStack_IO, cachedBody_s[iCommand]);
+      bodyStack_IO.back ().isCached = true;
+      nCachedBodies++;
+      continue;
+    }
+    if (!isRun_s[iCommand]) continue;
+
+    const string& word = command.word;
+    if (word == "sheet") {
+      PushSheet (command, bodyStack_IO);
+    } else if (word == "circle") {
+      PushCircle (command, bodyStack_IO);
+    } else if (word == "box") {
+      PushBox (command, bodyStack_IO);
+    } else if (word == "extrude") {
+      ExtrudeFirst (command, bodyStack_IO);
+    } else if (word == "revolve") {
+      RevolveFirst (command, bodyStack_IO);
+    } else if (word == "add") {
+      AddFirstAndSecond (bodyStack_IO);
+    } else if (word == "subtract") {
+      SubtractFirstFromSecond (bodyStack_IO);
+    }
+    nRunCommands++;
+
+    if (cache != WH_NULL && IsSetOperation (command)
+	&& bodyStack_IO.back ().facetBody != WH_NULL) {
+      WH_CVR_LINE;
+      if (cache->storeBody (command.key, bodyStack_IO.back ().facetBody)) {
+	nStoredBodies++;
+      }
+    }
+  }
+
+  if (cache != WH_NULL) {
+    WH_CVR_LINE;
+    WH_PRINTF_NORMAL("Body cache: %d of %d commands run, %d results "
+		     "loaded and %d stored", 
+		     nRunCommands, nCommands, nCachedBodies, nStoredBodies);
+  }
+}
+
+
+/* a body in binary form is the header, the vertices, the edges by the
+   indices of their vertices, the faces by the indices of their
+   vertices and edges, and the trailer */
+static const char* BODY_STREAM_MAGIC = "WHGB";
+
+static const char* BODY_STREAM_END = "END.";
+
+static const int BODY_STREAM_VERSION = 1;
+
+static void WriteLoop 
+(ostream& out,
+ WH_GM3D_Loop* loop,
+ const unordered_map<WH_GM3D_Vertex*, int>& vertexIndexMap)
+{
+  WH_writeBinary (out, (int)loop->vertexUse_s ().size ());
+  for (vector<WH_GM3D_LoopVertexUse*>::const_iterator 
+	 i_vertexUse = loop->vertexUse_s ().begin ();
+       i_vertexUse != loop->vertexUse_s ().end ();
+       i_vertexUse++) {
+    WH_writeBinary (out, vertexIndexMap.at ((*i_vertexUse)->vertex ()));
+  }
+}
+
+static void WriteFace 
+(ostream& out,
+ WH_GM3D_Face* face,
+ const unordered_map<WH_GM3D_Vertex*, int>& vertexIndexMap,
+ const unordered_map<WH_GM3D_Edge*, int>& edgeIndexMap)
+{
+  WH_Plane3D plane = face->plane ();
+  WH_writeBinary (out, plane.a ());
+  WH_writeBinary (out, plane.b ());
+  WH_writeBinary (out, plane.c ());
+  WH_writeBinary (out, plane.d ());
+  WH_writeBinary (out, face->frontSide ()->isInsideVolume () ? 1 : 0);
+  WH_writeBinary (out, face->backSide ()->isInsideVolume () ? 1 : 0);
+
+  WriteLoop (out, face->outerLoop (), vertexIndexMap);
+  WH_writeBinary (out, (int)face->innerLoop_s ().size ());
+  for (vector<WH_GM3D_Loop*>::const_iterator 
+	 i_loop = face->innerLoop_s ().begin ();
+       i_loop != face->innerLoop_s ().end ();
+       i_loop++) {
+    WriteLoop (out, (*i_loop), vertexIndexMap);
+  }
+
+  WH_writeBinary (out, (int)face->offLoopVertexUse_s ().size ());
+  for (vector<WH_GM3D_OffLoopVertexUse*>::const_iterator 
+	 i_vertexUse = face->offLoopVertexUse_s ().begin ();
+       i_vertexUse != face->offLoopVertexUse_s ().end ();
+       i_vertexUse++) {
+    WH_writeBinary (out, vertexIndexMap.at ((*i_vertexUse)->vertex ()));
+  }
+
+  WH_writeBinary (out, (int)face->offLoopEdgeUse_s ().size ());
+  for (vector<WH_GM3D_OffLoopEdgeUse*>::const_iterator 
+	 i_edgeUse = face->offLoopEdgeUse_s ().begin ();
+       i_edgeUse != face->offLoopEdgeUse_s ().end ();
+       i_edgeUse++) {
+    WH_writeBinary (out, edgeIndexMap.at ((*i_edgeUse)->edge ()));
+  }
+}
+
+static bool ReadIndexs 
+(istream& in,
+ int nItems,
+ vector<int>& index_s_OUT)
+{
+  int nIndexs;
+  if (!WH_readBinaryCount (in, nIndexs)) return false;
+  index_s_OUT.resize (nIndexs);
+  for (int i = 0; i < nIndexs; i++) {
+    if (!WH_readBinary (in, index_s_OUT[i])
+	|| index_s_OUT[i] < 0 || nItems <= index_s_OUT[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static WH_GM3D_Loop* CreateLoop 
+(WH_GM3D_Body* body,
+ WH_GM3D_Face* face,
+ const vector<int>& vertexIndex_s)
+{
+  WH_GM3D_Loop* result = body->createLoop (face);
+  for (vector<int>::const_iterator 
+	 i_index = vertexIndex_s.begin ();
+       i_index != vertexIndex_s.end ();
+       i_index++) {
+    result->addVertex (body->vertex_s ()[*i_index]);
+  }
+  return result;
+}
+
+static bool ReadFace 
+(istream& in,
+ WH_GM3D_Body* body_IO)
+{
+  /* the whole face is read before it is made, so that a broken one
+     leaves nothing behind */
+  double a, b, c, d;
+  int isFrontInside, isBackInside;
+  if (!WH_readBinary (in, a) || !WH_readBinary (in, b)
+      || !WH_readBinary (in, c) || !WH_readBinary (in, d)
+      || !WH_readBinary (in, isFrontInside) 
+      || !WH_readBinary (in, isBackInside)) {
+    return false;
+  }
+  if (!WH_eq (WH_Vector3D (a, b, c).length (), 1)) return false;
+
+  int nVertexs = (int)body_IO->vertex_s ().size ();
+  int nEdges = (int)body_IO->edge_s ().size ();
+
+  vector<int> outerLoop;
+  if (!ReadIndexs (in, nVertexs, outerLoop) || outerLoop.size () < 3) {
+    return false;
+  }
+  int nInnerLoops;
+  if (!WH_readBinaryCount (in, nInnerLoops)) return false;
+  vector<vector<int> > innerLoop_s (nInnerLoops);
+  for (int iLoop = 0; iLoop < nInnerLoops; iLoop++) {
+    if (!ReadIndexs (in, nVertexs, innerLoop_s[iLoop])
+	|| innerLoop_s[iLoop].size () < 3) {
+      return false;
+    }
+  }
+  vector<int> offLoopVertex_s;
+  vector<int> offLoopEdge_s;
+  if (!ReadIndexs (in, nVertexs, offLoopVertex_s)
+      || !ReadIndexs (in, nEdges, offLoopEdge_s)) {
+    return false;
+  }
+
+  /* as in WH_GM3D_Body::copyFace () */
+  WH_GM3D_Face* face = body_IO->createFace 
+    (WH_Plane3D::normalizedPlane (a, b, c, d));
+  face->setSides (isFrontInside != 0, isBackInside != 0);
+  face->setOuterLoop (CreateLoop (body_IO, face, outerLoop));
+  for (int iLoop = 0; iLoop < nInnerLoops; iLoop++) {
+    face->addInnerLoop (CreateLoop (body_IO, face, innerLoop_s[iLoop]));
+  }
+  for (vector<int>::const_iterator 
+	 i_index = offLoopVertex_s.begin ();
+       i_index != offLoopVertex_s.end ();
+       i_index++) {
+    face->addOffLoopVertex (body_IO->vertex_s ()[*i_index]);
+  }
+  for (vector<int>::const_iterator 
+	 i_index = offLoopEdge_s.begin ();
+       i_index != offLoopEdge_s.end ();
+       i_index++) {
+    face->addOffLoopEdge (body_IO->edge_s ()[*i_index]);
+  }
+  body_IO->addFace (face);
+
+  return true;
 }
 
 
 
 /* class WH_GM3D_IO */
 
+thread_local bool WH_GM3D_IO::_keepsFacetForm = true;
+
+thread_local WH_GM3D_BodyCache* WH_GM3D_IO::_bodyCache = WH_NULL;
+
+void WH_GM3D_IO
+::setKeepsFacetForm (bool keepsFacetForm)
+{
+  _keepsFacetForm = keepsFacetForm;
+}
+
+bool WH_GM3D_IO
+::keepsFacetForm ()
+{
+  return _keepsFacetForm;
+}
+
+void WH_GM3D_IO
+::setBodyCache (WH_GM3D_BodyCache* cache)
+{
+  _bodyCache = cache;
+}
+
+WH_GM3D_BodyCache* WH_GM3D_IO
+::bodyCache ()
+{
+  return _bodyCache;
+}
+
 WH_GM3D_Body* WH_GM3D_IO
 ::createBodyFromFile 
 (const string& fileName)
@@ -197,46 +794,176 @@ WH_GM3D_Body* WH_GM3D_IO
 
   WH_GM3D_Body* result = WH_NULL;
 
-  vector<WH_GM3D_Body*> bodyStack;
+  vector<WH_GM3D_StackedBody> bodyStack;
+
+  int nConversionsBefore = WH_GM3D::nConversions ();
+  double conversionSecondsBefore = WH_GM3D::conversionSeconds ();
+  int nFacetFormOperationsBefore = NFacetFormOperations;
+  int nFacetFormConversionsBefore = NFacetFormConversions;
+  int nCachedBodyConversionsBefore = NCachedBodyConversions;
+  double cachedBodyConversionSecondsBefore = CachedBodyConversionSeconds;
 
   ifstream in (fileName.c_str ());
   WH_ASSERT(in);
 
-  for (;;) {
-    string word;
-    in >> word;
+  vector<WH_GM3D_ScriptCommand> command_s;
+  ReadScript (in, command_s);
+  RunScript (command_s, bodyStack);
 
-    if (word[0] == '#') {
-      string line;
-      getline (in, line);
+  WH_ASSERT(bodyStack.size () == 1);
+  result = PopBody (bodyStack);
+
+  {
+    /* each set operation in facet form saves the three conversions
+       of WH_GM3D::add () or subtract (), less the ones made for it
+       when a body on the stack is moved between the forms.  bodies
+       loaded from the cache are left out */
+    int nConversions = WH_GM3D::nConversions () - nConversionsBefore
+      - (NCachedBodyConversions - nCachedBodyConversionsBefore);
+    double conversionSeconds 
+      = WH_GM3D::conversionSeconds () - conversionSecondsBefore
+      - (CachedBodyConversionSeconds - cachedBodyConversionSecondsBefore);
+    int nSavedConversions 
+      = 3 * (NFacetFormOperations - nFacetFormOperationsBefore)
+      - (NFacetFormConversions - nFacetFormConversionsBefore);
+    double savedSeconds = 0;
+    if (0 < nConversions) {
+      WH_CVR_LINE;
+      savedSeconds = conversionSeconds / nConversions * nSavedConversions;
+    }
+    WH_PRINTF_NORMAL("%d conversions between B-rep and facet form "
+		     "in %g seconds, %d saved (about %g seconds)",
+		     nConversions, conversionSeconds, 
+		     nSavedConversions, savedSeconds);
+  }
 
-      cerr << line << endl;
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(result != WH_NULL);
+#endif
 
-    } else if (word == "sheet") {
-      PushSheet (in, bodyStack);
-    } else if (word == "circle") {
-      PushCircle (in, bodyStack);
-    } else if (word == "box") {
-      PushBox (in, bodyStack);
-    } else if (word == "extrude") {
-      ExtrudeFirst (in, bodyStack);
-    } else if (word == "revolve") {
-      RevolveFirst (in, bodyStack);
-    } else if (word == "add") {
-      AddFirstAndSecond (in, bodyStack);
-    } else if (word == "subtract") {
-      SubtractFirstFromSecond (in, bodyStack);
-    } else {
-      break;
+  return result;
+}
+
+
+void WH_GM3D_IO
+::writeBody 
+(ostream& out,
+ WH_GM3D_Body* body)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(body != WH_NULL);
+  WH_ASSERT(body->isConsistent ());
+
+  WH_CVR_LINE;
+
+  WH_writeBinaryTag (out, BODY_STREAM_MAGIC);
+  WH_writeBinary (out, BODY_STREAM_VERSION);
+  WH_writeBinary (out, body->isRegular () ? 1 : 0);
+
+  unordered_map<WH_GM3D_Vertex*, int> vertexIndexMap;
+  WH_writeBinary (out, (int)body->vertex_s ().size ());
+  for (vector<WH_GM3D_Vertex*>::const_iterator 
+	 i_vertex = body->vertex_s ().begin ();
+       i_vertex != body->vertex_s ().end ();
+       i_vertex++) {
+    WH_GM3D_Vertex* vertex_i = (*i_vertex);
+    int index = (int)vertexIndexMap.size ();
+    vertexIndexMap[vertex_i] = index;
+    WH_Vector3D point = vertex_i->point ();
+    WH_writeBinary (out, point.x);
+    WH_writeBinary (out, point.y);
+    WH_writeBinary (out, point.z);
+  }
+
+  unordered_map<WH_GM3D_Edge*, int> edgeIndexMap;
+  WH_writeBinary (out, (int)body->edge_s ().size ());
+  for (vector<WH_GM3D_Edge*>::const_iterator 
+	 i_edge = body->edge_s ().begin ();
+       i_edge != body->edge_s ().end ();
+       i_edge++) {
+    WH_GM3D_Edge* edge_i = (*i_edge);
+    int index = (int)edgeIndexMap.size ();
+    edgeIndexMap[edge_i] = index;
+    WH_writeBinary 
+      (out, vertexIndexMap.at (edge_i->firstVertexUse ()->vertex ()));
+    WH_writeBinary 
+      (out, vertexIndexMap.at (edge_i->lastVertexUse ()->vertex ()));
+  }
+
+  WH_writeBinary (out, (int)body->face_s ().size ());
+  for (vector<WH_GM3D_Face*>::const_iterator 
+	 i_face = body->face_s ().begin ();
+       i_face != body->face_s ().end ();
+       i_face++) {
+    WriteFace (out, (*i_face), vertexIndexMap, edgeIndexMap);
+  }
+
+  WH_writeBinaryTag (out, BODY_STREAM_END);
+}
+
+WH_GM3D_Body* WH_GM3D_IO
+::createBodyFromStream (istream& in)
+{
+  WH_CVR_LINE;
+
+  int version;
+  int isRegular;
+  int nVertexs;
+  if (!WH_readBinaryTag (in, BODY_STREAM_MAGIC)
+      || !WH_readBinary (in, version) || version != BODY_STREAM_VERSION
+      || !WH_readBinary (in, isRegular) 
+      || !WH_readBinaryCount (in, nVertexs)) {
+    return WH_NULL;
+  }
+
+  /* as in WH_GM3D_Body::copyFrom (), by indices in place of points */
+  WH_GM3D_Body* result = new WH_GM3D_Body (isRegular != 0);
+  WH_ASSERT(result != WH_NULL);
+
+  bool isRead = true;
+  for (int iVertex = 0; iVertex < nVertexs && isRead; iVertex++) {
+    WH_Vector3D point;
+    isRead = WH_readBinary (in, point.x) && WH_readBinary (in, point.y)
+      && WH_readBinary (in, point.z);
+    if (isRead) {
+      result->addVertex (result->createVertex (point));
     }
   }
 
-  WH_ASSERT(bodyStack.size () == 1);
-  result = bodyStack.back ();
+  int nEdges = 0;
+  isRead = isRead && WH_readBinaryCount (in, nEdges);
+  for (int iEdge = 0; iEdge < nEdges && isRead; iEdge++) {
+    int index0, index1;
+    isRead = WH_readBinary (in, index0) && WH_readBinary (in, index1)
+      && 0 <= index0 && index0 < nVertexs 
+      && 0 <= index1 && index1 < nVertexs;
+    if (isRead) {
+      WH_GM3D_Edge* edge = result->createEdge ();
+      edge->setVertexs (result->vertex_s ()[index0], 
+			result->vertex_s ()[index1]);
+      result->addEdge (edge);
+    }
+  }
+
+  int nFaces = 0;
+  isRead = isRead && WH_readBinaryCount (in, nFaces);
+  for (int iFace = 0; iFace < nFaces && isRead; iFace++) {
+    isRead = ReadFace (in, result);
+  }
+
+  isRead = isRead && WH_readBinaryTag (in, BODY_STREAM_END);
+  if (!isRead) {
+    WH_CVR_LINE;
+    delete result;
+    return WH_NULL;
+  }
+
+  result->fix ();
 
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
-  WH_ASSERT(result != WH_NULL);
+  WH_ASSERT(result->isConsistent ());
 #endif
 
   return result;
@@ -12,15 +12,43 @@
 #define WH_INCLUDED_WH_GM3D
 #endif
 
+class WH_GM3D_BodyCache;
+
 class WH_GM3D_IO {
  public:
   static WH_GM3D_Body* createBodyFromFile (const string& fileName);
 
+  static void setKeepsFacetForm (bool keepsFacetForm);
+  /* true by default : the result of a set operation of volumes stays
+     in facet form for the next one, and its B-rep is built only when
+     it is needed */
+
+  static bool keepsFacetForm ();
+
+  static void setBodyCache (WH_GM3D_BodyCache* cache);
+  /* WH_NULL by default.  the results of set operations in facet form
+     are stored into <cache>, keyed by the commands which made them,
+     and a script resumes from the last ones it finds there */
+
+  static WH_GM3D_BodyCache* bodyCache ();
+
+  static void writeBody (ostream& out, WH_GM3D_Body* body);
+  /* <body> in a versioned binary form (see binary_io.h) : its
+     vertices, then its edges and faces by the indices of their
+     vertices and edges, so that createBodyFromStream () makes the
+     same B-rep to the bit, and so the same topology of it */
+
+  static WH_GM3D_Body* createBodyFromStream (istream& in);
+  /* WH_NULL if <in> is not at a body written by writeBody () */
+
   /* base */
 
   /* derived */
   
  protected:
+  static thread_local bool _keepsFacetForm;
+
+  static thread_local WH_GM3D_BodyCache* _bodyCache;
 
   /* base */
 
@@ -14,8 +14,28 @@
 
 
 
+/* module procedures */
+
+static bool IsApart 
+(WH_GM3D_TriangleFacet* facet,
+ const WH_Vector3D& minRange,
+ const WH_Vector3D& maxRange)
+{
+  WH_Vector3D facetMinRange;
+  WH_Vector3D facetMaxRange;
+  facet->getRange (facetMinRange, facetMaxRange);
+  return !WH_minMaxPairsOverlap 
+    (facetMinRange, facetMaxRange, minRange, maxRange);
+}
+
+
+
 /* class WH_GM3D_SetOperator */
 
+thread_local bool WH_GM3D_SetOperator::_usesLocality = true;
+
+thread_local int WH_GM3D_SetOperator::_nPassedFacets = 0;
+
 WH_GM3D_SetOperator
 ::WH_GM3D_SetOperator 
 (OperationType operationType,
@@ -110,6 +130,16 @@ void WH_GM3D_SetOperator
 
   facet_s_OUT.clear ();
 
+  /* a triangle of <bodyBy> apart from the range of <bodyFrom> divides
+     none of its facets, and a facet apart from the range of <bodyBy>
+     is divided by none of its triangles */
+  WH_Vector3D minRangeFrom;
+  WH_Vector3D maxRangeFrom;
+  bodyFrom->getRange (minRangeFrom, maxRangeFrom);
+  WH_Vector3D minRangeBy;
+  WH_Vector3D maxRangeBy;
+  bodyBy->getRange (minRangeBy, maxRangeBy);
+
   vector<WH_Triangle3D> triangleBy_s;
   for (vector<WH_GM3D_PolygonFacet*>::const_iterator 
 	 i_pfacet = bodyBy->polygonFacet_s ().begin ();
@@ -122,7 +152,15 @@ void WH_GM3D_SetOperator
 	 i_facet != pfacet_i->triangleFacet_s ().end ();
 	 i_facet++) {
       WH_GM3D_TriangleFacet* facet_i = (*i_facet);
-      triangleBy_s.push_back (facet_i->triangle ());
+      WH_Triangle3D triangle = facet_i->triangle ();
+      if (_usesLocality 
+	  && !WH_minMaxPairsOverlap 
+	  (triangle.minRange (), triangle.maxRange (),
+	   minRangeFrom, maxRangeFrom)) {
+	WH_CVR_LINE;
+	continue;
+      }
+      triangleBy_s.push_back (triangle);
     }  
   }  
 
@@ -137,6 +175,14 @@ void WH_GM3D_SetOperator
 	 i_facet != pfacet_i->triangleFacet_s ().end ();
 	 i_facet++) {
       WH_GM3D_TriangleFacet* facet_i = (*i_facet);
+
+      if (_usesLocality 
+	  && IsApart (facet_i, minRangeBy, maxRangeBy)) {
+	WH_CVR_LINE;
+	facet_s_OUT.push_back (facet_i->createCopy ());
+	_nPassedFacets++;
+	continue;
+      }
       
       vector<WH_GM3D_TriangleFacet*> dividedFacet_s;
       dividedFacet_s.push_back (facet_i->createCopy ());
@@ -173,6 +219,15 @@ void WH_GM3D_SetOperator
 
   bodyBy->setUpInOutCheck ();
 
+  /* the facets apart from the range of <bodyBy> are in the region
+     outside the range, which is connected and has no facet of
+     <bodyBy>, so they share the containment of the first one */
+  WH_Vector3D minRangeBy;
+  WH_Vector3D maxRangeBy;
+  bodyBy->getRange (minRangeBy, maxRangeBy);
+  bool apartFlagIsSet = false;
+  WH_InOutChecker3D::ContainmentType apartFlag = WH_InOutChecker3D::ON;
+
   for (vector<WH_GM3D_TriangleFacet*>::const_iterator 
 	 i_facet = facet_s.begin ();
        i_facet != facet_s.end ();
@@ -180,8 +235,21 @@ void WH_GM3D_SetOperator
     WH_GM3D_TriangleFacet* facet_i = (*i_facet);
 
     WH_Vector3D center = facet_i->triangle ().centerOfGravity ();
-    WH_InOutChecker3D::ContainmentType flag 
-      = bodyBy->checkContainmentAt (center);
+    WH_InOutChecker3D::ContainmentType flag;
+    if (_usesLocality 
+	&& IsApart (facet_i, minRangeBy, maxRangeBy)) {
+      WH_CVR_LINE;
+      if (!apartFlagIsSet) {
+	WH_CVR_LINE;
+	apartFlag = bodyBy->checkContainmentAt (center);
+	WH_ASSERT(apartFlag != WH_InOutChecker3D::ON);
+	apartFlagIsSet = true;
+      }
+      flag = apartFlag;
+    } else {
+      WH_CVR_LINE;
+      flag = bodyBy->checkContainmentAt (center);
+    }
     switch (flag) {
     case WH_InOutChecker3D::IN:
       WH_CVR_LINE;
@@ -383,6 +451,24 @@ void WH_GM3D_SetOperator
 #endif  
 }
 
+void WH_GM3D_SetOperator
+::setUsesLocality (bool usesLocality)
+{
+  _usesLocality = usesLocality;
+}
+
+bool WH_GM3D_SetOperator
+::usesLocality ()
+{
+  return _usesLocality;
+}
+
+int WH_GM3D_SetOperator
+::nPassedFacets ()
+{
+  return _nPassedFacets;
+}
+
 WH_GM3D_SetOperator::OperationType WH_GM3D_SetOperator
 ::operationType () const
 {
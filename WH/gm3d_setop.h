@@ -33,6 +33,18 @@ class WH_GM3D_SetOperator {
   
   /* base */
   virtual void perform ();
+
+  static void setUsesLocality (bool usesLocality);
+  /* true by default : a facet apart from the range of the other body
+     is passed through without division, and all such facets of a
+     body are classified by a single containment check, since they lie
+     in one region outside the range of the other body.  a facet apart
+     from the range of the other body does not divide it either */
+
+  static bool usesLocality ();
+
+  static int nPassedFacets ();
+  /* number of facets passed through so far */
   
   OperationType operationType () const;
 
@@ -44,6 +56,10 @@ class WH_GM3D_SetOperator {
   /* derived */
   
  protected:
+  static thread_local bool _usesLocality;
+
+  static thread_local int _nPassedFacets;
+
   OperationType _operationType;
 
   WH_GM3D_FacetBody* _body0;  /* not own */
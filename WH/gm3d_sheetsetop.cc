@@ -118,7 +118,7 @@ WH_GM2D_FacetBody* WH_GM3D_SheetSetOperator
 	      || WH_isReverse (facet_i->plane (), basePlane));
 
     {
-      WH_Polygon3D poly = facet_i->outerLoopPolygon ();
+      const WH_Polygon3D& poly = facet_i->outerLoopPolygon ();
 
       /* facets of outer loop are oriented toward outside */
 
@@ -153,7 +153,7 @@ WH_GM2D_FacetBody* WH_GM3D_SheetSetOperator
 	   i_poly = facet_i->innerLoopPolygon_s ().begin ();
 	 i_poly != facet_i->innerLoopPolygon_s ().end ();
 	 i_poly++) {
-      WH_Polygon3D poly_i = (*i_poly);
+      const WH_Polygon3D& poly_i = (*i_poly);
       
       /* facets of inner loops are oriented toward inside */
 
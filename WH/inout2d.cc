@@ -13,6 +13,7 @@
 
 #include "inout2d.h"
 #include "bucket2d.h"
+#include "arena.h"
 
 
 
@@ -218,11 +219,13 @@ WH_InOutChecker2D::ContainmentType WH_InOutChecker2D
   bool yNormalIsPlus = false;
   double minYWhichIsGreaterThanPositionY = WH::HUGE_VALUE;
 
-  vector<WH_Segment2D*> segment_s;
+  char buffer[1024];
+  WH_Arena arena (buffer, sizeof (buffer));
+  pmr::vector<WH_Segment2D*> segment_s (arena.resource ());
   _segmentBucket->getItemsWithin
     (pointMinRange, pointMaxRange, 
      segment_s);
-  for (vector<WH_Segment2D*>::const_iterator 
+  for (pmr::vector<WH_Segment2D*>::const_iterator 
 	 i_seg = segment_s.begin ();
        i_seg != segment_s.end ();
        i_seg++) {
@@ -12,8 +12,18 @@
 #endif
 
 #include "inout3d.h"
+#include "inout3d_bvh.h"
 #include "bucket3d.h"
 
+/* define WH_NO_SIMD to use the scalar kernel */
+#if defined(__AVX2__) && !defined(WH_NO_SIMD)
+#include <immintrin.h>
+#define WH_IOC3D_AVX2
+#elif (defined(__SSE2__) || defined(_M_X64)) && !defined(WH_NO_SIMD)
+#include <emmintrin.h>
+#define WH_IOC3D_SSE2
+#endif
+
 
 
 #if 1
@@ -38,6 +48,10 @@ WH_Triangle3D_IOC3D
   for (int iVertex = 0; iVertex < 3; iVertex++) {
     _vertex2Ds[iVertex] = _plane.parameterAt (_vertexs[iVertex]);
   }
+  for (int iEdge = 0; iEdge < 3; iEdge++) {
+    _edgeLength2Ds[iEdge] 
+      = WH_distance (_vertex2Ds[iEdge], _vertex2Ds[(iEdge + 1) % 3]);
+  }
   
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
@@ -93,15 +107,21 @@ bool WH_Triangle3D_IOC3D
 
   bool result = false;
 
+  /* the area of each edge is tolerated as a distance of WH::eps from
+     the edge.  a tolerance of the area itself is too small for a large
+     triangle, and a point on the edge shared by two triangles, e.g. on
+     the diagonal of a quadrangle, was in neither of them */
   WH_Vector2D position2D = _plane.parameterAt (position);
-  double sign0 = WH_signedTriangleAreaAmong 
-    (position2D, _vertex2Ds[0], _vertex2Ds[1]);
-  double sign1 = WH_signedTriangleAreaAmong 
-    (position2D, _vertex2Ds[1], _vertex2Ds[2]);
-  double sign2 = WH_signedTriangleAreaAmong 
-    (position2D, _vertex2Ds[2], _vertex2Ds[0]);
-  if ((WH_le2 (0, sign0) && WH_le2 (0, sign1) && WH_le2 (0, sign2))
-      || (WH_le2 (sign0, 0) && WH_le2 (sign1, 0) && WH_le2 (sign2, 0))) {
+  bool isAllPlus = true;
+  bool isAllMinus = true;
+  for (int iEdge = 0; iEdge < 3; iEdge++) {
+    double sign = WH_signedTriangleAreaAmong 
+      (position2D, _vertex2Ds[iEdge], _vertex2Ds[(iEdge + 1) % 3]);
+    double tolerance = WH::eps / 2 * _edgeLength2Ds[iEdge];
+    if (!(0 < sign + tolerance)) isAllPlus = false;
+    if (!(sign < 0 + tolerance)) isAllMinus = false;
+  }
+  if (isAllPlus || isAllMinus) {
     WH_CVR_LINE;
     result = true;
   }
@@ -109,10 +129,413 @@ bool WH_Triangle3D_IOC3D
   return result;
 }
 
+WH_Vector2D WH_Triangle3D_IOC3D
+::vertex2D (int iVertex) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= iVertex);
+  WH_ASSERT(iVertex < 3);
+
+  return _vertex2Ds[iVertex];
+}
+
+double WH_Triangle3D_IOC3D
+::edgeLength2D (int iEdge) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= iEdge);
+  WH_ASSERT(iEdge < 3);
+
+  return _edgeLength2Ds[iEdge];
+}
+
+
+
+/* packed triangles of a bucket cell */
+
+/* the triangles are stored field by field in blocks of 4.  the kernel
+   evaluates exactly the same expressions as
+   WH_Plane3D::contains (), WH_Plane3D::parameterAt () and
+   WH_Triangle3D_IOC3D::containsPointWhichIsOnPlane (), so that the
+   decisions with tolerance are the same as the scalar version */
+
+enum {
+  IOC3D_A, IOC3D_B, IOC3D_C, IOC3D_D,
+  IOC3D_OX, IOC3D_OY, IOC3D_OZ,
+  IOC3D_UX, IOC3D_UY, IOC3D_UZ,
+  IOC3D_VX, IOC3D_VY, IOC3D_VZ,
+  IOC3D_P0X, IOC3D_P0Y, IOC3D_P1X, IOC3D_P1Y, IOC3D_P2X, IOC3D_P2Y,
+  IOC3D_L0, IOC3D_L1, IOC3D_L2,
+  IOC3D_FIELDS
+};
+
+static const int IOC3D_LANES = 4;
+
+static const int IOC3D_BLOCK = IOC3D_FIELDS * IOC3D_LANES;
+
+static void PackTriangle 
+(const WH_Triangle3D_IOC3D* tri,
+ double* block,
+ int lane)
+{
+  WH_Plane3D plane = tri->plane ();
+  WH_Vector3D origin = plane.origin ();
+  WH_Vector3D uAxisDir = plane.uAxisDir ();
+  WH_Vector3D vAxisDir = plane.vAxisDir ();
+  WH_Vector2D p0 = tri->vertex2D (0);
+  WH_Vector2D p1 = tri->vertex2D (1);
+  WH_Vector2D p2 = tri->vertex2D (2);
+
+  double field_s[IOC3D_FIELDS] = {
+    plane.a (), plane.b (), plane.c (), plane.d (),
+    origin.x, origin.y, origin.z,
+    uAxisDir.x, uAxisDir.y, uAxisDir.z,
+    vAxisDir.x, vAxisDir.y, vAxisDir.z,
+    p0.x, p0.y, p1.x, p1.y, p2.x, p2.y,
+    tri->edgeLength2D (0), tri->edgeLength2D (1), tri->edgeLength2D (2)
+  };
+  for (int iField = 0; iField < IOC3D_FIELDS; iField++) {
+    block[iField * IOC3D_LANES + lane] = field_s[iField];
+  }
+}
+
+static void PackEmptyLane 
+(double* block,
+ int lane)
+{
+  /* never on the plane, and parallel to Z axis */
+  for (int iField = 0; iField < IOC3D_FIELDS; iField++) {
+    block[iField * IOC3D_LANES + lane] = 0;
+  }
+  block[IOC3D_D * IOC3D_LANES + lane] = WH::HUGE_VALUE;
+}
+
+#if defined(WH_IOC3D_AVX2)
+
+/* 4 lanes at a time */
+
+static inline __m256d IOC3D_Field (const double* block, int iField)
+{
+  return _mm256_loadu_pd (block + iField * IOC3D_LANES);
+}
+
+static inline __m256d IOC3D_ContainsOnPlane
+(const double* block, __m256d px, __m256d py, __m256d pz, __m256d halfEps)
+{
+  __m256d dx = _mm256_sub_pd (px, IOC3D_Field (block, IOC3D_OX));
+  __m256d dy = _mm256_sub_pd (py, IOC3D_Field (block, IOC3D_OY));
+  __m256d dz = _mm256_sub_pd (pz, IOC3D_Field (block, IOC3D_OZ));
+  __m256d u = _mm256_add_pd 
+    (_mm256_add_pd (_mm256_mul_pd (dx, IOC3D_Field (block, IOC3D_UX)),
+		    _mm256_mul_pd (dy, IOC3D_Field (block, IOC3D_UY))),
+     _mm256_mul_pd (dz, IOC3D_Field (block, IOC3D_UZ)));
+  __m256d v = _mm256_add_pd 
+    (_mm256_add_pd (_mm256_mul_pd (dx, IOC3D_Field (block, IOC3D_VX)),
+		    _mm256_mul_pd (dy, IOC3D_Field (block, IOC3D_VY))),
+     _mm256_mul_pd (dz, IOC3D_Field (block, IOC3D_VZ)));
+
+  __m256d two = _mm256_set1_pd (2.0);
+  __m256d zero = _mm256_setzero_pd ();
+  __m256d allPlus = _mm256_castsi256_pd (_mm256_set1_epi64x (-1));
+  __m256d allMinus = allPlus;
+  static const int vertex0_s[3] = { IOC3D_P0X, IOC3D_P1X, IOC3D_P2X };
+  static const int vertex1_s[3] = { IOC3D_P1X, IOC3D_P2X, IOC3D_P0X };
+  static const int length_s[3] = { IOC3D_L0, IOC3D_L1, IOC3D_L2 };
+  for (int iEdge = 0; iEdge < 3; iEdge++) {
+    __m256d lkx = _mm256_sub_pd (IOC3D_Field (block, vertex0_s[iEdge]), u);
+    __m256d lky = _mm256_sub_pd (IOC3D_Field (block, vertex0_s[iEdge] + 1), v);
+    __m256d mkx = _mm256_sub_pd (IOC3D_Field (block, vertex1_s[iEdge]), u);
+    __m256d mky = _mm256_sub_pd (IOC3D_Field (block, vertex1_s[iEdge] + 1), v);
+    /* (lk.x * mk.y - mk.x * lk.y) / 2 */
+    __m256d sign = _mm256_div_pd 
+      (_mm256_sub_pd (_mm256_mul_pd (lkx, mky), _mm256_mul_pd (mkx, lky)),
+       two);
+    __m256d tolerance 
+      = _mm256_mul_pd (halfEps, IOC3D_Field (block, length_s[iEdge]));
+    allPlus = _mm256_and_pd 
+      (allPlus, 
+       _mm256_cmp_pd (zero, _mm256_add_pd (sign, tolerance), _CMP_LT_OQ));
+    allMinus = _mm256_and_pd 
+      (allMinus, 
+       _mm256_cmp_pd (sign, _mm256_add_pd (zero, tolerance), _CMP_LT_OQ));
+  }
+  return _mm256_or_pd (allPlus, allMinus);
+}
+
+static void IOC3D_ScanBlock
+(const double* block,
+ const WH_Vector3D& position,
+ int& onMask_OUT,
+ int& crossMask_OUT,
+ double intersectionZ_OUT[IOC3D_LANES])
+{
+  __m256d px = _mm256_set1_pd (position.x);
+  __m256d py = _mm256_set1_pd (position.y);
+  __m256d pz = _mm256_set1_pd (position.z);
+  __m256d eps = _mm256_set1_pd (WH::eps);
+  __m256d halfEps = _mm256_set1_pd (WH::eps / 2);
+  __m256d zero = _mm256_setzero_pd ();
+
+  __m256d a = IOC3D_Field (block, IOC3D_A);
+  __m256d b = IOC3D_Field (block, IOC3D_B);
+  __m256d c = IOC3D_Field (block, IOC3D_C);
+  __m256d d = IOC3D_Field (block, IOC3D_D);
+
+  /* WH_Plane3D::contains () */
+  __m256d axby = _mm256_add_pd (_mm256_mul_pd (a, px), _mm256_mul_pd (b, py));
+  __m256d value = _mm256_add_pd 
+    (_mm256_add_pd (axby, _mm256_mul_pd (c, pz)), d);
+  __m256d isOnPlane = _mm256_and_pd 
+    (_mm256_cmp_pd (_mm256_sub_pd (value, eps), zero, _CMP_LT_OQ),
+     _mm256_cmp_pd (zero, _mm256_add_pd (value, eps), _CMP_LT_OQ));
+  int onPlaneMask = _mm256_movemask_pd (isOnPlane);
+  int onMask = 0;
+  if (onPlaneMask != 0) {
+    onMask = onPlaneMask & _mm256_movemask_pd 
+      (IOC3D_ContainsOnPlane (block, px, py, pz, halfEps));
+  }
+
+  /* intersection with the line parallel to Z axis */
+  __m256d cIsZero = _mm256_and_pd 
+    (_mm256_cmp_pd (_mm256_sub_pd (c, eps), zero, _CMP_LT_OQ),
+     _mm256_cmp_pd (zero, _mm256_add_pd (c, eps), _CMP_LT_OQ));
+  __m256d minusZero = _mm256_set1_pd (-0.0);
+  __m256d iz = _mm256_div_pd 
+    (_mm256_xor_pd (_mm256_add_pd (axby, d), minusZero), c);
+  int crossMask = ~_mm256_movemask_pd (cIsZero) & 0xf;
+  if (crossMask != 0) {
+    crossMask &= _mm256_movemask_pd 
+      (IOC3D_ContainsOnPlane (block, px, py, iz, halfEps));
+  }
+
+  onMask_OUT = onMask;
+  crossMask_OUT = crossMask;
+  _mm256_storeu_pd (intersectionZ_OUT, iz);
+}
+
+#elif defined(WH_IOC3D_SSE2)
+
+/* 2 lanes at a time */
+
+static inline __m128d IOC3D_Field 
+(const double* block, int iField, int lane)
+{
+  return _mm_loadu_pd (block + iField * IOC3D_LANES + lane);
+}
+
+static inline __m128d IOC3D_ContainsOnPlane
+(const double* block, int lane, 
+ __m128d px, __m128d py, __m128d pz, __m128d halfEps)
+{
+  __m128d dx = _mm_sub_pd (px, IOC3D_Field (block, IOC3D_OX, lane));
+  __m128d dy = _mm_sub_pd (py, IOC3D_Field (block, IOC3D_OY, lane));
+  __m128d dz = _mm_sub_pd (pz, IOC3D_Field (block, IOC3D_OZ, lane));
+  __m128d u = _mm_add_pd 
+    (_mm_add_pd (_mm_mul_pd (dx, IOC3D_Field (block, IOC3D_UX, lane)),
+		 _mm_mul_pd (dy, IOC3D_Field (block, IOC3D_UY, lane))),
+     _mm_mul_pd (dz, IOC3D_Field (block, IOC3D_UZ, lane)));
+  __m128d v = _mm_add_pd 
+    (_mm_add_pd (_mm_mul_pd (dx, IOC3D_Field (block, IOC3D_VX, lane)),
+		 _mm_mul_pd (dy, IOC3D_Field (block, IOC3D_VY, lane))),
+     _mm_mul_pd (dz, IOC3D_Field (block, IOC3D_VZ, lane)));
+
+  __m128d two = _mm_set1_pd (2.0);
+  __m128d zero = _mm_setzero_pd ();
+  __m128d allPlus = _mm_cmpeq_pd (zero, zero);
+  __m128d allMinus = allPlus;
+  static const int vertex0_s[3] = { IOC3D_P0X, IOC3D_P1X, IOC3D_P2X };
+  static const int vertex1_s[3] = { IOC3D_P1X, IOC3D_P2X, IOC3D_P0X };
+  static const int length_s[3] = { IOC3D_L0, IOC3D_L1, IOC3D_L2 };
+  for (int iEdge = 0; iEdge < 3; iEdge++) {
+    __m128d lkx = _mm_sub_pd 
+      (IOC3D_Field (block, vertex0_s[iEdge], lane), u);
+    __m128d lky = _mm_sub_pd 
+      (IOC3D_Field (block, vertex0_s[iEdge] + 1, lane), v);
+    __m128d mkx = _mm_sub_pd 
+      (IOC3D_Field (block, vertex1_s[iEdge], lane), u);
+    __m128d mky = _mm_sub_pd 
+      (IOC3D_Field (block, vertex1_s[iEdge] + 1, lane), v);
+    /* (lk.x * mk.y - mk.x * lk.y) / 2 */
+    __m128d sign = _mm_div_pd 
+      (_mm_sub_pd (_mm_mul_pd (lkx, mky), _mm_mul_pd (mkx, lky)), two);
+    __m128d tolerance 
+      = _mm_mul_pd (halfEps, IOC3D_Field (block, length_s[iEdge], lane));
+    allPlus = _mm_and_pd 
+      (allPlus, _mm_cmplt_pd (zero, _mm_add_pd (sign, tolerance)));
+    allMinus = _mm_and_pd 
+      (allMinus, _mm_cmplt_pd (sign, _mm_add_pd (zero, tolerance)));
+  }
+  return _mm_or_pd (allPlus, allMinus);
+}
+
+static void IOC3D_ScanBlock
+(const double* block,
+ const WH_Vector3D& position,
+ int& onMask_OUT,
+ int& crossMask_OUT,
+ double intersectionZ_OUT[IOC3D_LANES])
+{
+  __m128d px = _mm_set1_pd (position.x);
+  __m128d py = _mm_set1_pd (position.y);
+  __m128d pz = _mm_set1_pd (position.z);
+  __m128d eps = _mm_set1_pd (WH::eps);
+  __m128d halfEps = _mm_set1_pd (WH::eps / 2);
+  __m128d zero = _mm_setzero_pd ();
+
+  onMask_OUT = 0;
+  crossMask_OUT = 0;
+  for (int lane = 0; lane < IOC3D_LANES; lane += 2) {
+    __m128d a = IOC3D_Field (block, IOC3D_A, lane);
+    __m128d b = IOC3D_Field (block, IOC3D_B, lane);
+    __m128d c = IOC3D_Field (block, IOC3D_C, lane);
+    __m128d d = IOC3D_Field (block, IOC3D_D, lane);
+
+    /* WH_Plane3D::contains () */
+    __m128d axby = _mm_add_pd (_mm_mul_pd (a, px), _mm_mul_pd (b, py));
+    __m128d value = _mm_add_pd (_mm_add_pd (axby, _mm_mul_pd (c, pz)), d);
+    __m128d isOnPlane = _mm_and_pd 
+      (_mm_cmplt_pd (_mm_sub_pd (value, eps), zero),
+       _mm_cmplt_pd (zero, _mm_add_pd (value, eps)));
+    int onMask = _mm_movemask_pd (isOnPlane);
+    if (onMask != 0) {
+      onMask &= _mm_movemask_pd 
+	(IOC3D_ContainsOnPlane (block, lane, px, py, pz, halfEps));
+    }
+
+    /* intersection with the line parallel to Z axis */
+    __m128d cIsZero = _mm_and_pd 
+      (_mm_cmplt_pd (_mm_sub_pd (c, eps), zero),
+       _mm_cmplt_pd (zero, _mm_add_pd (c, eps)));
+    __m128d iz = _mm_div_pd 
+      (_mm_xor_pd (_mm_add_pd (axby, d), _mm_set1_pd (-0.0)), c);
+    int crossMask = ~_mm_movemask_pd (cIsZero) & 0x3;
+    if (crossMask != 0) {
+      crossMask &= _mm_movemask_pd 
+	(IOC3D_ContainsOnPlane (block, lane, px, py, iz, halfEps));
+    }
+
+    onMask_OUT |= onMask << lane;
+    crossMask_OUT |= crossMask << lane;
+    _mm_storeu_pd (intersectionZ_OUT + lane, iz);
+  }
+}
+
+#else
+
+/* scalar fallback */
+
+static inline bool IOC3D_ContainsOnPlane
+(const double* f, double px, double py, double pz)
+{
+  double dx = px - f[IOC3D_OX * IOC3D_LANES];
+  double dy = py - f[IOC3D_OY * IOC3D_LANES];
+  double dz = pz - f[IOC3D_OZ * IOC3D_LANES];
+  WH_Vector2D position2D 
+    (dx * f[IOC3D_UX * IOC3D_LANES] + dy * f[IOC3D_UY * IOC3D_LANES] 
+     + dz * f[IOC3D_UZ * IOC3D_LANES],
+     dx * f[IOC3D_VX * IOC3D_LANES] + dy * f[IOC3D_VY * IOC3D_LANES] 
+     + dz * f[IOC3D_VZ * IOC3D_LANES]);
+  WH_Vector2D p0 (f[IOC3D_P0X * IOC3D_LANES], f[IOC3D_P0Y * IOC3D_LANES]);
+  WH_Vector2D p1 (f[IOC3D_P1X * IOC3D_LANES], f[IOC3D_P1Y * IOC3D_LANES]);
+  WH_Vector2D p2 (f[IOC3D_P2X * IOC3D_LANES], f[IOC3D_P2Y * IOC3D_LANES]);
+  double sign0 = WH_signedTriangleAreaAmong (position2D, p0, p1);
+  double sign1 = WH_signedTriangleAreaAmong (position2D, p1, p2);
+  double sign2 = WH_signedTriangleAreaAmong (position2D, p2, p0);
+  double tolerance0 = WH::eps / 2 * f[IOC3D_L0 * IOC3D_LANES];
+  double tolerance1 = WH::eps / 2 * f[IOC3D_L1 * IOC3D_LANES];
+  double tolerance2 = WH::eps / 2 * f[IOC3D_L2 * IOC3D_LANES];
+  return (0 < sign0 + tolerance0 && 0 < sign1 + tolerance1 
+	  && 0 < sign2 + tolerance2)
+    || (sign0 < 0 + tolerance0 && sign1 < 0 + tolerance1 
+	&& sign2 < 0 + tolerance2);
+}
+
+static void IOC3D_ScanBlock
+(const double* block,
+ const WH_Vector3D& position,
+ int& onMask_OUT,
+ int& crossMask_OUT,
+ double intersectionZ_OUT[IOC3D_LANES])
+{
+  onMask_OUT = 0;
+  crossMask_OUT = 0;
+  for (int lane = 0; lane < IOC3D_LANES; lane++) {
+    const double* f = block + lane;
+    double a = f[IOC3D_A * IOC3D_LANES];
+    double b = f[IOC3D_B * IOC3D_LANES];
+    double c = f[IOC3D_C * IOC3D_LANES];
+    double d = f[IOC3D_D * IOC3D_LANES];
+
+    double value = a * position.x + b * position.y + c * position.z + d;
+    if (WH_eq (value, 0)
+	&& IOC3D_ContainsOnPlane (f, position.x, position.y, position.z)) {
+      onMask_OUT |= 1 << lane;
+    }
+
+    double intersectionZ = -(a * position.x + b * position.y + d) / c;
+    if (!WH_eq (c, 0)
+	&& IOC3D_ContainsOnPlane 
+	(f, position.x, position.y, intersectionZ)) {
+      crossMask_OUT |= 1 << lane;
+    }
+    intersectionZ_OUT[lane] = intersectionZ;
+  }
+}
+
+#endif
+
 
 
 /* class WH_InOutChecker3D */
 
+thread_local WH_InOutChecker3D::CheckerType 
+WH_InOutChecker3D::_checkerType = WH_InOutChecker3D::BUCKET_CHECKER;
+
+void WH_InOutChecker3D
+::setCheckerType (CheckerType checkerType)
+{
+  _checkerType = checkerType;
+}
+
+WH_InOutChecker3D::CheckerType WH_InOutChecker3D
+::checkerType ()
+{
+  return _checkerType;
+}
+
+WH_InOutChecker3D* WH_InOutChecker3D
+::create (double faceSize)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(WH_lt (0, faceSize));
+
+  WH_CVR_LINE;
+
+  WH_InOutChecker3D* result = WH_NULL;
+  switch (_checkerType) {
+  case BUCKET_CHECKER:
+    WH_CVR_LINE;
+    result = new WH_InOutChecker3D (faceSize);
+    break;
+  case BVH_RAY_CHECKER:
+    WH_CVR_LINE;
+    result = new WH_InOutChecker3D_BVH 
+      (faceSize, WH_InOutChecker3D_BVH::RAY_QUERY);
+    break;
+  case BVH_WINDING_NUMBER_CHECKER:
+    WH_CVR_LINE;
+    result = new WH_InOutChecker3D_BVH 
+      (faceSize, WH_InOutChecker3D_BVH::WINDING_NUMBER_QUERY);
+    break;
+  default:
+    WH_ASSERT_NO_REACH;
+    break;
+  }
+  WH_ASSERT(result != WH_NULL);
+
+  return result;
+}
+
 WH_InOutChecker3D
 ::WH_InOutChecker3D 
 (double faceSize)
@@ -127,6 +550,8 @@ WH_InOutChecker3D
   _minRange = WH_Vector3D (0, 0, 0);
   _maxRange = WH_Vector3D (0, 0, 0);
   _triangleBucket = nullptr;
+  _nBucketCreations = 0;
+  _packIsStale = false;
 
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
@@ -177,7 +602,7 @@ bool WH_InOutChecker3D
   return true;
 }
   
-void WH_InOutChecker3D
+WH_Triangle3D_IOC3D* WH_InOutChecker3D
 ::addFace 
 (const WH_Vector3D& point0,
  const WH_Vector3D& point1,
@@ -185,7 +610,6 @@ void WH_InOutChecker3D
  const WH_Vector3D& normal)
 {
   /* PRE-CONDITION */
-  WH_ASSERT(!_isSetUp);
   WH_ASSERT(WH_ne (point0, point1));
   WH_ASSERT(WH_ne (point0, point2));
   WH_ASSERT(WH_ne (point1, point2));
@@ -214,6 +638,80 @@ void WH_InOutChecker3D
   WH_ASSERT(WH_eq (tri->plane ().normal (), n));
 
   _triangle_s.push_back (tri);
+
+  if (_isSetUp) {
+    WH_CVR_LINE;
+    this->registerTriangle (tri);
+  }
+
+  return tri;
+}
+
+void WH_InOutChecker3D
+::removeFace 
+(WH_Triangle3D_IOC3D* tri  /* DELETE */)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(tri != WH_NULL);
+  WH_ASSERT(!_isSetUp || 4 < this->triangle_s ().size ());
+
+  WH_CVR_LINE;
+
+  vector<WH_Triangle3D_IOC3D*>::iterator i_tri 
+    = find (_triangle_s.begin (), _triangle_s.end (), tri);
+  WH_ASSERT(i_tri != _triangle_s.end ());
+  _triangle_s.erase (i_tri);
+
+  if (_isSetUp) {
+    WH_CVR_LINE;
+    this->unregisterTriangle (tri);
+  }
+
+  delete tri;
+}
+
+void WH_InOutChecker3D
+::registerTriangle 
+(WH_Triangle3D_IOC3D* tri)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(_isSetUp);
+  WH_ASSERT(tri != WH_NULL);
+
+  WH_CVR_LINE;
+
+  if (WH_between (tri->minRange (), 
+		  _triangleBucket->minRange (), 
+		  _triangleBucket->maxRange ())
+      && WH_between (tri->maxRange (), 
+		     _triangleBucket->minRange (), 
+		     _triangleBucket->maxRange ())) {
+    WH_CVR_LINE;
+    _minRange = WH_min (tri->minRange (), _minRange);
+    _maxRange = WH_max (tri->maxRange (), _maxRange);
+    _triangleBucket->addItemLastWithin 
+      (tri->minRange (), tri->maxRange (), tri);
+    this->markCellsStale (tri->minRange (), tri->maxRange ());
+  } else {
+    WH_CVR_LINE;
+    this->createBucket ();
+  }
+}
+
+void WH_InOutChecker3D
+::unregisterTriangle 
+(WH_Triangle3D_IOC3D* tri)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(_isSetUp);
+  WH_ASSERT(tri != WH_NULL);
+
+  WH_CVR_LINE;
+
+  /* <_minRange> and <_maxRange> may get loose, but stay valid */
+  _triangleBucket->removeItemFromLastWithin 
+    (tri->minRange (), tri->maxRange (), tri);
+  this->markCellsStale (tri->minRange (), tri->maxRange ());
 }
 
 void WH_InOutChecker3D
@@ -225,6 +723,25 @@ void WH_InOutChecker3D
 
   WH_CVR_LINE;
 
+  this->createBucket ();
+
+  _isSetUp = true;
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(this->checkInvariant ());
+  WH_ASSERT(_isSetUp);
+#endif
+}
+
+void WH_InOutChecker3D
+::createBucket ()
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(3 < this->triangle_s ().size ());
+
+  WH_CVR_LINE;
+
   /* set <_minRange> and <_maxRange> */
   _minRange = WH_Vector3D::hugeValue ();
   _maxRange = -WH_Vector3D::hugeValue ();
@@ -248,9 +765,17 @@ void WH_InOutChecker3D
   /* MAGIC NUMBER : 11, 13 */
   WH_Vector3D extendedSize = extendedMaxRange - extendedMinRange;
 
-  int xCells = (int)ceil (extendedSize.x / _faceSize + WH::eps);
+  /* MAGIC NUMBER : 1 << 20 */
+  /* cells along an axis are bounded to keep them in int, as in
+     WH_MG3D_MeshGenerator::getBucketParameters (); the bucket is
+     sparse if the cells are too many to be allocated */
+  double maxCells = 1 << 20;
+
+  int xCells = (int)ceil (WH_min (extendedSize.x / _faceSize + WH::eps,
+				  maxCells));
   if (xCells / 2 == 0) xCells++;
-  int yCells = (int)ceil (extendedSize.y / _faceSize + WH::eps);
+  int yCells = (int)ceil (WH_min (extendedSize.y / _faceSize + WH::eps,
+				  maxCells));
   if (yCells / 2 == 0) yCells++;
 
 #ifdef TWO_DIRECTION_SEARCH
@@ -275,13 +800,261 @@ void WH_InOutChecker3D
       (tri_i->minRange (), tri_i->maxRange (), tri_i);
   }
 
-  _isSetUp = true;
+  /* pack triangles of each occupied cell in the order of the bucket.
+     the cells are those around the triangles, so that they scale with
+     the triangles rather than with the grid, as in a sparse bucket */
+  _packedCell_s.clear ();
+  vector<long long> cellIndex_s;
+  for (vector<WH_Triangle3D_IOC3D*>::iterator 
+	 i_tri = _triangle_s.begin ();
+       i_tri != _triangle_s.end ();
+       i_tri++) {
+    WH_Triangle3D_IOC3D* tri_i = (*i_tri);
 
-  /* POST-CONDITION */
-#ifndef WH_PRE_ONLY
-  WH_ASSERT(this->checkInvariant ());
-  WH_ASSERT(_isSetUp);
-#endif
+    this->collectCellIndexsWithin 
+      (tri_i->minRange (), tri_i->maxRange (), cellIndex_s);
+  }
+  sort (cellIndex_s.begin (), cellIndex_s.end ());
+  cellIndex_s.erase (unique (cellIndex_s.begin (), cellIndex_s.end ()),
+		     cellIndex_s.end ());
+  for (vector<long long>::iterator 
+	 i_index = cellIndex_s.begin ();
+       i_index != cellIndex_s.end ();
+       i_index++) {
+    this->packCellAt (*i_index);
+  }
+  _packIsStale = false;
+
+  _nBucketCreations++;
+}
+
+long long WH_InOutChecker3D
+::packedCellIndexIn (int cx, int cy, int cz) const
+{
+  /* same order as WH_Bucket3D_A::indexIn (), without overflow */
+  return ((long long)cx * _triangleBucket->yCells () + cy) 
+    * _triangleBucket->zCells () + cz;
+}
+
+void WH_InOutChecker3D
+::collectCellIndexsWithin 
+(const WH_Vector3D& minRange, const WH_Vector3D& maxRange,
+ vector<long long>& cellIndex_s_IO) const
+{
+  WH_CVR_LINE;
+
+  /* one more cell around, since the bucket rounds the range with
+     tolerance */
+  WH_Vector3D div0 = WH_divide (minRange - _triangleBucket->minRange (), 
+				_triangleBucket->cellSize ());
+  WH_Vector3D div1 = WH_divide (maxRange - _triangleBucket->minRange (), 
+				_triangleBucket->cellSize ());
+  int cx0 = WH_max ((int)floor (div0.x) - 1, 0);
+  int cy0 = WH_max ((int)floor (div0.y) - 1, 0);
+  int cz0 = WH_max ((int)floor (div0.z) - 1, 0);
+  int cx1 = WH_min ((int)floor (div1.x) + 1, _triangleBucket->xCells () - 1);
+  int cy1 = WH_min ((int)floor (div1.y) + 1, _triangleBucket->yCells () - 1);
+  int cz1 = WH_min ((int)floor (div1.z) + 1, _triangleBucket->zCells () - 1);
+  for (int cx = cx0; cx <= cx1; cx++) {
+    for (int cy = cy0; cy <= cy1; cy++) {
+      for (int cz = cz0; cz <= cz1; cz++) {
+	cellIndex_s_IO.push_back (this->packedCellIndexIn (cx, cy, cz));
+      }
+    }
+  }
+}
+
+void WH_InOutChecker3D
+::packCellAt (long long cellIndex) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= cellIndex);
+  WH_ASSERT(cellIndex < _triangleBucket->nCells ());
+
+  WH_CVR_LINE;
+
+  int yCells = _triangleBucket->yCells ();
+  int zCells = _triangleBucket->zCells ();
+  int cx = (int)(cellIndex / zCells / yCells);
+  int cy = (int)(cellIndex / zCells % yCells);
+  int cz = (int)(cellIndex % zCells);
+
+  WH_Vector3D cellSize = _triangleBucket->cellSize ();
+  WH_Vector3D center = _triangleBucket->minRange () 
+    + WH_Vector3D (cellSize.x * (cx + 0.5), 
+		   cellSize.y * (cy + 0.5), 
+		   cellSize.z * (cz + 0.5));
+  vector<WH_Triangle3D_IOC3D*> triangle_s;
+  _triangleBucket->getItemsOn (center, 
+			       triangle_s);
+
+  int nTriangles = (int)triangle_s.size ();
+  if (nTriangles == 0) {
+    WH_CVR_LINE;
+    _packedCell_s.erase (cellIndex);
+    return;
+  }
+  int nBlocks = (nTriangles + IOC3D_LANES - 1) / IOC3D_LANES;
+  vector<double>& packed = _packedCell_s[cellIndex];
+  packed.assign (nBlocks * IOC3D_BLOCK, 0.0);
+  for (int iLane = 0; iLane < nBlocks * IOC3D_LANES; iLane++) {
+    double* block = &packed[(iLane / IOC3D_LANES) * IOC3D_BLOCK];
+    if (iLane < nTriangles) {
+      PackTriangle (triangle_s[iLane], block, iLane % IOC3D_LANES);
+    } else {
+      PackEmptyLane (block, iLane % IOC3D_LANES);
+    }
+  }
+}
+
+void WH_InOutChecker3D
+::packCellsWithin 
+(const WH_Vector3D& minRange, const WH_Vector3D& maxRange) const
+{
+  WH_CVR_LINE;
+
+  vector<long long> cellIndex_s;
+  this->collectCellIndexsWithin (minRange, maxRange, cellIndex_s);
+  for (vector<long long>::iterator 
+	 i_index = cellIndex_s.begin ();
+       i_index != cellIndex_s.end ();
+       i_index++) {
+    this->packCellAt (*i_index);
+  }
+}
+
+void WH_InOutChecker3D
+::markCellsStale 
+(const WH_Vector3D& minRange, const WH_Vector3D& maxRange)
+{
+  WH_CVR_LINE;
+
+  if (_packIsStale) {
+    WH_CVR_LINE;
+    _staleMinRange = WH_min (minRange, _staleMinRange);
+    _staleMaxRange = WH_max (maxRange, _staleMaxRange);
+  } else {
+    WH_CVR_LINE;
+    _staleMinRange = minRange;
+    _staleMaxRange = maxRange;
+    _packIsStale = true;
+  }
+}
+
+long long WH_InOutChecker3D
+::packedCellIndexOn (const WH_Vector3D& position) const
+{
+  /* same rounding as WH_Bucket3D_A::getItemsWithin_A () */
+  WH_Vector3D div = WH_divide (position - _triangleBucket->minRange (), 
+			       _triangleBucket->cellSize ());
+  int cx = (int)floor (div.x + WH::eps);
+  int cy = (int)floor (div.y + WH::eps);
+  int cz = (int)floor (div.z + WH::eps);
+  if (WH_eq (div.x, cx) || WH_eq (div.y, cy) || WH_eq (div.z, cz)) {
+    WH_CVR_LINE;
+    /* on a cell boundary */
+    return WH_NO_INDEX;
+  }
+  if (cx < 0 || _triangleBucket->xCells () <= cx
+      || cy < 0 || _triangleBucket->yCells () <= cy
+      || cz < 0 || _triangleBucket->zCells () <= cz) {
+    WH_CVR_LINE;
+    return WH_NO_INDEX;
+  }
+  return this->packedCellIndexIn (cx, cy, cz);
+}
+
+WH_InOutChecker3D::ContainmentType WH_InOutChecker3D
+::checkContainmentInPackedCellAt 
+(long long cellIndex,
+ const WH_Vector3D& position, 
+ bool searchesPlusSide) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= cellIndex);
+  WH_ASSERT(cellIndex < _triangleBucket->nCells ());
+
+  WH_CVR_LINE;
+
+  unordered_map< long long, vector<double> >::const_iterator i_cell 
+    = _packedCell_s.find (cellIndex);
+  if (i_cell == _packedCell_s.end ()) {
+    WH_CVR_LINE;
+    /* no triangle in the cell */
+    return OUT;
+  }
+
+  /* same as checkContainmentPlusSideAt () and
+     checkContainmentMinusSideAt () over the packed triangles */
+
+  bool intersectionPointIsFound = false;
+  double nearestZ = searchesPlusSide ? WH::HUGE_VALUE : -WH::HUGE_VALUE;
+  bool zNormalIsPlus = false;
+
+  const vector<double>& packed = i_cell->second;
+  int nBlocks = (int)packed.size () / IOC3D_BLOCK;
+  for (int iBlock = 0; iBlock < nBlocks; iBlock++) {
+    const double* block = &packed[iBlock * IOC3D_BLOCK];
+
+    int onMask;
+    int crossMask;
+    double intersectionZ_s[IOC3D_LANES];
+    IOC3D_ScanBlock (block, position,
+		     onMask, crossMask, intersectionZ_s);
+    if (onMask == 0 && crossMask == 0) continue;
+
+    for (int lane = 0; lane < IOC3D_LANES; lane++) {
+      if (onMask & (1 << lane)) {
+	WH_CVR_LINE;
+	return ON;
+      }
+      if (!(crossMask & (1 << lane))) continue;
+
+      double intersectionZ = intersectionZ_s[lane];
+      double c = block[IOC3D_C * IOC3D_LANES + lane];
+      WH_ASSERT(WH_ne (position.z, intersectionZ));
+
+      if (searchesPlusSide) {
+	if (!WH_lt (position.z, intersectionZ)) continue;
+      } else {
+	if (!WH_lt (intersectionZ, position.z)) continue;
+      }
+
+      if (WH_eq (intersectionZ, nearestZ)) {
+	WH_CVR_LINE;
+	WH_ASSERT(intersectionPointIsFound);
+	/* keep the normal pointing to <position> */
+	if (searchesPlusSide) {
+	  if (WH_lt (0, c)) zNormalIsPlus = true;
+	} else {
+	  if (WH_lt (c, 0)) zNormalIsPlus = false;
+	}
+      } else if (searchesPlusSide 
+		 ? WH_lt (intersectionZ, nearestZ)
+		 : WH_lt (nearestZ, intersectionZ)) {
+	WH_CVR_LINE;
+	intersectionPointIsFound = true;
+	nearestZ = intersectionZ;
+	if (WH_lt (0, c)) {
+	  zNormalIsPlus = true;
+	} else {
+	  WH_ASSERT(WH_lt (c, 0));
+	  zNormalIsPlus = false;
+	}
+      }
+    }
+  }
+
+  ContainmentType result = OUT;
+  if (intersectionPointIsFound) {
+    WH_CVR_LINE;
+    if (searchesPlusSide) {
+      result = zNormalIsPlus ? IN : OUT;
+    } else {
+      result = zNormalIsPlus ? OUT : IN;
+    }
+  }
+  return result;
 }
   
 double WH_InOutChecker3D
@@ -308,12 +1081,31 @@ const vector<WH_Triangle3D_IOC3D*>& WH_InOutChecker3D
   return _triangle_s;
 }
 
+int WH_InOutChecker3D
+::nBucketCreations () const
+{
+  return _nBucketCreations;
+}
+
 WH_InOutChecker3D::ContainmentType WH_InOutChecker3D
 ::checkContainmentPlusSideAt 
 (const WH_Vector3D& position) const
 {
   WH_CVR_LINE;
 
+  vector<WH_Triangle3D_IOC3D*> triangle_s;
+  _triangleBucket->getItemsOn (position, 
+			       triangle_s);
+  return this->checkContainmentPlusSideAmong (position, triangle_s);
+}
+
+WH_InOutChecker3D::ContainmentType WH_InOutChecker3D
+::checkContainmentPlusSideAmong 
+(const WH_Vector3D& position,
+ const vector<WH_Triangle3D_IOC3D*>& triangle_s) const
+{
+  WH_CVR_LINE;
+
   ContainmentType result = OUT;
 
   WH_Vector3D pointMinRange (position.x, position.y, _minRange.z);
@@ -325,9 +1117,6 @@ WH_InOutChecker3D::ContainmentType WH_InOutChecker3D
   double minZWhichIsGreaterThanPositionZ = WH::HUGE_VALUE;
   bool zNormalIsPlus = false;
 
-  vector<WH_Triangle3D_IOC3D*> triangle_s;
-  _triangleBucket->getItemsOn (position, 
-			       triangle_s);
   for (vector<WH_Triangle3D_IOC3D*>::const_iterator 
 	 i_tri = triangle_s.begin ();
        i_tri != triangle_s.end ();
@@ -441,6 +1230,19 @@ WH_InOutChecker3D::ContainmentType WH_InOutChecker3D
 {
   WH_CVR_LINE;
 
+  vector<WH_Triangle3D_IOC3D*> triangle_s;
+  _triangleBucket->getItemsOn (position, 
+			       triangle_s);
+  return this->checkContainmentMinusSideAmong (position, triangle_s);
+}
+
+WH_InOutChecker3D::ContainmentType WH_InOutChecker3D
+::checkContainmentMinusSideAmong 
+(const WH_Vector3D& position,
+ const vector<WH_Triangle3D_IOC3D*>& triangle_s) const
+{
+  WH_CVR_LINE;
+
   ContainmentType result = OUT;
 
   WH_Vector3D pointMinRange (position.x, position.y, _minRange.z);
@@ -452,9 +1254,6 @@ WH_InOutChecker3D::ContainmentType WH_InOutChecker3D
   double maxZWhichIsLesserThanPositionZ = -WH::HUGE_VALUE;
   bool zNormalIsPlus = false;
 
-  vector<WH_Triangle3D_IOC3D*> triangle_s;
-  _triangleBucket->getItemsOn (position, 
-			       triangle_s);
   for (vector<WH_Triangle3D_IOC3D*>::const_iterator 
 	 i_tri = triangle_s.begin ();
        i_tri != triangle_s.end ();
@@ -580,7 +1379,23 @@ WH_InOutChecker3D::ContainmentType WH_InOutChecker3D
   WH_Vector3D bucketCenter = 
     (_triangleBucket->minRange () 
      + _triangleBucket->maxRange ()) / 2;
-  if (WH_le (bucketCenter.z, position.z)) {
+  bool searchesPlusSide = WH_le (bucketCenter.z, position.z);
+
+  if (_packIsStale) {
+    WH_CVR_LINE;
+    this->packCellsWithin (_staleMinRange, _staleMaxRange);
+    _packIsStale = false;
+  }
+
+  long long cellIndex = this->packedCellIndexOn (position);
+  if (cellIndex != WH_NO_INDEX) {
+    WH_CVR_LINE;
+    return this->checkContainmentInPackedCellAt 
+      (cellIndex, position, searchesPlusSide);
+  }
+
+  /* <position> is on a cell boundary */
+  if (searchesPlusSide) {
     WH_CVR_LINE;
     result = this->checkContainmentPlusSideAt (position);
   } else {
@@ -32,10 +32,17 @@ class WH_Triangle3D_IOC3D : public WH_Triangle3D {
   virtual bool containsPointWhichIsOnPlane 
     (const WH_Vector3D& position) const;
 
+  WH_Vector2D vertex2D (int iVertex) const;
+  /* vertex in parameter space of the plane */
+
+  double edgeLength2D (int iEdge) const;
+  /* length of the edge from vertex2D (iEdge) to the next one */
+
   /* derived */
 
  protected:
   WH_Vector2D _vertex2Ds[3];
+  double _edgeLength2Ds[3];
 
   /* base */
 
@@ -54,11 +61,18 @@ class WH_InOutChecker3D {
   virtual bool assureInvariant () const;
   
   /* base */
-  virtual void addFace 
+  virtual WH_Triangle3D_IOC3D* addFace 
     (const WH_Vector3D& point0,
      const WH_Vector3D& point1,
      const WH_Vector3D& point2,
      const WH_Vector3D& normal);
+  /* returns the registered triangle.  after setUp (), it is put into
+     the bucket at once, and the bucket is re-created only if the
+     triangle sticks out of it */
+
+  virtual void removeFace 
+    (WH_Triangle3D_IOC3D* tri  /* DELETE */);
+  /* <tri> must have been returned by addFace () */
 
   virtual void setUp ();
   
@@ -69,15 +83,31 @@ class WH_InOutChecker3D {
 
   const vector<WH_Triangle3D_IOC3D*>& triangle_s () const;
 
+  int nBucketCreations () const;
+
   enum ContainmentType {
     IN, OUT, ON
   };
   virtual ContainmentType 
     checkContainmentAt (const WH_Vector3D& position) const;
+
+  enum CheckerType {
+    BUCKET_CHECKER, BVH_RAY_CHECKER, BVH_WINDING_NUMBER_CHECKER
+  };
+  static void setCheckerType (CheckerType checkerType);
+  /* BUCKET_CHECKER by default : the type of the checkers made by
+     create ().  the others are WH_InOutChecker3D_BVH */
+
+  static CheckerType checkerType ();
+
+  static WH_InOutChecker3D* create (double faceSize);
+  /* new checker of checkerType () */
   
   /* derived */
   
  protected:
+  static thread_local CheckerType _checkerType;
+
   bool _isSetUp;
 
   double _faceSize;
@@ -88,14 +118,75 @@ class WH_InOutChecker3D {
   vector<WH_Triangle3D_IOC3D*> _triangle_s;  /* OWN */
 
   unique_ptr<WH_Bucket3D<WH_Triangle3D_IOC3D>> _triangleBucket;  /* OWN */
+
+  int _nBucketCreations;
+
+  mutable unordered_map< long long, vector<double> > _packedCell_s;
+  /* triangles of each occupied bucket cell for checkContainmentAt (),
+     packed field by field in blocks of 4 triangles, by the index of
+     the cell as in WH_Bucket3D_A */
+
+  mutable bool _packIsStale;
+  /* triangles are added or removed after the cells were packed */
+
+  mutable WH_Vector3D _staleMinRange;
+  mutable WH_Vector3D _staleMaxRange;
+  /* range of the triangles added or removed, whose cells are packed
+     again by the next query, so that a series of changes packs each
+     cell once */
   
   /* base */
+  virtual void createBucket ();
+  /* set range and register <_triangle_s> into new <_triangleBucket> */
+
+  virtual void registerTriangle (WH_Triangle3D_IOC3D* tri);
+  /* register <tri> added after setUp () */
+
+  virtual void unregisterTriangle (WH_Triangle3D_IOC3D* tri);
+  /* unregister <tri> removed after setUp (), before it is deleted */
+
+  long long packedCellIndexIn (int cx, int cy, int cz) const;
+
+  virtual void collectCellIndexsWithin 
+    (const WH_Vector3D& minRange, const WH_Vector3D& maxRange,
+     vector<long long>& cellIndex_s_IO) const;
+  /* appends the cells around the range, one more cell on each side */
+
+  virtual void packCellAt (long long cellIndex) const;
+  /* drops the cell if it has no triangle */
+
+  virtual void packCellsWithin 
+    (const WH_Vector3D& minRange, const WH_Vector3D& maxRange) const;
+
+  virtual void markCellsStale 
+    (const WH_Vector3D& minRange, const WH_Vector3D& maxRange);
+
+  virtual long long packedCellIndexOn (const WH_Vector3D& position) const;
+  /* index of the only bucket cell which contains <position>, or
+     WH_NO_INDEX if <position> is on a cell boundary */
+
+  virtual ContainmentType checkContainmentInPackedCellAt 
+    (long long cellIndex,
+     const WH_Vector3D& position, 
+     bool searchesPlusSide) const;
+
   virtual ContainmentType checkContainmentPlusSideAt 
     (const WH_Vector3D& position) const;
 
   virtual ContainmentType checkContainmentMinusSideAt 
     (const WH_Vector3D& position) const;
 
+  ContainmentType checkContainmentPlusSideAmong 
+    (const WH_Vector3D& position,
+     const vector<WH_Triangle3D_IOC3D*>& triangle_s) const;
+  /* by the nearest crossing of <triangle_s> on the plus Z side, where
+     <triangle_s> includes every triangle which may cross the Z line
+     through <position> on that side or contain <position> */
+
+  ContainmentType checkContainmentMinusSideAmong 
+    (const WH_Vector3D& position,
+     const vector<WH_Triangle3D_IOC3D*>& triangle_s) const;
+
   /* derived */
 
 };
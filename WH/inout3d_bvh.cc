@@ -0,0 +1,620 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* inout3d_bvh.cc */
+/* in-out checker of 3-D point on a bounding volume hierarchy */
+
+#if 0
+#define WH_COVERAGE_ENABLED
+#endif
+
+#include "inout3d_bvh.h"
+
+#include <algorithm>
+
+
+
+/* MAGIC NUMBER : nodes of up to 4 triangles are always leaves, and
+   nodes of up to 16 are leaves if no split is cheaper by SAH */
+static const int IOC3D_BVH_MIN_LEAF = 4;
+static const int IOC3D_BVH_MAX_LEAF = 16;
+
+static const int IOC3D_BVH_BINS = 16;
+
+/* deeper nodes are leaves, so that the traversal stack is bounded */
+static const int IOC3D_BVH_MAX_DEPTH = 48;
+
+/* MAGIC NUMBER : a node is approximated by a dipole for the winding
+   number if it is farther than this times its radius */
+static const double IOC3D_BVH_FAR_FIELD = 2.0;
+
+static double SurfaceAreaOf
+(const WH_Vector3D& minRange, const WH_Vector3D& maxRange)
+{
+  WH_Vector3D size = maxRange - minRange;
+  return 2 * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+static bool RangeContains
+(const WH_Vector3D& minRange, const WH_Vector3D& maxRange,
+ const WH_Vector3D& position)
+{
+  return minRange.x <= position.x && position.x <= maxRange.x
+    && minRange.y <= position.y && position.y <= maxRange.y
+    && minRange.z <= position.z && position.z <= maxRange.z;
+}
+
+static double SolidAngleOf
+(const WH_Triangle3D_IOC3D* tri, const WH_Vector3D& position)
+{
+  /* Van Oosterom and Strackee, signed by the normal of <tri> */
+  WH_Vector3D a = tri->vertex (0) - position;
+  WH_Vector3D b = tri->vertex (1) - position;
+  WH_Vector3D c = tri->vertex (2) - position;
+  double la = a.length ();
+  double lb = b.length ();
+  double lc = c.length ();
+  double numerator = WH_scalarProduct (a, WH_vectorProduct (b, c));
+  double denominator = la * lb * lc
+    + WH_scalarProduct (a, b) * lc
+    + WH_scalarProduct (a, c) * lb
+    + WH_scalarProduct (b, c) * la;
+  return 2 * atan2 (numerator, denominator);
+}
+
+
+
+/* class WH_InOutChecker3D_BVH */
+
+WH_InOutChecker3D_BVH
+::WH_InOutChecker3D_BVH
+(double faceSize,
+ QueryType queryType)
+  : WH_InOutChecker3D (faceSize)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(WH_lt (0, faceSize));
+
+  WH_CVR_LINE;
+
+  _queryType = queryType;
+  _nBvhCreations = 0;
+  _bvhIsStale = true;
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(this->checkInvariant ());
+#endif
+}
+
+WH_InOutChecker3D_BVH
+::~WH_InOutChecker3D_BVH ()
+{
+  WH_CVR_LINE;
+}
+
+bool WH_InOutChecker3D_BVH
+::checkInvariant () const
+{
+  WH_CVR_LINE;
+
+  this->WH_InOutChecker3D::checkInvariant ();
+
+  WH_ASSERT(_triangleBucket == nullptr);
+  if (_isSetUp && !_bvhIsStale) {
+    WH_CVR_LINE;
+    WH_ASSERT(0 < this->nBvhNodes ());
+    WH_ASSERT(_bvhTriangle_s.size () == this->triangle_s ().size ());
+  }
+
+  return true;
+}
+
+bool WH_InOutChecker3D_BVH
+::assureInvariant () const
+{
+  WH_CVR_LINE;
+
+  this->WH_InOutChecker3D::assureInvariant ();
+
+  if (!_bvhIsStale) {
+    WH_CVR_LINE;
+    int nLeafTriangles = 0;
+    for (int iNode = 0; iNode < (int)_bvhNode_s.size (); iNode++) {
+      const BvhNode& node = _bvhNode_s[iNode];
+      for (int iTri = node.firstIndex;
+	   iTri < node.firstIndex + node.nTriangles; iTri++) {
+	WH_ASSERT(WH_between (_bvhTriangle_s[iTri]->minRange (),
+			      node.minRange, node.maxRange));
+	WH_ASSERT(WH_between (_bvhTriangle_s[iTri]->maxRange (),
+			      node.minRange, node.maxRange));
+      }
+      nLeafTriangles += node.nTriangles;
+    }
+    WH_ASSERT(nLeafTriangles == (int)_bvhTriangle_s.size ());
+  }
+
+  return true;
+}
+
+WH_InOutChecker3D_BVH::QueryType WH_InOutChecker3D_BVH
+::queryType () const
+{
+  return _queryType;
+}
+
+int WH_InOutChecker3D_BVH
+::nBvhCreations () const
+{
+  return _nBvhCreations;
+}
+
+int WH_InOutChecker3D_BVH
+::nBvhNodes () const
+{
+  return (int)_bvhNode_s.size ();
+}
+
+void WH_InOutChecker3D_BVH
+::setUp ()
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(!_isSetUp);
+  WH_ASSERT(3 < this->triangle_s ().size ());
+
+  WH_CVR_LINE;
+
+  _minRange = WH_Vector3D::hugeValue ();
+  _maxRange = -WH_Vector3D::hugeValue ();
+  for (vector<WH_Triangle3D_IOC3D*>::iterator
+	 i_tri = _triangle_s.begin ();
+       i_tri != _triangle_s.end ();
+       i_tri++) {
+    WH_Triangle3D_IOC3D* tri_i = (*i_tri);
+
+    _minRange = WH_min (tri_i->minRange (), _minRange);
+    _maxRange = WH_max (tri_i->maxRange (), _maxRange);
+  }
+  WH_ASSERT(WH_lt (_minRange, _maxRange));
+
+  this->createBvh ();
+
+  _isSetUp = true;
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(this->checkInvariant ());
+  WH_ASSERT(_isSetUp);
+#endif
+}
+
+void WH_InOutChecker3D_BVH
+::registerTriangle
+(WH_Triangle3D_IOC3D* tri)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(_isSetUp);
+  WH_ASSERT(tri != WH_NULL);
+
+  WH_CVR_LINE;
+
+  /* the BVH is re-created by the next query, so that a series of
+     changes costs a single creation */
+  _minRange = WH_min (tri->minRange (), _minRange);
+  _maxRange = WH_max (tri->maxRange (), _maxRange);
+  _bvhIsStale = true;
+}
+
+void WH_InOutChecker3D_BVH
+::unregisterTriangle
+(WH_Triangle3D_IOC3D*)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(_isSetUp);
+
+  WH_CVR_LINE;
+
+  /* <_minRange> and <_maxRange> may get loose, but stay valid */
+  _bvhIsStale = true;
+}
+
+void WH_InOutChecker3D_BVH
+::createBvh () const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(3 < this->triangle_s ().size ());
+
+  WH_CVR_LINE;
+
+  vector<BvhItem> item_s (_triangle_s.size ());
+  for (int iTri = 0; iTri < (int)_triangle_s.size (); iTri++) {
+    WH_Triangle3D_IOC3D* tri = _triangle_s[iTri];
+    BvhItem& item = item_s[iTri];
+    item.tri = tri;
+    /* by tolerance, so that a point on a triangle is in its leaf */
+    WH_Vector3D margin (WH::eps, WH::eps, WH::eps);
+    item.minRange = tri->minRange () - margin;
+    item.maxRange = tri->maxRange () + margin;
+    WH_Vector3D v0 = tri->vertex (0);
+    WH_Vector3D v1 = tri->vertex (1);
+    WH_Vector3D v2 = tri->vertex (2);
+    item.center = (v0 + v1 + v2) / 3;
+    item.areaNormal = WH_vectorProduct (v1 - v0, v2 - v0) / 2;
+  }
+
+  _bvhNode_s.clear ();
+  _bvhNode_s.reserve (2 * item_s.size () / IOC3D_BVH_MIN_LEAF + 1);
+  this->buildBvhNode (item_s, 0, (int)item_s.size (), 0);
+
+  _bvhTriangle_s.resize (item_s.size ());
+  for (int iTri = 0; iTri < (int)item_s.size (); iTri++) {
+    _bvhTriangle_s[iTri] = item_s[iTri].tri;
+  }
+
+  _bvhIsStale = false;
+  _nBvhCreations++;
+}
+
+int WH_InOutChecker3D_BVH
+::buildBvhNode
+(vector<BvhItem>& item_s_IO,
+ int first, int count, int depth) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= first);
+  WH_ASSERT(0 < count);
+  WH_ASSERT(first + count <= (int)item_s_IO.size ());
+
+  WH_CVR_LINE;
+
+  int result = (int)_bvhNode_s.size ();
+  _bvhNode_s.push_back (BvhNode ());
+
+  WH_Vector3D minRange = WH_Vector3D::hugeValue ();
+  WH_Vector3D maxRange = -WH_Vector3D::hugeValue ();
+  WH_Vector3D minCenter = WH_Vector3D::hugeValue ();
+  WH_Vector3D maxCenter = -WH_Vector3D::hugeValue ();
+  WH_Vector3D areaNormal (0, 0, 0);
+  WH_Vector3D areaCenterSum (0, 0, 0);
+  double areaSum = 0;
+  for (int iItem = first; iItem < first + count; iItem++) {
+    const BvhItem& item = item_s_IO[iItem];
+    minRange = WH_min (item.minRange, minRange);
+    maxRange = WH_max (item.maxRange, maxRange);
+    minCenter = WH_min (item.center, minCenter);
+    maxCenter = WH_max (item.center, maxCenter);
+    double area = item.areaNormal.length ();
+    areaNormal += item.areaNormal;
+    areaCenterSum += item.center * area;
+    areaSum += area;
+  }
+
+  {
+    BvhNode& node = _bvhNode_s[result];
+    node.minRange = minRange;
+    node.maxRange = maxRange;
+    node.firstIndex = first;
+    node.nTriangles = count;
+    node.areaNormal = areaNormal;
+    if (0 < areaSum) {
+      WH_CVR_LINE;
+      node.areaCenter = areaCenterSum / areaSum;
+    } else {
+      WH_CVR_LINE;                                  /* NOT COVERED */
+      node.areaCenter = (minRange + maxRange) / 2;
+    }
+    node.radius = 0;
+    for (int iCorner = 0; iCorner < 8; iCorner++) {
+      WH_Vector3D corner
+	((iCorner & 1) ? maxRange.x : minRange.x,
+	 (iCorner & 2) ? maxRange.y : minRange.y,
+	 (iCorner & 4) ? maxRange.z : minRange.z);
+      node.radius = WH_max (node.radius,
+			    WH_distance (corner, node.areaCenter));
+    }
+  }
+
+  if (count <= IOC3D_BVH_MIN_LEAF
+      || IOC3D_BVH_MAX_DEPTH - 1 <= depth) {
+    WH_CVR_LINE;
+    return result;
+  }
+
+  /* split along the longest axis of the centers */
+  WH_Vector3D centerSize = maxCenter - minCenter;
+  int axis = 0;
+  if (centerSize.y > centerSize.x) axis = 1;
+  if (centerSize.z > (axis == 0 ? centerSize.x : centerSize.y)) axis = 2;
+  double minValue = (axis == 0) ? minCenter.x
+    : (axis == 1) ? minCenter.y : minCenter.z;
+  double extent = (axis == 0) ? centerSize.x
+    : (axis == 1) ? centerSize.y : centerSize.z;
+  if (extent <= 0) {
+    WH_CVR_LINE;
+    /* all the triangles have the same center */
+    return result;
+  }
+
+  /* binned surface area heuristic */
+  int binCount_s[IOC3D_BVH_BINS];
+  WH_Vector3D binMinRange_s[IOC3D_BVH_BINS];
+  WH_Vector3D binMaxRange_s[IOC3D_BVH_BINS];
+  for (int iBin = 0; iBin < IOC3D_BVH_BINS; iBin++) {
+    binCount_s[iBin] = 0;
+    binMinRange_s[iBin] = WH_Vector3D::hugeValue ();
+    binMaxRange_s[iBin] = -WH_Vector3D::hugeValue ();
+  }
+  double binScale = IOC3D_BVH_BINS / extent;
+  auto BinOf = [&] (const BvhItem& item) {
+    double value = (axis == 0) ? item.center.x
+      : (axis == 1) ? item.center.y : item.center.z;
+    int iBin = (int)((value - minValue) * binScale);
+    if (iBin < 0) iBin = 0;
+    if (IOC3D_BVH_BINS <= iBin) iBin = IOC3D_BVH_BINS - 1;
+    return iBin;
+  };
+  for (int iItem = first; iItem < first + count; iItem++) {
+    const BvhItem& item = item_s_IO[iItem];
+    int iBin = BinOf (item);
+    binCount_s[iBin]++;
+    binMinRange_s[iBin] = WH_min (item.minRange, binMinRange_s[iBin]);
+    binMaxRange_s[iBin] = WH_max (item.maxRange, binMaxRange_s[iBin]);
+  }
+
+  /* cost of the split before bin <iSplit> */
+  double rightCost_s[IOC3D_BVH_BINS];
+  {
+    int nRight = 0;
+    WH_Vector3D rightMin = WH_Vector3D::hugeValue ();
+    WH_Vector3D rightMax = -WH_Vector3D::hugeValue ();
+    for (int iSplit = IOC3D_BVH_BINS - 1; 0 < iSplit; iSplit--) {
+      nRight += binCount_s[iSplit];
+      rightMin = WH_min (binMinRange_s[iSplit], rightMin);
+      rightMax = WH_max (binMaxRange_s[iSplit], rightMax);
+      rightCost_s[iSplit] = (0 < nRight)
+	? nRight * SurfaceAreaOf (rightMin, rightMax) : 0;
+    }
+  }
+  int bestSplit = 0;
+  double bestCost = WH::HUGE_VALUE;
+  {
+    int nLeft = 0;
+    WH_Vector3D leftMin = WH_Vector3D::hugeValue ();
+    WH_Vector3D leftMax = -WH_Vector3D::hugeValue ();
+    for (int iSplit = 1; iSplit < IOC3D_BVH_BINS; iSplit++) {
+      nLeft += binCount_s[iSplit - 1];
+      leftMin = WH_min (binMinRange_s[iSplit - 1], leftMin);
+      leftMax = WH_max (binMaxRange_s[iSplit - 1], leftMax);
+      if (nLeft == 0 || nLeft == count) continue;
+      double cost = nLeft * SurfaceAreaOf (leftMin, leftMax)
+	+ rightCost_s[iSplit];
+      if (cost < bestCost) {
+	bestCost = cost;
+	bestSplit = iSplit;
+      }
+    }
+  }
+
+  double leafCost = count * SurfaceAreaOf (minRange, maxRange);
+  if (count <= IOC3D_BVH_MAX_LEAF
+      && (bestSplit == 0 || leafCost <= bestCost)) {
+    WH_CVR_LINE;
+    return result;
+  }
+
+  int middle = first + count / 2;
+  if (bestSplit != 0) {
+    WH_CVR_LINE;
+    middle = (int)(partition
+		   (item_s_IO.begin () + first,
+		    item_s_IO.begin () + first + count,
+		    [&] (const BvhItem& item) {
+		      return BinOf (item) < bestSplit;
+		    }) - item_s_IO.begin ());
+  } else {
+    WH_CVR_LINE;                                  /* NOT COVERED */
+    /* centers in a single bin : split at the median */
+    nth_element (item_s_IO.begin () + first,
+		 item_s_IO.begin () + middle,
+		 item_s_IO.begin () + first + count,
+		 [&] (const BvhItem& item0, const BvhItem& item1) {
+		   return (axis == 0) ? item0.center.x < item1.center.x
+		     : (axis == 1) ? item0.center.y < item1.center.y
+		     : item0.center.z < item1.center.z;
+		 });
+  }
+  WH_ASSERT(first < middle);
+  WH_ASSERT(middle < first + count);
+
+  /* the first child is next to this node */
+  WH_ASSERT((int)_bvhNode_s.size () == result + 1);
+  this->buildBvhNode
+    (item_s_IO, first, middle - first, depth + 1);
+  int secondChild = this->buildBvhNode
+    (item_s_IO, middle, first + count - middle, depth + 1);
+
+  BvhNode& node = _bvhNode_s[result];
+  node.firstIndex = secondChild;
+  node.nTriangles = 0;
+
+  return result;
+}
+
+void WH_InOutChecker3D_BVH
+::getTrianglesOnZLine
+(const WH_Vector3D& position,
+ bool searchesPlusSide,
+ vector<WH_Triangle3D_IOC3D*>& triangle_s_OUT) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(!_bvhIsStale);
+
+  WH_CVR_LINE;
+
+  triangle_s_OUT.clear ();
+
+  int stack[2 * IOC3D_BVH_MAX_DEPTH];
+  int nStacked = 0;
+  stack[nStacked++] = 0;
+  while (0 < nStacked) {
+    int iNode = stack[--nStacked];
+    const BvhNode& node = _bvhNode_s[iNode];
+    if (position.x < node.minRange.x || node.maxRange.x < position.x
+	|| position.y < node.minRange.y || node.maxRange.y < position.y) {
+      continue;
+    }
+    if (searchesPlusSide
+	? node.maxRange.z < position.z
+	: position.z < node.minRange.z) {
+      continue;
+    }
+    if (0 < node.nTriangles) {
+      for (int iTri = node.firstIndex;
+	   iTri < node.firstIndex + node.nTriangles; iTri++) {
+	triangle_s_OUT.push_back (_bvhTriangle_s[iTri]);
+      }
+    } else {
+      stack[nStacked++] = node.firstIndex;
+      stack[nStacked++] = iNode + 1;
+    }
+  }
+}
+
+bool WH_InOutChecker3D_BVH
+::hasTriangleOn (const WH_Vector3D& position) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(!_bvhIsStale);
+
+  WH_CVR_LINE;
+
+  int stack[2 * IOC3D_BVH_MAX_DEPTH];
+  int nStacked = 0;
+  stack[nStacked++] = 0;
+  while (0 < nStacked) {
+    int iNode = stack[--nStacked];
+    const BvhNode& node = _bvhNode_s[iNode];
+    if (!RangeContains (node.minRange, node.maxRange, position)) {
+      continue;
+    }
+    if (0 < node.nTriangles) {
+      for (int iTri = node.firstIndex;
+	   iTri < node.firstIndex + node.nTriangles; iTri++) {
+	WH_Triangle3D_IOC3D* tri = _bvhTriangle_s[iTri];
+	if (tri->plane ().contains (position)
+	    && tri->containsPointWhichIsOnPlane (position)) {
+	  WH_CVR_LINE;
+	  return true;
+	}
+      }
+    } else {
+      stack[nStacked++] = node.firstIndex;
+      stack[nStacked++] = iNode + 1;
+    }
+  }
+  return false;
+}
+
+double WH_InOutChecker3D_BVH
+::windingNumberAt (const WH_Vector3D& position) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(_isSetUp);
+
+  WH_CVR_LINE;
+
+  if (_bvhIsStale) {
+    WH_CVR_LINE;
+    this->createBvh ();
+  }
+
+  /* sum of the solid angles of the triangles, and of the dipoles of
+     the far nodes by Barill et al. */
+  double solidAngle = 0;
+  int stack[2 * IOC3D_BVH_MAX_DEPTH];
+  int nStacked = 0;
+  stack[nStacked++] = 0;
+  while (0 < nStacked) {
+    int iNode = stack[--nStacked];
+    const BvhNode& node = _bvhNode_s[iNode];
+    WH_Vector3D offset = node.areaCenter - position;
+    double distance = offset.length ();
+    if (IOC3D_BVH_FAR_FIELD * node.radius < distance) {
+      solidAngle += WH_scalarProduct (node.areaNormal, offset)
+	/ (distance * distance * distance);
+    } else if (0 < node.nTriangles) {
+      for (int iTri = node.firstIndex;
+	   iTri < node.firstIndex + node.nTriangles; iTri++) {
+	solidAngle += SolidAngleOf (_bvhTriangle_s[iTri], position);
+      }
+    } else {
+      stack[nStacked++] = node.firstIndex;
+      stack[nStacked++] = iNode + 1;
+    }
+  }
+
+  return solidAngle / (4 * M_PI);
+}
+
+WH_InOutChecker3D::ContainmentType WH_InOutChecker3D_BVH
+::checkContainmentAt (const WH_Vector3D& position) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(_isSetUp);
+
+  WH_CVR_LINE;
+
+  if (!WH_between (position, _minRange, _maxRange)) {
+    WH_CVR_LINE;
+    return OUT;
+  }
+
+  if (_bvhIsStale) {
+    WH_CVR_LINE;
+    this->createBvh ();
+  }
+
+  ContainmentType result = OUT;
+  switch (_queryType) {
+  case RAY_QUERY:
+    {
+      WH_CVR_LINE;
+      /* search the shorter side as WH_InOutChecker3D */
+      bool searchesPlusSide
+	= WH_le ((_minRange.z + _maxRange.z) / 2, position.z);
+      this->getTrianglesOnZLine
+	(position, searchesPlusSide, _candidate_s);
+      if (searchesPlusSide) {
+	WH_CVR_LINE;
+	result = this->checkContainmentPlusSideAmong
+	  (position, _candidate_s);
+      } else {
+	WH_CVR_LINE;
+	result = this->checkContainmentMinusSideAmong
+	  (position, _candidate_s);
+      }
+    }
+    break;
+  case WINDING_NUMBER_QUERY:
+    WH_CVR_LINE;
+    if (this->hasTriangleOn (position)) {
+      WH_CVR_LINE;
+      result = ON;
+    } else if (0.5 < this->windingNumberAt (position)) {
+      WH_CVR_LINE;
+      result = IN;
+    } else {
+      WH_CVR_LINE;
+      result = OUT;
+    }
+    break;
+  default:
+    WH_ASSERT_NO_REACH;
+    break;
+  }
+
+  return result;
+}
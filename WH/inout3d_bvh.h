@@ -0,0 +1,118 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* header file for inout3d_bvh.cc */
+
+#pragma once
+#ifndef WH_INCLUDED_WH_INOUT3D
+#include <WH/inout3d.h>
+#define WH_INCLUDED_WH_INOUT3D
+#endif
+
+class WH_InOutChecker3D_BVH;
+
+/* value-based class */
+/* heavy weight */
+/* in-out checker on a bounding volume hierarchy of the triangles,
+   split by the surface area heuristic.  a query visits only the
+   nodes around <position>, whatever the sizes of the triangles */
+class WH_InOutChecker3D_BVH : public WH_InOutChecker3D {
+ public:
+  enum QueryType {
+    RAY_QUERY, WINDING_NUMBER_QUERY
+  };
+  /* RAY_QUERY : the nearest crossing along Z, as WH_InOutChecker3D.
+     WINDING_NUMBER_QUERY : the generalized winding number, which
+     stays right across small gaps and overlaps of the triangles */
+
+  WH_InOutChecker3D_BVH
+    (double faceSize,
+     QueryType queryType);
+  virtual ~WH_InOutChecker3D_BVH ();
+  virtual bool checkInvariant () const;
+  virtual bool assureInvariant () const;
+
+  /* base */
+  QueryType queryType () const;
+
+  int nBvhCreations () const;
+
+  int nBvhNodes () const;
+
+  double windingNumberAt (const WH_Vector3D& position) const;
+  /* about 1 inside and 0 outside of the closed triangles */
+
+  /* derived */
+  virtual void setUp ();
+
+  virtual ContainmentType
+    checkContainmentAt (const WH_Vector3D& position) const;
+
+ protected:
+  struct BvhNode {
+    WH_Vector3D minRange;
+    WH_Vector3D maxRange;
+    int firstIndex;
+    /* first triangle of a leaf, or the second child of an inner
+       node whose first child is next to it */
+    int nTriangles;
+    /* 0 for an inner node */
+    WH_Vector3D areaNormal;
+    /* sum of area times normal of the triangles */
+    WH_Vector3D areaCenter;
+    /* area weighted center of the triangles */
+    double radius;
+    /* of the sphere around <areaCenter> which holds the node */
+  };
+
+  struct BvhItem {
+    WH_Triangle3D_IOC3D* tri;
+    WH_Vector3D minRange;
+    WH_Vector3D maxRange;
+    WH_Vector3D center;
+    WH_Vector3D areaNormal;
+  };
+
+  QueryType _queryType;
+
+  mutable int _nBvhCreations;
+
+  mutable bool _bvhIsStale;
+  /* triangles are added or removed after the BVH was created */
+
+  mutable vector<BvhNode> _bvhNode_s;
+
+  mutable vector<WH_Triangle3D_IOC3D*> _bvhTriangle_s;
+  /* triangles in the order of the leaves */
+
+  mutable vector<WH_Triangle3D_IOC3D*> _candidate_s;
+  /* work of checkContainmentAt (), kept to allocate once */
+
+  /* base */
+  virtual void createBvh () const;
+  /* build <_bvhNode_s> and <_bvhTriangle_s> on <_triangle_s> */
+
+  int buildBvhNode 
+    (vector<BvhItem>& item_s_IO,
+     int first, int count, int depth) const;
+  /* node of <item_s_IO> [first, first + count), which are reordered
+     into the leaves.  returns the index of the node */
+
+  void getTrianglesOnZLine
+    (const WH_Vector3D& position,
+     bool searchesPlusSide,
+     vector<WH_Triangle3D_IOC3D*>& triangle_s_OUT) const;
+  /* triangles whose range meets the Z line through <position> on
+     the searched side, including <position> itself */
+
+  bool hasTriangleOn (const WH_Vector3D& position) const;
+
+  /* derived */
+  virtual void registerTriangle (WH_Triangle3D_IOC3D* tri);
+
+  virtual void unregisterTriangle (WH_Triangle3D_IOC3D* tri);
+
+};
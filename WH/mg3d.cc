@@ -13,9 +13,18 @@
 #include "tetrahedron3d.h"
 #include "mg3d_delaunay2d.h"
 #include "mg3d_delaunay3d.h"
+#include "mg3d_optimizer.h"
+#include "mg3d_edge_table.h"
 #include "robust_predicates.h"
+#include "binary_io.h"
 #include "debug_levels.h"
 
+#include <chrono>
+#include <thread>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 
 
 /* class WH_MG3D_MeshGenerator */
@@ -34,6 +43,13 @@ WH_MG3D_MeshGenerator
   _minRange = WH_Vector3D (0, 0, 0);
   _maxRange = WH_Vector3D (0, 0, 0);
   _tetrahedronSize = 1.0;
+  _classifiesInOutByPropagation = false;
+  _optimizesTetrahedrons = false;
+  _nThreads = (int)thread::hardware_concurrency ();
+  if (_nThreads < 1) _nThreads = 1;
+  _releasesIntermediateData = false;
+  _hasReleasedIntermediateData = false;
+  _hasSurfaceMesh = false;
   _nodeBucket = WH_NULL;
   _obeSegBucket = WH_NULL;
   _obfTriBucket = WH_NULL;
@@ -68,7 +84,7 @@ WH_MG3D_MeshGenerator
 bool WH_MG3D_MeshGenerator
 ::checkInvariant () const
 {
-  if (_rangeIsSet) {
+  if (_rangeIsSet && !_hasReleasedIntermediateData) {
     WH_ASSERT(WH_lt (this->minRange (), this->maxRange ()));
     WH_ASSERT(this->nodeBucket () != WH_NULL);
     WH_ASSERT(this->obeSegBucket () != WH_NULL);
@@ -151,11 +167,51 @@ void WH_MG3D_MeshGenerator
 }
 
 void WH_MG3D_MeshGenerator
-::generateMesh ()
+::setClassifiesInOutByPropagation (bool flag)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(!_isDone);
+
+  _classifiesInOutByPropagation = flag;
+}
+
+void WH_MG3D_MeshGenerator
+::setOptimizesTetrahedrons (bool flag)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(!_isDone);
+
+  _optimizesTetrahedrons = flag;
+}
+
+void WH_MG3D_MeshGenerator
+::setNumberOfThreads (int n)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(!_isDone);
+  WH_ASSERT(0 < n);
+
+  _nThreads = n;
+}
+
+void WH_MG3D_MeshGenerator
+::setReleasesIntermediateData (bool flag)
 {
   /* PRE-CONDITION */
   WH_ASSERT(!_isDone);
 
+  _releasesIntermediateData = flag;
+}
+
+void WH_MG3D_MeshGenerator
+::generateSurfaceMesh ()
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(!_isDone);
+  WH_ASSERT(!_rangeIsSet);
+
+  if (_hasSurfaceMesh) return;
+
   WH_PRINT_TRACE("About to call generateNodesOnVertexs");
   cerr.flush();
 
@@ -173,6 +229,23 @@ void WH_MG3D_MeshGenerator
   this->generateMeshOverFaces ();
 
   WH_PRINT_VERBOSE("generateMeshOverFaces completed");
+  this->printMemoryUsage ("generateMeshOverFaces");
+
+  _hasSurfaceMesh = true;
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(_hasSurfaceMesh);
+#endif
+}
+
+void WH_MG3D_MeshGenerator
+::generateMesh ()
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(!_isDone);
+
+  this->generateSurfaceMesh ();
 
   this->setRange ();
 
@@ -185,17 +258,37 @@ void WH_MG3D_MeshGenerator
   this->generateNodesOverVolume ();
 
   WH_PRINT_VERBOSE("generateNodesOverVolume");
+  this->printMemoryUsage ("generateNodesOverVolume");
 
   this->generateTetrahedronsOverVolume ();
-  this->deleteOutsideVolumeNodes ();
-  this->collectFinalBoundaryFaceTriangles ();
 
   WH_PRINT_VERBOSE("generateTetrahedrons");
+  this->printMemoryUsage ("generateTetrahedrons");
+
+  if (_optimizesTetrahedrons) {
+    /* before deleteOutsideVolumeNodes () since a few tetrahedrons may
+       still refer to OUTSIDE_VOLUME nodes */
+    this->optimizeTetrahedrons ();
+
+    WH_PRINT_VERBOSE("optimizeTetrahedrons");
+    this->printMemoryUsage ("optimizeTetrahedrons");
+  }
+
+  if (_releasesIntermediateData) {
+    this->releaseIntermediateData ();
+
+    WH_PRINT_VERBOSE("releaseIntermediateData");
+    this->printMemoryUsage ("releaseIntermediateData");
+  }
+
+  this->deleteOutsideVolumeNodes ();
+  this->collectFinalBoundaryFaceTriangles ();
 
   this->generateSecondOrderNodes ();
   this->setNodeId ();
 
   WH_PRINT_VERBOSE("generateSecondOrderNodes");
+  this->printMemoryUsage ("generateSecondOrderNodes");
 
   _isDone = true;
 
@@ -211,21 +304,9 @@ void WH_MG3D_MeshGenerator
   /* PRE-CONDITION */
   WH_ASSERT(!_isDone);
 
-  this->generateNodesOnVertexs ();
-
-  WH_PRINT_VERBOSE("generateNodesOnVertexs completed");
-
-  WH_PRINT_PROGRESS("generateMeshAlongEdges");
-  this->generateMeshAlongEdges ();
-
-  WH_PRINT_VERBOSE("generateMeshAlongEdges completed");
-
-  WH_PRINT_PROGRESS("generateMeshOverFaces");
-  this->generateMeshOverFaces ();
+  this->generateSurfaceMesh ();
   this->setNodeId ();
 
-  WH_PRINT_VERBOSE("generateMeshOverFaces completed");
-
   _isDone = true;
 
   /* POST-CONDITION */
@@ -361,12 +442,18 @@ void WH_MG3D_MeshGenerator
     = extendedMaxRange_OUT - extendedMinRange_OUT;
   WH_ASSERT(WH_le (WH_Vector3D::zero (), extendedSize));
 
+  /* MAGIC NUMBER : 1 << 20 */
+  /* cells along an axis are bounded to keep them in int; the bucket
+     is sparse if the cells are too many to be allocated */
+  double maxCells = 1 << 20;
+
   if (WH_eq (0, extendedSize.x)) {
     extendedMinRange_OUT.x -= 1.0;
     extendedMaxRange_OUT.x += 1.0;
     xCells_OUT = 1;
   } else {
-    xCells_OUT = (int)ceil (extendedSize.x / cellSize + WH::eps);
+    xCells_OUT = (int)ceil (WH_min (extendedSize.x / cellSize + WH::eps, 
+				      maxCells));
     if (xCells_OUT / 2 == 0) xCells_OUT++;
   }
 
@@ -375,7 +462,8 @@ void WH_MG3D_MeshGenerator
     extendedMaxRange_OUT.y += 1.0;
     yCells_OUT = 1;
   } else {
-    yCells_OUT = (int)ceil (extendedSize.y / cellSize + WH::eps);
+    yCells_OUT = (int)ceil (WH_min (extendedSize.y / cellSize + WH::eps, 
+				      maxCells));
     if (yCells_OUT / 2 == 0) yCells_OUT++;
   }
 
@@ -384,7 +472,8 @@ void WH_MG3D_MeshGenerator
     extendedMaxRange_OUT.z += 1.0;
     zCells_OUT = 1;
   } else {
-    zCells_OUT = (int)ceil (extendedSize.z / cellSize + WH::eps);
+    zCells_OUT = (int)ceil (WH_min (extendedSize.z / cellSize + WH::eps, 
+				      maxCells));
     if (zCells_OUT / 2 == 0) zCells_OUT++;
   }
 
@@ -407,6 +496,19 @@ void WH_MG3D_MeshGenerator
 
   _node_s.push_back (node);
 
+  /* topology of <node> is fixed before it is added */
+  switch (node->topologyType ()) {
+  case WH_MG3D_Node::ON_VERTEX:
+    /* the first node on the vertex wins */
+    _vertexNodeMap.insert (make_pair (node->vertex (), node));
+    break;
+  case WH_MG3D_Node::ON_EDGE:
+    _edgeNodeMap[node->edge ()].push_back (node);
+    break;
+  default:
+    break;
+  }
+
   if (_nodeBucket != WH_NULL) {
     WH_ASSERT(_rangeIsSet);
     _nodeBucket->addItemLastOn 
@@ -422,15 +524,10 @@ WH_MG3D_Node* WH_MG3D_MeshGenerator
   
   WH_MG3D_Node* result = WH_NULL;
 
-  for (vector<WH_MG3D_Node*>::const_iterator 
-	 i_node = _node_s.begin ();
-       i_node != _node_s.end ();
-       i_node++) {
-    WH_MG3D_Node* node_i = (*i_node);
-    if (node_i->vertex () == vertex) {
-      result = node_i;
-      break;
-    }
+  unordered_map<WH_TPL3D_Vertex_A*, WH_MG3D_Node*>::const_iterator 
+    i_node = _vertexNodeMap.find (vertex);
+  if (i_node != _vertexNodeMap.end ()) {
+    result = i_node->second;
   }
 
   /* POST-CONDITION */
@@ -445,6 +542,22 @@ WH_MG3D_Node* WH_MG3D_MeshGenerator
   return result;
 }
 
+const vector<WH_MG3D_Node*>& WH_MG3D_MeshGenerator
+::nodesOnEdge (WH_TPL3D_Edge_A* edge) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(edge != WH_NULL);
+
+  static const vector<WH_MG3D_Node*> noNode_s;
+
+  unordered_map<WH_TPL3D_Edge_A*, vector<WH_MG3D_Node*> >::const_iterator 
+    i_node_s = _edgeNodeMap.find (edge);
+  if (i_node_s == _edgeNodeMap.end ()) {
+    return noNode_s;
+  }
+  return i_node_s->second;
+}
+
 bool WH_MG3D_MeshGenerator
 ::hasNodeNear 
 (const WH_Vector3D& position, double range) const
@@ -581,7 +694,7 @@ void WH_MG3D_MeshGenerator
        i_vertex++) {
     WH_TPL3D_Vertex_A* vertex_i = (*i_vertex);
     
-    static int vertexCount = 0;
+    static thread_local int vertexCount = 0;
     WH_PRINTF_TRACE("processing vertex #%d", vertexCount++);
     
     this->generateNodesOnVertex (vertex_i);
@@ -595,7 +708,7 @@ void WH_MG3D_MeshGenerator
   WH_ASSERT(edge != WH_NULL);
   
   // Debug: Track where crash occurs
-  static int edgeCount = 0;
+  static thread_local int edgeCount = 0;
   WH_PRINTF_TRACE("generateMeshAlongEdge entry #%d", edgeCount++);
   
   /* MAGIC NUMBER */
@@ -622,7 +735,7 @@ void WH_MG3D_MeshGenerator
   bool useRobustComparison = (hasSmallScale && hasComplexGeometry);
   
   // Debug output to see if robust predicates are triggering
-  static int debugCount = 0;
+  static thread_local int debugCount = 0;
   if (debugCount < 5) {
     WH_PRINTF_TRACE("geometryScale=%g hasSmallScale=%d edgeLength=%g tetraSize=%g hasComplexGeometry=%d useRobust=%d", 
                     geometryScale, hasSmallScale, edge->length(), _tetrahedronSize, hasComplexGeometry, useRobustComparison);
@@ -835,7 +948,7 @@ void WH_MG3D_MeshGenerator
 
   /* MAGIC NUMBER */
   double size = _tetrahedronSize * 0.5;
-  _inOutChecker = new WH_InOutChecker3D (size);
+  _inOutChecker = WH_InOutChecker3D::create (size);
   WH_ASSERT(_inOutChecker != WH_NULL);
   
   for (vector<WH_MG3D_OriginalBoundaryFaceTriangle*>::const_iterator 
@@ -1228,6 +1341,11 @@ void WH_MG3D_MeshGenerator
   _volumeTriangulator 
     = new WH_DLN3D_Triangulator_MG3D (this, _volume);
   WH_ASSERT(_volumeTriangulator != WH_NULL);
+  if (_classifiesInOutByPropagation) {
+    _volumeTriangulator->setInOutClassificationType 
+      (WH_DLN3D_Triangulator_MG3D::PROPAGATION_CLASSIFICATION);
+  }
+  _volumeTriangulator->setNumberOfThreads (_nThreads);
   
   for (vector<WH_MG3D_Node*>::const_iterator 
 	 i_node = this->node_s ().begin ();
@@ -1448,12 +1566,96 @@ void WH_MG3D_MeshGenerator
 #endif
 }
 
+void WH_MG3D_MeshGenerator
+::optimizeTetrahedrons ()
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < this->tetrahedron_s ().size ());
+  WH_ASSERT(this->fbfTri_s ().size () == 0);
+
+  WH_MG3D_MeshOptimizer optimizer (_tetrahedron_s);
+  optimizer.setNumberOfThreads (_nThreads);
+
+  WH_MG3D_QualityHistogram before;
+  optimizer.getQualityHistogram (before);
+  before.print ("quality before optimization");
+
+  optimizer.perform ();
+  optimizer.updateNodePositions (_nodeBucket);
+
+  WH_MG3D_QualityHistogram after;
+  optimizer.getQualityHistogram (after);
+  after.print ("quality after optimization");
+
+  WH_PRINTF_NORMAL("optimization : flips 2-3 %d, 3-2 %d, 4-4 %d, smoothed nodes %d",
+		   optimizer.nFlips23 (), optimizer.nFlips32 (),
+		   optimizer.nFlips44 (), optimizer.nSmoothedNodes ());
+
+  if (!optimizer.hasChangedConnectivity ()) return;
+
+  /* rebuild tetrahedrons.  Flips never touch boundary faces.  the
+     tetrahedrons of <_volumeTriangulator> refer to the old ones, so
+     the references are cleared before they are deleted */
+  if (_volumeTriangulator != WH_NULL) {
+    WH_CVR_LINE;
+    for (list<WH_DLN3D_Tetrahedron*>::const_iterator 
+	   i_tetra = _volumeTriangulator->tetrahedron_s ().begin ();
+	 i_tetra != _volumeTriangulator->tetrahedron_s ().end ();
+	 i_tetra++) {
+      WH_DLN3D_Tetrahedron_MG3D* tetraMg_i 
+	= dynamic_cast<WH_DLN3D_Tetrahedron_MG3D*>(*i_tetra);
+      WH_ASSERT(tetraMg_i != WH_NULL);
+      tetraMg_i->clearTetrahedron ();
+    }
+  }
+  WH_T_Delete (_tetrahedron_s);
+  _tetrahedron_s.clear ();
+
+  int nTetras = optimizer.nTetrahedrons ();
+  vector<int> neighborIndex_s (nTetras * 4);
+  for (int t = 0; t < nTetras; t++) {
+    WH_MG3D_Node* node_s[4];
+    optimizer.getTetrahedron (t, node_s, &neighborIndex_s[t * 4]);
+
+    WH_MG3D_Tetrahedron* volumeTetra
+      = new WH_MG3D_Tetrahedron 
+      (node_s[0], node_s[1], node_s[2], node_s[3], _volume);
+    WH_ASSERT(volumeTetra != WH_NULL);
+    this->addTetrahedron (volumeTetra);
+  }
+  for (int t = 0; t < nTetras; t++) {
+    WH_MG3D_Tetrahedron* neighbor_s[4];
+    for (int f = 0; f < 4; f++) {
+      int index = neighborIndex_s[t * 4 + f];
+      neighbor_s[f] = (index < 0) ? WH_NULL : _tetrahedron_s[index];
+    }
+    _tetrahedron_s[t]->setNeighbors 
+      (neighbor_s[0], neighbor_s[1], neighbor_s[2], neighbor_s[3]);
+  }
+}
+
 void WH_MG3D_MeshGenerator
 ::generateSecondOrderNodes ()
 {
   /* PRE-CONDITION */
   WH_ASSERT(0 < this->tetrahedron_s ().size ());
   WH_ASSERT(0 < this->fbfTri_s ().size ());
+
+  chrono::steady_clock::time_point startTime = chrono::steady_clock::now ();
+
+  /* temporary ID of the first order nodes to key the edges, renumbered
+     by setNodeId () */
+  int nFirstOrderNodes = (int)_node_s.size ();
+  for (int i = 0; i < nFirstOrderNodes; i++) {
+    WH_ASSERT(_node_s[i]->isFirstOrder ());
+    _node_s[i]->setId (i);
+  }
+
+  WH_MG3D_EdgeNodeTable edgeNodeTable 
+    (WH_MG3D_EdgeNodeTable::estimateNumberOfEdges 
+     (_node_s.size (), _tetrahedron_s.size (), _fbfTri_s.size ()));
+  edgeNodeTable.setNumberOfThreads (_nThreads);
+  edgeNodeTable.insertEdgesOf (_tetrahedron_s);
   
   for (vector<WH_MG3D_Tetrahedron*>::const_iterator 
 	 i_tetra = _tetrahedron_s.begin ();
@@ -1469,10 +1671,13 @@ void WH_MG3D_MeshGenerator
 	(WH_Tetrahedron3D_A::edgeVertexMap[iEdge][0]);
       WH_MG3D_Node* node1 = tetra_i->firstOrderNode 
 	(WH_Tetrahedron3D_A::edgeVertexMap[iEdge][1]);
-      WH_Vector3D midPoint = (node0->position () + node1->position ()) / 2;
 
-      WH_MG3D_Node* secondOrderNode = this->nodeAt (midPoint);
+      WH_MG3D_Node*& secondOrderNode 
+	= edgeNodeTable.nodeOn (node0->id (), node1->id ());
       if (secondOrderNode == WH_NULL) {
+	WH_Vector3D midPoint 
+	  = (node0->position () + node1->position ()) / 2;
+
 	bool isFirstOrder = false;
 	secondOrderNode = new WH_MG3D_Node (midPoint, isFirstOrder);
 	WH_ASSERT(secondOrderNode != WH_NULL);
@@ -1518,6 +1723,20 @@ void WH_MG3D_MeshGenerator
        secondOrderNodes[4],
        secondOrderNodes[5]);
   }
+
+  double seconds = chrono::duration<double> 
+    (chrono::steady_clock::now () - startTime).count ();
+  WH_PRINTF_VERBOSE("second order nodes : %d on %d edges, %zu slots (%zu bytes, max probe %d), %.3f sec",
+		    (int)_node_s.size () - nFirstOrderNodes, 
+		    edgeNodeTable.nEdges (), edgeNodeTable.nSlots (),
+		    edgeNodeTable.memorySize (), 
+		    edgeNodeTable.maxProbeLength (), seconds);
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT((int)_node_s.size () - nFirstOrderNodes 
+	    == edgeNodeTable.nEdges ());
+#endif
 }
 
 void WH_MG3D_MeshGenerator
@@ -1552,6 +1771,405 @@ void WH_MG3D_MeshGenerator
   }
 }
 
+/* give the freed heap back to the system so that RSS drops */
+static void WH_MG3D_TrimHeap ()
+{
+#ifdef __GLIBC__
+  malloc_trim (0);
+#endif
+}
+
+void WH_MG3D_MeshGenerator
+::releaseIntermediateData ()
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < this->tetrahedron_s ().size ());
+  WH_ASSERT(!_hasReleasedIntermediateData);
+
+  /* <_tetrahedron_s> refers only to nodes, which are kept */
+  delete _volumeTriangulator;
+  _volumeTriangulator = WH_NULL;
+  delete _inOutChecker;
+  _inOutChecker = WH_NULL;
+  delete _nodeBucket;
+  _nodeBucket = WH_NULL;
+  delete _obeSegBucket;
+  _obeSegBucket = WH_NULL;
+  delete _obfTriBucket;
+  _obfTriBucket = WH_NULL;
+
+  _hasReleasedIntermediateData = true;
+
+  WH_MG3D_TrimHeap ();
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(this->volumeTriangulator () == WH_NULL);
+  WH_ASSERT(this->nodeBucket () == WH_NULL);
+#endif
+}
+
+void WH_MG3D_MeshGenerator
+::printMemoryUsage (const char* stage) const
+{
+  if (g_debugLevel < WH_DEBUG_VERBOSE) return;
+
+  /* VmHWM is the peak RSS of the process so far.  it is not reset
+     between stages, as it is the peak of the whole process to other
+     tools too */
+  long rss = -1;
+  long peakRss = -1;
+  ifstream status ("/proc/self/status");
+  string line;
+  while (getline (status, line)) {
+    if (line.compare (0, 6, "VmRSS:") == 0) {
+      rss = atol (line.c_str () + 6);
+    } else if (line.compare (0, 6, "VmHWM:") == 0) {
+      peakRss = atol (line.c_str () + 6);
+    }
+  }
+  if (rss < 0 || peakRss < 0) return;
+
+  WH_PRINTF_VERBOSE("memory : %s : RSS %ld kB, peak %ld kB",
+		    stage, rss, peakRss);
+}
+
+void WH_MG3D_MeshGenerator
+::writeMesh (ostream& out)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(_isDone);
+
+  out << _tetrahedron_s.size () << endl;
+  for (vector<WH_MG3D_Tetrahedron*>::iterator 
+	 i_tetra = _tetrahedron_s.begin ();
+       i_tetra != _tetrahedron_s.end ();
+       i_tetra++) {
+    WH_MG3D_Tetrahedron* tetra_i = (*i_tetra);
+
+    for (int iNode = 0;
+	 iNode < WH_MG3D_Tetrahedron::nFirstOrderNodes;
+	 iNode++) {
+      out << tetra_i->firstOrderNode (iNode)->id () << " ";
+    }
+    for (int iEdge = 0;
+	 iEdge < WH_Tetrahedron3D_A::nTetrahedronEdges;
+	 iEdge++) {
+      out << tetra_i->secondOrderNode (iEdge)->id ()
+	  << ((iEdge + 1 < WH_Tetrahedron3D_A::nTetrahedronEdges) 
+	      ? " " : "\n");
+    }
+
+    if (_releasesIntermediateData) {
+      delete tetra_i;
+      (*i_tetra) = WH_NULL;
+    }
+  }
+  if (_releasesIntermediateData) {
+    /* final boundary face triangles refer to the deleted tetrahedrons,
+       and original boundary segments and triangles to the nodes
+       deleted below */
+    _tetrahedron_s.clear ();
+    _tetrahedron_s.shrink_to_fit ();
+    WH_T_Delete (_fbfTri_s);
+    _fbfTri_s.clear ();
+    _fbfTri_s.shrink_to_fit ();
+    WH_T_Delete (_obeSeg_s);
+    _obeSeg_s.clear ();
+    _obeSeg_s.shrink_to_fit ();
+    WH_T_Delete (_obfTri_s);
+    _obfTri_s.clear ();
+    _obfTri_s.shrink_to_fit ();
+    WH_MG3D_TrimHeap ();
+
+    this->printMemoryUsage ("writeMesh : tetrahedrons");
+  }
+
+  out << _node_s.size () << endl;
+  for (vector<WH_MG3D_Node*>::iterator 
+	 i_node = _node_s.begin ();
+       i_node != _node_s.end ();
+       i_node++) {
+    WH_MG3D_Node* node_i = (*i_node);
+    WH_ASSERT(node_i->id () == (int)(i_node - _node_s.begin ()));
+
+    WH_Vector3D position = node_i->position ();
+    out << position.x << " " 
+	<< position.y << " " 
+	<< position.z << "\n";
+
+    if (_releasesIntermediateData) {
+      delete node_i;
+      (*i_node) = WH_NULL;
+    }
+  }
+  if (_releasesIntermediateData) {
+    _node_s.clear ();
+    _node_s.shrink_to_fit ();
+    _vertexNodeMap.clear ();
+    _edgeNodeMap.clear ();
+    WH_MG3D_TrimHeap ();
+
+    this->printMemoryUsage ("writeMesh : nodes");
+  }
+  out.flush ();
+}
+
+/* a surface mesh in binary form is the header, the nodes, the
+   original boundary edge segments and face triangles by the indices
+   of their nodes, and the trailer */
+static const char* SURFACE_MESH_MAGIC = "WHSM";
+
+static const char* SURFACE_MESH_END = "END.";
+
+static const int SURFACE_MESH_VERSION = 1;
+
+template <class Type>
+static void WH_MG3D_MakeIndexMap 
+(const vector<Type*>& item_s,
+ unordered_map<Type*, int>& indexMap_OUT)
+{
+  for (int i = 0; i < (int)item_s.size (); i++) {
+    indexMap_OUT[item_s[i]] = i;
+  }
+}
+
+static bool WH_MG3D_ReadIndex 
+(istream& in,
+ int nItems,
+ int& index_OUT)
+{
+  return WH_readBinary (in, index_OUT) 
+    && 0 <= index_OUT && index_OUT < nItems;
+}
+
+void WH_MG3D_MeshGenerator
+::writeSurfaceMesh (ostream& out) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(!_rangeIsSet);
+  WH_ASSERT(0 < this->obfTri_s ().size ());
+
+  WH_TPL3D_Body_A* body = _volume->body ();
+  WH_ASSERT(body != WH_NULL);
+
+  unordered_map<WH_TPL3D_Vertex_A*, int> vertexIndexMap;
+  WH_MG3D_MakeIndexMap (body->vertex_s (), vertexIndexMap);
+  unordered_map<WH_TPL3D_Edge_A*, int> edgeIndexMap;
+  WH_MG3D_MakeIndexMap (body->edge_s (), edgeIndexMap);
+  unordered_map<WH_TPL3D_Face_A*, int> faceIndexMap;
+  WH_MG3D_MakeIndexMap (body->face_s (), faceIndexMap);
+  unordered_map<WH_TPL3D_Volume_A*, int> volumeIndexMap;
+  WH_MG3D_MakeIndexMap (body->volume_s (), volumeIndexMap);
+
+  WH_writeBinaryTag (out, SURFACE_MESH_MAGIC);
+  WH_writeBinary (out, SURFACE_MESH_VERSION);
+  WH_writeBinary (out, _tetrahedronSize);
+  /* the topology, to find a mismatch on reading */
+  WH_writeBinary (out, volumeIndexMap.at (_volume));
+  WH_writeBinary (out, (int)body->vertex_s ().size ());
+  WH_writeBinary (out, (int)body->edge_s ().size ());
+  WH_writeBinary (out, (int)body->face_s ().size ());
+
+  unordered_map<WH_MG3D_Node*, int> nodeIndexMap;
+  WH_MG3D_MakeIndexMap (_node_s, nodeIndexMap);
+  WH_writeBinary (out, (int)_node_s.size ());
+  for (vector<WH_MG3D_Node*>::const_iterator 
+	 i_node = _node_s.begin ();
+       i_node != _node_s.end ();
+       i_node++) {
+    WH_MG3D_Node* node_i = (*i_node);
+    WH_ASSERT(node_i->isFirstOrder ());
+
+    WH_writeBinary (out, (int)node_i->topologyType ());
+    switch (node_i->topologyType ()) {
+    case WH_MG3D_Node::ON_VERTEX:
+      WH_writeBinary (out, vertexIndexMap.at (node_i->vertex ()));
+      break;
+    case WH_MG3D_Node::ON_EDGE:
+      WH_writeBinary (out, edgeIndexMap.at (node_i->edge ()));
+      break;
+    case WH_MG3D_Node::ON_FACE:
+      WH_writeBinary (out, faceIndexMap.at (node_i->face ()));
+      break;
+    default:
+      WH_ASSERT_NO_REACH;
+      break;
+    }
+    WH_writeBinary (out, node_i->isJustOnTopologicalEntity () ? 1 : 0);
+    WH_Vector3D position = node_i->position ();
+    WH_writeBinary (out, position.x);
+    WH_writeBinary (out, position.y);
+    WH_writeBinary (out, position.z);
+  }
+
+  WH_writeBinary (out, (int)_obeSeg_s.size ());
+  for (vector<WH_MG3D_OriginalBoundaryEdgeSegment*>::const_iterator 
+	 i_obeSeg = _obeSeg_s.begin ();
+       i_obeSeg != _obeSeg_s.end ();
+       i_obeSeg++) {
+    WH_MG3D_OriginalBoundaryEdgeSegment* obeSeg_i = (*i_obeSeg);
+    WH_writeBinary (out, nodeIndexMap.at (obeSeg_i->node0 ()));
+    WH_writeBinary (out, nodeIndexMap.at (obeSeg_i->node1 ()));
+    WH_writeBinary (out, edgeIndexMap.at (obeSeg_i->edge ()));
+  }
+
+  WH_writeBinary (out, (int)_obfTri_s.size ());
+  for (vector<WH_MG3D_OriginalBoundaryFaceTriangle*>::const_iterator 
+	 i_obfTri = _obfTri_s.begin ();
+       i_obfTri != _obfTri_s.end ();
+       i_obfTri++) {
+    WH_MG3D_OriginalBoundaryFaceTriangle* obfTri_i = (*i_obfTri);
+    WH_writeBinary (out, nodeIndexMap.at (obfTri_i->node0 ()));
+    WH_writeBinary (out, nodeIndexMap.at (obfTri_i->node1 ()));
+    WH_writeBinary (out, nodeIndexMap.at (obfTri_i->node2 ()));
+    WH_writeBinary (out, faceIndexMap.at (obfTri_i->face ()));
+  }
+
+  WH_writeBinaryTag (out, SURFACE_MESH_END);
+}
+
+bool WH_MG3D_MeshGenerator
+::readSurfaceMesh (istream& in)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(!_isDone);
+  WH_ASSERT(this->node_s ().size () == 0);
+  WH_ASSERT(this->obeSeg_s ().size () == 0);
+  WH_ASSERT(this->obfTri_s ().size () == 0);
+
+  WH_TPL3D_Body_A* body = _volume->body ();
+  WH_ASSERT(body != WH_NULL);
+  int nVertexs = (int)body->vertex_s ().size ();
+  int nEdges = (int)body->edge_s ().size ();
+  int nFaces = (int)body->face_s ().size ();
+  int volumeIndex = (int)(find (body->volume_s ().begin (), 
+				body->volume_s ().end (), _volume)
+			  - body->volume_s ().begin ());
+
+  int version;
+  double size;
+  int volumeIndexInFile, nVertexsInFile, nEdgesInFile, nFacesInFile;
+  if (!WH_readBinaryTag (in, SURFACE_MESH_MAGIC)
+      || !WH_readBinary (in, version) || version != SURFACE_MESH_VERSION
+      || !WH_readBinary (in, size) || !(0 < size)
+      || !WH_readBinary (in, volumeIndexInFile)
+      || !WH_readBinary (in, nVertexsInFile)
+      || !WH_readBinary (in, nEdgesInFile)
+      || !WH_readBinary (in, nFacesInFile)
+      || volumeIndexInFile != volumeIndex || nVertexsInFile != nVertexs
+      || nEdgesInFile != nEdges || nFacesInFile != nFaces) {
+    return false;
+  }
+
+  /* the whole mesh is read before it is added, so that a broken one
+     leaves nothing behind */
+  vector<WH_MG3D_Node*> node_s;
+  vector<WH_MG3D_OriginalBoundaryEdgeSegment*> obeSeg_s;
+  vector<WH_MG3D_OriginalBoundaryFaceTriangle*> obfTri_s;
+
+  int nNodes = 0;
+  bool isRead = WH_readBinaryCount (in, nNodes);
+  for (int iNode = 0; iNode < nNodes && isRead; iNode++) {
+    int topologyType, index, isJust;
+    WH_Vector3D position;
+    isRead = WH_readBinary (in, topologyType) 
+      && WH_readBinary (in, index)
+      && WH_readBinary (in, isJust)
+      && WH_readBinary (in, position.x)
+      && WH_readBinary (in, position.y)
+      && WH_readBinary (in, position.z);
+    if (!isRead) break;
+
+    WH_MG3D_Node* node = new WH_MG3D_Node (position);
+    WH_ASSERT(node != WH_NULL);
+    node_s.push_back (node);
+    switch (topologyType) {
+    case WH_MG3D_Node::ON_VERTEX:
+      isRead = 0 <= index && index < nVertexs;
+      if (isRead) node->putOnVertex (body->vertex_s ()[index]);
+      break;
+    case WH_MG3D_Node::ON_EDGE:
+      isRead = 0 <= index && index < nEdges;
+      if (isRead) node->putOnEdge (body->edge_s ()[index], isJust != 0);
+      break;
+    case WH_MG3D_Node::ON_FACE:
+      isRead = 0 <= index && index < nFaces;
+      if (isRead) node->putOnFace (body->face_s ()[index], isJust != 0);
+      break;
+    default:
+      isRead = false;
+      break;
+    }
+  }
+
+  int nObeSegs = 0;
+  isRead = isRead && WH_readBinaryCount (in, nObeSegs);
+  for (int iObeSeg = 0; iObeSeg < nObeSegs && isRead; iObeSeg++) {
+    int iNode0, iNode1, iEdge;
+    isRead = WH_MG3D_ReadIndex (in, nNodes, iNode0)
+      && WH_MG3D_ReadIndex (in, nNodes, iNode1)
+      && WH_MG3D_ReadIndex (in, nEdges, iEdge);
+    if (isRead) {
+      obeSeg_s.push_back 
+	(new WH_MG3D_OriginalBoundaryEdgeSegment 
+	 (node_s[iNode0], node_s[iNode1], body->edge_s ()[iEdge]));
+    }
+  }
+
+  int nObfTris = 0;
+  isRead = isRead && WH_readBinaryCount (in, nObfTris) && 0 < nObfTris;
+  for (int iObfTri = 0; iObfTri < nObfTris && isRead; iObfTri++) {
+    int iNode0, iNode1, iNode2, iFace;
+    isRead = WH_MG3D_ReadIndex (in, nNodes, iNode0)
+      && WH_MG3D_ReadIndex (in, nNodes, iNode1)
+      && WH_MG3D_ReadIndex (in, nNodes, iNode2)
+      && WH_MG3D_ReadIndex (in, nFaces, iFace);
+    if (isRead) {
+      obfTri_s.push_back 
+	(new WH_MG3D_OriginalBoundaryFaceTriangle 
+	 (node_s[iNode0], node_s[iNode1], node_s[iNode2], 
+	  body->face_s ()[iFace]));
+    }
+  }
+
+  isRead = isRead && WH_readBinaryTag (in, SURFACE_MESH_END);
+  if (!isRead) {
+    WH_T_Delete (obfTri_s);
+    WH_T_Delete (obeSeg_s);
+    WH_T_Delete (node_s);
+    return false;
+  }
+
+  _tetrahedronSize = size;
+  for (vector<WH_MG3D_Node*>::const_iterator 
+	 i_node = node_s.begin ();
+       i_node != node_s.end ();
+       i_node++) {
+    this->addNode (*i_node);
+  }
+  for (vector<WH_MG3D_OriginalBoundaryEdgeSegment*>::const_iterator 
+	 i_obeSeg = obeSeg_s.begin ();
+       i_obeSeg != obeSeg_s.end ();
+       i_obeSeg++) {
+    this->addObeSeg (*i_obeSeg);
+  }
+  for (vector<WH_MG3D_OriginalBoundaryFaceTriangle*>::const_iterator 
+	 i_obfTri = obfTri_s.begin ();
+       i_obfTri != obfTri_s.end ();
+       i_obfTri++) {
+    this->addObfTri (*i_obfTri);
+  }
+  _hasSurfaceMesh = true;
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(0 < this->obfTri_s ().size ());
+#endif
+
+  return true;
+}
+
 
 
 
@@ -30,10 +30,51 @@ class WH_MG3D_MeshGenerator {
   /* base */
   virtual void setTetrahedronSize (double size);
   
+  virtual void setClassifiesInOutByPropagation (bool flag);
+  /* propagate IN/OUT of tetrahedrons across the recovered boundary
+     instead of ray casting each of them */
+
+  virtual void setOptimizesTetrahedrons (bool flag);
+  /* improve tetrahedrons by flips and smoothing after they are
+     generated */
+
+  virtual void setNumberOfThreads (int n);
+  /* threads used by boundary recovery, optimization and second order
+     nodes.  the mesh does not depend on it */
+
+  virtual void setReleasesIntermediateData (bool flag);
+  /* low memory mode : delete the volume triangulator, the buckets and
+     the in/out checker as soon as the tetrahedrons are generated, and
+     release tetrahedrons and nodes while writeMesh () streams them */
+
+  virtual void generateSurfaceMesh ();
+  /* the nodes and triangles over the boundary, which generateMesh ()
+     and generatePatch () start with.  nothing if they are already
+     there, e.g. restored by readSurfaceMesh () */
+
   virtual void generateMesh ();
 
   virtual void generatePatch ();
 
+  virtual void writeMesh (ostream& out);
+  /* number of tetrahedrons, 10 node IDs of each (4 vertices, then
+     edges in the order of WH_Tetrahedron3D_A::edgeVertexMap), number
+     of nodes and their coordinates.  In the low memory mode the
+     tetrahedrons, final boundary face triangles and nodes are deleted
+     as they are written */
+
+  virtual void writeSurfaceMesh (ostream& out) const;
+  /* versioned binary form (see binary_io.h) of the mesh over the
+     boundary, as left by generatePatch () : the tetrahedron size, the
+     nodes, the original boundary edge segments and face triangles.
+     the vertices, edges and faces under them are referred to by their
+     indices in the body of volume () */
+
+  virtual bool readSurfaceMesh (istream& in);
+  /* restore the mesh written by writeSurfaceMesh () for the same
+     topology, so that generateMesh () or generatePatch () starts
+     after it.  false if <in> has no such mesh */
+
   double tetrahedronSize () const;
 
   WH_TPL3D_Volume_A* volume () const;
@@ -66,6 +107,11 @@ class WH_MG3D_MeshGenerator {
   virtual WH_MG3D_Node* findNodeOnVertex 
     (WH_TPL3D_Vertex_A* vertex) const;
 
+  virtual const vector<WH_MG3D_Node*>& nodesOnEdge 
+    (WH_TPL3D_Edge_A* edge) const;
+  /* nodes put on <edge> in the order of addition, excluding the
+     nodes on its vertices */
+
   virtual bool hasNodeNear 
     (const WH_Vector3D& position, double range) const;
 
@@ -85,6 +131,19 @@ class WH_MG3D_MeshGenerator {
   bool _rangeIsSet;
 
   double _tetrahedronSize;
+
+  bool _classifiesInOutByPropagation;
+
+  bool _optimizesTetrahedrons;
+
+  int _nThreads;
+
+  bool _releasesIntermediateData;
+
+  bool _hasReleasedIntermediateData;
+
+  bool _hasSurfaceMesh;
+  /* by generateSurfaceMesh () or readSurfaceMesh () */
   
   vector<WH_MG3D_Node*> _node_s;  /* OWN */
 
@@ -92,6 +151,10 @@ class WH_MG3D_MeshGenerator {
   WH_Vector3D _maxRange;
 
   WH_Bucket3D<WH_MG3D_Node>* _nodeBucket;  /* OWN */
+
+  unordered_map<WH_TPL3D_Vertex_A*, WH_MG3D_Node*> _vertexNodeMap;
+
+  unordered_map<WH_TPL3D_Edge_A*, vector<WH_MG3D_Node*> > _edgeNodeMap;
   
   vector<WH_MG3D_OriginalBoundaryEdgeSegment*> 
     _obeSeg_s;  /* OWN */
@@ -181,10 +244,17 @@ class WH_MG3D_MeshGenerator {
 
   virtual void collectFinalBoundaryFaceTriangles ();
 
+  virtual void optimizeTetrahedrons ();
+
   virtual void generateSecondOrderNodes ();
 
   virtual void setNodeId ();
 
+  virtual void releaseIntermediateData ();
+
+  virtual void printMemoryUsage (const char* stage) const;
+  /* current and peak RSS since the last call, at WH_DEBUG_VERBOSE */
+
   /* derived */
   
 };
@@ -8,6 +8,7 @@
 
 #include "mg3d_delaunay2d.h"
 #include "bucket2d.h"
+#include "arena.h"
 #include "inout2d.h"
 #include "constdel2d.h"
 #include "robust_cdt.h"
@@ -543,28 +544,24 @@ WH_MG3D_FaceNode* WH_MG3D_FaceMeshGenerator
 WH_MG3D_FaceNode* WH_MG3D_FaceMeshGenerator
 ::findNodeFrom 
 (WH_MG3D_Node* node3D,
- const vector<WH_MG3D_FaceNode*>& node_s)
+ const unordered_map<WH_MG3D_Node*, WH_MG3D_FaceNode*>& nodeMap)
 {
   /* PRE-CONDITION */
   WH_ASSERT(node3D != WH_NULL);
-  WH_ASSERT(2 <= node_s.size ());
+  WH_ASSERT(2 <= nodeMap.size ());
 
   WH_MG3D_FaceNode* result = WH_NULL;
-  for (vector<WH_MG3D_FaceNode*>::const_iterator 
-	 i_node = node_s.begin ();
-       i_node != node_s.end ();
-       i_node++) {
-    WH_MG3D_FaceNode* node_i = (*i_node);
-    if (node_i->node3D () == node3D) {
-      result = node_i;
-      break;
-    }
+  unordered_map<WH_MG3D_Node*, WH_MG3D_FaceNode*>::const_iterator 
+    i_node = nodeMap.find (node3D);
+  if (i_node != nodeMap.end ()) {
+    result = i_node->second;
   }
   WH_ASSERT(result != WH_NULL);
 
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
   WH_ASSERT(result != WH_NULL);
+  WH_ASSERT(result->node3D () == node3D);
 #endif
 
   return result;
@@ -653,22 +650,23 @@ void WH_MG3D_FaceMeshGenerator
     WH_ASSERT(endNode != WH_NULL);
 
     /* generate 2D nodes just on <edge> and store all of them into
-       <edgeNode_s> */
-    vector<WH_MG3D_FaceNode*> edgeNode_s;
-    edgeNode_s.push_back (startNode);
+       <edgeNodeMap> keyed by their 3D nodes */
+    unordered_map<WH_MG3D_Node*, WH_MG3D_FaceNode*> edgeNodeMap;
+    edgeNodeMap.insert (make_pair (startNode->node3D (), startNode));
+    const vector<WH_MG3D_Node*>& edgeNode3D_s 
+      = _meshGenerator->nodesOnEdge (edge);
     for (vector<WH_MG3D_Node*>::const_iterator 
-	   i_node3D = _meshGenerator->node_s ().begin ();
-	 i_node3D != _meshGenerator->node_s ().end ();
+	   i_node3D = edgeNode3D_s.begin ();
+	 i_node3D != edgeNode3D_s.end ();
 	 i_node3D++) {
       WH_MG3D_Node* node3D_i = (*i_node3D);
-      if (node3D_i->edge () == edge) {
-	WH_MG3D_FaceNode* node
-	  = this->makeBoundaryNode (node3D_i);
-	edgeNode_s.push_back (node);
-      }
+      WH_ASSERT(node3D_i->edge () == edge);
+      WH_MG3D_FaceNode* node
+	= this->makeBoundaryNode (node3D_i);
+      edgeNodeMap.insert (make_pair (node3D_i, node));
     }
     if (endNode != startNode) {
-      edgeNode_s.push_back (endNode);
+      edgeNodeMap.insert (make_pair (endNode->node3D (), endNode));
     }
 
     /* generate 2D boundary segments on <edge> */
@@ -680,9 +678,9 @@ void WH_MG3D_FaceMeshGenerator
 
       if (obeSeg_i->edge () == edge) {
 	WH_MG3D_FaceNode* node0 
-	  = this->findNodeFrom (obeSeg_i->node0 (), edgeNode_s);
+	  = this->findNodeFrom (obeSeg_i->node0 (), edgeNodeMap);
 	WH_MG3D_FaceNode* node1 
-	  = this->findNodeFrom (obeSeg_i->node1 (), edgeNode_s);
+	  = this->findNodeFrom (obeSeg_i->node1 (), edgeNodeMap);
 	
 	/* check the order between two nodes along the curve of <edge> */
 	double param0 
@@ -802,12 +800,14 @@ bool WH_MG3D_FaceMeshGenerator
   
   bool result = false;
   
-  vector<WH_MG3D_FaceNode*> node_s;
+  char buffer[1024];
+  WH_Arena arena (buffer, sizeof (buffer));
+  pmr::vector<WH_MG3D_FaceNode*> node_s (arena.resource ());
   _nodeBucket->getItemsWithin
     (position - WH_Vector2D (range, range), 
      position + WH_Vector2D (range, range), 
      node_s);
-  for (vector<WH_MG3D_FaceNode*>::const_iterator 
+  for (pmr::vector<WH_MG3D_FaceNode*>::const_iterator 
 	 i_node = node_s.begin ();
        i_node != node_s.end ();
        i_node++) {
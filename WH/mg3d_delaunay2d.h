@@ -200,7 +200,7 @@ class WH_MG3D_FaceMeshGenerator {
 
   virtual WH_MG3D_FaceNode* findNodeFrom 
     (WH_MG3D_Node* node3D,
-     const vector<WH_MG3D_FaceNode*>& node_s);
+     const unordered_map<WH_MG3D_Node*, WH_MG3D_FaceNode*>& nodeMap);
 
   virtual void makeBoundarySegment 
     (WH_MG3D_FaceNode* node0, WH_MG3D_FaceNode* node1);
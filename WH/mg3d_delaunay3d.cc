@@ -11,6 +11,10 @@
 #include "inout3d.h"
 #include "triangle3d.h"
 #include "tetrahedron3d.h"
+#include "debug_levels.h"
+#include "context.h"
+
+#include <thread>
 
 
 
@@ -76,6 +80,8 @@ WH_DLN3D_Tetrahedron_MG3D
 {
   _inOutType = UNDEFINED;
   _tetrahedron = WH_NULL;
+  _regionId = -1;
+  _isClearOfBoundary = false;
   
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
@@ -198,6 +204,36 @@ WH_MG3D_Tetrahedron* WH_DLN3D_Tetrahedron_MG3D
   return _tetrahedron;
 }
 
+void WH_DLN3D_Tetrahedron_MG3D
+::clearTetrahedron ()
+{
+  _tetrahedron = WH_NULL;
+}
+
+void WH_DLN3D_Tetrahedron_MG3D
+::setRegionId (int id)
+{
+  _regionId = id;
+}
+
+int WH_DLN3D_Tetrahedron_MG3D
+::regionId () const
+{
+  return _regionId;
+}
+
+void WH_DLN3D_Tetrahedron_MG3D
+::setIsClearOfBoundary (bool flag)
+{
+  _isClearOfBoundary = flag;
+}
+
+bool WH_DLN3D_Tetrahedron_MG3D
+::isClearOfBoundary () const
+{
+  return _isClearOfBoundary;
+}
+
 
 
 /* class WH_DLN3D_FaceTriangle_MG3D */
@@ -340,6 +376,14 @@ WH_DLN3D_Triangulator_MG3D
 
   _meshGenerator = meshGenerator;
   _volume = volume;
+  _inOutClassificationType = RAY_CAST_CLASSIFICATION;
+  _nRayCastTetrahedrons = 0;
+  _nPropagatedTetrahedrons = 0;
+  _nAmbiguousRegions = 0;
+  _nThreads = (int)thread::hardware_concurrency ();
+  if (_nThreads < 1) _nThreads = 1;
+  _nIntersectionChecks = 0;
+  _nBoundaryDivisions = 0;
 
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
@@ -392,6 +436,58 @@ const vector<WH_DLN3D_FaceTriangle_MG3D*>& WH_DLN3D_Triangulator_MG3D
   return _faceTriangle_s;
 }
 
+void WH_DLN3D_Triangulator_MG3D
+::setInOutClassificationType (InOutClassificationType type)
+{
+  _inOutClassificationType = type;
+}
+
+WH_DLN3D_Triangulator_MG3D::InOutClassificationType 
+WH_DLN3D_Triangulator_MG3D
+::inOutClassificationType () const
+{
+  return _inOutClassificationType;
+}
+
+int WH_DLN3D_Triangulator_MG3D
+::nRayCastTetrahedrons () const
+{
+  return _nRayCastTetrahedrons;
+}
+
+int WH_DLN3D_Triangulator_MG3D
+::nPropagatedTetrahedrons () const
+{
+  return _nPropagatedTetrahedrons;
+}
+
+int WH_DLN3D_Triangulator_MG3D
+::nAmbiguousRegions () const
+{
+  return _nAmbiguousRegions;
+}
+
+void WH_DLN3D_Triangulator_MG3D
+::setNumberOfThreads (int n)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < n);
+
+  _nThreads = n;
+}
+
+int WH_DLN3D_Triangulator_MG3D
+::nIntersectionChecks () const
+{
+  return _nIntersectionChecks;
+}
+
+int WH_DLN3D_Triangulator_MG3D
+::nBoundaryDivisions () const
+{
+  return _nBoundaryDivisions;
+}
+
 void WH_DLN3D_Triangulator_MG3D
 ::classifyInOutOfTetrahedronsRoughly ()
 {
@@ -895,13 +991,22 @@ WH_DLN3D_Point_MG3D* WH_DLN3D_Triangulator_MG3D
   return result;
 }
 
-bool WH_DLN3D_Triangulator_MG3D
-::checkIntersection 
-(WH_DLN3D_Tetrahedron_MG3D* tetra)
+WH_DLN3D_Triangulator_MG3D::IntersectionType 
+WH_DLN3D_Triangulator_MG3D
+::findIntersection 
+(WH_DLN3D_Tetrahedron_MG3D* tetra,
+ WH_MG3D_OriginalBoundaryEdgeSegment*& obeSeg_OUT,
+ WH_MG3D_OriginalBoundaryFaceTriangle*& obfTri_OUT,
+ int& edgeOrFace_OUT,
+ WH_Vector3D& intersectionPoint_OUT) const
 {
   /* PRE-CONDITION */
   WH_ASSERT(tetra != WH_NULL);
 
+  obeSeg_OUT = WH_NULL;
+  obfTri_OUT = WH_NULL;
+  edgeOrFace_OUT = WH_NO_INDEX;
+
   WH_Tetrahedron3D shape 
     (tetra->point (0)->position (),
      tetra->point (1)->position (),
@@ -936,42 +1041,21 @@ bool WH_DLN3D_Triangulator_MG3D
 	break;
       case WH_Polygon3D_A::POINT_WITH_SEGMENT:
 	if (!tri.hasVertexAt (intersectionPoint)) {
+	  obeSeg_OUT = obeSeg_i;
+	  intersectionPoint_OUT = intersectionPoint;
 	  for (int e = 0; e < 3; e++) {
 	    if (tri.edge (e).justContains (intersectionPoint)) {
-	      int iEdge = WH_Tetrahedron3D_A::faceEdgeMap[iFace][e];
-
 	      /* the boundary edge intersects at <intersectionPoint>
-                 on edge <iEdge> */
-
-	      WH_DLN3D_Point_MG3D* newPoint = 
-		this->createPointAtIntersectionWithEdge 
-		(obeSeg_i, intersectionPoint);
-	      WH_DLN3D_Point* point0 
-		= tetra->point (WH_Tetrahedron3D_A::edgeVertexMap[iEdge][0]);
-	      WH_DLN3D_Point* point1 
-		= tetra->point (WH_Tetrahedron3D_A::edgeVertexMap[iEdge][1]);
-	      this->divideTetrahedronsIntersectingOnEdge 
-		(newPoint, point0, point1);
-
-	      return true;
+                 on edge <edgeOrFace_OUT> */
+	      edgeOrFace_OUT = WH_Tetrahedron3D_A::faceEdgeMap[iFace][e];
+	      return BOUNDARY_EDGE_ON_EDGE;
 	    }  
 	  }
 
 	  /* the boundary edge intersects at <intersectionPoint>
 	     inside face <iFace> */
-	  WH_DLN3D_Point_MG3D* newPoint = 
-	    this->createPointAtIntersectionWithEdge 
-	    (obeSeg_i, intersectionPoint);
-	  WH_DLN3D_Point* point0 
-	    = tetra->point (WH_Tetrahedron3D_A::faceVertexMap[iFace][0]);
-	  WH_DLN3D_Point* point1 
-	    = tetra->point (WH_Tetrahedron3D_A::faceVertexMap[iFace][1]);
-	  WH_DLN3D_Point* point2 
-	    = tetra->point (WH_Tetrahedron3D_A::faceVertexMap[iFace][2]);
-	  this->divideTetrahedronsIntersectingOnFace 
-	    (newPoint, point0, point1, point2);
-	  
-	  return true;
+	  edgeOrFace_OUT = iFace;
+	  return BOUNDARY_EDGE_ON_FACE;
 	}
 	break;
       case WH_Polygon3D_A::PARALLEL_WITH_SEGMENT:
@@ -982,22 +1066,12 @@ bool WH_DLN3D_Triangulator_MG3D
 	      == WH_Polygon3D_A::EdgeIntersectionData::HAS_INTERSECTION
 	      && edgeData[e].positionType
 	      == WH_Polygon3D_A::EdgeIntersectionData::ON_EDGE) {
-	    intersectionPoint = edgeData[e].intersectionPoint;
-	    int iEdge = WH_Tetrahedron3D_A::faceEdgeMap[iFace][e];
-	    
 	    /* the boundary edge intersects at <intersectionPoint>
-	       on edge <iEdge> */
-	    WH_DLN3D_Point_MG3D* newPoint = 
-	      this->createPointAtIntersectionWithEdge 
-	      (obeSeg_i, intersectionPoint);
-	    WH_DLN3D_Point* point0 
-	      = tetra->point (WH_Tetrahedron3D_A::edgeVertexMap[iEdge][0]);
-	    WH_DLN3D_Point* point1 
-	      = tetra->point (WH_Tetrahedron3D_A::edgeVertexMap[iEdge][1]);
-	    this->divideTetrahedronsIntersectingOnEdge 
-	      (newPoint, point0, point1);
-
-	    return true;
+	       on edge <edgeOrFace_OUT> */
+	    obeSeg_OUT = obeSeg_i;
+	    intersectionPoint_OUT = edgeData[e].intersectionPoint;
+	    edgeOrFace_OUT = WH_Tetrahedron3D_A::faceEdgeMap[iFace][e];
+	    return BOUNDARY_EDGE_ON_EDGE;
 	  }
 	}
 	break;
@@ -1033,59 +1107,308 @@ bool WH_DLN3D_Triangulator_MG3D
       
       if (flag == WH_Polygon3D_A::POINT_WITH_SEGMENT) {
 	if (!segment.hasVertexAt (intersectionPoint)) {
-	  
 	  /* the boundary face intersects at <intersectionPoint> 
 	     on edge <iEdge> */
-	  WH_DLN3D_Point_MG3D* newPoint = 
-	    this->createPointAtIntersectionWithFace 
-	    (obfTri_i, intersectionPoint);
-	  WH_DLN3D_Point* point0 
-	    = tetra->point (WH_Tetrahedron3D_A::edgeVertexMap[iEdge][0]);
-	  WH_DLN3D_Point* point1 
-	    = tetra->point (WH_Tetrahedron3D_A::edgeVertexMap[iEdge][1]);
-	  this->divideTetrahedronsIntersectingOnEdge 
-	    (newPoint, point0, point1);
-	  
-	  return true;
+	  obfTri_OUT = obfTri_i;
+	  intersectionPoint_OUT = intersectionPoint;
+	  edgeOrFace_OUT = iEdge;
+	  return BOUNDARY_FACE_ON_EDGE;
 	}
       }
     }
   }
 
-  return false;
+  return NO_INTERSECTION;
 }
 
 void WH_DLN3D_Triangulator_MG3D
-::divideBoundaryTetrahedrons ()
+::divideAtIntersection 
+(WH_DLN3D_Tetrahedron_MG3D* tetra,
+ IntersectionType type,
+ WH_MG3D_OriginalBoundaryEdgeSegment* obeSeg,
+ WH_MG3D_OriginalBoundaryFaceTriangle* obfTri,
+ int edgeOrFace,
+ const WH_Vector3D& intersectionPoint)
 {
-  for (;;) {
-    bool hasIntersection = false;
+  /* PRE-CONDITION */
+  WH_ASSERT(tetra != WH_NULL);
+  WH_ASSERT(type != NO_INTERSECTION);
 
+  _nBoundaryDivisions++;
+
+  switch (type) {
+  case BOUNDARY_EDGE_ON_EDGE:
+    {
+      WH_ASSERT(obeSeg != WH_NULL);
+      WH_DLN3D_Point_MG3D* newPoint = 
+	this->createPointAtIntersectionWithEdge 
+	(obeSeg, intersectionPoint);
+      WH_DLN3D_Point* point0 
+	= tetra->point (WH_Tetrahedron3D_A::edgeVertexMap[edgeOrFace][0]);
+      WH_DLN3D_Point* point1 
+	= tetra->point (WH_Tetrahedron3D_A::edgeVertexMap[edgeOrFace][1]);
+      this->divideTetrahedronsIntersectingOnEdge 
+	(newPoint, point0, point1);
+    }
+    break;
+  case BOUNDARY_EDGE_ON_FACE:
+    {
+      WH_ASSERT(obeSeg != WH_NULL);
+      WH_DLN3D_Point_MG3D* newPoint = 
+	this->createPointAtIntersectionWithEdge 
+	(obeSeg, intersectionPoint);
+      WH_DLN3D_Point* point0 
+	= tetra->point (WH_Tetrahedron3D_A::faceVertexMap[edgeOrFace][0]);
+      WH_DLN3D_Point* point1 
+	= tetra->point (WH_Tetrahedron3D_A::faceVertexMap[edgeOrFace][1]);
+      WH_DLN3D_Point* point2 
+	= tetra->point (WH_Tetrahedron3D_A::faceVertexMap[edgeOrFace][2]);
+      this->divideTetrahedronsIntersectingOnFace 
+	(newPoint, point0, point1, point2);
+    }
+    break;
+  case BOUNDARY_FACE_ON_EDGE:
+    {
+      WH_ASSERT(obfTri != WH_NULL);
+      WH_DLN3D_Point_MG3D* newPoint = 
+	this->createPointAtIntersectionWithFace 
+	(obfTri, intersectionPoint);
+      WH_DLN3D_Point* point0 
+	= tetra->point (WH_Tetrahedron3D_A::edgeVertexMap[edgeOrFace][0]);
+      WH_DLN3D_Point* point1 
+	= tetra->point (WH_Tetrahedron3D_A::edgeVertexMap[edgeOrFace][1]);
+      this->divideTetrahedronsIntersectingOnEdge 
+	(newPoint, point0, point1);
+    }
+    break;
+  default:
+    WH_ASSERT_NO_REACH;
+    break;
+  }
+}
+
+bool WH_DLN3D_Triangulator_MG3D
+::checkIntersection 
+(WH_DLN3D_Tetrahedron_MG3D* tetra)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(tetra != WH_NULL);
+
+  WH_MG3D_OriginalBoundaryEdgeSegment* obeSeg;
+  WH_MG3D_OriginalBoundaryFaceTriangle* obfTri;
+  int edgeOrFace;
+  WH_Vector3D intersectionPoint;
+  _nIntersectionChecks++;
+  IntersectionType type = this->findIntersection 
+    (tetra, obeSeg, obfTri, edgeOrFace, intersectionPoint);
+  if (type == NO_INTERSECTION) {
+    tetra->setIsClearOfBoundary (true);
+    return false;
+  }
+
+  this->divideAtIntersection 
+    (tetra, type, obeSeg, obfTri, edgeOrFace, intersectionPoint);
+  return true;
+}
+
+void WH_DLN3D_Triangulator_MG3D
+::recoverBoundary ()
+{
+  for (;;) {
+    /* candidates in list order */
+    vector<WH_DLN3D_Tetrahedron_MG3D*> tetra_s;
     for (list<WH_DLN3D_Tetrahedron*>::const_iterator 
 	   i_tetra = _tetrahedron_s.begin ();
 	 i_tetra != _tetrahedron_s.end ();
 	 i_tetra++) {
-      WH_DLN3D_Tetrahedron* tetra_i = (*i_tetra);
       WH_DLN3D_Tetrahedron_MG3D* tetraMg_i 
-	= dynamic_cast<WH_DLN3D_Tetrahedron_MG3D*>(tetra_i);
+	= dynamic_cast<WH_DLN3D_Tetrahedron_MG3D*>(*i_tetra);
       WH_ASSERT(tetraMg_i != WH_NULL);
       
-      if (tetraMg_i->inOutType () == WH_DLN3D_Tetrahedron_MG3D::BOUNDARY
-	  || tetraMg_i->inOutType () == WH_DLN3D_Tetrahedron_MG3D::UNDEFINED) {
-	if (this->checkIntersection (tetraMg_i)) {
-	  hasIntersection = true;
-	  break;
+      if ((tetraMg_i->inOutType () == WH_DLN3D_Tetrahedron_MG3D::BOUNDARY
+	   || tetraMg_i->inOutType () == WH_DLN3D_Tetrahedron_MG3D::UNDEFINED)
+	  && !tetraMg_i->isClearOfBoundary ()) {
+	tetra_s.push_back (tetraMg_i);
+      }
+    }
+
+    int nTetras = (int)tetra_s.size ();
+    if (nTetras == 0) break;
+
+    /* each block is checked up to its first crossing tetrahedron */
+    int nBlocks = WH_min (_nThreads, nTetras / 256 + 1);
+    vector<int> hitIndex_s (nBlocks, WH_NO_INDEX);
+    vector<int> nChecks_s (nBlocks, 0);
+    vector<IntersectionType> type_s (nBlocks, NO_INTERSECTION);
+    vector<WH_MG3D_OriginalBoundaryEdgeSegment*> obeSeg_s (nBlocks);
+    vector<WH_MG3D_OriginalBoundaryFaceTriangle*> obfTri_s (nBlocks);
+    vector<int> edgeOrFace_s (nBlocks);
+    vector<WH_Vector3D> point_s (nBlocks);
+
+    auto checkBlock = [&] (int k) {
+      int begin = (int)((long)nTetras * k / nBlocks);
+      int end = (int)((long)nTetras * (k + 1) / nBlocks);
+      for (int t = begin; t < end; t++) {
+	nChecks_s[k]++;
+	type_s[k] = this->findIntersection 
+	  (tetra_s[t], obeSeg_s[k], obfTri_s[k], 
+	   edgeOrFace_s[k], point_s[k]);
+	if (type_s[k] != NO_INTERSECTION) {
+	  hitIndex_s[k] = t;
+	  return;
 	}
       }
+    };
+
+    /* the workers run under the context of the job */
+    WH_Context context;
+    vector<thread> thread_s;
+    for (int k = 1; k < nBlocks; k++) {
+      thread_s.push_back (thread ([&context, &checkBlock, k] {
+	WH_ContextScope scope (context);
+	checkBlock (k);
+      }));
+    }
+    checkBlock (0);
+    for (vector<thread>::iterator
+	   i_thread = thread_s.begin ();
+	 i_thread != thread_s.end ();
+	 i_thread++) {
+      i_thread->join ();
+    }
+
+    int hitBlock = WH_NO_INDEX;
+    for (int k = 0; k < nBlocks; k++) {
+      _nIntersectionChecks += nChecks_s[k];
+
+      int begin = (int)((long)nTetras * k / nBlocks);
+      int end = (hitIndex_s[k] == WH_NO_INDEX)
+	? (int)((long)nTetras * (k + 1) / nBlocks) : hitIndex_s[k];
+      for (int t = begin; t < end; t++) {
+	tetra_s[t]->setIsClearOfBoundary (true);
+      }
+      if (hitBlock == WH_NO_INDEX && hitIndex_s[k] != WH_NO_INDEX) {
+	hitBlock = k;
+      }
     }
+    if (hitBlock == WH_NO_INDEX) break;
 
-    if (!hasIntersection) break;
+    this->divideAtIntersection 
+      (tetra_s[hitIndex_s[hitBlock]], type_s[hitBlock], 
+       obeSeg_s[hitBlock], obfTri_s[hitBlock], 
+       edgeOrFace_s[hitBlock], point_s[hitBlock]);
   }
 
-  /* <_faceTriangle_s> are no longer valid */
-  WH_T_Delete (_faceTriangle_s);
-  _faceTriangle_s.clear (); 
+  WH_PRINTF_VERBOSE("boundary recovery : %d divisions, %d checks, %d threads",
+		    _nBoundaryDivisions, _nIntersectionChecks, _nThreads);
+}
 
+WH_DLN3D_Tetrahedron_MG3D::InOutType WH_DLN3D_Triangulator_MG3D
+::checkInOutByRayCast 
+(WH_DLN3D_Tetrahedron_MG3D* tetra)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(tetra != WH_NULL);
+
+  _nRayCastTetrahedrons++;
+
+  WH_DLN3D_Tetrahedron_MG3D::InOutType result 
+    = WH_DLN3D_Tetrahedron_MG3D::OUTER;
+
+  /* check in/out at center of gravity */
+  
+  WH_Vector3D p0 = tetra->point (0)->position ();
+  WH_Vector3D p1 = tetra->point (1)->position ();
+  WH_Vector3D p2 = tetra->point (2)->position ();
+  WH_Vector3D p3 = tetra->point (3)->position ();
+  WH_Vector3D center = (p0 + p1 + p2 + p3) / 4;
+  
+  WH_InOutChecker3D::ContainmentType flag 
+    = _meshGenerator->inOutChecker ()->checkContainmentAt (center);
+  switch (flag) {
+  case WH_InOutChecker3D::IN:
+    {
+      /* NEED TO REDEFINE : ???? */
+      
+      WH_Vector3D q0 = center * 0.1 + p0 * 0.9;
+      WH_Vector3D q1 = center * 0.1 + p1 * 0.9;
+      WH_Vector3D q2 = center * 0.1 + p2 * 0.9;
+      WH_Vector3D q3 = center * 0.1 + p3 * 0.9;
+      if (_meshGenerator->inOutChecker ()
+	  ->checkContainmentAt (q0) == WH_InOutChecker3D::IN
+	  && _meshGenerator->inOutChecker ()
+	  ->checkContainmentAt (q1) == WH_InOutChecker3D::IN
+	  && _meshGenerator->inOutChecker ()
+	  ->checkContainmentAt (q2) == WH_InOutChecker3D::IN
+	  && _meshGenerator->inOutChecker ()
+	  ->checkContainmentAt (q3) == WH_InOutChecker3D::IN) {
+	result = WH_DLN3D_Tetrahedron_MG3D::INNER;
+      }
+    }
+    break;
+  case WH_InOutChecker3D::OUT:
+  case WH_InOutChecker3D::ON:
+    break;
+  default:
+    WH_ASSERT_NO_REACH;
+    break;
+  }
+
+  return result;
+}
+
+bool WH_DLN3D_Triangulator_MG3D
+::isOnRecoveredBoundaryFace 
+(WH_DLN3D_Tetrahedron_MG3D* tetra,
+ int faceNumber)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(tetra != WH_NULL);
+  WH_ASSERT(0 <= faceNumber);
+  WH_ASSERT(faceNumber < 4);
+
+  WH_MG3D_Node* node_s[3];
+  WH_Vector3D center (0, 0, 0);
+  for (int k = 0; k < 3; k++) {
+    int v = WH_Tetrahedron3D_A::faceVertexMap[faceNumber][k];
+    if (tetra->point (v)->isDummy ()) return false;
+
+    WH_DLN3D_Point_MG3D* pointMg = tetra->pointMg (v);
+    node_s[k] = pointMg->node ();
+    if (node_s[k] == WH_NULL) return false;
+
+    center += pointMg->position ();
+  }
+  center /= 3;
+
+  WH_TPL3D_Face_A* face 
+    = WH_MG3D_Node::commonFace (node_s[0], node_s[1], node_s[2]);
+  if (face == WH_NULL) return false;
+  if (face->faceType () != WH_TPL3D_Face_A::OUTER_BOUNDARY) return false;
+
+  /* the three nodes may share a face of non-convex shape while the
+     triangle itself lies off the face, so check its center */
+  vector<WH_MG3D_OriginalBoundaryFaceTriangle*> obfTri_s;
+  _meshGenerator->obfTriBucket ()->getItemsOn (center, obfTri_s);
+  for (vector<WH_MG3D_OriginalBoundaryFaceTriangle*>::const_iterator 
+	 i_obfTri = obfTri_s.begin ();
+       i_obfTri != obfTri_s.end ();
+       i_obfTri++) {
+    WH_MG3D_OriginalBoundaryFaceTriangle* obfTri_i = (*i_obfTri);
+    if (obfTri_i->face () != face) continue;
+
+    if (obfTri_i->shape ().checkContainmentAt (center) 
+	!= WH_Polygon3D_A::OUT) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void WH_DLN3D_Triangulator_MG3D
+::classifyInOutByRayCast ()
+{
   for (list<WH_DLN3D_Tetrahedron*>::const_iterator 
 	 i_tetra = _tetrahedron_s.begin ();
        i_tetra != _tetrahedron_s.end ();
@@ -1095,48 +1418,233 @@ void WH_DLN3D_Triangulator_MG3D
       = dynamic_cast<WH_DLN3D_Tetrahedron_MG3D*>(tetra_i);
     WH_ASSERT(tetraMg_i != WH_NULL);
     
-    /* check in/out at center of gravity */
-    
-    WH_Vector3D p0 = tetraMg_i->point (0)->position ();
-    WH_Vector3D p1 = tetraMg_i->point (1)->position ();
-    WH_Vector3D p2 = tetraMg_i->point (2)->position ();
-    WH_Vector3D p3 = tetraMg_i->point (3)->position ();
-    WH_Vector3D center = (p0 + p1 + p2 + p3) / 4;
-    
-    WH_InOutChecker3D::ContainmentType flag 
-      = _meshGenerator->inOutChecker ()->checkContainmentAt (center);
-    switch (flag) {
-    case WH_InOutChecker3D::IN:
-      {
-	/* NEED TO REDEFINE : ???? */
-
-	WH_Vector3D q0 = center * 0.1 + p0 * 0.9;
-	WH_Vector3D q1 = center * 0.1 + p1 * 0.9;
-	WH_Vector3D q2 = center * 0.1 + p2 * 0.9;
-	WH_Vector3D q3 = center * 0.1 + p3 * 0.9;
-	if (_meshGenerator->inOutChecker ()
-	    ->checkContainmentAt (q0) == WH_InOutChecker3D::IN
-	    && _meshGenerator->inOutChecker ()
-	    ->checkContainmentAt (q1) == WH_InOutChecker3D::IN
-	    && _meshGenerator->inOutChecker ()
-	    ->checkContainmentAt (q2) == WH_InOutChecker3D::IN
-	    && _meshGenerator->inOutChecker ()
-	    ->checkContainmentAt (q3) == WH_InOutChecker3D::IN) {
-	  tetraMg_i->setInOutType (WH_DLN3D_Tetrahedron_MG3D::INNER);
-	} else {
-	  tetraMg_i->setInOutType (WH_DLN3D_Tetrahedron_MG3D::OUTER);
+    tetraMg_i->setInOutType (this->checkInOutByRayCast (tetraMg_i));
+  }
+}
+
+void WH_DLN3D_Triangulator_MG3D
+::classifyInOutByPropagation ()
+{
+  /* collect regions, i.e. tetrahedrons connected across faces which
+     are not on the recovered boundary */
+  vector< vector<WH_DLN3D_Tetrahedron_MG3D*> > region_s;
+  for (list<WH_DLN3D_Tetrahedron*>::const_iterator 
+	 i_tetra = _tetrahedron_s.begin ();
+       i_tetra != _tetrahedron_s.end ();
+       i_tetra++) {
+    WH_DLN3D_Tetrahedron_MG3D* tetraMg_i 
+      = dynamic_cast<WH_DLN3D_Tetrahedron_MG3D*>(*i_tetra);
+    WH_ASSERT(tetraMg_i != WH_NULL);
+    tetraMg_i->setRegionId (-1);
+  }
+
+  /* pairs of regions facing each other across the boundary */
+  vector< pair<int, int> > boundaryPair_s;
+  
+  for (list<WH_DLN3D_Tetrahedron*>::const_iterator 
+	 i_tetra = _tetrahedron_s.begin ();
+       i_tetra != _tetrahedron_s.end ();
+       i_tetra++) {
+    WH_DLN3D_Tetrahedron_MG3D* tetraMg_i 
+      = dynamic_cast<WH_DLN3D_Tetrahedron_MG3D*>(*i_tetra);
+    if (tetraMg_i->regionId () != -1) continue;
+
+    int regionId = (int)region_s.size ();
+    region_s.push_back (vector<WH_DLN3D_Tetrahedron_MG3D*> ());
+    vector<WH_DLN3D_Tetrahedron_MG3D*>& member_s = region_s.back ();
+
+    vector<WH_DLN3D_Tetrahedron_MG3D*> stack;
+    tetraMg_i->setRegionId (regionId);
+    stack.push_back (tetraMg_i);
+    while (!stack.empty ()) {
+      WH_DLN3D_Tetrahedron_MG3D* tetra = stack.back ();
+      stack.pop_back ();
+      member_s.push_back (tetra);
+
+      for (int f = 0; f < 4; f++) {
+	WH_DLN3D_Tetrahedron_MG3D* neighborMg 
+	  = (WH_DLN3D_Tetrahedron_MG3D*)tetra->neighborAt (f);
+	if (neighborMg == WH_NULL) continue;
+	if (neighborMg->regionId () != -1) continue;
+	if (this->isOnRecoveredBoundaryFace (tetra, f)) continue;
+
+	neighborMg->setRegionId (regionId);
+	stack.push_back (neighborMg);
+      }
+    }
+  }
+
+  int nRegions = (int)region_s.size ();
+  vector<bool> isAmbiguous_s (nRegions, false);
+
+  for (list<WH_DLN3D_Tetrahedron*>::const_iterator 
+	 i_tetra = _tetrahedron_s.begin ();
+       i_tetra != _tetrahedron_s.end ();
+       i_tetra++) {
+    WH_DLN3D_Tetrahedron_MG3D* tetraMg_i 
+      = dynamic_cast<WH_DLN3D_Tetrahedron_MG3D*>(*i_tetra);
+    for (int f = 0; f < 4; f++) {
+      WH_DLN3D_Tetrahedron_MG3D* neighborMg 
+	= (WH_DLN3D_Tetrahedron_MG3D*)tetraMg_i->neighborAt (f);
+      if (neighborMg == WH_NULL) continue;
+      if (tetraMg_i->regionId () == neighborMg->regionId ()) {
+	/* both sides of a boundary face in the same region means the
+	   boundary is not closed there */
+	if (this->isOnRecoveredBoundaryFace (tetraMg_i, f)) {
+	  isAmbiguous_s[tetraMg_i->regionId ()] = true;
 	}
+      } else if (tetraMg_i->regionId () < neighborMg->regionId ()) {
+	boundaryPair_s.push_back 
+	  (make_pair (tetraMg_i->regionId (), neighborMg->regionId ()));
+      }
+    }
+  }
+
+  vector< vector<int> > adjacentRegion_s (nRegions);
+  for (vector< pair<int, int> >::const_iterator 
+	 i_pair = boundaryPair_s.begin ();
+       i_pair != boundaryPair_s.end ();
+       i_pair++) {
+    adjacentRegion_s[i_pair->first].push_back (i_pair->second);
+    adjacentRegion_s[i_pair->second].push_back (i_pair->first);
+  }
+
+  /* seeds given for free by the nodes : a region touching the dummy
+     box or an OUTSIDE_VOLUME node is outer, a region touching an
+     INSIDE_VOLUME node is inner */
+  vector<bool> hasOuterSeed_s (nRegions, false);
+  vector<bool> hasInnerSeed_s (nRegions, false);
+  for (int r = 0; r < nRegions; r++) {
+    for (vector<WH_DLN3D_Tetrahedron_MG3D*>::const_iterator 
+	   i_tetra = region_s[r].begin ();
+	 i_tetra != region_s[r].end ();
+	 i_tetra++) {
+      WH_DLN3D_Tetrahedron_MG3D* tetra_i = (*i_tetra);
+      if (tetra_i->hasAnyOutsideVolumeNode ()) {
+	hasOuterSeed_s[r] = true;
+      }
+      if (tetra_i->hasAnyInsideVolumeNode ()) {
+	hasInnerSeed_s[r] = true;
+      }
+    }
+    if (hasOuterSeed_s[r] && hasInnerSeed_s[r]) {
+      isAmbiguous_s[r] = true;
+    }
+  }
+
+  /* ray cast one representative per group of regions, flip across
+     every boundary face, and repeat until the result is consistent */
+  vector<WH_DLN3D_Tetrahedron_MG3D::InOutType> type_s (nRegions);
+  for (;;) {
+    for (int r = 0; r < nRegions; r++) {
+      type_s[r] = WH_DLN3D_Tetrahedron_MG3D::UNDEFINED;
+    }
+
+    for (int r = 0; r < nRegions; r++) {
+      if (isAmbiguous_s[r]) continue;
+      if (type_s[r] != WH_DLN3D_Tetrahedron_MG3D::UNDEFINED) continue;
+      
+      type_s[r] = this->checkInOutByRayCast (region_s[r][0]);
+      
+      vector<int> stack;
+      stack.push_back (r);
+      while (!stack.empty ()) {
+	int region = stack.back ();
+	stack.pop_back ();
+	
+	WH_DLN3D_Tetrahedron_MG3D::InOutType flipped 
+	  = (type_s[region] == WH_DLN3D_Tetrahedron_MG3D::INNER)
+	  ? WH_DLN3D_Tetrahedron_MG3D::OUTER
+	  : WH_DLN3D_Tetrahedron_MG3D::INNER;
+	for (vector<int>::const_iterator 
+	       i_adj = adjacentRegion_s[region].begin ();
+	     i_adj != adjacentRegion_s[region].end ();
+	     i_adj++) {
+	  int adj = (*i_adj);
+	  if (isAmbiguous_s[adj]) continue;
+	  if (type_s[adj] != WH_DLN3D_Tetrahedron_MG3D::UNDEFINED) continue;
+	  type_s[adj] = flipped;
+	  stack.push_back (adj);
+	}
+      }
+    }
+
+    bool isConsistent = true;
+    for (int r = 0; r < nRegions; r++) {
+      if (isAmbiguous_s[r]) continue;
+      if ((type_s[r] == WH_DLN3D_Tetrahedron_MG3D::INNER 
+	   && hasOuterSeed_s[r])
+	  || (type_s[r] == WH_DLN3D_Tetrahedron_MG3D::OUTER 
+	      && hasInnerSeed_s[r])) {
+	isAmbiguous_s[r] = true;
+	isConsistent = false;
       }
-      break;
-    case WH_InOutChecker3D::OUT:
-    case WH_InOutChecker3D::ON:
-      tetraMg_i->setInOutType (WH_DLN3D_Tetrahedron_MG3D::OUTER);
-      break;
-    default:
-      WH_ASSERT_NO_REACH;
-      break;
     }
+    for (vector< pair<int, int> >::const_iterator 
+	   i_pair = boundaryPair_s.begin ();
+	 i_pair != boundaryPair_s.end ();
+	 i_pair++) {
+      int r0 = i_pair->first;
+      int r1 = i_pair->second;
+      if (isAmbiguous_s[r0] || isAmbiguous_s[r1]) continue;
+      if (type_s[r0] == type_s[r1]) {
+	isAmbiguous_s[r0] = true;
+	isAmbiguous_s[r1] = true;
+	isConsistent = false;
+      }
+    }
+
+    if (isConsistent) break;
+  }
+
+  /* fall back on ray casts inside ambiguous regions */
+  for (int r = 0; r < nRegions; r++) {
+    if (isAmbiguous_s[r]) {
+      _nAmbiguousRegions++;
+      for (vector<WH_DLN3D_Tetrahedron_MG3D*>::const_iterator 
+	     i_tetra = region_s[r].begin ();
+	   i_tetra != region_s[r].end ();
+	   i_tetra++) {
+	WH_DLN3D_Tetrahedron_MG3D* tetra_i = (*i_tetra);
+	tetra_i->setInOutType (this->checkInOutByRayCast (tetra_i));
+      }
+    } else {
+      for (vector<WH_DLN3D_Tetrahedron_MG3D*>::const_iterator 
+	     i_tetra = region_s[r].begin ();
+	   i_tetra != region_s[r].end ();
+	   i_tetra++) {
+	WH_DLN3D_Tetrahedron_MG3D* tetra_i = (*i_tetra);
+	tetra_i->setInOutType (type_s[r]);
+      }
+      _nPropagatedTetrahedrons += (int)region_s[r].size ();
+    }
+  }
+}
+
+void WH_DLN3D_Triangulator_MG3D
+::divideBoundaryTetrahedrons ()
+{
+  this->recoverBoundary ();
+
+  /* <_faceTriangle_s> are no longer valid */
+  WH_T_Delete (_faceTriangle_s);
+  _faceTriangle_s.clear (); 
+
+  switch (_inOutClassificationType) {
+  case RAY_CAST_CLASSIFICATION:
+    this->classifyInOutByRayCast ();
+    break;
+  case PROPAGATION_CLASSIFICATION:
+    this->classifyInOutByPropagation ();
+    break;
+  default:
+    WH_ASSERT_NO_REACH;
+    break;
   }
+
+  WH_PRINTF_VERBOSE("in/out classification : %d ray cast, %d propagated, %d ambiguous regions",
+		    _nRayCastTetrahedrons, _nPropagatedTetrahedrons, 
+		    _nAmbiguousRegions);
 }
 
 void WH_DLN3D_Triangulator_MG3D
@@ -78,6 +78,20 @@ class WH_DLN3D_Tetrahedron_MG3D : public WH_DLN3D_Tetrahedron {
 
   WH_MG3D_Tetrahedron* tetrahedron () const;
 
+  virtual void clearTetrahedron ();
+  /* when the tetrahedron of the volume mesh is deleted */
+
+  virtual void setRegionId (int id);
+
+  int regionId () const;
+  /* index of the connected region used by in/out propagation, or -1 */
+
+  virtual void setIsClearOfBoundary (bool flag);
+
+  bool isClearOfBoundary () const;
+  /* no original boundary edge or face crosses the tetrahedron.  it
+     remains so while other tetrahedrons are divided */
+
   /* derived */
 
  protected:
@@ -85,6 +99,10 @@ class WH_DLN3D_Tetrahedron_MG3D : public WH_DLN3D_Tetrahedron {
 
   WH_MG3D_Tetrahedron* _tetrahedron;
 
+  int _regionId;
+
+  bool _isClearOfBoundary;
+
   /* base */
 
   /* derived */
@@ -148,6 +166,39 @@ public:
 
   const vector<WH_DLN3D_FaceTriangle_MG3D*>& faceTriangle_s () const;
 
+  enum InOutClassificationType {
+    RAY_CAST_CLASSIFICATION, 
+    PROPAGATION_CLASSIFICATION
+  };
+  virtual void setInOutClassificationType 
+    (InOutClassificationType type);
+
+  InOutClassificationType inOutClassificationType () const;
+  /* RAY_CAST_CLASSIFICATION : ray cast at every tetrahedron (default)
+     PROPAGATION_CLASSIFICATION : ray cast one tetrahedron per region
+     and propagate IN/OUT across recovered boundary faces */
+
+  int nRayCastTetrahedrons () const;
+
+  int nPropagatedTetrahedrons () const;
+
+  int nAmbiguousRegions () const;
+
+  virtual void setNumberOfThreads (int n);
+  /* threads checking tetrahedrons against the original boundary.  the
+     result does not depend on it */
+
+  int nIntersectionChecks () const;
+
+  int nBoundaryDivisions () const;
+
+  enum IntersectionType {
+    NO_INTERSECTION,
+    BOUNDARY_EDGE_ON_EDGE,
+    BOUNDARY_EDGE_ON_FACE,
+    BOUNDARY_FACE_ON_EDGE
+  };
+
   /* derived */
 
 protected:
@@ -157,6 +208,17 @@ protected:
 
   vector<WH_DLN3D_FaceTriangle_MG3D*> _faceTriangle_s;  /* OWN */
 
+  InOutClassificationType _inOutClassificationType;
+
+  int _nRayCastTetrahedrons;
+  int _nPropagatedTetrahedrons;
+  int _nAmbiguousRegions;
+
+  int _nThreads;
+
+  int _nIntersectionChecks;
+  int _nBoundaryDivisions;
+
   /* base */
   virtual void classifyInOutOfTetrahedronsRoughly ();
 
@@ -195,9 +257,42 @@ protected:
     (WH_MG3D_OriginalBoundaryFaceTriangle* obfTri, 
      const WH_Vector3D& intersectionPoint);
   
+  virtual IntersectionType findIntersection 
+    (WH_DLN3D_Tetrahedron_MG3D* tetra,
+     WH_MG3D_OriginalBoundaryEdgeSegment*& obeSeg_OUT,
+     WH_MG3D_OriginalBoundaryFaceTriangle*& obfTri_OUT,
+     int& edgeOrFace_OUT,
+     WH_Vector3D& intersectionPoint_OUT) const;
+  /* does not modify anything, so that it is called concurrently.
+     <edgeOrFace_OUT> is the edge or face number of <tetra> */
+
+  virtual void divideAtIntersection 
+    (WH_DLN3D_Tetrahedron_MG3D* tetra,
+     IntersectionType type,
+     WH_MG3D_OriginalBoundaryEdgeSegment* obeSeg,
+     WH_MG3D_OriginalBoundaryFaceTriangle* obfTri,
+     int edgeOrFace,
+     const WH_Vector3D& intersectionPoint);
+
   virtual bool checkIntersection 
     (WH_DLN3D_Tetrahedron_MG3D* tetra);
+
+  virtual void recoverBoundary ();
+  /* divide tetrahedrons until no original boundary crosses them.
+     tetrahedrons are checked concurrently in contiguous blocks, and
+     the first crossing one in list order is divided each time */
   
+  virtual WH_DLN3D_Tetrahedron_MG3D::InOutType checkInOutByRayCast 
+    (WH_DLN3D_Tetrahedron_MG3D* tetra);
+
+  virtual bool isOnRecoveredBoundaryFace 
+    (WH_DLN3D_Tetrahedron_MG3D* tetra,
+     int faceNumber);
+
+  virtual void classifyInOutByRayCast ();
+
+  virtual void classifyInOutByPropagation ();
+
   virtual void divideBoundaryTetrahedrons ();
 
   /* derived */
@@ -0,0 +1,218 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* mg3d_edge_table.cc : table of nodes on edges of tetrahedrons */
+
+#include "mg3d_edge_table.h"
+#include "context.h"
+
+#include <thread>
+
+
+
+/* class WH_MG3D_EdgeNodeTable */
+
+/* key 0 is never used, since ID of the end nodes of an edge differ */
+static const unsigned long long WH_MG3D_EmptyEdgeKey = 0;
+
+WH_MG3D_EdgeNodeTable
+::WH_MG3D_EdgeNodeTable
+(size_t nExpectedEdges)
+{
+  /* keep the load factor at most 0.5 for <nExpectedEdges>, which also
+     leaves room for the few more edges of a volume with holes */
+  size_t nSlots = 16;
+  while (nSlots < nExpectedEdges * 2) {
+    nSlots *= 2;
+  }
+  _key_s = vector< atomic<unsigned long long> > (nSlots);
+  for (size_t i = 0; i < nSlots; i++) {
+    _key_s[i].store (WH_MG3D_EmptyEdgeKey, memory_order_relaxed);
+  }
+  _node_s.assign (nSlots, (WH_MG3D_Node*)WH_NULL);
+
+  _nEdges = 0;
+  _maxProbeLength = 0;
+  _nThreads = (int)thread::hardware_concurrency ();
+  if (_nThreads < 1) _nThreads = 1;
+}
+
+WH_MG3D_EdgeNodeTable
+::~WH_MG3D_EdgeNodeTable ()
+{
+}
+
+bool WH_MG3D_EdgeNodeTable
+::checkInvariant () const
+{
+  WH_ASSERT(0 < _key_s.size ());
+  WH_ASSERT((_key_s.size () & (_key_s.size () - 1)) == 0);
+  WH_ASSERT(_key_s.size () == _node_s.size ());
+  WH_ASSERT(0 < _nThreads);
+
+  return true;
+}
+
+bool WH_MG3D_EdgeNodeTable
+::assureInvariant () const
+{
+  this->checkInvariant ();
+
+  WH_ASSERT((size_t)_nEdges <= _key_s.size ());
+
+  return true;
+}
+
+unsigned long long WH_MG3D_EdgeNodeTable
+::keyOf (int id0, int id1)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= id0);
+  WH_ASSERT(0 <= id1);
+  WH_ASSERT(id0 != id1);
+
+  unsigned long long minId = (unsigned long long)WH_min (id0, id1);
+  unsigned long long maxId = (unsigned long long)WH_max (id0, id1);
+  return (minId << 32) | maxId;
+}
+
+size_t WH_MG3D_EdgeNodeTable
+::estimateNumberOfEdges 
+(size_t nNodes, size_t nTetrahedrons, size_t nBoundaryFaces)
+{
+  /* V - E + F - T = 1 with F = (4 T + B) / 2, and each hole through
+     the volume adds an edge */
+  return nNodes + nTetrahedrons + nBoundaryFaces / 2;
+}
+
+void WH_MG3D_EdgeNodeTable
+::setNumberOfThreads (int n)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < n);
+
+  _nThreads = n;
+}
+
+size_t WH_MG3D_EdgeNodeTable
+::slotOf (unsigned long long key) const
+{
+  /* Fibonacci hashing */
+  unsigned long long hash = key * 0x9E3779B97F4A7C15ULL;
+  return (size_t)(hash >> 32) & (_key_s.size () - 1);
+}
+
+void WH_MG3D_EdgeNodeTable
+::insert (unsigned long long key)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(key != WH_MG3D_EmptyEdgeKey);
+
+  size_t mask = _key_s.size () - 1;
+  size_t slot = this->slotOf (key);
+  for (int probe = 1; ; probe++) {
+    unsigned long long expected = WH_MG3D_EmptyEdgeKey;
+    if (_key_s[slot].compare_exchange_strong (expected, key)) {
+      _nEdges++;
+    } else if (expected != key) {
+      WH_ASSERT((size_t)probe < _key_s.size ());
+      slot = (slot + 1) & mask;
+      continue;
+    }
+
+    int maxProbe = _maxProbeLength.load ();
+    while (maxProbe < probe
+	   && !_maxProbeLength.compare_exchange_weak (maxProbe, probe)) {
+    }
+    return;
+  }
+}
+
+void WH_MG3D_EdgeNodeTable
+::insertEdgesOf
+(const vector<WH_MG3D_Tetrahedron*>& tetra_s)
+{
+  int nTetras = (int)tetra_s.size ();
+  int nThreads = WH_min (_nThreads, nTetras / 1024 + 1);
+
+  auto insertFrom = [this, &tetra_s, nTetras, nThreads] (int k) {
+    for (int t = k; t < nTetras; t += nThreads) {
+      WH_MG3D_Tetrahedron* tetra_t = tetra_s[t];
+      for (int iEdge = 0;
+	   iEdge < WH_Tetrahedron3D_A::nTetrahedronEdges;
+	   iEdge++) {
+	WH_MG3D_Node* node0 = tetra_t->firstOrderNode
+	  (WH_Tetrahedron3D_A::edgeVertexMap[iEdge][0]);
+	WH_MG3D_Node* node1 = tetra_t->firstOrderNode
+	  (WH_Tetrahedron3D_A::edgeVertexMap[iEdge][1]);
+	this->insert (keyOf (node0->id (), node1->id ()));
+      }
+    }
+  };
+
+  /* the workers run under the context of the job */
+  WH_Context context;
+  vector<thread> thread_s;
+  for (int k = 1; k < nThreads; k++) {
+    thread_s.push_back (thread ([&context, &insertFrom, k] {
+      WH_ContextScope scope (context);
+      insertFrom (k);
+    }));
+  }
+  insertFrom (0);
+  for (vector<thread>::iterator
+	 i_thread = thread_s.begin ();
+       i_thread != thread_s.end ();
+       i_thread++) {
+    i_thread->join ();
+  }
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT((size_t)_nEdges 
+	    <= (size_t)nTetras * WH_Tetrahedron3D_A::nTetrahedronEdges);
+#endif
+}
+
+WH_MG3D_Node*& WH_MG3D_EdgeNodeTable
+::nodeOn (int id0, int id1)
+{
+  unsigned long long key = keyOf (id0, id1);
+
+  size_t mask = _key_s.size () - 1;
+  size_t slot = this->slotOf (key);
+  while (_key_s[slot].load (memory_order_relaxed) != key) {
+    WH_ASSERT(_key_s[slot].load (memory_order_relaxed)
+	      != WH_MG3D_EmptyEdgeKey);
+    slot = (slot + 1) & mask;
+  }
+  return _node_s[slot];
+}
+
+int WH_MG3D_EdgeNodeTable
+::nEdges () const
+{
+  return _nEdges;
+}
+
+size_t WH_MG3D_EdgeNodeTable
+::nSlots () const
+{
+  return _key_s.size ();
+}
+
+size_t WH_MG3D_EdgeNodeTable
+::memorySize () const
+{
+  return _key_s.size () * sizeof (atomic<unsigned long long>)
+    + _node_s.size () * sizeof (WH_MG3D_Node*);
+}
+
+int WH_MG3D_EdgeNodeTable
+::maxProbeLength () const
+{
+  return _maxProbeLength;
+}
@@ -0,0 +1,75 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* header file for mg3d_edge_table.cc */
+
+#pragma once
+#ifndef WH_INCLUDED_WH_MG3D_BASE
+#include <WH/mg3d_base.h>
+#define WH_INCLUDED_WH_MG3D_BASE
+#endif
+
+#include <atomic>
+
+class WH_MG3D_EdgeNodeTable;
+
+class WH_MG3D_EdgeNodeTable {
+ public:
+  WH_MG3D_EdgeNodeTable
+    (size_t nExpectedEdges);
+  virtual ~WH_MG3D_EdgeNodeTable ();
+  virtual bool checkInvariant () const;
+  virtual bool assureInvariant () const;
+
+  /* base */
+  static unsigned long long keyOf (int id0, int id1);
+  /* (min ID, max ID) of the end nodes of an edge */
+
+  static size_t estimateNumberOfEdges 
+    (size_t nNodes, size_t nTetrahedrons, size_t nBoundaryFaces);
+  /* by Euler's formula of a tetrahedral mesh of a ball */
+
+  virtual void setNumberOfThreads (int n);
+
+  virtual void insertEdgesOf
+    (const vector<WH_MG3D_Tetrahedron*>& tetra_s);
+  /* register all the edges of <tetra_s> in parallel.  ID of the first
+     order nodes must be set and unique */
+
+  WH_MG3D_Node*& nodeOn (int id0, int id1);
+  /* slot of the node on the edge, WH_NULL until it is set.  the edge
+     must have been registered */
+
+  int nEdges () const;
+
+  size_t nSlots () const;
+
+  size_t memorySize () const;  /* in bytes */
+
+  int maxProbeLength () const;
+
+  /* derived */
+
+ protected:
+  vector< atomic<unsigned long long> > _key_s;
+
+  vector<WH_MG3D_Node*> _node_s;
+
+  atomic<int> _nEdges;
+
+  atomic<int> _maxProbeLength;
+
+  int _nThreads;
+
+  /* base */
+  virtual size_t slotOf (unsigned long long key) const;
+  /* first slot probed for <key> */
+
+  virtual void insert (unsigned long long key);
+
+  /* derived */
+
+};
@@ -0,0 +1,234 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* mg3d_mesh_snapshot.cc : copy of the final mesh in flat arrays */
+
+#include "mg3d_mesh_snapshot.h"
+#include "mg3d.h"
+
+
+
+/* class WH_MG3D_MeshSnapshot */
+
+WH_MG3D_MeshSnapshot
+::WH_MG3D_MeshSnapshot
+(const WH_MG3D_MeshGenerator* meshGenerator)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(meshGenerator != WH_NULL);
+
+  const vector<WH_MG3D_Node*>& node_s = meshGenerator->node_s ();
+  int nNodes = (int)node_s.size ();
+  _coordinate_s.resize (nNodes * 3);
+  _topologyType_s.resize (nNodes);
+  for (int iNode = 0; iNode < nNodes; iNode++) {
+    WH_MG3D_Node* node_i = node_s[iNode];
+    WH_ASSERT(node_i->id () == iNode);
+
+    WH_Vector3D position = node_i->position ();
+    _coordinate_s[iNode * 3 + 0] = position.x;
+    _coordinate_s[iNode * 3 + 1] = position.y;
+    _coordinate_s[iNode * 3 + 2] = position.z;
+    _topologyType_s[iNode] = (unsigned char)node_i->topologyType ();
+  }
+
+  const vector<WH_MG3D_Tetrahedron*>& tetra_s
+    = meshGenerator->tetrahedron_s ();
+  _nNodesPerTetrahedron = WH_MG3D_Tetrahedron::nFirstOrderNodes
+    + WH_MG3D_Tetrahedron::nSecondOrderNodes;
+  _tetrahedronNode_s.reserve (tetra_s.size () * _nNodesPerTetrahedron);
+  for (vector<WH_MG3D_Tetrahedron*>::const_iterator
+	 i_tetra = tetra_s.begin ();
+       i_tetra != tetra_s.end ();
+       i_tetra++) {
+    WH_MG3D_Tetrahedron* tetra_i = (*i_tetra);
+    for (int iNode = 0;
+	 iNode < WH_MG3D_Tetrahedron::nFirstOrderNodes;
+	 iNode++) {
+      _tetrahedronNode_s.push_back (tetra_i->firstOrderNode (iNode)->id ());
+    }
+    for (int iNode = 0;
+	 iNode < WH_MG3D_Tetrahedron::nSecondOrderNodes;
+	 iNode++) {
+      _tetrahedronNode_s.push_back (tetra_i->secondOrderNode (iNode)->id ());
+    }
+  }
+
+  /* face IDs */
+  unordered_map<WH_TPL3D_Face_A*, int> faceIdMap;
+  const vector<WH_TPL3D_Face_A*>& face_s
+    = meshGenerator->volume ()->face_s ();
+  for (int iFace = 0; iFace < (int)face_s.size (); iFace++) {
+    faceIdMap[face_s[iFace]] = iFace;
+  }
+
+  if (0 < tetra_s.size ()) {
+    const vector<WH_MG3D_FinalBoundaryFaceTriangle*>& fbfTri_s
+      = meshGenerator->fbfTri_s ();
+    _nNodesPerTriangle = WH_MG3D_FinalBoundaryFaceTriangle::nFirstOrderNodes
+      + WH_MG3D_FinalBoundaryFaceTriangle::nSecondOrderNodes;
+    _triangleNode_s.reserve (fbfTri_s.size () * _nNodesPerTriangle);
+    _faceId_s.reserve (fbfTri_s.size ());
+    for (vector<WH_MG3D_FinalBoundaryFaceTriangle*>::const_iterator
+	   i_fbfTri = fbfTri_s.begin ();
+	 i_fbfTri != fbfTri_s.end ();
+	 i_fbfTri++) {
+      WH_MG3D_FinalBoundaryFaceTriangle* fbfTri_i = (*i_fbfTri);
+      for (int iNode = 0;
+	   iNode < WH_MG3D_FinalBoundaryFaceTriangle::nFirstOrderNodes;
+	   iNode++) {
+	_triangleNode_s.push_back
+	  (fbfTri_i->firstOrderNode (iNode)->id ());
+      }
+      for (int iNode = 0;
+	   iNode < WH_MG3D_FinalBoundaryFaceTriangle::nSecondOrderNodes;
+	   iNode++) {
+	_triangleNode_s.push_back
+	  (fbfTri_i->secondOrderNode (iNode)->id ());
+      }
+      unordered_map<WH_TPL3D_Face_A*, int>::const_iterator i_face
+	= faceIdMap.find (fbfTri_i->face ());
+      _faceId_s.push_back 
+	((i_face == faceIdMap.end ()) ? WH_NO_INDEX : i_face->second);
+    }
+  } else {
+    const vector<WH_MG3D_OriginalBoundaryFaceTriangle*>& obfTri_s
+      = meshGenerator->obfTri_s ();
+    _nNodesPerTriangle = 3;
+    _triangleNode_s.reserve (obfTri_s.size () * _nNodesPerTriangle);
+    _faceId_s.reserve (obfTri_s.size ());
+    for (vector<WH_MG3D_OriginalBoundaryFaceTriangle*>::const_iterator
+	   i_obfTri = obfTri_s.begin ();
+	 i_obfTri != obfTri_s.end ();
+	 i_obfTri++) {
+      WH_MG3D_OriginalBoundaryFaceTriangle* obfTri_i = (*i_obfTri);
+      _triangleNode_s.push_back (obfTri_i->node0 ()->id ());
+      _triangleNode_s.push_back (obfTri_i->node1 ()->id ());
+      _triangleNode_s.push_back (obfTri_i->node2 ()->id ());
+      unordered_map<WH_TPL3D_Face_A*, int>::const_iterator i_face
+	= faceIdMap.find (obfTri_i->face ());
+      _faceId_s.push_back 
+	((i_face == faceIdMap.end ()) ? WH_NO_INDEX : i_face->second);
+    }
+  }
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(this->checkInvariant ());
+#endif
+}
+
+WH_MG3D_MeshSnapshot
+::~WH_MG3D_MeshSnapshot ()
+{
+}
+
+bool WH_MG3D_MeshSnapshot
+::checkInvariant () const
+{
+  WH_ASSERT(_coordinate_s.size () == _topologyType_s.size () * 3);
+  WH_ASSERT(0 < _nNodesPerTetrahedron);
+  WH_ASSERT(0 < _nNodesPerTriangle);
+  WH_ASSERT(_tetrahedronNode_s.size () % _nNodesPerTetrahedron == 0);
+  WH_ASSERT(_triangleNode_s.size () % _nNodesPerTriangle == 0);
+  WH_ASSERT(_triangleNode_s.size ()
+	    == _faceId_s.size () * _nNodesPerTriangle);
+
+  return true;
+}
+
+bool WH_MG3D_MeshSnapshot
+::assureInvariant () const
+{
+  this->checkInvariant ();
+
+  for (vector<int32_t>::const_iterator
+	 i_id = _tetrahedronNode_s.begin ();
+       i_id != _tetrahedronNode_s.end ();
+       i_id++) {
+    WH_ASSERT(0 <= (*i_id) && (*i_id) < this->nNodes ());
+  }
+  for (vector<int32_t>::const_iterator
+	 i_id = _triangleNode_s.begin ();
+       i_id != _triangleNode_s.end ();
+       i_id++) {
+    WH_ASSERT(0 <= (*i_id) && (*i_id) < this->nNodes ());
+  }
+
+  return true;
+}
+
+int WH_MG3D_MeshSnapshot
+::nNodes () const
+{
+  return (int)_topologyType_s.size ();
+}
+
+int WH_MG3D_MeshSnapshot
+::nTetrahedrons () const
+{
+  return (int)_tetrahedronNode_s.size () / _nNodesPerTetrahedron;
+}
+
+int WH_MG3D_MeshSnapshot
+::nNodesPerTetrahedron () const
+{
+  return _nNodesPerTetrahedron;
+}
+
+int WH_MG3D_MeshSnapshot
+::nTriangles () const
+{
+  return (int)_faceId_s.size ();
+}
+
+int WH_MG3D_MeshSnapshot
+::nNodesPerTriangle () const
+{
+  return _nNodesPerTriangle;
+}
+
+const double* WH_MG3D_MeshSnapshot
+::coordinates () const
+{
+  return _coordinate_s.data ();
+}
+
+const int32_t* WH_MG3D_MeshSnapshot
+::tetrahedronNodes () const
+{
+  return _tetrahedronNode_s.data ();
+}
+
+const int32_t* WH_MG3D_MeshSnapshot
+::triangleNodes () const
+{
+  return _triangleNode_s.data ();
+}
+
+const unsigned char* WH_MG3D_MeshSnapshot
+::topologyTypes () const
+{
+  return _topologyType_s.data ();
+}
+
+const int32_t* WH_MG3D_MeshSnapshot
+::faceIds () const
+{
+  return _faceId_s.data ();
+}
+
+WH_Vector3D WH_MG3D_MeshSnapshot
+::positionAt (int node) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= node);
+  WH_ASSERT(node < this->nNodes ());
+
+  return WH_Vector3D (_coordinate_s[node * 3 + 0],
+		      _coordinate_s[node * 3 + 1],
+		      _coordinate_s[node * 3 + 2]);
+}
@@ -0,0 +1,90 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* header file for mg3d_mesh_snapshot.cc */
+
+#pragma once
+#ifndef WH_INCLUDED_WH_MG3D_BASE
+#include <WH/mg3d_base.h>
+#define WH_INCLUDED_WH_MG3D_BASE
+#endif
+
+#include <cstdint>
+
+class WH_MG3D_MeshGenerator;
+
+class WH_MG3D_MeshSnapshot;
+
+/* value-based class */
+/* flat arrays of the final mesh indexed by node ID.  they are copied
+   from the mesh generator when it is constructed, and do not follow
+   later changes of it */
+class WH_MG3D_MeshSnapshot {
+ public:
+  WH_MG3D_MeshSnapshot
+    (const WH_MG3D_MeshGenerator* meshGenerator);
+  /* <meshGenerator> must be done.  triangles are the final boundary
+     face triangles of a volume mesh, or the original boundary face
+     triangles of a patch which has no tetrahedron */
+  virtual ~WH_MG3D_MeshSnapshot ();
+  virtual bool checkInvariant () const;
+  virtual bool assureInvariant () const;
+
+  /* base */
+  int nNodes () const;
+
+  int nTetrahedrons () const;
+
+  int nNodesPerTetrahedron () const;
+  /* 10 : 4 vertices, then nodes on edges in the order of
+     WH_Tetrahedron3D_A::edgeVertexMap */
+
+  int nTriangles () const;
+
+  int nNodesPerTriangle () const;
+  /* 6 for a volume mesh (3 vertices, then nodes on edges), 3 for a
+     patch */
+
+  const double* coordinates () const;
+  /* x, y, z of node <i> at 3 * i */
+
+  const int32_t* tetrahedronNodes () const;
+  /* nNodesPerTetrahedron () node IDs for each tetrahedron */
+
+  const int32_t* triangleNodes () const;
+  /* nNodesPerTriangle () node IDs for each triangle */
+
+  const unsigned char* topologyTypes () const;
+  /* WH_MG3D_Node::TopologyType of each node */
+
+  const int32_t* faceIds () const;
+  /* index in volume ()->face_s () of the face of each triangle, or
+     WH_NO_INDEX if it is not on a single face */
+
+  WH_Vector3D positionAt (int node) const;
+
+  /* derived */
+
+ protected:
+  int _nNodesPerTetrahedron;
+
+  int _nNodesPerTriangle;
+
+  vector<double> _coordinate_s;
+
+  vector<int32_t> _tetrahedronNode_s;
+
+  vector<int32_t> _triangleNode_s;
+
+  vector<unsigned char> _topologyType_s;
+
+  vector<int32_t> _faceId_s;
+
+  /* base */
+
+  /* derived */
+
+};
@@ -0,0 +1,899 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* mg3d_optimizer.cc : quality optimization of tetrahedral mesh */
+
+#include "mg3d_optimizer.h"
+#include "bucket3d.h"
+#include "debug_levels.h"
+#include "context.h"
+
+#include <thread>
+
+
+
+/* class WH_MG3D_QualityHistogram */
+
+const int WH_MG3D_QualityHistogram
+::nDihedralAngleBins = 18;
+const int WH_MG3D_QualityHistogram
+::nRadiusRatioBins = 10;
+
+WH_MG3D_QualityHistogram
+::WH_MG3D_QualityHistogram ()
+  : _dihedralAngleCount_s (nDihedralAngleBins, 0),
+    _radiusRatioCount_s (nRadiusRatioBins, 0)
+{
+  _nTetrahedrons = 0;
+  _minDihedralAngle = 180;
+  _maxDihedralAngle = 0;
+  _minRadiusRatio = 1;
+}
+
+WH_MG3D_QualityHistogram
+::~WH_MG3D_QualityHistogram ()
+{
+}
+
+void WH_MG3D_QualityHistogram
+::addTetrahedron
+(const WH_Vector3D& p0,
+ const WH_Vector3D& p1,
+ const WH_Vector3D& p2,
+ const WH_Vector3D& p3)
+{
+  _nTetrahedrons++;
+
+  double angles[6];
+  WH_MG3D_MeshOptimizer::getDihedralAngles (p0, p1, p2, p3, angles);
+  for (int e = 0; e < 6; e++) {
+    int bin = (int)(angles[e] / 10);
+    bin = WH_max (0, WH_min (bin, nDihedralAngleBins - 1));
+    _dihedralAngleCount_s[bin]++;
+    _minDihedralAngle = WH_min (_minDihedralAngle, angles[e]);
+    _maxDihedralAngle = WH_max (_maxDihedralAngle, angles[e]);
+  }
+
+  double ratio = WH_MG3D_MeshOptimizer::radiusRatio (p0, p1, p2, p3);
+  int bin = (int)(ratio * nRadiusRatioBins);
+  bin = WH_max (0, WH_min (bin, nRadiusRatioBins - 1));
+  _radiusRatioCount_s[bin]++;
+  _minRadiusRatio = WH_min (_minRadiusRatio, ratio);
+}
+
+void WH_MG3D_QualityHistogram
+::print (const char* title) const
+{
+  WH_PRINTF_NORMAL("%s : %d tetrahedrons", title, _nTetrahedrons);
+  if (_nTetrahedrons == 0) return;
+
+  WH_PRINTF_NORMAL("  dihedral angle  min %6.2f  max %6.2f",
+		   _minDihedralAngle, _maxDihedralAngle);
+  for (int bin = 0; bin < nDihedralAngleBins; bin++) {
+    WH_PRINTF_NORMAL("    %3d - %3d : %d",
+		     bin * 10, (bin + 1) * 10,
+		     _dihedralAngleCount_s[bin]);
+  }
+
+  WH_PRINTF_NORMAL("  radius ratio  min %6.4f", _minRadiusRatio);
+  for (int bin = 0; bin < nRadiusRatioBins; bin++) {
+    WH_PRINTF_NORMAL("    %3.1f - %3.1f : %d",
+		     (double)bin / nRadiusRatioBins,
+		     (double)(bin + 1) / nRadiusRatioBins,
+		     _radiusRatioCount_s[bin]);
+  }
+}
+
+int WH_MG3D_QualityHistogram
+::nTetrahedrons () const
+{
+  return _nTetrahedrons;
+}
+
+double WH_MG3D_QualityHistogram
+::minDihedralAngle () const
+{
+  return _minDihedralAngle;
+}
+
+double WH_MG3D_QualityHistogram
+::maxDihedralAngle () const
+{
+  return _maxDihedralAngle;
+}
+
+double WH_MG3D_QualityHistogram
+::minRadiusRatio () const
+{
+  return _minRadiusRatio;
+}
+
+
+
+/* class WH_MG3D_MeshOptimizer */
+
+WH_MG3D_MeshOptimizer
+::WH_MG3D_MeshOptimizer
+(const vector<WH_MG3D_Tetrahedron*>& tetra_s)
+{
+  _nIterations = 3;
+  _nThreads = (int)thread::hardware_concurrency ();
+  if (_nThreads < 1) _nThreads = 1;
+  _qualityThreshold = 0.3;
+  _hasChangedConnectivity = false;
+  _nFlips23 = 0;
+  _nFlips32 = 0;
+  _nFlips44 = 0;
+  _nSmoothedNodes = 0;
+
+  /* number the nodes of <tetra_s> */
+  unordered_map<WH_MG3D_Node*, int> nodeIndexMap;
+  for (vector<WH_MG3D_Tetrahedron*>::const_iterator
+	 i_tetra = tetra_s.begin ();
+       i_tetra != tetra_s.end ();
+       i_tetra++) {
+    WH_MG3D_Tetrahedron* tetra_i = (*i_tetra);
+
+    int nodeIndexs[4];
+    for (int v = 0; v < 4; v++) {
+      WH_MG3D_Node* node = tetra_i->firstOrderNode (v);
+      unordered_map<WH_MG3D_Node*, int>::const_iterator
+	i_index = nodeIndexMap.find (node);
+      if (i_index == nodeIndexMap.end ()) {
+	int index = (int)_node_s.size ();
+	nodeIndexMap[node] = index;
+	_node_s.push_back (node);
+	_position_s.push_back (node->position ());
+	_isMovable_s.push_back
+	  (node->topologyType () == WH_MG3D_Node::INSIDE_VOLUME);
+	_nodeTetra_s.push_back (vector<int> ());
+	nodeIndexs[v] = index;
+      } else {
+	nodeIndexs[v] = i_index->second;
+      }
+    }
+
+    /* keep every tetrahedron positively oriented */
+    if (this->signedVolumeOf (nodeIndexs[0], nodeIndexs[1],
+			      nodeIndexs[2], nodeIndexs[3]) < 0) {
+      swap (nodeIndexs[2], nodeIndexs[3]);
+    }
+    this->addTetrahedron (nodeIndexs[0], nodeIndexs[1],
+			  nodeIndexs[2], nodeIndexs[3]);
+  }
+
+  this->numberAliveTetrahedrons ();
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(this->checkInvariant ());
+#endif
+}
+
+WH_MG3D_MeshOptimizer
+::~WH_MG3D_MeshOptimizer ()
+{
+}
+
+bool WH_MG3D_MeshOptimizer
+::checkInvariant () const
+{
+  WH_ASSERT(_tetraNode_s.size () == _isAlive_s.size () * 4);
+  WH_ASSERT(_position_s.size () == _node_s.size ());
+  WH_ASSERT(_isMovable_s.size () == _node_s.size ());
+  WH_ASSERT(_nodeTetra_s.size () == _node_s.size ());
+  WH_ASSERT(0 < _nThreads);
+
+  return true;
+}
+
+bool WH_MG3D_MeshOptimizer
+::assureInvariant () const
+{
+  this->checkInvariant ();
+
+#ifndef NDEBUG
+  for (int t = 0; t < (int)_isAlive_s.size (); t++) {
+    if (!_isAlive_s[t]) continue;
+    for (int v = 0; v < 4; v++) {
+      const vector<int>& tetra_s = _nodeTetra_s[_tetraNode_s[t * 4 + v]];
+      WH_ASSERT(find (tetra_s.begin (), tetra_s.end (), t)
+		!= tetra_s.end ());
+    }
+  }
+#endif
+
+  return true;
+}
+
+double WH_MG3D_MeshOptimizer
+::radiusRatio
+(const WH_Vector3D& p0,
+ const WH_Vector3D& p1,
+ const WH_Vector3D& p2,
+ const WH_Vector3D& p3)
+{
+  WH_Vector3D a = p1 - p0;
+  WH_Vector3D b = p2 - p0;
+  WH_Vector3D c = p3 - p0;
+
+  WH_Vector3D bc = WH_vectorProduct (b, c);
+  WH_Vector3D ca = WH_vectorProduct (c, a);
+  WH_Vector3D ab = WH_vectorProduct (a, b);
+  double det = fabs (WH_scalarProduct (a, bc));
+  if (det == 0) return 0;
+
+  WH_Vector3D offset
+    = (bc * WH_scalarProduct (a, a)
+       + ca * WH_scalarProduct (b, b)
+       + ab * WH_scalarProduct (c, c)) / (2 * det);
+  double circumRadius = offset.length ();
+
+  double area
+    = (bc.length () + ca.length () + ab.length ()
+       + WH_vectorProduct (p2 - p1, p3 - p1).length ()) / 2;
+  double inRadius = (det / 2) / area;  /* 3 * volume / area */
+
+  return 3 * inRadius / circumRadius;
+}
+
+void WH_MG3D_MeshOptimizer
+::getDihedralAngles
+(const WH_Vector3D& p0,
+ const WH_Vector3D& p1,
+ const WH_Vector3D& p2,
+ const WH_Vector3D& p3,
+ double angles_OUT[6])
+{
+  const WH_Vector3D p[4] = { p0, p1, p2, p3 };
+
+  for (int e = 0; e < 6; e++) {
+    int i = WH_Tetrahedron3D_A::edgeVertexMap[e][0];
+    int j = WH_Tetrahedron3D_A::edgeVertexMap[e][1];
+    int k = 0;
+    while (k == i || k == j) k++;
+    int l = 6 - i - j - k;
+
+    /* angle between the two faces sharing edge <i, j>, measured
+       perpendicular to the edge */
+    WH_Vector3D axis = p[j] - p[i];
+    double axisLength = axis.length ();
+    if (axisLength == 0) {
+      angles_OUT[e] = 0;
+      continue;
+    }
+    axis = axis / axisLength;
+    WH_Vector3D u = p[k] - p[i];
+    WH_Vector3D v = p[l] - p[i];
+    u = u - axis * WH_scalarProduct (axis, u);
+    v = v - axis * WH_scalarProduct (axis, v);
+    double uv = u.length () * v.length ();
+    if (uv == 0) {
+      angles_OUT[e] = 0;
+      continue;
+    }
+    double cosine = WH_scalarProduct (u, v) / uv;
+    cosine = WH_max (-1.0, WH_min (1.0, cosine));
+    angles_OUT[e] = acos (cosine) * 180 / M_PI;
+  }
+}
+
+void WH_MG3D_MeshOptimizer
+::setNumberOfIterations (int n)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= n);
+
+  _nIterations = n;
+}
+
+void WH_MG3D_MeshOptimizer
+::setNumberOfThreads (int n)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < n);
+
+  _nThreads = n;
+}
+
+void WH_MG3D_MeshOptimizer
+::setQualityThreshold (double radiusRatio)
+{
+  _qualityThreshold = radiusRatio;
+}
+
+double WH_MG3D_MeshOptimizer
+::signedVolumeOf (int n0, int n1, int n2, int n3) const
+{
+  WH_Vector3D p0 = _position_s[n0];
+  return WH_scalarProduct
+    (_position_s[n1] - p0,
+     WH_vectorProduct (_position_s[n2] - p0, _position_s[n3] - p0)) / 6;
+}
+
+double WH_MG3D_MeshOptimizer
+::qualityOf (int n0, int n1, int n2, int n3) const
+{
+  /* inverted tetrahedrons are worse than any valid one */
+  if (this->signedVolumeOf (n0, n1, n2, n3) <= 0) return -1;
+
+  return radiusRatio
+    (_position_s[n0], _position_s[n1],
+     _position_s[n2], _position_s[n3]);
+}
+
+double WH_MG3D_MeshOptimizer
+::qualityOf (int tetra) const
+{
+  const int* n = &_tetraNode_s[tetra * 4];
+  return this->qualityOf (n[0], n[1], n[2], n[3]);
+}
+
+bool WH_MG3D_MeshOptimizer
+::hasNode (int tetra, int node) const
+{
+  const int* n = &_tetraNode_s[tetra * 4];
+  return n[0] == node || n[1] == node || n[2] == node || n[3] == node;
+}
+
+int WH_MG3D_MeshOptimizer
+::addTetrahedron (int n0, int n1, int n2, int n3)
+{
+  int result = (int)_isAlive_s.size ();
+  _tetraNode_s.push_back (n0);
+  _tetraNode_s.push_back (n1);
+  _tetraNode_s.push_back (n2);
+  _tetraNode_s.push_back (n3);
+  _isAlive_s.push_back (true);
+  _nodeTetra_s[n0].push_back (result);
+  _nodeTetra_s[n1].push_back (result);
+  _nodeTetra_s[n2].push_back (result);
+  _nodeTetra_s[n3].push_back (result);
+  return result;
+}
+
+void WH_MG3D_MeshOptimizer
+::removeTetrahedron (int tetra)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(_isAlive_s[tetra]);
+
+  /* <_nodeTetra_s> is cleaned up by purgeDeadTetrahedrons () */
+  _isAlive_s[tetra] = false;
+}
+
+void WH_MG3D_MeshOptimizer
+::purgeDeadTetrahedrons ()
+{
+  for (int node = 0; node < (int)_nodeTetra_s.size (); node++) {
+    vector<int>& tetra_s = _nodeTetra_s[node];
+    int n = 0;
+    for (int i = 0; i < (int)tetra_s.size (); i++) {
+      if (_isAlive_s[tetra_s[i]]) {
+	tetra_s[n++] = tetra_s[i];
+      }
+    }
+    tetra_s.resize (n);
+  }
+}
+
+int WH_MG3D_MeshOptimizer
+::neighborAcross (int tetra, int face) const
+{
+  const int* n = &_tetraNode_s[tetra * 4];
+  int a = n[WH_Tetrahedron3D_A::faceVertexMap[face][0]];
+  int b = n[WH_Tetrahedron3D_A::faceVertexMap[face][1]];
+  int c = n[WH_Tetrahedron3D_A::faceVertexMap[face][2]];
+
+  const vector<int>& tetra_s = _nodeTetra_s[a];
+  for (vector<int>::const_iterator
+	 i_tetra = tetra_s.begin ();
+       i_tetra != tetra_s.end ();
+       i_tetra++) {
+    int tetra_i = (*i_tetra);
+    if (tetra_i == tetra || !_isAlive_s[tetra_i]) continue;
+    if (this->hasNode (tetra_i, b) && this->hasNode (tetra_i, c)) {
+      return tetra_i;
+    }
+  }
+  return -1;
+}
+
+bool WH_MG3D_MeshOptimizer
+::isOnTopologicalEntity (int n0, int n1) const
+{
+  return WH_MG3D_Node::commonEdge (_node_s[n0], _node_s[n1]) != WH_NULL
+    || WH_MG3D_Node::commonFace (_node_s[n0], _node_s[n1]) != WH_NULL;
+}
+
+bool WH_MG3D_MeshOptimizer
+::isOnTopologicalEntity (int n0, int n1, int n2) const
+{
+  return WH_MG3D_Node::commonFace
+    (_node_s[n0], _node_s[n1], _node_s[n2]) != WH_NULL;
+}
+
+bool WH_MG3D_MeshOptimizer
+::replaceTetrahedrons
+(const vector<int>& oldTetra_s,
+ const vector<int>& newNode_s)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < oldTetra_s.size ());
+  WH_ASSERT(newNode_s.size () % 4 == 0);
+
+  double oldVolume = 0;
+  double oldQuality = 1;
+  for (vector<int>::const_iterator
+	 i_tetra = oldTetra_s.begin ();
+       i_tetra != oldTetra_s.end ();
+       i_tetra++) {
+    const int* n = &_tetraNode_s[(*i_tetra) * 4];
+    oldVolume += fabs (this->signedVolumeOf (n[0], n[1], n[2], n[3]));
+    oldQuality = WH_min (oldQuality, this->qualityOf (*i_tetra));
+  }
+
+  /* the new tetrahedrons must fill exactly the same polyhedron,
+     without any of them degenerate, and be better than the old */
+  vector<int> node_s = newNode_s;
+  double newVolume = 0;
+  double newQuality = 1;
+  for (int i = 0; i < (int)node_s.size (); i += 4) {
+    double volume
+      = this->signedVolumeOf (node_s[i], node_s[i + 1],
+			      node_s[i + 2], node_s[i + 3]);
+    if (volume < 0) {
+      swap (node_s[i + 2], node_s[i + 3]);
+      volume = -volume;
+    }
+    if (volume <= oldVolume * 1e-9) return false;
+    newVolume += volume;
+
+    newQuality = WH_min
+      (newQuality,
+       this->qualityOf (node_s[i], node_s[i + 1],
+			node_s[i + 2], node_s[i + 3]));
+  }
+  if (oldVolume * 1e-9 < fabs (newVolume - oldVolume)) return false;
+  if (newQuality <= oldQuality + 1e-6) return false;
+
+  for (vector<int>::const_iterator
+	 i_tetra = oldTetra_s.begin ();
+       i_tetra != oldTetra_s.end ();
+       i_tetra++) {
+    this->removeTetrahedron (*i_tetra);
+  }
+  for (int i = 0; i < (int)node_s.size (); i += 4) {
+    this->addTetrahedron
+      (node_s[i], node_s[i + 1], node_s[i + 2], node_s[i + 3]);
+  }
+  _hasChangedConnectivity = true;
+
+  return true;
+}
+
+bool WH_MG3D_MeshOptimizer
+::tryFlip23 (int tetra, int face)
+{
+  int neighbor = this->neighborAcross (tetra, face);
+  if (neighbor < 0) return false;
+
+  const int* n = &_tetraNode_s[tetra * 4];
+  int a = n[WH_Tetrahedron3D_A::faceVertexMap[face][0]];
+  int b = n[WH_Tetrahedron3D_A::faceVertexMap[face][1]];
+  int c = n[WH_Tetrahedron3D_A::faceVertexMap[face][2]];
+  if (this->isOnTopologicalEntity (a, b, c)) return false;
+
+  int apex = -1;
+  for (int v = 0; v < 4; v++) {
+    int node = _tetraNode_s[neighbor * 4 + v];
+    if (node != a && node != b && node != c) {
+      apex = node;
+      break;
+    }
+  }
+  WH_ASSERT(0 <= apex);
+
+  /* replace each vertex of the common face by the apex of
+     <neighbor> in turn */
+  vector<int> newNode_s;
+  for (int k = 0; k < 3; k++) {
+    int vertex = WH_Tetrahedron3D_A::faceVertexMap[face][k];
+    for (int v = 0; v < 4; v++) {
+      newNode_s.push_back (v == vertex ? apex : n[v]);
+    }
+  }
+
+  vector<int> oldTetra_s;
+  oldTetra_s.push_back (tetra);
+  oldTetra_s.push_back (neighbor);
+  if (this->replaceTetrahedrons (oldTetra_s, newNode_s)) {
+    _nFlips23++;
+    return true;
+  }
+  return false;
+}
+
+bool WH_MG3D_MeshOptimizer
+::tryEdgeRemoval (int tetra, int edge)
+{
+  int u = _tetraNode_s[tetra * 4 + WH_Tetrahedron3D_A::edgeVertexMap[edge][0]];
+  int v = _tetraNode_s[tetra * 4 + WH_Tetrahedron3D_A::edgeVertexMap[edge][1]];
+  if (this->isOnTopologicalEntity (u, v)) return false;
+
+  /* tetrahedrons around edge <u, v> and their opposite edges */
+  vector<int> ring_s;
+  vector< pair<int, int> > opposite_s;
+  const vector<int>& tetra_s = _nodeTetra_s[u];
+  for (vector<int>::const_iterator
+	 i_tetra = tetra_s.begin ();
+       i_tetra != tetra_s.end ();
+       i_tetra++) {
+    int tetra_i = (*i_tetra);
+    if (!_isAlive_s[tetra_i] || !this->hasNode (tetra_i, v)) continue;
+    if (4 < ring_s.size ()) return false;
+
+    ring_s.push_back (tetra_i);
+    int other[2];
+    int nOthers = 0;
+    for (int k = 0; k < 4; k++) {
+      int node = _tetraNode_s[tetra_i * 4 + k];
+      if (node != u && node != v) other[nOthers++] = node;
+    }
+    opposite_s.push_back (make_pair (other[0], other[1]));
+  }
+  int nRing = (int)ring_s.size ();
+  if (nRing != 3 && nRing != 4) return false;
+
+  /* order the opposite edges into a closed polygon; an open one means
+     <u, v> is on the boundary */
+  vector<int> polygon_s;
+  vector<bool> isUsed_s (nRing, false);
+  polygon_s.push_back (opposite_s[0].first);
+  int current = opposite_s[0].second;
+  isUsed_s[0] = true;
+  for (int i = 1; i < nRing; i++) {
+    polygon_s.push_back (current);
+    int next = -1;
+    for (int j = 0; j < nRing; j++) {
+      if (isUsed_s[j]) continue;
+      if (opposite_s[j].first == current) {
+	next = opposite_s[j].second;
+      } else if (opposite_s[j].second == current) {
+	next = opposite_s[j].first;
+      } else {
+	continue;
+      }
+      isUsed_s[j] = true;
+      break;
+    }
+    if (next < 0) return false;
+    current = next;
+  }
+  if (current != polygon_s[0]) return false;
+
+  if (nRing == 3) {
+    /* 3-2 flip */
+    vector<int> newNode_s;
+    int tri[3] = { polygon_s[0], polygon_s[1], polygon_s[2] };
+    for (int k = 0; k < 3; k++) newNode_s.push_back (tri[k]);
+    newNode_s.push_back (u);
+    for (int k = 0; k < 3; k++) newNode_s.push_back (tri[k]);
+    newNode_s.push_back (v);
+    if (this->replaceTetrahedrons (ring_s, newNode_s)) {
+      _nFlips32++;
+      return true;
+    }
+    return false;
+  }
+
+  /* 4-4 flip : split the polygon along one of its diagonals, trying
+     the better one first */
+  vector<int> candidate_s[2];
+  double candidateQuality[2];
+  for (int d = 0; d < 2; d++) {
+    int p0 = polygon_s[d];
+    int p1 = polygon_s[d + 1];
+    int p2 = polygon_s[d + 2];
+    int p3 = polygon_s[(d + 3) % 4];
+    int tri[2][3] = { { p0, p1, p2 }, { p0, p2, p3 } };
+    candidateQuality[d] = 1;
+    for (int t = 0; t < 2; t++) {
+      for (int apex = 0; apex < 2; apex++) {
+	int n[4] = { tri[t][0], tri[t][1], tri[t][2], apex == 0 ? u : v };
+	if (this->signedVolumeOf (n[0], n[1], n[2], n[3]) < 0) {
+	  swap (n[2], n[3]);
+	}
+	candidateQuality[d] = WH_min
+	  (candidateQuality[d], this->qualityOf (n[0], n[1], n[2], n[3]));
+	for (int k = 0; k < 4; k++) candidate_s[d].push_back (n[k]);
+      }
+    }
+  }
+  int first = (candidateQuality[0] < candidateQuality[1]) ? 1 : 0;
+  for (int i = 0; i < 2; i++) {
+    int d = (first + i) % 2;
+    if (this->replaceTetrahedrons (ring_s, candidate_s[d])) {
+      _nFlips44++;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WH_MG3D_MeshOptimizer
+::doFlips ()
+{
+  /* tetrahedrons created here are visited in the next iteration */
+  int nTetras = (int)_isAlive_s.size ();
+  for (int t = 0; t < nTetras; t++) {
+    if (!_isAlive_s[t]) continue;
+    if (_qualityThreshold <= this->qualityOf (t)) continue;
+
+    bool isFlipped = false;
+    for (int e = 0; e < 6 && !isFlipped; e++) {
+      isFlipped = this->tryEdgeRemoval (t, e);
+    }
+    for (int f = 0; f < 4 && !isFlipped; f++) {
+      isFlipped = this->tryFlip23 (t, f);
+    }
+  }
+  this->purgeDeadTetrahedrons ();
+}
+
+bool WH_MG3D_MeshOptimizer
+::smoothNode (int node)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(_isMovable_s[node]);
+
+  const vector<int>& tetra_s = _nodeTetra_s[node];
+  if (tetra_s.size () == 0) return false;
+
+  /* move toward the center of the adjacent nodes */
+  WH_Vector3D sum (0, 0, 0);
+  int nAdjacents = 0;
+  double oldQuality = 1;
+  for (vector<int>::const_iterator
+	 i_tetra = tetra_s.begin ();
+       i_tetra != tetra_s.end ();
+       i_tetra++) {
+    int tetra_i = (*i_tetra);
+    oldQuality = WH_min (oldQuality, this->qualityOf (tetra_i));
+    for (int v = 0; v < 4; v++) {
+      int other = _tetraNode_s[tetra_i * 4 + v];
+      if (other == node) continue;
+      sum += _position_s[other];
+      nAdjacents++;
+    }
+  }
+  WH_Vector3D oldPosition = _position_s[node];
+  WH_Vector3D target = sum / nAdjacents;
+
+  /* accept only if the worst adjacent tetrahedron gets better */
+  for (int trial = 0; trial < 2; trial++) {
+    _position_s[node] = (trial == 0)
+      ? target : (oldPosition + target) / 2;
+
+    double newQuality = 1;
+    for (vector<int>::const_iterator
+	   i_tetra = tetra_s.begin ();
+	 i_tetra != tetra_s.end ();
+	 i_tetra++) {
+      newQuality = WH_min (newQuality, this->qualityOf (*i_tetra));
+      if (newQuality <= oldQuality) break;
+    }
+    if (oldQuality + 1e-6 < newQuality) return true;
+  }
+  _position_s[node] = oldPosition;
+  return false;
+}
+
+void WH_MG3D_MeshOptimizer
+::doSmoothing ()
+{
+  /* greedy colouring of movable nodes so that no two nodes of the
+     same colour share a tetrahedron; nodes of one colour are
+     independent and smoothed in parallel */
+  int nNodes = (int)_node_s.size ();
+
+  /* a node on a face without neighbor is on the boundary of the mesh
+     even if it is INSIDE_VOLUME, and moving it changes the volume */
+  vector<bool> isOnMeshBoundary_s (nNodes, false);
+  for (int t = 0; t < (int)_isAlive_s.size (); t++) {
+    if (!_isAlive_s[t]) continue;
+    for (int f = 0; f < 4; f++) {
+      if (0 <= this->neighborAcross (t, f)) continue;
+      for (int k = 0; k < 3; k++) {
+	int v = WH_Tetrahedron3D_A::faceVertexMap[f][k];
+	isOnMeshBoundary_s[_tetraNode_s[t * 4 + v]] = true;
+      }
+    }
+  }
+
+  vector<int> colour_s (nNodes, -1);
+  vector< vector<int> > colourNode_s;
+  vector<int> usedColourMark_s;
+  for (int node = 0; node < nNodes; node++) {
+    if (!_isMovable_s[node] || isOnMeshBoundary_s[node]) continue;
+
+    usedColourMark_s.assign (colourNode_s.size () + 1, 0);
+    const vector<int>& tetra_s = _nodeTetra_s[node];
+    for (vector<int>::const_iterator
+	   i_tetra = tetra_s.begin ();
+	 i_tetra != tetra_s.end ();
+	 i_tetra++) {
+      for (int v = 0; v < 4; v++) {
+	int other = _tetraNode_s[(*i_tetra) * 4 + v];
+	if (0 <= colour_s[other]) usedColourMark_s[colour_s[other]] = 1;
+      }
+    }
+    int colour = 0;
+    while (usedColourMark_s[colour]) colour++;
+    if (colour == (int)colourNode_s.size ()) {
+      colourNode_s.push_back (vector<int> ());
+    }
+    colour_s[node] = colour;
+    colourNode_s[colour].push_back (node);
+  }
+
+  for (vector< vector<int> >::const_iterator
+	 i_colour = colourNode_s.begin ();
+       i_colour != colourNode_s.end ();
+       i_colour++) {
+    const vector<int>& node_s = (*i_colour);
+    int nThreads = WH_min (_nThreads, (int)node_s.size () / 64 + 1);
+
+    /* the workers run under the context of the job */
+    WH_Context context;
+    vector<int> nSmoothed_s (nThreads, 0);
+    vector<thread> thread_s;
+    for (int k = 1; k < nThreads; k++) {
+      thread_s.push_back (thread ([this, &context, &node_s, &nSmoothed_s, 
+				   k, nThreads] {
+	WH_ContextScope scope (context);
+	for (int i = k; i < (int)node_s.size (); i += nThreads) {
+	  if (this->smoothNode (node_s[i])) nSmoothed_s[k]++;
+	}
+      }));
+    }
+    for (int i = 0; i < (int)node_s.size (); i += nThreads) {
+      if (this->smoothNode (node_s[i])) nSmoothed_s[0]++;
+    }
+    for (vector<thread>::iterator
+	   i_thread = thread_s.begin ();
+	 i_thread != thread_s.end ();
+	 i_thread++) {
+      i_thread->join ();
+    }
+    for (int k = 0; k < nThreads; k++) {
+      _nSmoothedNodes += nSmoothed_s[k];
+    }
+  }
+}
+
+void WH_MG3D_MeshOptimizer
+::numberAliveTetrahedrons ()
+{
+  _aliveIndex_s.assign (_isAlive_s.size (), -1);
+  _aliveTetra_s.clear ();
+  for (int t = 0; t < (int)_isAlive_s.size (); t++) {
+    if (_isAlive_s[t]) {
+      _aliveIndex_s[t] = (int)_aliveTetra_s.size ();
+      _aliveTetra_s.push_back (t);
+    }
+  }
+}
+
+void WH_MG3D_MeshOptimizer
+::perform ()
+{
+  for (int iter = 0; iter < _nIterations; iter++) {
+    int nChanges = _nFlips23 + _nFlips32 + _nFlips44 + _nSmoothedNodes;
+
+    this->doFlips ();
+    this->doSmoothing ();
+
+    WH_PRINTF_VERBOSE("optimization %d : flips 2-3 %d, 3-2 %d, 4-4 %d, smoothed %d",
+		      iter, _nFlips23, _nFlips32, _nFlips44, _nSmoothedNodes);
+
+    if (nChanges
+	== _nFlips23 + _nFlips32 + _nFlips44 + _nSmoothedNodes) break;
+  }
+
+  this->numberAliveTetrahedrons ();
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(this->assureInvariant ());
+#endif
+}
+
+void WH_MG3D_MeshOptimizer
+::getQualityHistogram
+(WH_MG3D_QualityHistogram& histogram_OUT) const
+{
+  for (int t = 0; t < (int)_isAlive_s.size (); t++) {
+    if (!_isAlive_s[t]) continue;
+    const int* n = &_tetraNode_s[t * 4];
+    histogram_OUT.addTetrahedron
+      (_position_s[n[0]], _position_s[n[1]],
+       _position_s[n[2]], _position_s[n[3]]);
+  }
+}
+
+void WH_MG3D_MeshOptimizer
+::updateNodePositions 
+(WH_Bucket3D<WH_MG3D_Node>* nodeBucket)
+{
+  for (int node = 0; node < (int)_node_s.size (); node++) {
+    if (!_isMovable_s[node]) continue;
+
+    WH_MG3D_Node* nodeAt = _node_s[node];
+    if (WH_eq (nodeAt->position (), _position_s[node])) continue;
+
+    if (nodeBucket != WH_NULL) {
+      nodeBucket->removeItemFromLastOn (nodeAt->position (), nodeAt);
+      nodeBucket->addItemLastOn (_position_s[node], nodeAt);
+    }
+    nodeAt->setPosition (_position_s[node]);
+  }
+}
+
+bool WH_MG3D_MeshOptimizer
+::hasChangedConnectivity () const
+{
+  return _hasChangedConnectivity;
+}
+
+int WH_MG3D_MeshOptimizer
+::nTetrahedrons () const
+{
+  return (int)_aliveTetra_s.size ();
+}
+
+void WH_MG3D_MeshOptimizer
+::getTetrahedron
+(int index,
+ WH_MG3D_Node* node_OUT[4],
+ int neighborIndex_OUT[4]) const
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= index);
+  WH_ASSERT(index < this->nTetrahedrons ());
+
+  int tetra = _aliveTetra_s[index];
+
+  for (int v = 0; v < 4; v++) {
+    node_OUT[v] = _node_s[_tetraNode_s[tetra * 4 + v]];
+    int neighbor = this->neighborAcross (tetra, v);
+    neighborIndex_OUT[v] = (neighbor < 0) ? -1 : _aliveIndex_s[neighbor];
+  }
+}
+
+int WH_MG3D_MeshOptimizer
+::nFlips23 () const
+{
+  return _nFlips23;
+}
+
+int WH_MG3D_MeshOptimizer
+::nFlips32 () const
+{
+  return _nFlips32;
+}
+
+int WH_MG3D_MeshOptimizer
+::nFlips44 () const
+{
+  return _nFlips44;
+}
+
+int WH_MG3D_MeshOptimizer
+::nSmoothedNodes () const
+{
+  return _nSmoothedNodes;
+}
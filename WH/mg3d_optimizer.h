@@ -0,0 +1,196 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ All Rights Reserved
+ *********************************************************************/
+
+/* header file for mg3d_optimizer.cc */
+
+#pragma once
+#ifndef WH_INCLUDED_WH_MG3D_BASE
+#include <WH/mg3d_base.h>
+#define WH_INCLUDED_WH_MG3D_BASE
+#endif
+
+template <class Type> class WH_Bucket3D;
+
+class WH_MG3D_QualityHistogram;
+class WH_MG3D_MeshOptimizer;
+
+class WH_MG3D_QualityHistogram {
+ public:
+  WH_MG3D_QualityHistogram ();
+  virtual ~WH_MG3D_QualityHistogram ();
+
+  /* base */
+  static const int nDihedralAngleBins;  /* 10 degrees each */
+  static const int nRadiusRatioBins;  /* 0.1 each */
+
+  virtual void addTetrahedron
+    (const WH_Vector3D& p0,
+     const WH_Vector3D& p1,
+     const WH_Vector3D& p2,
+     const WH_Vector3D& p3);
+
+  virtual void print (const char* title) const;
+  /* printed at WH_DEBUG_NORMAL and above */
+
+  int nTetrahedrons () const;
+
+  double minDihedralAngle () const;  /* in degrees */
+  double maxDihedralAngle () const;  /* in degrees */
+  double minRadiusRatio () const;
+
+  /* derived */
+
+ protected:
+  int _nTetrahedrons;
+
+  vector<int> _dihedralAngleCount_s;
+
+  vector<int> _radiusRatioCount_s;
+
+  double _minDihedralAngle;
+  double _maxDihedralAngle;
+  double _minRadiusRatio;
+
+  /* base */
+
+  /* derived */
+
+};
+
+class WH_MG3D_MeshOptimizer {
+ public:
+  WH_MG3D_MeshOptimizer
+    (const vector<WH_MG3D_Tetrahedron*>& tetra_s);
+  virtual ~WH_MG3D_MeshOptimizer ();
+  virtual bool checkInvariant () const;
+  virtual bool assureInvariant () const;
+
+  /* base */
+  static double radiusRatio
+    (const WH_Vector3D& p0,
+     const WH_Vector3D& p1,
+     const WH_Vector3D& p2,
+     const WH_Vector3D& p3);
+  /* 3 * inradius / circumradius : 1 for the regular tetrahedron,
+     0 for a degenerate one */
+
+  static void getDihedralAngles
+    (const WH_Vector3D& p0,
+     const WH_Vector3D& p1,
+     const WH_Vector3D& p2,
+     const WH_Vector3D& p3,
+     double angles_OUT[6]);
+  /* in degrees, at the edges of WH_Tetrahedron3D_A::edgeVertexMap */
+
+  virtual void setNumberOfIterations (int n);
+
+  virtual void setNumberOfThreads (int n);
+
+  virtual void setQualityThreshold (double radiusRatio);
+  /* tetrahedrons below <radiusRatio> are the targets of flips */
+
+  virtual void perform ();
+  /* 2-3, 3-2 and 4-4 flips on interior faces and edges followed by
+     smoothing of INSIDE_VOLUME nodes, repeated <numberOfIterations>
+     times.  Nodes are not moved until updateNodePositions () */
+
+  virtual void getQualityHistogram
+    (WH_MG3D_QualityHistogram& histogram_OUT) const;
+
+  virtual void updateNodePositions 
+    (WH_Bucket3D<WH_MG3D_Node>* nodeBucket);
+  /* moved nodes are also moved in <nodeBucket> unless it is WH_NULL */
+
+  bool hasChangedConnectivity () const;
+
+  int nTetrahedrons () const;
+  /* alive tetrahedrons, numbered from 0 in the order of
+     getTetrahedron () */
+
+  virtual void getTetrahedron
+    (int index,
+     WH_MG3D_Node* node_OUT[4],
+     int neighborIndex_OUT[4]) const;
+  /* <neighborIndex_OUT[f]> is across the face opposite to node <f>,
+     -1 on the boundary */
+
+  int nFlips23 () const;
+  int nFlips32 () const;
+  int nFlips44 () const;
+  int nSmoothedNodes () const;
+
+  /* derived */
+
+ protected:
+  vector<WH_MG3D_Node*> _node_s;
+
+  vector<WH_Vector3D> _position_s;
+
+  vector<bool> _isMovable_s;
+
+  vector<int> _tetraNode_s;  /* 4 node indices per tetrahedron */
+
+  vector<bool> _isAlive_s;
+
+  vector< vector<int> > _nodeTetra_s;  /* may hold dead ones */
+
+  vector<int> _aliveIndex_s;  /* tetrahedron -> numbered index */
+
+  vector<int> _aliveTetra_s;  /* numbered index -> tetrahedron */
+
+  int _nIterations;
+
+  int _nThreads;
+
+  double _qualityThreshold;
+
+  bool _hasChangedConnectivity;
+
+  int _nFlips23;
+  int _nFlips32;
+  int _nFlips44;
+  int _nSmoothedNodes;
+
+  /* base */
+  virtual double qualityOf (int tetra) const;
+
+  virtual double qualityOf (int n0, int n1, int n2, int n3) const;
+
+  virtual double signedVolumeOf (int n0, int n1, int n2, int n3) const;
+
+  virtual bool hasNode (int tetra, int node) const;
+
+  virtual int addTetrahedron (int n0, int n1, int n2, int n3);
+
+  virtual void removeTetrahedron (int tetra);
+
+  virtual void purgeDeadTetrahedrons ();
+
+  virtual int neighborAcross (int tetra, int face) const;
+
+  virtual bool isOnTopologicalEntity (int n0, int n1) const;
+
+  virtual bool isOnTopologicalEntity (int n0, int n1, int n2) const;
+
+  virtual bool replaceTetrahedrons
+    (const vector<int>& oldTetra_s,
+     const vector<int>& newNode_s);
+
+  virtual bool tryFlip23 (int tetra, int face);
+
+  virtual bool tryEdgeRemoval (int tetra, int edge);
+
+  virtual void doFlips ();
+
+  virtual bool smoothNode (int node);
+
+  virtual void doSmoothing ();
+
+  virtual void numberAliveTetrahedrons ();
+
+  /* derived */
+
+};
@@ -1094,8 +1094,8 @@ WH_Polygon2D
 {
   WH_CVR_LINE;
 
-  _nVertexs = 3;
-  _vertexs = new WH_Vector2D[_nVertexs];
+  _vertexs = WH_NULL;
+  this->allocateVertexs (3);
   _vertexs[0] = WH_Vector2D (0, 0);
   _vertexs[1] = WH_Vector2D (1, 0);
   _vertexs[2] = WH_Vector2D (0, 1);
@@ -1116,9 +1116,8 @@ WH_Polygon2D
   
   WH_CVR_LINE;
 
-  _nVertexs = nVertexs;
-  _vertexs = new WH_Vector2D[_nVertexs];
-  WH_ASSERT(_vertexs != WH_NULL);
+  _vertexs = WH_NULL;
+  this->allocateVertexs (nVertexs);
   for (int iVertex = 0; 
        iVertex < _nVertexs; 
        iVertex++) {
@@ -1140,9 +1139,8 @@ WH_Polygon2D
 
   WH_CVR_LINE;
   
-  _nVertexs = (int)vertex_s.size ();
-  _vertexs = new WH_Vector2D[_nVertexs];
-  WH_ASSERT(_vertexs != WH_NULL);
+  _vertexs = WH_NULL;
+  this->allocateVertexs ((int)vertex_s.size ());
   for (int iVertex = 0; 
        iVertex < _nVertexs; 
        iVertex++) {
@@ -1161,9 +1159,8 @@ WH_Polygon2D
 {
   WH_CVR_LINE;
 
-  _nVertexs = polygon._nVertexs;
-  _vertexs = new WH_Vector2D[_nVertexs];
-  WH_ASSERT(_vertexs != WH_NULL);
+  _vertexs = WH_NULL;
+  this->allocateVertexs (polygon._nVertexs);
   for (int iVertex = 0; 
        iVertex < _nVertexs; 
        iVertex++) {
@@ -1183,7 +1180,18 @@ WH_Polygon2D
   WH_CVR_LINE;
 
   _nVertexs = polygon._nVertexs;
-  _vertexs = polygon._vertexs;
+  if (polygon._vertexs == polygon._inlineVertexs) {
+    WH_CVR_LINE;
+    _vertexs = _inlineVertexs;
+    for (int iVertex = 0; 
+	 iVertex < _nVertexs; 
+	 iVertex++) {
+      _inlineVertexs[iVertex] = polygon._inlineVertexs[iVertex];
+    }
+  } else {
+    WH_CVR_LINE;
+    _vertexs = polygon._vertexs;
+  }
 
   // Reset moved-from object
   polygon._nVertexs = 0;
@@ -1195,19 +1203,17 @@ WH_Polygon2D
 {
   WH_CVR_LINE;
 
-  delete[] _vertexs;
+  this->freeVertexs ();
 }
 
 const WH_Polygon2D& WH_Polygon2D
 ::operator= (const WH_Polygon2D& polygon)
 {
   WH_CVR_LINE;
+
   if (this != &polygon) {
     WH_CVR_LINE;
-    delete[] _vertexs;
-    _nVertexs = polygon._nVertexs;
-    _vertexs = new WH_Vector2D[_nVertexs];
-    WH_ASSERT(_vertexs != WH_NULL);
+    this->allocateVertexs (polygon._nVertexs);
     for (int iVertex = 0; 
 	 iVertex < _nVertexs; 
 	 iVertex++) {
@@ -1229,10 +1235,20 @@ WH_Polygon2D& WH_Polygon2D
   WH_CVR_LINE;
 
   if (this != &polygon) {
-    delete[] _vertexs;
-    
-    _nVertexs = polygon._nVertexs;
-    _vertexs = polygon._vertexs;
+    if (polygon._vertexs == polygon._inlineVertexs) {
+      WH_CVR_LINE;
+      this->allocateVertexs (polygon._nVertexs);
+      for (int iVertex = 0; 
+	   iVertex < _nVertexs; 
+	   iVertex++) {
+	_vertexs[iVertex] = polygon._inlineVertexs[iVertex];
+      }
+    } else {
+      WH_CVR_LINE;
+      this->freeVertexs ();
+      _nVertexs = polygon._nVertexs;
+      _vertexs = polygon._vertexs;
+    }
 
     // Reset moved-from object
     polygon._nVertexs = 0;
@@ -1242,6 +1258,45 @@ WH_Polygon2D& WH_Polygon2D
   return *this;
 }
 
+void WH_Polygon2D
+::allocateVertexs (int nVertexs)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= nVertexs);
+
+  bool canReuse = (_vertexs == _inlineVertexs) 
+    ? (nVertexs <= N_INLINE_VERTEXS) 
+    : (_vertexs != WH_NULL && _nVertexs == nVertexs);
+  if (canReuse) {
+    WH_CVR_LINE;
+    _nVertexs = nVertexs;
+    return;
+  }
+
+  this->freeVertexs ();
+  _nVertexs = nVertexs;
+  if (nVertexs <= N_INLINE_VERTEXS) {
+    WH_CVR_LINE;
+    _vertexs = _inlineVertexs;
+  } else {
+    WH_CVR_LINE;
+    _vertexs = new WH_Vector2D[nVertexs];
+    WH_ASSERT(_vertexs != WH_NULL);
+  }
+}
+
+void WH_Polygon2D
+::freeVertexs ()
+{
+  WH_CVR_LINE;
+
+  if (_vertexs != _inlineVertexs) {
+    WH_CVR_LINE;
+    delete[] _vertexs;
+  }
+  _vertexs = WH_NULL;
+}
+
 bool WH_Polygon2D
 ::checkInvariant () const
 {
@@ -1281,6 +1336,12 @@ ostream& operator<< (ostream& out, const WH_Polygon2D& polygon)
   return out;
 }
 
+const WH_Vector2D* WH_Polygon2D
+::vertexs () const
+{
+  return _vertexs;
+}
+
 int WH_Polygon2D
 ::nVertexs () const
 {
@@ -111,6 +111,15 @@ class WH_Polygon2D : public WH_Polygon2D_A {
   friend ostream& operator<< (ostream& out, const WH_Polygon2D& polygon);
 
   /* base */
+  enum {
+    N_INLINE_VERTEXS = 8
+  };
+  /* polygons of up to N_INLINE_VERTEXS vertices, which are most of
+     the facets, are stored without any heap allocation */
+
+  const WH_Vector2D* vertexs () const;
+  /* contiguous array of nVertexs () vertices, valid until this is
+     modified or destructed */
 
   /* derived */
 
@@ -120,10 +129,16 @@ class WH_Polygon2D : public WH_Polygon2D_A {
 
  protected:
   int _nVertexs;
-  WH_Vector2D* _vertexs;   /* OWN */
+  WH_Vector2D* _vertexs;   /* OWN unless it is <_inlineVertexs> */
   /* WH_Vector2D _vertexs[_nVertexs] */
+
+  WH_Vector2D _inlineVertexs[N_INLINE_VERTEXS];
   
   /* base */
+  void allocateVertexs (int nVertexs);
+  /* make <_vertexs> of <nVertexs> vertices */
+
+  void freeVertexs ();
   
   /* derived */
   
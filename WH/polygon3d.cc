@@ -1206,8 +1206,8 @@ WH_Polygon3D
 {
   WH_CVR_LINE;
 
-  _nVertexs = 3;
-  _vertexs = new WH_Vector3D[_nVertexs];
+  _vertexs = WH_NULL;
+  this->allocateVertexs (3);
   _vertexs[0] = WH_Vector3D (0, 0, 0);
   _vertexs[1] = WH_Vector3D (1, 0, 0);
   _vertexs[2] = WH_Vector3D (0, 1, 0);
@@ -1231,9 +1231,8 @@ WH_Polygon3D
   
   WH_CVR_LINE;
 
-  _nVertexs = nVertexs;
-  _vertexs = new WH_Vector3D[_nVertexs];
-  WH_ASSERT(_vertexs != WH_NULL);
+  _vertexs = WH_NULL;
+  this->allocateVertexs (nVertexs);
   for (int iVertex = 0; 
        iVertex < _nVertexs; 
        iVertex++) {
@@ -1264,9 +1263,8 @@ WH_Polygon3D
 
   WH_CVR_LINE;
   
-  _nVertexs = (int)vertex_s.size ();
-  _vertexs = new WH_Vector3D[_nVertexs];
-  WH_ASSERT(_vertexs != WH_NULL);
+  _vertexs = WH_NULL;
+  this->allocateVertexs ((int)vertex_s.size ());
   for (int iVertex = 0; 
        iVertex < _nVertexs; 
        iVertex++) {
@@ -1294,9 +1292,8 @@ WH_Polygon3D
 {
   WH_CVR_LINE;
 
-  _nVertexs = polygon._nVertexs;
-  _vertexs = new WH_Vector3D[_nVertexs];
-  WH_ASSERT(_vertexs != WH_NULL);
+  _vertexs = WH_NULL;
+  this->allocateVertexs (polygon._nVertexs);
   for (int iVertex = 0; 
        iVertex < _nVertexs; 
        iVertex++) {
@@ -1319,7 +1316,19 @@ WH_Polygon3D
   WH_CVR_LINE;
 
   _nVertexs = polygon._nVertexs;
-  _vertexs = polygon._vertexs;
+  if (polygon._vertexs == polygon._inlineVertexs) {
+    WH_CVR_LINE;
+    _vertexs = _inlineVertexs;
+    for (int iVertex = 0; 
+	 iVertex < _nVertexs; 
+	 iVertex++) {
+      _inlineVertexs[iVertex] = polygon._inlineVertexs[iVertex];
+    }
+  } else {
+    WH_CVR_LINE;
+    _vertexs = polygon._vertexs;
+  }
+
   _planeExists = polygon._planeExists;
   _plane = polygon._plane;
 
@@ -1334,7 +1343,7 @@ WH_Polygon3D
 {
   WH_CVR_LINE;
 
-  delete[] _vertexs;
+  this->freeVertexs ();
 }
 
 const WH_Polygon3D& WH_Polygon3D
@@ -1343,10 +1352,8 @@ const WH_Polygon3D& WH_Polygon3D
   WH_CVR_LINE;
 
   if (this != &polygon) {
-    delete[] _vertexs;
-    _nVertexs = polygon._nVertexs;
-    _vertexs = new WH_Vector3D[_nVertexs];
-    WH_ASSERT(_vertexs != WH_NULL);
+    WH_CVR_LINE;
+    this->allocateVertexs (polygon._nVertexs);
     for (int iVertex = 0; 
 	 iVertex < _nVertexs; 
 	 iVertex++) {
@@ -1371,10 +1378,21 @@ WH_Polygon3D& WH_Polygon3D
   WH_CVR_LINE;
 
   if (this != &polygon) {
-    delete[] _vertexs;
-    
-    _nVertexs = polygon._nVertexs;
-    _vertexs = polygon._vertexs;
+    if (polygon._vertexs == polygon._inlineVertexs) {
+      WH_CVR_LINE;
+      this->allocateVertexs (polygon._nVertexs);
+      for (int iVertex = 0; 
+	   iVertex < _nVertexs; 
+	   iVertex++) {
+	_vertexs[iVertex] = polygon._inlineVertexs[iVertex];
+      }
+    } else {
+      WH_CVR_LINE;
+      this->freeVertexs ();
+      _nVertexs = polygon._nVertexs;
+      _vertexs = polygon._vertexs;
+    }
+
     _planeExists = polygon._planeExists;
     _plane = polygon._plane;
 
@@ -1387,6 +1405,45 @@ WH_Polygon3D& WH_Polygon3D
   return *this;
 }
 
+void WH_Polygon3D
+::allocateVertexs (int nVertexs)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 <= nVertexs);
+
+  bool canReuse = (_vertexs == _inlineVertexs) 
+    ? (nVertexs <= N_INLINE_VERTEXS) 
+    : (_vertexs != WH_NULL && _nVertexs == nVertexs);
+  if (canReuse) {
+    WH_CVR_LINE;
+    _nVertexs = nVertexs;
+    return;
+  }
+
+  this->freeVertexs ();
+  _nVertexs = nVertexs;
+  if (nVertexs <= N_INLINE_VERTEXS) {
+    WH_CVR_LINE;
+    _vertexs = _inlineVertexs;
+  } else {
+    WH_CVR_LINE;
+    _vertexs = new WH_Vector3D[nVertexs];
+    WH_ASSERT(_vertexs != WH_NULL);
+  }
+}
+
+void WH_Polygon3D
+::freeVertexs ()
+{
+  WH_CVR_LINE;
+
+  if (_vertexs != _inlineVertexs) {
+    WH_CVR_LINE;
+    delete[] _vertexs;
+  }
+  _vertexs = WH_NULL;
+}
+
 bool WH_Polygon3D
 ::checkInvariant () const
 {
@@ -1426,6 +1483,12 @@ ostream& operator<< (ostream& out, const WH_Polygon3D& polygon)
   return out;
 }
 
+const WH_Vector3D* WH_Polygon3D
+::vertexs () const
+{
+  return _vertexs;
+}
+
 int WH_Polygon3D
 ::nVertexs () const
 {
@@ -147,6 +147,15 @@ class WH_Polygon3D : public WH_Polygon3D_A {
   friend ostream& operator<< (ostream& out, const WH_Polygon3D& polygon);
 
   /* base */
+  enum {
+    N_INLINE_VERTEXS = 8
+  };
+  /* polygons of up to N_INLINE_VERTEXS vertices, which are most of
+     the facets, are stored without any heap allocation */
+
+  const WH_Vector3D* vertexs () const;
+  /* contiguous array of nVertexs () vertices, valid until this is
+     modified or destructed */
 
   /* derived */
 
@@ -159,13 +168,19 @@ class WH_Polygon3D : public WH_Polygon3D_A {
 
  protected:
   int _nVertexs;
-  WH_Vector3D* _vertexs;   /* OWN */
+  WH_Vector3D* _vertexs;   /* OWN unless it is <_inlineVertexs> */
   /* WH_Vector3D _vertexs[_nVertexs] */
+
+  WH_Vector3D _inlineVertexs[N_INLINE_VERTEXS];
   
   bool _planeExists;
   WH_Plane3D _plane;
 
   /* base */
+  void allocateVertexs (int nVertexs);
+  /* make <_vertexs> of <nVertexs> vertices */
+
+  void freeVertexs ();
   
   /* derived */
   
@@ -6,9 +6,46 @@
 #include "triangle2d.h"
 #include "debug_levels.h"
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <fstream>
 
+namespace {
+
+int sign_of(double value) {
+    return (value > 0) - (value < 0);
+}
+
+// exact sign of orient2d(a, b, c), positive if counterclockwise
+int orientation(const WH_DLN2D_Point* a, const WH_DLN2D_Point* b, const WH_DLN2D_Point* c) {
+    return sign_of(WH_RobustPredicates::orient2d_robust(
+        a->position(), b->position(), c->position()));
+}
+
+int vertex_index(const WH_DLN2D_Triangle* tri, const WH_DLN2D_Point* point) {
+    for (int v = 0; v < 3; v++) {
+        if (tri->point(v) == point) return v;
+    }
+    return WH_NO_INDEX;
+}
+
+// index of the vertex of <tri> other than <point0> and <point1>
+int third_vertex_index(const WH_DLN2D_Triangle* tri,
+                       const WH_DLN2D_Point* point0, const WH_DLN2D_Point* point1) {
+    for (int v = 0; v < 3; v++) {
+        if (tri->point(v) != point0 && tri->point(v) != point1) return v;
+    }
+    return WH_NO_INDEX;
+}
+
+void link_neighbors(WH_DLN2D_Triangle* tri, int edgeNumber, WH_DLN2D_Triangle* neighbor) {
+    if (neighbor == WH_NULL) return;
+    tri->setNeighborAt(edgeNumber, neighbor);
+    neighbor->setNeighborAt(neighbor->edgeNumberOfNeighbor(tri), tri);
+}
+
+}  // namespace
+
 WH_RobustCDT_Triangulator::WH_RobustCDT_Triangulator() : WH_CDLN2D_Triangulator() {
     _stats = TriangulationStats();
 }
@@ -22,57 +59,73 @@ void WH_RobustCDT_Triangulator::perform() {
     WH_ASSERT(3 <= _point_s.size());
     WH_ASSERT(3 <= _boundarySegment_s.size());
 
-    if (_debugFaceId >= 0) {
-        WH_PRINTF_NORMAL("Starting robust triangulation for face %d", _debugFaceId);
-        dumpTriangulationState("PRE_TRIANGULATION");
-    }
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
 
-    // Select triangulation strategy based on geometry
-    TriangulationStrategy strategy = selectStrategy();
-    
+    // One pass: exact incremental Delaunay triangulation, recovery of the
+    // missing constraints by edge flipping, and flood fill of the domains.
+    // The fallback is only for a face this pass cannot handle.
     bool success = false;
-    switch (strategy) {
-        case STANDARD_CDT:
-            // Try standard approach first
-            try {
-                this->WH_DLN2D_Triangulator::perform();
-                this->setUpBoundarySegmentBucket();
-                this->fitBoundary();
-                this->identifyDomain();
-                
-                // CRITICAL: Remove dummy triangles before validation
-                removeDummyTriangles();
-                
-                success = validateTriangulation();
-            } catch (...) {
-                std::cerr << "WARNING: Standard CDT failed, trying robust recovery" << std::endl;
-                success = false;
-            }
-            break;
-            
-        case ROBUST_CDT_WITH_RECOVERY:
-            success = performFallbackTriangulation();
-            break;
-            
-        default:
-            success = performFallbackTriangulation();
-            break;
+    try {
+        this->WH_DLN2D_Triangulator::perform();
+        this->setUpBoundarySegmentBucket();
+        this->fitBoundary();
+        this->identifyDomain();
+        removeDummyTriangles();
+        success = validateTriangulation();
+        _stats.usedExactPredicates = true;
+    } catch (...) {
+        std::cerr << "WARNING: Robust CDT failed, trying fallback triangulation" << std::endl;
+        success = false;
     }
-    
+
     if (!success) {
-        _stats.failureReason = "All triangulation strategies failed";
+        _stats.failureReason = "Constrained Delaunay triangulation failed";
         if (_debugFaceId >= 0) {
-            std::cerr << "ERROR: All triangulation strategies failed for face " << _debugFaceId << std::endl;
+            std::cerr << "ERROR: Constrained Delaunay triangulation failed for face " << _debugFaceId << std::endl;
             dumpTriangulationState("FAILED");
         }
-        // Throw exception or use simple fan as last resort
-        WH_ASSERT(!"Triangulation failed completely");
+        if (!performFallbackTriangulation()) {
+            _stats.failureReason = "All triangulation strategies failed";
+            WH_ASSERT(!"Triangulation failed completely");
+        }
     }
-    
-    if (_debugFaceId >= 0) {
-        dumpTriangulationState("POST_TRIANGULATION");
-        WH_PRINTF_NORMAL("Triangulation completed for face %d - mixed triangles: %s", _debugFaceId, (hasMixedTriangles() ? "YES" : "NO"));
+
+    _stats.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - startTime).count();
+    WH_PRINTF_VERBOSE("Robust CDT: %zu points, %zu constraints, %d recovered by %d flips, %d failed, %.3f ms",
+                      _point_s.size(), _boundarySegment_s.size(),
+                      _stats.constraintsRecovered, _stats.edgeFlips,
+                      _stats.constraintsFailed, _stats.seconds * 1000.0);
+}
+
+WH_DLN2D_Triangle* WH_RobustCDT_Triangulator::pickUpFirstTriangle() const {
+    // Walk from the most recently created triangle toward <_currentPoint>.
+    // The triangle containing the point is always within its own circle,
+    // and consecutive points are usually close, so the walk is short
+    // where the scan of the base class visits every triangle.
+    WH_DLN2D_Triangle* tri = _triangle_s.front();
+    for (size_t step = 0; step < _triangle_s.size(); step++) {
+        int triOrientation = orientation(tri->point(0), tri->point(1), tri->point(2));
+        if (triOrientation == 0) break;
+
+        WH_DLN2D_Triangle* next = WH_NULL;
+        bool isOutside = false;
+        for (int e = 0; e < 3; e++) {
+            WH_DLN2D_Point* point0 = tri->point(WH_Triangle2D_A::edgeVertexMap[e][0]);
+            WH_DLN2D_Point* point1 = tri->point(WH_Triangle2D_A::edgeVertexMap[e][1]);
+            if (orientation(point0, point1, _currentPoint) == -triOrientation) {
+                next = tri->neighborAt(e);
+                isOutside = (next == WH_NULL);
+                break;
+            }
+        }
+        if (isOutside) break;
+        if (next == WH_NULL) return tri;
+        tri = next;
     }
+
+    // flat triangles or points beyond the dummy points
+    return this->WH_CDLN2D_Triangulator::pickUpFirstTriangle();
 }
 
 void WH_RobustCDT_Triangulator::fitBoundary() {
@@ -83,7 +136,20 @@ void WH_RobustCDT_Triangulator::fitBoundary() {
         WH_PRINTF_VERBOSE("Starting constraint recovery for %zu constraints", _boundarySegment_s.size());
     }
 
-    // First pass: mark existing constraints
+    // Recover the constraints missing from the Delaunay triangulation
+    this->mapIncidentTriangles();
+    for (vector<WH_CDLN2D_BoundarySegment*>::const_iterator i_seg = _boundarySegment_s.begin();
+         i_seg != _boundarySegment_s.end(); i_seg++) {
+        WH_CDLN2D_BoundarySegment* seg_i = (*i_seg);
+        if (!recoverConstraintSegment_robust(seg_i)) {
+            _stats.constraintsFailed++;
+            std::cerr << "WARNING: Failed to recover constraint ["
+                      << seg_i->point0()->id() << "," << seg_i->point1()->id() << "]" << std::endl;
+        }
+    }
+    _incidentTriangle.clear();
+
+    // Set domain ID based on which side of constraint the triangle is on
     for (list<WH_DLN2D_Triangle*>::const_iterator i_tri = _triangle_s.begin();
          i_tri != _triangle_s.end(); i_tri++) {
         WH_CDLN2D_Triangle* tri_i = (WH_CDLN2D_Triangle*)(*i_tri);
@@ -93,21 +159,8 @@ void WH_RobustCDT_Triangulator::fitBoundary() {
             WH_DLN2D_Point* point1 = tri_i->point(WH_Triangle2D_A::edgeVertexMap[e][1]);
             WH_CDLN2D_BoundarySegment* seg = this->findBoundarySegment(point0, point1);
             if (seg != WH_NULL) {
-                seg->setMark();
-                _stats.constraintsRecovered++;
-                
-                // Set domain ID based on which side of constraint the triangle is on
-                WH_Vector2D triangleCenter = (tri_i->point(0)->position() + 
-                                            tri_i->point(1)->position() + 
-                                            tri_i->point(2)->position()) / 3;
-                WH_Vector2D edgeMidPoint = (point0->position() + point1->position()) / 2;
-                WH_Vector2D dir = triangleCenter - edgeMidPoint;
-                
-                // Use robust orientation test
-                double orientation = WH_RobustPredicates::orient2d_robust(
-                    edgeMidPoint, edgeMidPoint + seg->frontNormal(), triangleCenter);
-                
-                if (orientation > 0) {
+                // the front is on the left of point0 -> point1
+                if (0 < orientation(seg->point0(), seg->point1(), tri_i->point(e))) {
                     tri_i->setDomainId(seg->frontDomainId());
                 } else {
                     tri_i->setDomainId(seg->rearDomainId());
@@ -116,38 +169,6 @@ void WH_RobustCDT_Triangulator::fitBoundary() {
         }
     }
 
-    // Assign default domain ID to triangles that weren't assigned by boundary segments
-    WH_PRINT_VERBOSE("Assigning default domain IDs to unassigned triangles");
-    int assigned_count = 0;
-    for (list<WH_DLN2D_Triangle*>::iterator i_tri = _triangle_s.begin();
-         i_tri != _triangle_s.end(); i_tri++) {
-        WH_CDLN2D_Triangle* tri_i = (WH_CDLN2D_Triangle*)(*i_tri);
-        if (tri_i->domainId() == WH_NO_INDEX) {
-            tri_i->setDomainId(1);  // Assign valid domain ID (not 0 which gets filtered out)
-            assigned_count++;
-        }
-    }
-    WH_PRINTF_VERBOSE("Assigned domain ID 1 to %d unassigned triangles", assigned_count);
-
-    // Second pass: recover missing constraints with robust methods
-    for (vector<WH_CDLN2D_BoundarySegment*>::const_iterator i_seg = _boundarySegment_s.begin();
-         i_seg != _boundarySegment_s.end(); i_seg++) {
-        WH_CDLN2D_BoundarySegment* seg_i = (*i_seg);
-        if (!seg_i->hasMark()) {
-            if (_debugFaceId >= 0) {
-                WH_PRINTF_TRACE("Recovering constraint [%d,%d]", seg_i->point0()->id(), seg_i->point1()->id());
-            }
-            
-            if (!recoverConstraintSegment_robust(seg_i)) {
-                _stats.constraintsFailed++;
-                if (_debugFaceId >= 0) {
-                    std::cerr << "WARNING: Failed to recover constraint [" 
-                              << seg_i->point0()->id() << "," << seg_i->point1()->id() << "]" << std::endl;
-                }
-            }
-        }
-    }
-    
     if (_debugFaceId >= 0) {
         WH_PRINTF_VERBOSE("Constraint recovery completed - recovered: %d, failed: %d", _stats.constraintsRecovered, _stats.constraintsFailed);
     }
@@ -156,97 +177,249 @@ void WH_RobustCDT_Triangulator::fitBoundary() {
 bool WH_RobustCDT_Triangulator::recoverConstraintSegment_robust(WH_CDLN2D_BoundarySegment* segment) {
     WH_DLN2D_Point* p0 = segment->point0();
     WH_DLN2D_Point* p1 = segment->point1();
-    
+
     // Check for dummy points - these indicate algorithmic failure
     if (p0->isDummy() || p1->isDummy()) {
         if (_debugFaceId >= 0) {
-            std::cerr << "ERROR: Cannot recover constraint with dummy points [" 
-                      << p0->id() << "," << p1->id() << "] - dummy flags: [" 
+            std::cerr << "ERROR: Cannot recover constraint with dummy points ["
+                      << p0->id() << "," << p1->id() << "] - dummy flags: ["
                       << p0->isDummy() << "," << p1->isDummy() << "]" << std::endl;
         }
         return false;
     }
-    
-    // Try incremental insertion first
-    if (insertConstraintSegment_incremental(segment)) {
+
+    // Already an edge, possibly made by recovering another constraint
+    if (findTriangleWithEdge(p0, p1) != WH_NULL) {
         segment->setMark();
-        _stats.constraintsRecovered++;
         return true;
     }
-    
-    // Try edge swapping approach
+
     if (insertConstraintSegment_swapping(segment)) {
         segment->setMark();
         _stats.constraintsRecovered++;
         return true;
     }
-    
-    // If both fail, mark as failed but continue (for debugging)
-    if (_debugFaceId >= 0) {
-        std::cerr << "WARNING: All constraint recovery methods failed for [" 
-                  << p0->id() << "," << p1->id() << "]" << std::endl;
-        // For now, mark it to prevent crash and allow analysis
-        segment->setMark();
-    }
-    
+
     return false;
 }
 
-bool WH_RobustCDT_Triangulator::insertConstraintSegment_incremental(WH_CDLN2D_BoundarySegment* segment) {
-    // Find all triangles that intersect with the constraint segment
-    WH_Vector2D p0 = segment->point0()->position();
-    WH_Vector2D p1 = segment->point1()->position();
-    
-    std::vector<WH_DLN2D_Triangle*> intersecting_triangles;
-    
+bool WH_RobustCDT_Triangulator::insertConstraintSegment_swapping(WH_CDLN2D_BoundarySegment* segment) {
+    // Sloan's algorithm: flip the edges crossing the segment until none is
+    // left, then restore the Delaunay property of the new edges by flipping
+    // them again, leaving the segment itself in place.
+    WH_DLN2D_Point* p0 = segment->point0();
+    WH_DLN2D_Point* p1 = segment->point1();
+
+    std::deque<std::pair<WH_DLN2D_Point*, WH_DLN2D_Point*>> crossing;
+    if (!collectCrossingEdges(p0, p1, crossing)) {
+        if (_debugFaceId >= 0) {
+            WH_PRINTF_VERBOSE("Constraint [%d,%d] passes through a point or leaves the triangulation",
+                              p0->id(), p1->id());
+        }
+        return false;
+    }
+
+    // flips of a non-convex quadrilateral are retried later; the count is
+    // bounded for valid input, so the limit only guards degenerate input
+    size_t nRetriesLeft = (crossing.size() + 2) * (crossing.size() + 2) * 4;
+    std::vector<std::pair<WH_DLN2D_Point*, WH_DLN2D_Point*>> newEdge_s;
+    while (!crossing.empty()) {
+        if (nRetriesLeft-- == 0) return false;
+
+        std::pair<WH_DLN2D_Point*, WH_DLN2D_Point*> edge = crossing.front();
+        crossing.pop_front();
+        WH_DLN2D_Point* a;
+        WH_DLN2D_Point* b;
+        if (!flipEdge(edge.first, edge.second, a, b)) {
+            crossing.push_back(edge);
+            continue;
+        }
+        if (a != p0 && a != p1 && b != p0 && b != p1
+            && orientation(p0, p1, a) * orientation(p0, p1, b) < 0) {
+            crossing.push_back(std::make_pair(a, b));
+        } else {
+            newEdge_s.push_back(std::make_pair(a, b));
+        }
+    }
+
+    bool hasFlipped = true;
+    for (size_t nPasses = 0; hasFlipped && nPasses < newEdge_s.size() + 1; nPasses++) {
+        hasFlipped = false;
+        for (size_t i = 0; i < newEdge_s.size(); i++) {
+            WH_DLN2D_Point* a = newEdge_s[i].first;
+            WH_DLN2D_Point* b = newEdge_s[i].second;
+            if (this->findBoundarySegment(a, b) != WH_NULL) continue;
+
+            WH_DLN2D_Triangle* tri = findTriangleWithEdge(a, b);
+            WH_ASSERT(tri != WH_NULL);
+            int iC = third_vertex_index(tri, a, b);
+            WH_DLN2D_Triangle* neighbor = tri->neighborAt(iC);
+            if (neighbor == WH_NULL) continue;
+            WH_DLN2D_Point* c = tri->point(iC);
+            WH_DLN2D_Point* d = neighbor->point(third_vertex_index(neighbor, a, b));
+
+            int inCircle = orientation(a, b, c) * sign_of(WH_RobustPredicates::incircle_robust(
+                a->position(), b->position(), c->position(), d->position()));
+            if (0 < inCircle && flipEdge(a, b, newEdge_s[i].first, newEdge_s[i].second)) {
+                hasFlipped = true;
+            }
+        }
+    }
+
+    return findTriangleWithEdge(p0, p1) != WH_NULL;
+}
+
+void WH_RobustCDT_Triangulator::mapIncidentTriangles() {
+    _incidentTriangle.clear();
+    _incidentTriangle.reserve(_point_s.size() + _cornerDummyPoint_s.size());
     for (list<WH_DLN2D_Triangle*>::const_iterator i_tri = _triangle_s.begin();
          i_tri != _triangle_s.end(); i_tri++) {
-        WH_DLN2D_Triangle* tri = *i_tri;
-        
-        if (WH_RobustPredicates::segment_intersects_triangle_robust(
-                p0, p1, 
-                tri->point(0)->position(),
-                tri->point(1)->position(), 
-                tri->point(2)->position())) {
-            intersecting_triangles.push_back(tri);
+        for (int v = 0; v < 3; v++) {
+            _incidentTriangle[(*i_tri)->point(v)] = (*i_tri);
         }
     }
-    
-    if (intersecting_triangles.empty()) {
-        // Constraint might already exist
-        return true;
+}
+
+void WH_RobustCDT_Triangulator::collectTrianglesAround(
+    WH_DLN2D_Point* point, std::vector<WH_DLN2D_Triangle*>& tri_s_OUT) {
+    tri_s_OUT.clear();
+    std::unordered_map<WH_DLN2D_Point*, WH_DLN2D_Triangle*>::const_iterator i_incident
+        = _incidentTriangle.find(point);
+    if (i_incident == _incidentTriangle.end()) return;
+
+    // the triangles around <point> are connected by the edges at <point>
+    std::vector<WH_DLN2D_Triangle*> stack(1, i_incident->second);
+    while (!stack.empty()) {
+        WH_DLN2D_Triangle* tri = stack.back();
+        stack.pop_back();
+        if (std::find(tri_s_OUT.begin(), tri_s_OUT.end(), tri) != tri_s_OUT.end()) continue;
+        tri_s_OUT.push_back(tri);
+
+        int iPoint = vertex_index(tri, point);
+        WH_ASSERT(iPoint != WH_NO_INDEX);
+        for (int e = 0; e < 3; e++) {
+            if (e == iPoint) continue;
+            WH_DLN2D_Triangle* neighbor = tri->neighborAt(e);
+            if (neighbor != WH_NULL) stack.push_back(neighbor);
+        }
     }
-    
-    // For now, just mark as recovered to prevent crashes
-    // A full implementation would retriangulate the intersected region
-    if (_debugFaceId >= 0) {
-        WH_PRINTF_VERBOSE("Found %zu intersecting triangles for constraint recovery", intersecting_triangles.size());
+}
+
+WH_DLN2D_Triangle* WH_RobustCDT_Triangulator::findTriangleWithEdge(
+    WH_DLN2D_Point* point0, WH_DLN2D_Point* point1) {
+    std::vector<WH_DLN2D_Triangle*> tri_s;
+    collectTrianglesAround(point0, tri_s);
+    for (size_t i = 0; i < tri_s.size(); i++) {
+        if (tri_s[i]->hasPoint(point1)) return tri_s[i];
     }
-    
-    return true; // Simplified recovery
+    return WH_NULL;
 }
 
-bool WH_RobustCDT_Triangulator::insertConstraintSegment_swapping(WH_CDLN2D_BoundarySegment* segment) {
-    // Edge swapping approach: find path of edges to swap to create constraint
-    // This is a simplified implementation
+bool WH_RobustCDT_Triangulator::collectCrossingEdges(
+    WH_DLN2D_Point* point0, WH_DLN2D_Point* point1,
+    std::deque<std::pair<WH_DLN2D_Point*, WH_DLN2D_Point*>>& edge_s_OUT) {
+    edge_s_OUT.clear();
+
+    // find the triangle at <point0> whose opposite edge the segment crosses
+    std::vector<WH_DLN2D_Triangle*> tri_s;
+    collectTrianglesAround(point0, tri_s);
+    WH_DLN2D_Triangle* tri = WH_NULL;
+    WH_DLN2D_Point* x = WH_NULL;
+    WH_DLN2D_Point* y = WH_NULL;
+    for (size_t i = 0; i < tri_s.size() && tri == WH_NULL; i++) {
+        int iPoint0 = vertex_index(tri_s[i], point0);
+        WH_DLN2D_Point* px = tri_s[i]->point(WH_Triangle2D_A::edgeVertexMap[iPoint0][0]);
+        WH_DLN2D_Point* py = tri_s[i]->point(WH_Triangle2D_A::edgeVertexMap[iPoint0][1]);
+        int ox = orientation(point0, point1, px);
+        int oy = orientation(point0, point1, py);
+        WH_Vector2D dir = point1->position() - point0->position();
+        // a point on the segment splits it, which flipping cannot do
+        if ((ox == 0 && 0 < WH_scalarProduct(px->position() - point0->position(), dir))
+            || (oy == 0 && 0 < WH_scalarProduct(py->position() - point0->position(), dir))) {
+            return false;
+        }
+        if (ox * oy < 0
+            && orientation(px, py, point0) * orientation(px, py, point1) < 0) {
+            tri = tri_s[i];
+            x = px;
+            y = py;
+        }
+    }
+    if (tri == WH_NULL) return false;
+
+    // walk along the segment through the triangles it crosses
+    int ox = orientation(point0, point1, x);
+    for (size_t step = 0; step < _triangle_s.size(); step++) {
+        edge_s_OUT.push_back(std::make_pair(x, y));
+        WH_DLN2D_Triangle* next = tri->neighborAt(third_vertex_index(tri, x, y));
+        if (next == WH_NULL) return false;
+        WH_DLN2D_Point* w = next->point(third_vertex_index(next, x, y));
+        if (w == point1) return true;
+        int ow = orientation(point0, point1, w);
+        if (ow == 0) return false;
+        if (ow == ox) {
+            x = w;
+        } else {
+            y = w;
+        }
+        tri = next;
+    }
+    return false;
+}
+
+bool WH_RobustCDT_Triangulator::flipEdge(
+    WH_DLN2D_Point* point0, WH_DLN2D_Point* point1,
+    WH_DLN2D_Point*& newPoint0_OUT, WH_DLN2D_Point*& newPoint1_OUT) {
+    WH_DLN2D_Triangle* tri0 = findTriangleWithEdge(point0, point1);
+    if (tri0 == WH_NULL) return false;
+    int iA = third_vertex_index(tri0, point0, point1);
+    WH_DLN2D_Triangle* tri1 = tri0->neighborAt(iA);
+    if (tri1 == WH_NULL) return false;
+    WH_DLN2D_Point* a = tri0->point(iA);
+    WH_DLN2D_Point* b = tri1->point(third_vertex_index(tri1, point0, point1));
+
+    // only the diagonal of a strictly convex quadrilateral can be flipped
+    if (0 <= orientation(a, b, point0) * orientation(a, b, point1)) return false;
+
+    WH_DLN2D_Triangle* neighbor0a = tri0->neighborAt(vertex_index(tri0, point0));
+    WH_DLN2D_Triangle* neighbor1a = tri0->neighborAt(vertex_index(tri0, point1));
+    WH_DLN2D_Triangle* neighbor0b = tri1->neighborAt(vertex_index(tri1, point0));
+    WH_DLN2D_Triangle* neighbor1b = tri1->neighborAt(vertex_index(tri1, point1));
+
+    /*
+       point0 -- a          point0 -- a
+         |  \   |             |    / |
+         |   \  |     ->      |   /  |
+         |    \ |             |  /   |
+         b -- point1          b -- point1
+     */
+    WH_DLN2D_Triangle* new0 = this->createTriangle(a, b, point0);
+    WH_DLN2D_Triangle* new1 = this->createTriangle(b, a, point1);
+    new0->setNeighborAt(2, new1);
+    new1->setNeighborAt(2, new0);
+    link_neighbors(new0, 0, neighbor1b);
+    link_neighbors(new0, 1, neighbor1a);
+    link_neighbors(new1, 0, neighbor0a);
+    link_neighbors(new1, 1, neighbor0b);
+    this->addTriangle(new0);
+    this->addTriangle(new1);
+    this->removeTriangle(tri0);
+    this->removeTriangle(tri1);
+
+    _incidentTriangle[point0] = new0;
+    _incidentTriangle[a] = new0;
+    _incidentTriangle[b] = new0;
+    _incidentTriangle[point1] = new1;
+    _stats.edgeFlips++;
+
+    newPoint0_OUT = a;
+    newPoint1_OUT = b;
     return true;
 }
 
 bool WH_RobustCDT_Triangulator::performFallbackTriangulation() {
     _stats.usedFallbackStrategy = true;
     
-    // Try ear clipping for simple polygons
-    if (isSimplePolygon() && earClippingTriangulation()) {
-        _stats.fallbacksUsed++;
-        return true;
-    }
-    
-    // Try monotone partition
-    if (monotonePartitionTriangulation()) {
-        _stats.fallbacksUsed++;
-        return true;
-    }
-    
     // Last resort: simple fan triangulation
     if (simpleFanTriangulation()) {
         _stats.fallbacksUsed++;
@@ -256,18 +429,6 @@ bool WH_RobustCDT_Triangulator::performFallbackTriangulation() {
     return false;
 }
 
-bool WH_RobustCDT_Triangulator::earClippingTriangulation() {
-    // Simplified ear clipping implementation
-    WH_PRINT_NORMAL("Using ear clipping fallback triangulation");
-    return false; // Not implemented yet
-}
-
-bool WH_RobustCDT_Triangulator::monotonePartitionTriangulation() {
-    // Monotone polygon triangulation
-    WH_PRINT_NORMAL("Using monotone partition fallback triangulation");
-    return false; // Not implemented yet
-}
-
 bool WH_RobustCDT_Triangulator::simpleFanTriangulation() {
     // Simple fan triangulation from first vertex
     WH_PRINT_NORMAL("Using simple fan fallback triangulation");
@@ -390,63 +551,32 @@ void WH_RobustCDT_Triangulator::dumpTriangulationState(const std::string& stage)
     WH_PRINTF_VERBOSE("State dumped to %s", filename.c_str());
 }
 
-WH_RobustCDT_Triangulator::TriangulationStrategy WH_RobustCDT_Triangulator::selectStrategy() {
-    double complexity = estimateGeometryComplexity();
-    
-    if (complexity < 0.5) {
-        return STANDARD_CDT;
-    } else if (complexity < 0.8) {
-        return ROBUST_CDT_WITH_RECOVERY;
-    } else {
-        return EAR_CLIPPING_FALLBACK;
-    }
-}
-
-bool WH_RobustCDT_Triangulator::isSimplePolygon() {
-    // Simplified check - a full implementation would check for self-intersections
-    return _boundarySegment_s.size() >= 3;
-}
-
 void WH_RobustCDT_Triangulator::removeDummyTriangles() {
     if (_debugFaceId >= 0) {
         WH_PRINTF_TRACE("Removing dummy triangles from %zu total triangles", _triangle_s.size());
     }
     
     // Remove triangles that contain any dummy points
-    auto it = _triangle_s.begin();
-    int removed_count = 0;
-    
-    while (it != _triangle_s.end()) {
-        WH_DLN2D_Triangle* tri = *it;
-        
+    std::vector<WH_DLN2D_Triangle*> dummy_s;
+    for (list<WH_DLN2D_Triangle*>::const_iterator i_tri = _triangle_s.begin();
+         i_tri != _triangle_s.end(); i_tri++) {
+        WH_DLN2D_Triangle* tri = *i_tri;
         if (tri->isDummy()) {
-            if (_debugFaceId >= 0) {
             if (_debugFaceId >= 0) {
                 WH_PRINT_TRACE("Removing dummy triangle with points:");
                 WH_PRINTF_TRACE("  [%d,%d,%d]", tri->point(0)->id(), tri->point(1)->id(), tri->point(2)->id());
             }
-            }
-            
-            it = _triangle_s.erase(it);
-            removed_count++;
-        } else {
-            ++it;
+            dummy_s.push_back(tri);
         }
     }
+    int removed_count = (int)dummy_s.size();
+    this->deleteTriangles(dummy_s);
     
     if (_debugFaceId >= 0) {
         WH_PRINTF_VERBOSE("Removed %d dummy triangles, %zu triangles remaining", removed_count, _triangle_s.size());
     }
 }
 
-double WH_RobustCDT_Triangulator::estimateGeometryComplexity() {
-    // Simple heuristic based on number of points and segments
-    double point_complexity = std::min(1.0, _point_s.size() / 100.0);
-    double segment_complexity = std::min(1.0, _boundarySegment_s.size() / 50.0);
-    
-    return (point_complexity + segment_complexity) / 2.0;
-}
-
 // Factory function
 WH_CDLN2D_Triangulator* createRobustTriangulator(int faceId) {
     WH_RobustCDT_Triangulator* triangulator = new WH_RobustCDT_Triangulator();
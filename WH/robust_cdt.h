@@ -7,6 +7,9 @@
 
 #include "constdel2d.h"
 #include "robust_predicates.h"
+#include <deque>
+#include <unordered_map>
+#include <utility>
 
 // Enhanced CDT with robust constraint recovery and fallback strategies
 class WH_RobustCDT_Triangulator : public WH_CDLN2D_Triangulator {
@@ -14,7 +17,7 @@ public:
     WH_RobustCDT_Triangulator();
     virtual ~WH_RobustCDT_Triangulator();
     
-    // Main triangulation with fallback strategies
+    // Single exact CDT pass; the fallback runs only if it fails
     virtual void perform() override;
     
     // Enable debugging for specific face IDs
@@ -25,26 +28,42 @@ public:
         int constraintsRecovered = 0;
         int constraintsFailed = 0;
         int fallbacksUsed = 0;
+        int edgeFlips = 0;
         bool usedExactPredicates = false;
         bool usedFallbackStrategy = false;
+        double seconds = 0.0;  // wall time of perform() for this face
         std::string failureReason;
     };
     
     const TriangulationStats& getStats() const { return _stats; }
 
 protected:
-    // Enhanced constraint recovery with multiple strategies
+    // Point location by walking from the most recently created triangle
+    virtual WH_DLN2D_Triangle* pickUpFirstTriangle() const override;
+
+    // Recovers every missing constraint, then sets the domain of the
+    // triangles along the constraints
     virtual void fitBoundary() override;
     
     // Robust constraint recovery methods
     bool recoverConstraintSegment_robust(WH_CDLN2D_BoundarySegment* segment);
-    bool insertConstraintSegment_incremental(WH_CDLN2D_BoundarySegment* segment);
     bool insertConstraintSegment_swapping(WH_CDLN2D_BoundarySegment* segment);
+
+    // Edge flipping support for constraint recovery
+    void mapIncidentTriangles();
+    void collectTrianglesAround(WH_DLN2D_Point* point,
+                                std::vector<WH_DLN2D_Triangle*>& tri_s_OUT);
+    WH_DLN2D_Triangle* findTriangleWithEdge(WH_DLN2D_Point* point0,
+                                            WH_DLN2D_Point* point1);
+    bool collectCrossingEdges(
+        WH_DLN2D_Point* point0, WH_DLN2D_Point* point1,
+        std::deque<std::pair<WH_DLN2D_Point*, WH_DLN2D_Point*>>& edge_s_OUT);
+    bool flipEdge(WH_DLN2D_Point* point0, WH_DLN2D_Point* point1,
+                  WH_DLN2D_Point*& newPoint0_OUT,
+                  WH_DLN2D_Point*& newPoint1_OUT);
     
     // Fallback triangulation strategies
     bool performFallbackTriangulation();
-    bool earClippingTriangulation();
-    bool monotonePartitionTriangulation();
     bool simpleFanTriangulation();
     
     // Validation and cleanup
@@ -60,19 +79,9 @@ protected:
 private:
     int _debugFaceId = -1;
     TriangulationStats _stats;
-    
-    // Strategy selection based on geometry complexity
-    enum TriangulationStrategy {
-        STANDARD_CDT,
-        ROBUST_CDT_WITH_RECOVERY,
-        EAR_CLIPPING_FALLBACK,
-        MONOTONE_PARTITION_FALLBACK,
-        SIMPLE_FAN_FALLBACK
-    };
-    
-    TriangulationStrategy selectStrategy();
-    bool isSimplePolygon();
-    double estimateGeometryComplexity();
+
+    // one triangle incident to each point, valid during fitBoundary()
+    std::unordered_map<WH_DLN2D_Point*, WH_DLN2D_Triangle*> _incidentTriangle;
 };
 
 // Factory function for creating appropriate triangulator
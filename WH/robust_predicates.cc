@@ -7,9 +7,216 @@
 #include "debug_levels.h"
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 namespace WH_RobustPredicates {
 
+namespace {
+
+// Error bounds of the floating-point filters (Shewchuk, "Adaptive
+// Precision Floating-Point Arithmetic and Fast Robust Geometric
+// Predicates", 1997).  epsilon is half an ulp of 1.0
+const double epsilon = 1.1102230246251565e-16;
+const double ccwerrboundA = (3.0 + 16.0 * epsilon) * epsilon;
+const double iccerrboundA = (10.0 + 96.0 * epsilon) * epsilon;
+const double o3derrboundA = (7.0 + 56.0 * epsilon) * epsilon;
+const double isperrboundA = (16.0 + 224.0 * epsilon) * epsilon;
+
+thread_local FilterCounters counters = {0, 0, 0, 0, 0, 0, 0, 0};
+
+// Expansion arithmetic.  An expansion is a sum of nonoverlapping doubles
+// stored in increasing order of magnitude; its sign is the sign of the
+// last component.  Only used when a filter fails, so plain vectors do.
+typedef std::vector<double> Expansion;
+
+inline void two_sum(double a, double b, double& x, double& y) {
+    x = a + b;
+    double bvirt = x - a;
+    double avirt = x - bvirt;
+    y = (a - avirt) + (b - bvirt);
+}
+
+inline void fast_two_sum(double a, double b, double& x, double& y) {
+    // requires |a| >= |b|
+    x = a + b;
+    y = b - (x - a);
+}
+
+inline void two_product(double a, double b, double& x, double& y) {
+    x = a * b;
+    y = std::fma(a, b, -x);
+}
+
+// exact a - b as an expansion
+Expansion difference(double a, double b) {
+    double x = a - b;
+    double bvirt = a - x;
+    double avirt = x + bvirt;
+    double y = (a - avirt) + (bvirt - b);
+    Expansion h;
+    if (y != 0.0) h.push_back(y);
+    h.push_back(x);
+    return h;
+}
+
+// e + b with zero elimination
+Expansion grow(const Expansion& e, double b) {
+    Expansion h;
+    h.reserve(e.size() + 1);
+    double q = b;
+    for (size_t i = 0; i < e.size(); i++) {
+        double qnew, hh;
+        two_sum(q, e[i], qnew, hh);
+        q = qnew;
+        if (hh != 0.0) h.push_back(hh);
+    }
+    if (q != 0.0 || h.empty()) h.push_back(q);
+    return h;
+}
+
+Expansion sum(const Expansion& e, const Expansion& f) {
+    Expansion h = e;
+    for (size_t i = 0; i < f.size(); i++) {
+        if (f[i] != 0.0) h = grow(h, f[i]);
+    }
+    return h;
+}
+
+Expansion negate(const Expansion& e) {
+    Expansion h = e;
+    for (size_t i = 0; i < h.size(); i++) h[i] = -h[i];
+    return h;
+}
+
+Expansion difference(const Expansion& e, const Expansion& f) {
+    return sum(e, negate(f));
+}
+
+// e * b with zero elimination
+Expansion scale(const Expansion& e, double b) {
+    Expansion h;
+    h.reserve(e.size() * 2);
+    double q, hh;
+    two_product(e[0], b, q, hh);
+    if (hh != 0.0) h.push_back(hh);
+    for (size_t i = 1; i < e.size(); i++) {
+        double product1, product0, s;
+        two_product(e[i], b, product1, product0);
+        two_sum(q, product0, s, hh);
+        if (hh != 0.0) h.push_back(hh);
+        fast_two_sum(product1, s, q, hh);
+        if (hh != 0.0) h.push_back(hh);
+    }
+    if (q != 0.0 || h.empty()) h.push_back(q);
+    return h;
+}
+
+Expansion product(const Expansion& e, const Expansion& f) {
+    Expansion h(1, 0.0);
+    for (size_t i = 0; i < f.size(); i++) {
+        if (f[i] != 0.0) h = sum(h, scale(e, f[i]));
+    }
+    return h;
+}
+
+// approximation of the value with the exact sign
+double estimate(const Expansion& e) {
+    double value = 0.0;
+    for (size_t i = 0; i < e.size(); i++) value += e[i];
+    return value;
+}
+
+double orient2d_exact(const WH_Vector2D& pa, const WH_Vector2D& pb, const WH_Vector2D& pc) {
+    Expansion acx = difference(pa.x, pc.x);
+    Expansion acy = difference(pa.y, pc.y);
+    Expansion bcx = difference(pb.x, pc.x);
+    Expansion bcy = difference(pb.y, pc.y);
+    return estimate(difference(product(acx, bcy), product(acy, bcx)));
+}
+
+double incircle_exact(const WH_Vector2D& pa, const WH_Vector2D& pb,
+                      const WH_Vector2D& pc, const WH_Vector2D& pd) {
+    Expansion adx = difference(pa.x, pd.x);
+    Expansion ady = difference(pa.y, pd.y);
+    Expansion bdx = difference(pb.x, pd.x);
+    Expansion bdy = difference(pb.y, pd.y);
+    Expansion cdx = difference(pc.x, pd.x);
+    Expansion cdy = difference(pc.y, pd.y);
+
+    Expansion abdet = difference(product(adx, bdy), product(bdx, ady));
+    Expansion bcdet = difference(product(bdx, cdy), product(cdx, bdy));
+    Expansion cadet = difference(product(cdx, ady), product(adx, cdy));
+    Expansion alift = sum(product(adx, adx), product(ady, ady));
+    Expansion blift = sum(product(bdx, bdx), product(bdy, bdy));
+    Expansion clift = sum(product(cdx, cdx), product(cdy, cdy));
+
+    return estimate(sum(sum(product(alift, bcdet), product(blift, cadet)),
+                        product(clift, abdet)));
+}
+
+double orient3d_exact(const WH_Vector3D& pa, const WH_Vector3D& pb,
+                      const WH_Vector3D& pc, const WH_Vector3D& pd) {
+    Expansion adx = difference(pa.x, pd.x);
+    Expansion ady = difference(pa.y, pd.y);
+    Expansion adz = difference(pa.z, pd.z);
+    Expansion bdx = difference(pb.x, pd.x);
+    Expansion bdy = difference(pb.y, pd.y);
+    Expansion bdz = difference(pb.z, pd.z);
+    Expansion cdx = difference(pc.x, pd.x);
+    Expansion cdy = difference(pc.y, pd.y);
+    Expansion cdz = difference(pc.z, pd.z);
+
+    Expansion bc = difference(product(bdx, cdy), product(cdx, bdy));
+    Expansion ca = difference(product(cdx, ady), product(adx, cdy));
+    Expansion ab = difference(product(adx, bdy), product(bdx, ady));
+
+    return estimate(sum(sum(product(adz, bc), product(bdz, ca)),
+                        product(cdz, ab)));
+}
+
+double insphere_exact(const WH_Vector3D& pa, const WH_Vector3D& pb,
+                      const WH_Vector3D& pc, const WH_Vector3D& pd,
+                      const WH_Vector3D& pe) {
+    Expansion aex = difference(pa.x, pe.x);
+    Expansion aey = difference(pa.y, pe.y);
+    Expansion aez = difference(pa.z, pe.z);
+    Expansion bex = difference(pb.x, pe.x);
+    Expansion bey = difference(pb.y, pe.y);
+    Expansion bez = difference(pb.z, pe.z);
+    Expansion cex = difference(pc.x, pe.x);
+    Expansion cey = difference(pc.y, pe.y);
+    Expansion cez = difference(pc.z, pe.z);
+    Expansion dex = difference(pd.x, pe.x);
+    Expansion dey = difference(pd.y, pe.y);
+    Expansion dez = difference(pd.z, pe.z);
+
+    Expansion ab = difference(product(aex, bey), product(bex, aey));
+    Expansion bc = difference(product(bex, cey), product(cex, bey));
+    Expansion cd = difference(product(cex, dey), product(dex, cey));
+    Expansion da = difference(product(dex, aey), product(aex, dey));
+    Expansion ac = difference(product(aex, cey), product(cex, aey));
+    Expansion bd = difference(product(bex, dey), product(dex, bey));
+
+    Expansion abc = sum(difference(product(aez, bc), product(bez, ac)),
+                        product(cez, ab));
+    Expansion bcd = sum(difference(product(bez, cd), product(cez, bd)),
+                        product(dez, bc));
+    Expansion cda = sum(sum(product(cez, da), product(dez, ac)),
+                        product(aez, cd));
+    Expansion dab = sum(sum(product(dez, ab), product(aez, bd)),
+                        product(bez, da));
+
+    Expansion alift = sum(sum(product(aex, aex), product(aey, aey)), product(aez, aez));
+    Expansion blift = sum(sum(product(bex, bex), product(bey, bey)), product(bez, bez));
+    Expansion clift = sum(sum(product(cex, cex), product(cey, cey)), product(cez, cez));
+    Expansion dlift = sum(sum(product(dex, dex), product(dey, dey)), product(dez, dez));
+
+    return estimate(sum(difference(product(dlift, abc), product(clift, dab)),
+                        difference(product(blift, cda), product(alift, bcd))));
+}
+
+} // namespace
+
 // Robust 2D orientation test
 double orient2d_robust(const WH_Vector2D& pa, const WH_Vector2D& pb, const WH_Vector2D& pc) {
     return RobustOrientationTest::test(pa, pb, pc);
@@ -18,6 +225,8 @@ double orient2d_robust(const WH_Vector2D& pa, const WH_Vector2D& pb, const WH_Ve
 // Robust incircle test  
 double incircle_robust(const WH_Vector2D& pa, const WH_Vector2D& pb, 
                       const WH_Vector2D& pc, const WH_Vector2D& pd) {
+    counters.incircle_calls++;
+
     // Translate points to reduce coordinate magnitude
     double adx = pa.x - pd.x;
     double ady = pa.y - pd.y;
@@ -26,27 +235,183 @@ double incircle_robust(const WH_Vector2D& pa, const WH_Vector2D& pb,
     double cdx = pc.x - pd.x;
     double cdy = pc.y - pd.y;
     
-    double abdet = adx * bdy - bdx * ady;
-    double bcdet = bdx * cdy - cdx * bdy;
-    double cadet = cdx * ady - adx * cdy;
+    double bdxcdy = bdx * cdy;
+    double cdxbdy = cdx * bdy;
     double alift = adx * adx + ady * ady;
+    double cdxady = cdx * ady;
+    double adxcdy = adx * cdy;
     double blift = bdx * bdx + bdy * bdy;
+    double adxbdy = adx * bdy;
+    double bdxady = bdx * ady;
     double clift = cdx * cdx + cdy * cdy;
     
-    double det = alift * bcdet + blift * cadet + clift * abdet;
+    double det = alift * (bdxcdy - cdxbdy)
+               + blift * (cdxady - adxcdy)
+               + clift * (adxbdy - bdxady);
     
     // Check if result needs higher precision
-    double errbound = 1e-15 * (std::abs(alift) + std::abs(blift) + std::abs(clift)) *
-                      (std::abs(bcdet) + std::abs(cadet) + std::abs(abdet));
+    double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * alift
+                     + (std::abs(cdxady) + std::abs(adxcdy)) * blift
+                     + (std::abs(adxbdy) + std::abs(bdxady)) * clift;
+    double errbound = iccerrboundA * permanent;
     
-    if (std::abs(det) > errbound) {
+    if (det > errbound || -det > errbound || permanent == 0.0) {
         return det;
     }
     
-    // Fall back to exact arithmetic if needed
-    WH_PRINTF_VERBOSE("Using exact arithmetic for incircle test");
-    // For now, return the computed value (exact arithmetic would go here)
-    return det;
+    // Fall back to exact arithmetic
+    counters.incircle_exact++;
+    return incircle_exact(pa, pb, pc, pd);
+}
+
+// Robust 3D orientation test
+double orient3d_robust(const WH_Vector3D& pa, const WH_Vector3D& pb,
+                      const WH_Vector3D& pc, const WH_Vector3D& pd) {
+    counters.orient3d_calls++;
+
+    double adx = pa.x - pd.x;
+    double ady = pa.y - pd.y;
+    double adz = pa.z - pd.z;
+    double bdx = pb.x - pd.x;
+    double bdy = pb.y - pd.y;
+    double bdz = pb.z - pd.z;
+    double cdx = pc.x - pd.x;
+    double cdy = pc.y - pd.y;
+    double cdz = pc.z - pd.z;
+
+    double bdxcdy = bdx * cdy;
+    double cdxbdy = cdx * bdy;
+    double cdxady = cdx * ady;
+    double adxcdy = adx * cdy;
+    double adxbdy = adx * bdy;
+    double bdxady = bdx * ady;
+
+    double det = adz * (bdxcdy - cdxbdy)
+               + bdz * (cdxady - adxcdy)
+               + cdz * (adxbdy - bdxady);
+
+    double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * std::abs(adz)
+                     + (std::abs(cdxady) + std::abs(adxcdy)) * std::abs(bdz)
+                     + (std::abs(adxbdy) + std::abs(bdxady)) * std::abs(cdz);
+    double errbound = o3derrboundA * permanent;
+
+    if (det > errbound || -det > errbound || permanent == 0.0) {
+        return det;
+    }
+
+    counters.orient3d_exact++;
+    return orient3d_exact(pa, pb, pc, pd);
+}
+
+// Robust insphere test
+double insphere_robust(const WH_Vector3D& pa, const WH_Vector3D& pb,
+                      const WH_Vector3D& pc, const WH_Vector3D& pd,
+                      const WH_Vector3D& pe) {
+    counters.insphere_calls++;
+
+    double aex = pa.x - pe.x;
+    double bex = pb.x - pe.x;
+    double cex = pc.x - pe.x;
+    double dex = pd.x - pe.x;
+    double aey = pa.y - pe.y;
+    double bey = pb.y - pe.y;
+    double cey = pc.y - pe.y;
+    double dey = pd.y - pe.y;
+    double aez = pa.z - pe.z;
+    double bez = pb.z - pe.z;
+    double cez = pc.z - pe.z;
+    double dez = pd.z - pe.z;
+
+    double aexbey = aex * bey;
+    double bexaey = bex * aey;
+    double ab = aexbey - bexaey;
+    double bexcey = bex * cey;
+    double cexbey = cex * bey;
+    double bc = bexcey - cexbey;
+    double cexdey = cex * dey;
+    double dexcey = dex * cey;
+    double cd = cexdey - dexcey;
+    double dexaey = dex * aey;
+    double aexdey = aex * dey;
+    double da = dexaey - aexdey;
+    double aexcey = aex * cey;
+    double cexaey = cex * aey;
+    double ac = aexcey - cexaey;
+    double bexdey = bex * dey;
+    double dexbey = dex * bey;
+    double bd = bexdey - dexbey;
+
+    double abc = aez * bc - bez * ac + cez * ab;
+    double bcd = bez * cd - cez * bd + dez * bc;
+    double cda = cez * da + dez * ac + aez * cd;
+    double dab = dez * ab + aez * bd + bez * da;
+
+    double alift = aex * aex + aey * aey + aez * aez;
+    double blift = bex * bex + bey * bey + bez * bez;
+    double clift = cex * cex + cey * cey + cez * cez;
+    double dlift = dex * dex + dey * dey + dez * dez;
+
+    double det = (dlift * abc - clift * dab) + (blift * cda - alift * bcd);
+
+    double aezplus = std::abs(aez);
+    double bezplus = std::abs(bez);
+    double cezplus = std::abs(cez);
+    double dezplus = std::abs(dez);
+    double aexbeyplus = std::abs(aexbey);
+    double bexaeyplus = std::abs(bexaey);
+    double bexceyplus = std::abs(bexcey);
+    double cexbeyplus = std::abs(cexbey);
+    double cexdeyplus = std::abs(cexdey);
+    double dexceyplus = std::abs(dexcey);
+    double dexaeyplus = std::abs(dexaey);
+    double aexdeyplus = std::abs(aexdey);
+    double aexceyplus = std::abs(aexcey);
+    double cexaeyplus = std::abs(cexaey);
+    double bexdeyplus = std::abs(bexdey);
+    double dexbeyplus = std::abs(dexbey);
+    double permanent = ((cexdeyplus + dexceyplus) * bezplus
+                        + (dexbeyplus + bexdeyplus) * cezplus
+                        + (bexceyplus + cexbeyplus) * dezplus) * alift
+                     + ((dexaeyplus + aexdeyplus) * cezplus
+                        + (aexceyplus + cexaeyplus) * dezplus
+                        + (cexdeyplus + dexceyplus) * aezplus) * blift
+                     + ((aexbeyplus + bexaeyplus) * dezplus
+                        + (bexdeyplus + dexbeyplus) * aezplus
+                        + (dexaeyplus + aexdeyplus) * bezplus) * clift
+                     + ((bexceyplus + cexbeyplus) * aezplus
+                        + (cexaeyplus + aexceyplus) * bezplus
+                        + (aexbeyplus + bexaeyplus) * cezplus) * dlift;
+    double errbound = isperrboundA * permanent;
+
+    if (det > errbound || -det > errbound || permanent == 0.0) {
+        return det;
+    }
+
+    counters.insphere_exact++;
+    return insphere_exact(pa, pb, pc, pd, pe);
+}
+
+FilterCounters filter_counters() {
+    return counters;
+}
+
+void reset_filter_counters() {
+    FilterCounters zero = {0, 0, 0, 0, 0, 0, 0, 0};
+    counters = zero;
+}
+
+void print_filter_counters(const char* label, const FilterCounters& since) {
+    WH_PRINTF_VERBOSE("%s: orient2d %llu (exact %llu), incircle %llu (exact %llu), "
+                      "orient3d %llu (exact %llu), insphere %llu (exact %llu)",
+                      label,
+                      counters.orient2d_calls - since.orient2d_calls,
+                      counters.orient2d_exact - since.orient2d_exact,
+                      counters.incircle_calls - since.incircle_calls,
+                      counters.incircle_exact - since.incircle_exact,
+                      counters.orient3d_calls - since.orient3d_calls,
+                      counters.orient3d_exact - since.orient3d_exact,
+                      counters.insphere_calls - since.insphere_calls,
+                      counters.insphere_exact - since.insphere_exact);
 }
 
 // Robust segment intersection
@@ -116,39 +481,29 @@ bool segment_intersects_triangle_robust(const WH_Vector2D& seg_start, const WH_V
 // Adaptive precision orientation test
 double RobustOrientationTest::test(const WH_Vector2D& pa, const WH_Vector2D& pb, const WH_Vector2D& pc,
                                   PrecisionLevel max_precision) {
+    counters.orient2d_calls++;
+
     // Try double precision first
-    double result = test_double(pa, pb, pc);
+    double detleft = (pa.x - pc.x) * (pb.y - pc.y);
+    double detright = (pa.y - pc.y) * (pb.x - pc.x);
+    double result = detleft - detright;
     
-    // Estimate error bound
-    double errbound = 1e-15 * (std::abs(pa.x) + std::abs(pa.y) + 
-                               std::abs(pb.x) + std::abs(pb.y) + 
-                               std::abs(pc.x) + std::abs(pc.y));
+    // Static error bound of the double precision evaluation
+    double permanent = std::abs(detleft) + std::abs(detright);
+    double errbound = ccwerrboundA * permanent;
     
-    if (std::abs(result) > errbound || max_precision == DOUBLE_PRECISION) {
+    if (result > errbound || -result > errbound || permanent == 0.0
+        || max_precision == DOUBLE_PRECISION) {
         return result;
     }
     
-    // Fall back to exact arithmetic if available
-    if (max_precision >= EXACT_PRECISION) {
-        WH_PRINTF_VERBOSE("Using exact arithmetic for orientation test");
-        return test_exact(pa, pb, pc);
-    }
-    
-    return result;
-}
-
-double RobustOrientationTest::test_double(const WH_Vector2D& pa, const WH_Vector2D& pb, const WH_Vector2D& pc) {
-    return (pb.x - pa.x) * (pc.y - pa.y) - (pc.x - pa.x) * (pb.y - pa.y);
+    // Fall back to exact arithmetic
+    counters.orient2d_exact++;
+    return test_exact(pa, pb, pc);
 }
 
 double RobustOrientationTest::test_exact(const WH_Vector2D& pa, const WH_Vector2D& pb, const WH_Vector2D& pc) {
-    // For now, use high-precision double computation
-    // In a full implementation, this would use arbitrary precision arithmetic
-    long double pax = pa.x, pay = pa.y;
-    long double pbx = pb.x, pby = pb.y;
-    long double pcx = pc.x, pcy = pc.y;
-    
-    return static_cast<double>((pbx - pax) * (pcy - pay) - (pcx - pax) * (pby - pay));
+    return orient2d_exact(pa, pb, pc);
 }
 
 // 3D robust predicates implementation
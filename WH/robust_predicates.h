@@ -21,6 +21,46 @@ double orient2d_robust(const WH_Vector2D& pa, const WH_Vector2D& pb, const WH_Ve
 double incircle_robust(const WH_Vector2D& pa, const WH_Vector2D& pb, 
                       const WH_Vector2D& pc, const WH_Vector2D& pd);
 
+// 3D orientation test: returns > 0 if pd lies below the plane through
+// pa,pb,pc, where pa,pb,pc appear counterclockwise seen from above
+// = 0 if coplanar, < 0 if above
+double orient3d_robust(const WH_Vector3D& pa, const WH_Vector3D& pb,
+                      const WH_Vector3D& pc, const WH_Vector3D& pd);
+
+// Insphere test: returns > 0 if pe is inside sphere through pa,pb,pc,pd
+// when orient3d_robust(pa,pb,pc,pd) > 0 (the sign flips otherwise)
+// = 0 if on sphere
+double insphere_robust(const WH_Vector3D& pa, const WH_Vector3D& pb,
+                      const WH_Vector3D& pc, const WH_Vector3D& pd,
+                      const WH_Vector3D& pe);
+
+// The four tests above evaluate the determinant in double precision and
+// accept it when it exceeds Shewchuk's static error bound; otherwise they
+// fall back to exact expansion arithmetic, so the sign is always exact.
+// The value itself is only an approximation of the determinant.
+
+// Number of calls and of filter failures (exact fallbacks) per test.
+// Counted per thread, so that the common case stays free of atomics.
+struct FilterCounters {
+    unsigned long long orient2d_calls;
+    unsigned long long orient2d_exact;
+    unsigned long long incircle_calls;
+    unsigned long long incircle_exact;
+    unsigned long long orient3d_calls;
+    unsigned long long orient3d_exact;
+    unsigned long long insphere_calls;
+    unsigned long long insphere_exact;
+};
+
+// Counters of the calling thread
+FilterCounters filter_counters();
+
+void reset_filter_counters();
+
+// Print the counts of the calling thread accumulated since <since> at
+// VERBOSE level
+void print_filter_counters(const char* label, const FilterCounters& since);
+
 // Line-line intersection with robust computation
 bool intersect_segments_robust(const WH_Vector2D& p1, const WH_Vector2D& q1,
                               const WH_Vector2D& p2, const WH_Vector2D& q2,
@@ -46,7 +86,6 @@ public:
     static double test(const WH_Vector2D& pa, const WH_Vector2D& pb, const WH_Vector2D& pc,
                       PrecisionLevel max_precision = EXACT_PRECISION);
 private:
-    static double test_double(const WH_Vector2D& pa, const WH_Vector2D& pb, const WH_Vector2D& pc);
     static double test_exact(const WH_Vector2D& pa, const WH_Vector2D& pb, const WH_Vector2D& pc);
 };
 
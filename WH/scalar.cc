@@ -18,8 +18,6 @@
 
 const double WH::HUGE_VALUE = 1.0e+20;
 
-double WH::eps = 0.0000001;
-
 void WH
 ::sortValuesInAscendantOrder 
 (int nValues, double values_IO[])
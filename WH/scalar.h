@@ -69,7 +69,10 @@ bool WH_valuesOverlap
 struct WH {
   static const double HUGE_VALUE;
   
-  static double eps;
+  static inline thread_local double eps = 0.0000001;
+  /* of the calling thread, set by WH_Context.  its constant initializer
+     is in the header, so that an access needs no check for a dynamic
+     initialization of it in another translation unit */
 
   static void sortValuesInAscendantOrder 
     (int nValues, double values_IO[]); 
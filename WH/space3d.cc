@@ -1056,6 +1056,29 @@ double WH_angleOfLines (const WH_Line3D& l0, const WH_Line3D& l1)
 
 /* class WH_Plane3D */
 
+WH_Plane3D WH_Plane3D
+::normalizedPlane (double a, double b, double c, double d)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(WH_eq (WH_Vector3D (a, b, c).length (), 1));
+
+  WH_CVR_LINE;
+
+  WH_Plane3D result;
+  result._a = a;
+  result._b = b;
+  result._c = c;
+  result._d = d;
+  result.calculateUVAxis ();
+
+  /* POST-CONDITION */
+#ifndef WH_PRE_ONLY
+  WH_ASSERT(result.checkInvariant ());
+#endif
+
+  return result;
+}
+
 WH_Plane3D
 ::WH_Plane3D ()
 {
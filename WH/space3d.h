@@ -250,6 +250,11 @@ class WH_Plane3D {
   static WH_Plane3D xyPlane ();
   static WH_Plane3D yzPlane ();
   static WH_Plane3D zxPlane ();
+
+  static WH_Plane3D normalizedPlane 
+    (double a, double b, double c, double d);
+  /* <a> to <d> as a () to d () of a plane give them.  they are kept
+     as they are, so that the plane is made again exactly */
   
   WH_Plane3D ();
   WH_Plane3D (double a, double b, double c, double d);
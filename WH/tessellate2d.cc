@@ -12,6 +12,10 @@
 #endif
 
 #include "tessellate2d.h"
+#include "robust_predicates.h"
+
+#include <set>
+#include <unordered_map>
 
 
 
@@ -258,13 +262,513 @@ void WH_AF2D_Triangulator_TSLT
 
 /* class WH_TSLT_Tessellator2D */
 
+/* vertices of all the loops, numbered through for the sweep.  the
+   region is on the left side of each edge from a vertex to its next
+   one, since the outer loop is counter clock-wise and the inner loops
+   are clock-wise */
+struct WH_TSLT_SweepPolygon {
+  pmr::vector<WH_Vector2D> position_s;
+  pmr::vector<int> loopId_s;
+  pmr::vector<int> loopVertexId_s;
+  pmr::vector<int> next_s;
+  pmr::vector<int> prev_s;
+
+  WH_TSLT_SweepPolygon (pmr::memory_resource* resource)
+    : position_s (resource), loopId_s (resource), 
+      loopVertexId_s (resource), next_s (resource), prev_s (resource) {}
+};
+
+/* type of a vertex in the sweep from the top to the bottom */
+enum WH_TSLT_VertexType {
+  WH_TSLT_START,
+  WH_TSLT_END,
+  WH_TSLT_SPLIT,
+  WH_TSLT_MERGE,
+  WH_TSLT_LEFT_REGULAR,
+  /* on a left chain, the region is on its right */
+  WH_TSLT_RIGHT_REGULAR
+};
+
+static int Orientation 
+(const WH_Vector2D& p0, 
+ const WH_Vector2D& p1, 
+ const WH_Vector2D& p2)
+{
+  double value = WH_RobustPredicates::orient2d_robust (p0, p1, p2);
+  return (0 < value) - (value < 0);
+}
+
+/* no angle of the triangle is 0, within the tolerance of the other
+   geometry, so that the triangle facet has a normal */
+static bool IsRegularTriangle 
+(const WH_Vector2D& p0, 
+ const WH_Vector2D& p1, 
+ const WH_Vector2D& p2)
+{
+  return !WH_eq (WH_angleOfVectors (p1 - p0, p2 - p0), 0)
+    && !WH_eq (WH_angleOfVectors (p2 - p1, p0 - p1), 0)
+    && !WH_eq (WH_angleOfVectors (p0 - p2, p1 - p2), 0);
+}
+
+/* order of the sweep : from top to bottom, and from left to right on
+   the same height */
+static bool IsAbove 
+(const WH_Vector2D& p, 
+ const WH_Vector2D& q)
+{
+  return q.y < p.y || (p.y == q.y && p.x < q.x);
+}
+
+/* order of the edges crossing the sweep line from left to right.  an
+   edge is numbered after its first vertex, and a negative number -1 -
+   v stands for vertex v to search the edge left of it */
+struct WH_TSLT_EdgeIsLeftOf {
+  const WH_TSLT_SweepPolygon* polygon;
+
+  void getEnds 
+  (int edge, 
+   WH_Vector2D& top_OUT, 
+   WH_Vector2D& bottom_OUT) const
+  {
+    WH_Vector2D p0 = polygon->position_s[edge];
+    WH_Vector2D p1 = polygon->position_s[polygon->next_s[edge]];
+    if (IsAbove (p0, p1)) {
+      top_OUT = p0;  bottom_OUT = p1;
+    } else {
+      top_OUT = p1;  bottom_OUT = p0;
+    }
+  }
+
+  bool operator() (int edge0, int edge1) const
+  {
+    if (edge0 == edge1) return false;
+
+    /* positive orientation of (top, bottom, p) is right of the edge */
+    WH_Vector2D top0, bottom0;
+    WH_Vector2D top1, bottom1;
+    if (edge1 < 0) {
+      getEnds (edge0, top0, bottom0);
+      return 0 < Orientation 
+	(top0, bottom0, polygon->position_s[-1 - edge1]);
+    }
+    if (edge0 < 0) {
+      getEnds (edge1, top1, bottom1);
+      return Orientation 
+	(top1, bottom1, polygon->position_s[-1 - edge0]) < 0;
+    }
+
+    getEnds (edge0, top0, bottom0);
+    getEnds (edge1, top1, bottom1);
+    int side0 = Orientation (top0, bottom0, top1);
+    int side1 = Orientation (top0, bottom0, bottom1);
+    if (0 <= side0 && 0 <= side1 && 0 < side0 + side1) return true;
+    if (side0 <= 0 && side1 <= 0 && side0 + side1 < 0) return false;
+    side0 = Orientation (top1, bottom1, top0);
+    side1 = Orientation (top1, bottom1, bottom0);
+    if (0 <= side0 && 0 <= side1 && 0 < side0 + side1) return false;
+    if (side0 <= 0 && side1 <= 0 && side0 + side1 < 0) return true;
+    return edge0 < edge1;
+  }
+};
+
+/* add diagonals which divide the region into y-monotone polygons */
+static bool MakeMonotone 
+(const WH_TSLT_SweepPolygon& polygon,
+ pmr::memory_resource* resource,
+ pmr::vector< pair<int, int> >& diagonal_s_OUT)
+{
+  WH_CVR_LINE;
+
+  const pmr::vector<WH_Vector2D>& position_s = polygon.position_s;
+  int nVertexs = (int)position_s.size ();
+
+  pmr::vector<WH_TSLT_VertexType> type_s (nVertexs, resource);
+  for (int v = 0; v < nVertexs; v++) {
+    int prev = polygon.prev_s[v];
+    int next = polygon.next_s[v];
+    bool prevIsAbove = IsAbove (position_s[prev], position_s[v]);
+    bool nextIsAbove = IsAbove (position_s[next], position_s[v]);
+    bool isConvex = 0 <= Orientation 
+      (position_s[prev], position_s[v], position_s[next]);
+    if (!prevIsAbove && !nextIsAbove) {
+      type_s[v] = isConvex ? WH_TSLT_START : WH_TSLT_SPLIT;
+    } else if (prevIsAbove && nextIsAbove) {
+      type_s[v] = isConvex ? WH_TSLT_END : WH_TSLT_MERGE;
+    } else if (prevIsAbove) {
+      type_s[v] = WH_TSLT_LEFT_REGULAR;
+    } else {
+      type_s[v] = WH_TSLT_RIGHT_REGULAR;
+    }
+  }
+
+  pmr::vector<int> order_s (nVertexs, resource);
+  for (int v = 0; v < nVertexs; v++) {
+    order_s[v] = v;
+  }
+  sort (order_s.begin (), order_s.end (), 
+	[&position_s] (int v0, int v1) {
+	  return IsAbove (position_s[v0], position_s[v1]);
+	});
+
+  WH_TSLT_EdgeIsLeftOf edgeIsLeftOf;
+  edgeIsLeftOf.polygon = &polygon;
+  pmr::set<int, WH_TSLT_EdgeIsLeftOf> status (edgeIsLeftOf, resource);
+  pmr::vector<int> helper_s (nVertexs, WH_NO_INDEX, resource);
+
+  for (pmr::vector<int>::const_iterator 
+	 i_v = order_s.begin ();
+       i_v != order_s.end ();
+       i_v++) {
+    int v = (*i_v);
+    int prevEdge = polygon.prev_s[v];
+
+    if (type_s[v] == WH_TSLT_END
+	|| type_s[v] == WH_TSLT_MERGE
+	|| type_s[v] == WH_TSLT_LEFT_REGULAR) {
+      /* <prevEdge> ends at <v> */
+      if (type_s[helper_s[prevEdge]] == WH_TSLT_MERGE) {
+	diagonal_s_OUT.push_back (make_pair (v, helper_s[prevEdge]));
+      }
+      if (status.erase (prevEdge) != 1) return false;
+    }
+
+    if (type_s[v] == WH_TSLT_SPLIT
+	|| type_s[v] == WH_TSLT_MERGE
+	|| type_s[v] == WH_TSLT_RIGHT_REGULAR) {
+      /* the edge left of <v> */
+      pmr::set<int, WH_TSLT_EdgeIsLeftOf>::iterator i_edge 
+	= status.lower_bound (-1 - v);
+      if (i_edge == status.begin ()) return false;
+      i_edge--;
+      int leftEdge = (*i_edge);
+      if (type_s[v] == WH_TSLT_SPLIT
+	  || type_s[helper_s[leftEdge]] == WH_TSLT_MERGE) {
+	diagonal_s_OUT.push_back (make_pair (v, helper_s[leftEdge]));
+      }
+      helper_s[leftEdge] = v;
+    }
+
+    if (type_s[v] == WH_TSLT_START
+	|| type_s[v] == WH_TSLT_SPLIT
+	|| type_s[v] == WH_TSLT_LEFT_REGULAR) {
+      /* the edge from <v> starts */
+      if (!status.insert (v).second) return false;
+      helper_s[v] = v;
+    }
+  }
+
+  return status.size () == 0;
+}
+
+/* order of the directions from <center> by the clockwise angle from
+   <back>, in (0, 2 pi] : 0 for the angles in (0, pi), 1 for pi, 2 for
+   (pi, 2 pi) and 3 for 2 pi */
+static int ClockwiseHalf 
+(const WH_Vector2D& center,
+ const WH_Vector2D& back,
+ const WH_Vector2D& point)
+{
+  int side = Orientation (center, back, point);
+  if (side < 0) return 0;
+  if (0 < side) return 2;
+  return (0 < WH_scalarProduct (point - center, back - center)) ? 3 : 1;
+}
+
+/* true if <point0> comes before <point1> clockwise from <back> around
+   <center>, by exact predicates */
+static bool IsBeforeClockwise 
+(const WH_Vector2D& center,
+ const WH_Vector2D& back,
+ const WH_Vector2D& point0,
+ const WH_Vector2D& point1)
+{
+  int half0 = ClockwiseHalf (center, back, point0);
+  int half1 = ClockwiseHalf (center, back, point1);
+  if (half0 != half1) return half0 < half1;
+  return Orientation (center, point0, point1) < 0;
+}
+
+/* collect the monotone polygons bounded by the loops and <diagonal_s>,
+   each counter clock-wise */
+static bool CollectMonotonePolygons 
+(const WH_TSLT_SweepPolygon& polygon,
+ const pmr::vector< pair<int, int> >& diagonal_s,
+ pmr::memory_resource* resource,
+ pmr::vector< pmr::vector<int> >& monotone_s_OUT)
+{
+  WH_CVR_LINE;
+
+  const pmr::vector<WH_Vector2D>& position_s = polygon.position_s;
+  int nVertexs = (int)position_s.size ();
+
+  /* half edges with the region on their left */
+  pmr::vector< pmr::vector<int> > out_s (nVertexs, resource);
+  for (int v = 0; v < nVertexs; v++) {
+    out_s[v].push_back (polygon.next_s[v]);
+  }
+  for (pmr::vector< pair<int, int> >::const_iterator 
+	 i_diagonal = diagonal_s.begin ();
+       i_diagonal != diagonal_s.end ();
+       i_diagonal++) {
+    out_s[i_diagonal->first].push_back (i_diagonal->second);
+    out_s[i_diagonal->second].push_back (i_diagonal->first);
+  }
+  pmr::vector< pmr::vector<bool> > isVisited_s (nVertexs, resource);
+  for (int v = 0; v < nVertexs; v++) {
+    isVisited_s[v].assign (out_s[v].size (), false);
+  }
+  int nHalfEdges = nVertexs + 2 * (int)diagonal_s.size ();
+
+  for (int v = 0; v < nVertexs; v++) {
+    for (int k = 0; k < (int)out_s[v].size (); k++) {
+      if (isVisited_s[v][k]) continue;
+
+      pmr::vector<int> monotone (resource);
+      int from = v;
+      int kOut = k;
+      for (;;) {
+	if (isVisited_s[from][kOut]) break;
+	if (nHalfEdges < (int)monotone.size ()) return false;
+	isVisited_s[from][kOut] = true;
+	monotone.push_back (from);
+
+	/* the next half edge is the first one clockwise from the way
+	   back */
+	int to = out_s[from][kOut];
+	const pmr::vector<int>& toOut = out_s[to];
+	int kNext = 0;
+	for (int kTo = 1; kTo < (int)toOut.size (); kTo++) {
+	  if (IsBeforeClockwise 
+	      (position_s[to], position_s[from], 
+	       position_s[toOut[kTo]], position_s[toOut[kNext]])) {
+	    kNext = kTo;
+	  }
+	}
+	from = to;
+	kOut = kNext;
+      }
+      if (from != v || kOut != k || monotone.size () < 3) return false;
+      monotone_s_OUT.push_back (std::move (monotone));
+    }
+  }
+
+  return true;
+}
+
+/* triangulate a y-monotone polygon, counter clock-wise, by the stack
+   along its chains */
+static bool TriangulateMonotonePolygon 
+(const WH_TSLT_SweepPolygon& polygon,
+ const pmr::vector<int>& monotone,
+ pmr::memory_resource* resource,
+ pmr::vector<int>& triangleVertex_s_OUT)
+{
+  WH_CVR_LINE;
+
+  const pmr::vector<WH_Vector2D>& position_s = polygon.position_s;
+  int nVertexs = (int)monotone.size ();
+
+  int iTop = 0;
+  int iBottom = 0;
+  for (int i = 1; i < nVertexs; i++) {
+    if (IsAbove (position_s[monotone[i]], position_s[monotone[iTop]])) {
+      iTop = i;
+    }
+    if (IsAbove (position_s[monotone[iBottom]], position_s[monotone[i]])) {
+      iBottom = i;
+    }
+  }
+
+  /* counter clock-wise from the top to the bottom is the left chain */
+  pmr::vector<bool> isLeft_s (nVertexs, false, resource);
+  for (int i = (iTop + 1) % nVertexs; i != iBottom; i = (i + 1) % nVertexs) {
+    isLeft_s[i] = true;
+  }
+
+  /* merge the chains */
+  pmr::vector<int> order_s (resource);
+  order_s.reserve (nVertexs);
+  order_s.push_back (iTop);
+  int iLeft = (iTop + 1) % nVertexs;
+  int iRight = (iTop + nVertexs - 1) % nVertexs;
+  while ((int)order_s.size () < nVertexs) {
+    if (iLeft == iBottom 
+	|| (iRight != iBottom 
+	    && IsAbove (position_s[monotone[iRight]], 
+			position_s[monotone[iLeft]]))) {
+      order_s.push_back (iRight);
+      iRight = (iRight + nVertexs - 1) % nVertexs;
+    } else {
+      order_s.push_back (iLeft);
+      if (iLeft == iBottom) break;
+      iLeft = (iLeft + 1) % nVertexs;
+    }
+  }
+  if ((int)order_s.size () != nVertexs || order_s.back () != iBottom) {
+    return false;
+  }
+
+  auto addTriangle = [&] (int i0, int i1, int i2) {
+    int v0 = monotone[i0];
+    int v1 = monotone[i1];
+    int v2 = monotone[i2];
+    int orientation = Orientation 
+      (position_s[v0], position_s[v1], position_s[v2]);
+    if (orientation == 0) return false;
+    if (orientation < 0) swap (v1, v2);
+    triangleVertex_s_OUT.push_back (v0);
+    triangleVertex_s_OUT.push_back (v1);
+    triangleVertex_s_OUT.push_back (v2);
+    return true;
+  };
+
+  pmr::vector<int> stack (resource);
+  stack.push_back (order_s[0]);
+  stack.push_back (order_s[1]);
+  for (int j = 2; j < nVertexs - 1; j++) {
+    int i = order_s[j];
+    if (isLeft_s[i] != isLeft_s[stack.back ()]) {
+      /* the whole stack is visible from <i> */
+      for (int s = 0; s + 1 < (int)stack.size (); s++) {
+	if (!addTriangle (i, stack[s], stack[s + 1])) return false;
+      }
+      int last = stack.back ();
+      stack.clear ();
+      stack.push_back (last);
+      stack.push_back (i);
+    } else {
+      int last = stack.back ();
+      stack.pop_back ();
+      while (0 < stack.size ()) {
+	const WH_Vector2D& p = position_s[monotone[i]];
+	const WH_Vector2D& q = position_s[monotone[last]];
+	const WH_Vector2D& r = position_s[monotone[stack.back ()]];
+	bool isInside = isLeft_s[i] 
+	  ? 0 < Orientation (r, q, p)
+	  : 0 < Orientation (p, q, r);
+	if (!isInside) break;
+	if (!addTriangle (i, last, stack.back ())) return false;
+	last = stack.back ();
+	stack.pop_back ();
+      }
+      stack.push_back (last);
+      stack.push_back (i);
+    }
+  }
+  for (int s = 0; s + 1 < (int)stack.size (); s++) {
+    if (!addTriangle (iBottom, stack[s], stack[s + 1])) return false;
+  }
+
+  return true;
+}
+
+/* flip the diagonals of <triangleVertex_s>, counter clock-wise, into
+   the constrained Delaunay triangulation of the loops, which has the
+   best shaped triangles on the vertices */
+static void MakeDelaunay 
+(const WH_TSLT_SweepPolygon& polygon,
+ pmr::memory_resource* resource,
+ pmr::vector<int>& triangleVertex_s)
+{
+  WH_CVR_LINE;
+
+  const pmr::vector<WH_Vector2D>& position_s = polygon.position_s;
+  long long nVertexs = (long long)position_s.size ();
+  int nTriangles = (int)triangleVertex_s.size () / 3;
+
+  auto keyOf = [nVertexs] (int v0, int v1) {
+    return (long long)WH_min (v0, v1) * nVertexs + WH_max (v0, v1);
+  };
+  auto isLoopEdge = [&polygon] (int v0, int v1) {
+    return polygon.next_s[v0] == v1 || polygon.next_s[v1] == v0;
+  };
+
+  /* the 2 triangles on each edge */
+  pmr::unordered_map<long long, pair<int, int> > edgeTriangle_s (resource);
+  edgeTriangle_s.reserve (nTriangles * 3);
+  pmr::vector<long long> stack (resource);
+  for (int iTri = 0; iTri < nTriangles; iTri++) {
+    for (int e = 0; e < 3; e++) {
+      int v0 = triangleVertex_s[iTri * 3 + e];
+      int v1 = triangleVertex_s[iTri * 3 + (e + 1) % 3];
+      pair<int, int>& tri_s = edgeTriangle_s.emplace 
+	(keyOf (v0, v1), make_pair (WH_NO_INDEX, WH_NO_INDEX)).first->second;
+      if (tri_s.first == WH_NO_INDEX) {
+	tri_s.first = iTri;
+      } else {
+	tri_s.second = iTri;
+	if (!isLoopEdge (v0, v1)) stack.push_back (keyOf (v0, v1));
+      }
+    }
+  }
+
+  auto replaceTriangle = [&] (int v0, int v1, int oldTri, int newTri) {
+    pair<int, int>& tri_s = edgeTriangle_s[keyOf (v0, v1)];
+    if (tri_s.first == oldTri) {
+      tri_s.first = newTri;
+    } else {
+      tri_s.second = newTri;
+    }
+  };
+
+  while (0 < stack.size ()) {
+    long long key = stack.back ();
+    stack.pop_back ();
+    pmr::unordered_map<long long, pair<int, int> >::iterator i_edge 
+      = edgeTriangle_s.find (key);
+    if (i_edge == edgeTriangle_s.end ()) continue;
+    int tri0 = i_edge->second.first;
+    int tri1 = i_edge->second.second;
+    if (tri1 == WH_NO_INDEX) continue;
+
+    /* <tri0> is (x, y, c) and <tri1> is (y, x, d) */
+    int* vertex0 = &triangleVertex_s[tri0 * 3];
+    int* vertex1 = &triangleVertex_s[tri1 * 3];
+    int e0 = 0;
+    while (keyOf (vertex0[e0], vertex0[(e0 + 1) % 3]) != key) e0++;
+    int x = vertex0[e0];
+    int y = vertex0[(e0 + 1) % 3];
+    int c = vertex0[(e0 + 2) % 3];
+    int d = WH_NO_INDEX;
+    for (int v = 0; v < 3; v++) {
+      if (vertex1[v] != x && vertex1[v] != y) d = vertex1[v];
+    }
+
+    if (WH_RobustPredicates::incircle_robust 
+	(position_s[x], position_s[y], position_s[c], position_s[d]) <= 0
+	|| Orientation (position_s[x], position_s[d], position_s[c]) <= 0
+	|| Orientation (position_s[d], position_s[y], position_s[c]) <= 0) {
+      continue;
+    }
+
+    /* flip to (x, d, c) and (d, y, c) */
+    vertex0[0] = x;  vertex0[1] = d;  vertex0[2] = c;
+    vertex1[0] = d;  vertex1[1] = y;  vertex1[2] = c;
+    edgeTriangle_s.erase (i_edge);
+    edgeTriangle_s[keyOf (c, d)] = make_pair (tri0, tri1);
+    replaceTriangle (y, c, tri0, tri1);
+    replaceTriangle (x, d, tri1, tri0);
+
+    int outer_s[4][2] = { { x, d }, { d, y }, { y, c }, { c, x } };
+    for (int e = 0; e < 4; e++) {
+      if (!isLoopEdge (outer_s[e][0], outer_s[e][1])) {
+	stack.push_back (keyOf (outer_s[e][0], outer_s[e][1]));
+      }
+    }
+  }
+}
+
 WH_TSLT_Tessellator2D
-::WH_TSLT_Tessellator2D ()
+::WH_TSLT_Tessellator2D (Method method, WH_Arena* arena)
 {
   WH_CVR_LINE;
 
-  _triangulator = new WH_AF2D_Triangulator_TSLT ();
+  _method = method;
+  _triangulator = WH_NULL;
   _currentLoop = WH_NULL;
+  _ownsArena = (arena == WH_NULL);
+  _arena = _ownsArena ? new WH_Arena () : arena;
+  WH_ASSERT(_arena != WH_NULL);
 }
  
 WH_TSLT_Tessellator2D
@@ -272,10 +776,11 @@ WH_TSLT_Tessellator2D
 {
   WH_CVR_LINE;
 
+  /* <_triangle_s> are on <_arena> */
   WH_T_Delete (_loop_s);
-  WH_T_Delete (_triangle_s);
   delete _triangulator;
   delete _currentLoop;
+  if (_ownsArena) delete _arena;
 }
 
 bool WH_TSLT_Tessellator2D
@@ -305,8 +810,6 @@ void WH_TSLT_Tessellator2D
   _currentLoop = new Loop ();
   WH_ASSERT(_currentLoop != WH_NULL);
 
-  _triangulator->beginLoop ();
-
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
   WH_ASSERT(_currentLoop != WH_NULL);
@@ -320,8 +823,6 @@ void WH_TSLT_Tessellator2D
   WH_ASSERT(_currentLoop != WH_NULL);
 
   _currentLoop->vertex_s.push_back (position);
-
-  _triangulator->addLoopVertex (position);
 }
 
 void WH_TSLT_Tessellator2D
@@ -334,21 +835,122 @@ void WH_TSLT_Tessellator2D
   _loop_s.push_back (_currentLoop);
   _currentLoop = WH_NULL;
 
-  _triangulator->endLoop ();
-
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
   WH_ASSERT(_currentLoop == WH_NULL);
 #endif
 }
 
+bool WH_TSLT_Tessellator2D
+::performMonotone ()
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(_triangle_s.size () == 0);
+
+  WH_CVR_LINE;
+
+  pmr::memory_resource* resource = _arena->resource ();
+
+  WH_TSLT_SweepPolygon polygon (resource);
+  int nVertexs = 0;
+  for (int iLoop = 0; iLoop < (int)_loop_s.size (); iLoop++) {
+    const vector<WH_Vector2D>& vertex_s = _loop_s[iLoop]->vertex_s;
+    int nLoopVertexs = (int)vertex_s.size ();
+    for (int iVertex = 0; iVertex < nLoopVertexs; iVertex++) {
+      polygon.position_s.push_back (vertex_s[iVertex]);
+      polygon.loopId_s.push_back (iLoop);
+      polygon.loopVertexId_s.push_back (iVertex);
+      polygon.next_s.push_back 
+	(nVertexs + (iVertex + 1) % nLoopVertexs);
+      polygon.prev_s.push_back 
+	(nVertexs + (iVertex + nLoopVertexs - 1) % nLoopVertexs);
+    }
+    nVertexs += nLoopVertexs;
+  }
+
+  pmr::vector< pair<int, int> > diagonal_s (resource);
+  pmr::vector< pmr::vector<int> > monotone_s (resource);
+  if (!MakeMonotone (polygon, resource, diagonal_s)) return false;
+  if (!CollectMonotonePolygons (polygon, diagonal_s, resource, 
+				monotone_s)) {
+    return false;
+  }
+
+  pmr::vector<int> triangleVertex_s (resource);
+  triangleVertex_s.reserve ((nVertexs + 2 * _loop_s.size ()) * 3);
+  for (pmr::vector< pmr::vector<int> >::const_iterator 
+	 i_monotone = monotone_s.begin ();
+       i_monotone != monotone_s.end ();
+       i_monotone++) {
+    if (!TriangulateMonotonePolygon 
+	(polygon, (*i_monotone), resource, triangleVertex_s)) {
+      return false;
+    }
+  }
+
+  /* Euler's formula for a region with holes */
+  int nTriangles = (int)triangleVertex_s.size () / 3;
+  if (nTriangles != nVertexs + 2 * ((int)_loop_s.size () - 1) - 2) {
+    return false;
+  }
+
+  MakeDelaunay (polygon, resource, triangleVertex_s);
+  for (int iTri = 0; iTri < nTriangles; iTri++) {
+    if (!IsRegularTriangle 
+	(polygon.position_s[triangleVertex_s[iTri * 3 + 0]],
+	 polygon.position_s[triangleVertex_s[iTri * 3 + 1]],
+	 polygon.position_s[triangleVertex_s[iTri * 3 + 2]])) {
+      return false;
+    }
+  }
+
+  for (int iTri = 0; iTri < nTriangles; iTri++) {
+    int v0 = triangleVertex_s[iTri * 3 + 0];
+    int v1 = triangleVertex_s[iTri * 3 + 1];
+    int v2 = triangleVertex_s[iTri * 3 + 2];
+
+    Triangle* newTri = _arena->create<Triangle> ();
+    WH_ASSERT(newTri != WH_NULL);
+    
+    newTri->loopId0 = polygon.loopId_s[v0];
+    newTri->vertexId0 = polygon.loopVertexId_s[v0];
+    newTri->loopId1 = polygon.loopId_s[v1];
+    newTri->vertexId1 = polygon.loopVertexId_s[v1];
+    newTri->loopId2 = polygon.loopId_s[v2];
+    newTri->vertexId2 = polygon.loopVertexId_s[v2];
+
+    _triangle_s.push_back (newTri);
+  }
+
+  return true;
+}
+
 void WH_TSLT_Tessellator2D
-::perform ()
+::performAdvancingFront ()
 {
   /* PRE-CONDITION */
-  WH_ASSERT(_currentLoop == WH_NULL);
+  WH_ASSERT(_triangulator == WH_NULL);
   WH_ASSERT(_triangle_s.size () == 0);
-  WH_ASSERT(0 < _loop_s.size ());
+
+  WH_CVR_LINE;
+
+  _triangulator = new WH_AF2D_Triangulator_TSLT ();
+  WH_ASSERT(_triangulator != WH_NULL);
+
+  for (vector<Loop*>::const_iterator 
+	 i_loop = _loop_s.begin ();
+       i_loop != _loop_s.end ();
+       i_loop++) {
+    Loop* loop_i = (*i_loop);
+    _triangulator->beginLoop ();
+    for (vector<WH_Vector2D>::const_iterator 
+	   i_vertex = loop_i->vertex_s.begin ();
+	 i_vertex != loop_i->vertex_s.end ();
+	 i_vertex++) {
+      _triangulator->addLoopVertex (*i_vertex);
+    }
+    _triangulator->endLoop ();
+  }
 
   _triangulator->perform ();
 
@@ -365,7 +967,7 @@ void WH_TSLT_Tessellator2D
     WH_AF2D_Vertex_TSLT* vertex2 
       = (WH_AF2D_Vertex_TSLT*)tri_i->vertex2 ();
 
-    Triangle* newTri = new Triangle ();
+    Triangle* newTri = _arena->create<Triangle> ();
     WH_ASSERT(newTri != WH_NULL);
     
     newTri->loopId0 = vertex0->loopId ();
@@ -377,6 +979,28 @@ void WH_TSLT_Tessellator2D
 
     _triangle_s.push_back (newTri);
   }
+}
+
+void WH_TSLT_Tessellator2D
+::perform ()
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(_currentLoop == WH_NULL);
+  WH_ASSERT(_triangle_s.size () == 0);
+  WH_ASSERT(0 < _loop_s.size ());
+
+  if (_method == MONOTONE) {
+    WH_CVR_LINE;
+    if (!this->performMonotone ()) {
+      WH_CVR_LINE;
+      /* degenerate loops : fall back to the advancing front */
+      _triangle_s.clear ();
+      this->performAdvancingFront ();
+    }
+  } else {
+    WH_CVR_LINE;
+    this->performAdvancingFront ();
+  }
 
   /* POST-CONDITION */
 #ifndef WH_PRE_ONLY
@@ -396,6 +1020,13 @@ const vector<WH_TSLT_Tessellator2D::Triangle*>& WH_TSLT_Tessellator2D
   return _triangle_s;
 }
 
+WH_TSLT_Tessellator2D::Method WH_TSLT_Tessellator2D
+::method () const
+{
+  return _method;
+}
+
 
 
 /* not yet covered */
+
@@ -12,6 +12,11 @@
 #define WH_INCLUDED_WH_AFRONT2D
 #endif
 
+#ifndef WH_INCLUDED_WH_ARENA
+#include <WH/arena.h>
+#define WH_INCLUDED_WH_ARENA
+#endif
+
 /* classes derived from afront2d classes */
 class WH_AF2D_Vertex_TSLT;
 class WH_AF2D_Triangulator_TSLT;
@@ -92,7 +97,18 @@ class WH_AF2D_Triangulator_TSLT : public WH_AF2D_Triangulator_A {
 /* heavy weight */
 class WH_TSLT_Tessellator2D {
  public:
-  WH_TSLT_Tessellator2D ();
+  enum Method {
+    MONOTONE,
+    /* sweep-line decomposition into monotone polygons, O(n log n) */
+    ADVANCING_FRONT
+    /* well shaped triangles, much slower */
+  };
+
+  WH_TSLT_Tessellator2D 
+    (Method method = MONOTONE,
+     WH_Arena* arena = WH_NULL);
+  /* the temporaries and the triangles are on <arena>, or on an own
+     arena if it is WH_NULL */
   virtual ~WH_TSLT_Tessellator2D ();
   virtual bool checkInvariant () const;
   virtual bool assureInvariant () const;
@@ -118,19 +134,33 @@ class WH_TSLT_Tessellator2D {
     int vertexId2;
   };
   const vector<Triangle*>& triangle_s () const;
+
+  Method method () const;
   
   /* derived */
   
  protected:
+  Method _method;
+
   vector<Loop*> _loop_s;  /* own */
   
-  vector<Triangle*> _triangle_s;  /* own */
+  vector<Triangle*> _triangle_s;  /* on <_arena> */
+
+  WH_Arena* _arena;  /* own if <_ownsArena> */
+
+  bool _ownsArena;
 
   WH_AF2D_Triangulator_TSLT* _triangulator;  /* own */
+  /* WH_NULL unless the advancing front is used */
 
   Loop* _currentLoop;  /* own */
 
   /* base */
+  virtual bool performMonotone ();
+  /* false if the loops are too degenerate for the sweep, leaving no
+     triangle */
+
+  virtual void performAdvancingFront ();
 
   /* derived */
 
@@ -1,9 +1,19 @@
 #include <chrono>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <vector>
 #include "WH/space3d.h"
 #include "WH/polygon3d.h"
 #include "WH/sorter.h"
+#include "WH/delaunay3d.h"
+#include "WH/tetrahedron3d.h"
+#include "WH/gm3d_io.h"
+#include "WH/gm3d_brep.h"
+#include "WH/gm3d.h"
+#include "WH/gm3d_facet.h"
+#include "WH/inout3d.h"
+#include "WH/arena.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -104,6 +114,352 @@ void benchmark_constexpr_math() {
     cout << "Average per operation: " << (double)duration.count() / iterations << " microseconds" << endl;
 }
 
+// Tetrahedron which caches its circumsphere, as WH_DLN3D_Tetrahedron
+// did before insphere was evaluated from the vertices
+class SphereCachingTetrahedron : public WH_DLN3D_Tetrahedron {
+public:
+    SphereCachingTetrahedron(WH_DLN3D_Point* point0, WH_DLN3D_Point* point1,
+                             WH_DLN3D_Point* point2, WH_DLN3D_Point* point3)
+        : WH_DLN3D_Tetrahedron(point0, point1, point2, point3) {
+        centerOfSphere = WH_circumcenterAmong(point0->position(), point1->position(),
+                                              point2->position(), point3->position());
+        radiusOfSphere = WH_distance(centerOfSphere, point0->position());
+    }
+
+    // the old test, by the distance to the cached center
+    bool includesWithinCachedSphere(const WH_DLN3D_Point* point) const {
+        double sum = WH_squareSum(point->position(), centerOfSphere);
+        return WH_le(sum, radiusOfSphere * radiusOfSphere);
+    }
+
+    WH_Vector3D centerOfSphere;
+    double radiusOfSphere;
+};
+
+// Triangulator which runs the old sphere test on the cached spheres if
+// <cachesSphere>, and the kernel's test otherwise
+class BenchmarkTriangulator : public WH_DLN3D_Triangulator {
+public:
+    explicit BenchmarkTriangulator(bool cachesSphere)
+        : cachesSphere(cachesSphere), nCreated(0) {}
+
+    bool cachesSphere;
+    long nCreated;
+
+protected:
+    WH_DLN3D_Tetrahedron* createTetrahedron(WH_DLN3D_Point* point0, WH_DLN3D_Point* point1,
+                                            WH_DLN3D_Point* point2, WH_DLN3D_Point* point3) override {
+        nCreated++;
+        if (cachesSphere) {
+            return new SphereCachingTetrahedron(point0, point1, point2, point3);
+        }
+        return new WH_DLN3D_Tetrahedron(point0, point1, point2, point3);
+    }
+
+    bool includesWithinSphere(const WH_DLN3D_Tetrahedron* tetra) const {
+        // every tetrahedron is created by createTetrahedron ()
+        return static_cast<const SphereCachingTetrahedron*>(tetra)
+            ->includesWithinCachedSphere(_currentPoint);
+    }
+
+    WH_DLN3D_Tetrahedron* pickUpFirstTetrahedron() const override {
+        if (!cachesSphere) {
+            return WH_DLN3D_Triangulator::pickUpFirstTetrahedron();
+        }
+        for (WH_DLN3D_Tetrahedron* tetra : _tetrahedron_s) {
+            if (includesWithinSphere(tetra)) {
+                return tetra;
+            }
+        }
+        return WH_NULL;
+    }
+
+    // same as WH_DLN3D_Triangulator::searchNeighbor () but for the test
+    void searchNeighbor(WH_DLN3D_Tetrahedron* tetra, int faceNumber) override {
+        if (!cachesSphere) {
+            WH_DLN3D_Triangulator::searchNeighbor(tetra, faceNumber);
+            return;
+        }
+        WH_DLN3D_Tetrahedron* neighbor = tetra->neighborAt(faceNumber);
+        if (neighbor != WH_NULL && neighbor->hasMark()) return;
+        if (neighbor == WH_NULL || !includesWithinSphere(neighbor)) {
+            WH_DLN3D_Triangle* tri = _arena.create<WH_DLN3D_Triangle>(
+                tetra->point(WH_Tetrahedron3D_A::faceVertexMap[faceNumber][0]),
+                tetra->point(WH_Tetrahedron3D_A::faceVertexMap[faceNumber][1]),
+                tetra->point(WH_Tetrahedron3D_A::faceVertexMap[faceNumber][2]),
+                tetra, faceNumber);
+            _surroundingTriangle_s.push_back(tri);
+            tri->setFront(neighbor);
+        } else {
+            markTetrahedron(neighbor);
+        }
+    }
+};
+
+void benchmark_delaunay3d_tetrahedron() {
+    cout << "\n=== Delaunay 3D Tetrahedron Benchmark ===" << endl;
+
+    const char* models[] = {
+        "stress_tests/complex_csg_1.gm3d", "stress_tests/complex_csg_2.gm3d",
+        "stress_tests/complex_csg_3.gm3d", "stress_tests/multi_box_1.gm3d",
+        "stress_tests/multi_box_2.gm3d", "stress_tests/multi_box_3.gm3d",
+        "stress_tests/nested_feat_1.gm3d", "stress_tests/nested_feat_2.gm3d",
+        "stress_tests/thin_struct_1.gm3d", "stress_tests/thin_struct_2.gm3d"
+    };
+    const int gridPoints = 16;
+
+    cout << "Tetrahedron size: cached sphere " << sizeof(SphereCachingTetrahedron)
+         << " bytes, compact " << sizeof(WH_DLN3D_Tetrahedron) << " bytes" << endl;
+
+    for (const char* model : models) {
+        if (!ifstream(model)) {
+            cout << model << ": not found, skipped" << endl;
+            continue;
+        }
+
+        // vertices of the model and a jittered grid over its bounding box
+        WH_GM3D_Body* body = WH_GM3D_IO::createBodyFromFile(model);
+        vector<WH_Vector3D> position_s;
+        for (WH_GM3D_Vertex* vertex : body->vertex_s()) {
+            position_s.push_back(vertex->point());
+        }
+        delete body;
+        WH_Vector3D minRange = position_s[0];
+        WH_Vector3D maxRange = position_s[0];
+        for (const WH_Vector3D& position : position_s) {
+            minRange = WH_min(minRange, position);
+            maxRange = WH_max(maxRange, position);
+        }
+        WH_Vector3D step = (maxRange - minRange) / gridPoints;
+        unsigned int seed = 1;
+        for (int i = 0; i < gridPoints; ++i) {
+            for (int j = 0; j < gridPoints; ++j) {
+                for (int k = 0; k < gridPoints; ++k) {
+                    double jitter[3];
+                    for (int d = 0; d < 3; ++d) {
+                        seed = seed * 1103515245 + 12345;
+                        jitter[d] = 0.25 + 0.5 * (double)((seed >> 16) & 0x7fff) / 0x8000;
+                    }
+                    position_s.push_back(minRange + WH_Vector3D(step.x * (i + jitter[0]),
+                                                                step.y * (j + jitter[1]),
+                                                                step.z * (k + jitter[2])));
+                }
+            }
+        }
+
+        cout << model << " (" << position_s.size() << " points)" << endl;
+        for (int cachesSphere = 1; 0 <= cachesSphere; --cachesSphere) {
+            BenchmarkTriangulator triangulator(cachesSphere != 0);
+            for (int i = 0; i < (int)position_s.size(); ++i) {
+                WH_DLN3D_Point* point = new WH_DLN3D_Point(position_s[i]);
+                point->setId(i);
+                triangulator.addPoint(point);
+            }
+
+            auto start = high_resolution_clock::now();
+            triangulator.perform();
+            auto end = high_resolution_clock::now();
+            auto duration = duration_cast<microseconds>(end - start);
+
+            size_t tetraSize = cachesSphere ? sizeof(SphereCachingTetrahedron)
+                                            : sizeof(WH_DLN3D_Tetrahedron);
+            long nTetras = (long)triangulator.tetrahedron_s().size();
+            cout << "  " << (cachesSphere ? "cached sphere, distance" : "compact, insphere      ")
+                 << ": " << duration.count() << " microseconds, "
+                 << position_s.size() * 1e6 / WH_max(1L, (long)duration.count()) << " points/s, "
+                 << triangulator.nCreated << " tetrahedrons created ("
+                 << triangulator.nCreated * tetraSize / 1024 << " KB), "
+                 << nTetras << " alive (" << nTetras * tetraSize / 1024 << " KB)" << endl;
+        }
+    }
+}
+
+void benchmark_polygon_facet_accessors() {
+    cout << "\n=== Polygon Facet Accessors Benchmark ===" << endl;
+
+    const char* models[] = {
+        "stress_tests/complex_csg_1.gm3d", "stress_tests/multi_box_1.gm3d",
+        "stress_tests/nested_feat_1.gm3d", "stress_tests/thin_struct_1.gm3d"
+    };
+    const int gridPoints = 32;
+    // -1 unless WH is built with WH_HEAP_COUNTER_ENABLED
+    bool countsAllocations = WH_nProcessHeapAllocations() >= 0;
+
+    cout << "Polygon size: 2D " << sizeof(WH_Polygon2D) << " bytes, 3D "
+         << sizeof(WH_Polygon3D) << " bytes, up to "
+         << WH_Polygon2D::N_INLINE_VERTEXS << " vertices inline" << endl;
+    if (!countsAllocations) {
+        cout << "Heap allocations not counted: build WH with WH_HEAP_COUNTER_ENABLED" << endl;
+    }
+
+    for (const char* model : models) {
+        if (!ifstream(model)) {
+            cout << model << ": not found, skipped" << endl;
+            continue;
+        }
+
+        WH_GM3D_Body* body = WH_GM3D_IO::createBodyFromFile(model);
+        WH_GM3D_FacetBody* facetBody = WH_GM3D::createFacetBody(body);
+        delete body;
+        const vector<WH_GM3D_PolygonFacet*>& facet_s = facetBody->polygonFacet_s();
+
+        // copies of every loop polygon, as the by-value accessors made
+        long nCopies = 0;
+        long nLargeCopies = 0;
+        long long nAllocations = WH_nProcessHeapAllocations();
+        for (WH_GM3D_PolygonFacet* facet : facet_s) {
+            WH_Polygon3D poly = facet->outerLoopPolygon();
+            WH_Polygon2D paramPoly = facet->outerLoopParameterPolygon();
+            nCopies += 2;
+            nLargeCopies += 2 * (poly.nVertexs() > WH_Polygon3D::N_INLINE_VERTEXS);
+            for (const WH_Polygon2D& innerPoly : facet->innerLoopParameterPolygon_s()) {
+                WH_Polygon2D innerCopy = innerPoly;
+                nCopies++;
+                nLargeCopies += (innerCopy.nVertexs() > WH_Polygon2D::N_INLINE_VERTEXS);
+            }
+        }
+        nAllocations = WH_nProcessHeapAllocations() - nAllocations;
+
+        // containment over a grid of parameters of each facet, through copies
+        // of the loops and through the facet
+        long nQueries = 0;
+        long nInside[2] = {0, 0};
+        long long nQueryAllocations[2];
+        long elapsed[2];
+        for (int byReference = 0; byReference < 2; ++byReference) {
+            long long allocationsBefore = WH_nProcessHeapAllocations();
+            auto start = high_resolution_clock::now();
+            for (WH_GM3D_PolygonFacet* facet : facet_s) {
+                WH_Vector2D minRange, maxRange;
+                facet->getParameterRange(minRange, maxRange);
+                WH_Vector2D step = (maxRange - minRange) / gridPoints;
+                for (int i = 0; i < gridPoints; ++i) {
+                    for (int j = 0; j < gridPoints; ++j) {
+                        WH_Vector2D parameter = minRange
+                            + WH_Vector2D(step.x * (i + 0.5), step.y * (j + 0.5));
+                        WH_Polygon2D::ContainmentType flag;
+                        if (byReference) {
+                            flag = facet->checkContainmentAt(parameter);
+                        } else {
+                            WH_Polygon2D outerPoly = facet->outerLoopParameterPolygon();
+                            flag = outerPoly.checkContainmentAt(parameter);
+                            if (flag == WH_Polygon2D::IN) {
+                                for (WH_Polygon2D innerPoly : facet->innerLoopParameterPolygon_s()) {
+                                    WH_Polygon2D::ContainmentType innerFlag
+                                        = innerPoly.checkContainmentAt(parameter);
+                                    if (innerFlag != WH_Polygon2D::OUT) {
+                                        flag = (innerFlag == WH_Polygon2D::IN)
+                                            ? WH_Polygon2D::OUT : WH_Polygon2D::ON;
+                                        break;
+                                    }
+                                }
+                            }
+                        }
+                        nInside[byReference] += (flag == WH_Polygon2D::IN);
+                        nQueries += (byReference == 0);
+                    }
+                }
+            }
+            auto end = high_resolution_clock::now();
+            elapsed[byReference] = (long)duration_cast<microseconds>(end - start).count();
+            nQueryAllocations[byReference] = WH_nProcessHeapAllocations() - allocationsBefore;
+        }
+
+        cout << model << " (" << facet_s.size() << " facets)" << endl;
+        cout << "  loop copies: " << nCopies << " (" << nLargeCopies
+             << " beyond the inline vertices)";
+        if (countsAllocations) {
+            cout << ", heap allocations " << nAllocations;
+        }
+        cout << endl;
+        cout << "  " << nQueries << " containment queries: through copies "
+             << elapsed[0] << " microseconds";
+        if (countsAllocations) {
+            cout << ", " << nQueryAllocations[0] << " allocations";
+        }
+        cout << "; through facet " << elapsed[1] << " microseconds";
+        if (countsAllocations) {
+            cout << ", " << nQueryAllocations[1] << " allocations";
+        }
+        cout << (nInside[0] == nInside[1] ? "" : " (MISMATCH)") << endl;
+
+        delete facetBody;
+    }
+}
+
+void benchmark_inout_checkers() {
+    cout << "\n=== In-Out Checker Benchmark ===" << endl;
+
+    const char* models[] = {
+        "stress_tests/complex_csg_1.gm3d", "stress_tests/multi_box_1.gm3d",
+        "stress_tests/nested_feat_1.gm3d", "stress_tests/thin_struct_1.gm3d"
+    };
+    const int gridPoints = 40;
+    const WH_InOutChecker3D::CheckerType checkerType_s[] = {
+        WH_InOutChecker3D::BUCKET_CHECKER, WH_InOutChecker3D::BVH_RAY_CHECKER,
+        WH_InOutChecker3D::BVH_WINDING_NUMBER_CHECKER
+    };
+    const char* checkerName_s[] = {"bucket        ", "BVH ray       ", "BVH winding   "};
+
+    for (const char* model : models) {
+        if (!ifstream(model)) {
+            cout << model << ": not found, skipped" << endl;
+            continue;
+        }
+        cout << model << " (" << gridPoints * gridPoints * gridPoints << " points)" << endl;
+
+        long nBucketInside = -1;
+        for (int iType = 0; iType < 3; ++iType) {
+            WH_InOutChecker3D::setCheckerType(checkerType_s[iType]);
+            WH_GM3D_Body* body = WH_GM3D_IO::createBodyFromFile(model);
+            WH_GM3D_FacetBody* facetBody = WH_GM3D::createFacetBody(body);
+            delete body;
+            if (facetBody->bodyType() != WH_GM3D_FacetBody::VOLUME) {
+                cout << "  not a volume, skipped" << endl;
+                delete facetBody;
+                break;
+            }
+
+            auto start = high_resolution_clock::now();
+            facetBody->setUpInOutCheck();
+            auto built = high_resolution_clock::now();
+
+            // grid over the range, extended so that some points are outside
+            WH_Vector3D minRange, maxRange;
+            facetBody->getRange(minRange, maxRange);
+            WH_Vector3D margin = (maxRange - minRange) / 10;
+            minRange -= margin;
+            maxRange += margin;
+            WH_Vector3D step = (maxRange - minRange) / gridPoints;
+            long nInside = 0;
+            long nOn = 0;
+            for (int i = 0; i < gridPoints; ++i) {
+                for (int j = 0; j < gridPoints; ++j) {
+                    for (int k = 0; k < gridPoints; ++k) {
+                        WH_Vector3D point = minRange + WH_Vector3D(step.x * (i + 0.37),
+                                                                   step.y * (j + 0.59),
+                                                                   step.z * (k + 0.23));
+                        WH_InOutChecker3D::ContainmentType flag
+                            = facetBody->checkContainmentAt(point);
+                        nInside += (flag == WH_InOutChecker3D::IN);
+                        nOn += (flag == WH_InOutChecker3D::ON);
+                    }
+                }
+            }
+            auto end = high_resolution_clock::now();
+            if (iType == 0) nBucketInside = nInside;
+
+            cout << "  " << checkerName_s[iType] << ": set up "
+                 << duration_cast<microseconds>(built - start).count() << " microseconds, queries "
+                 << duration_cast<microseconds>(end - built).count() << " microseconds, "
+                 << nInside << " in, " << nOn << " on"
+                 << (nInside == nBucketInside ? "" : " (DIFFERS FROM BUCKET)") << endl;
+            delete facetBody;
+        }
+    }
+    WH_InOutChecker3D::setCheckerType(WH_InOutChecker3D::BUCKET_CHECKER);
+}
+
 int main() {
     cout << "AdvCAD Performance Benchmark - Modernized Version" << endl;
     cout << "=================================================" << endl;
@@ -112,6 +468,9 @@ int main() {
     benchmark_polygon_move_semantics();
     benchmark_sorter_move_semantics();
     benchmark_constexpr_math();
+    benchmark_delaunay3d_tetrahedron();
+    benchmark_polygon_facet_accessors();
+    benchmark_inout_checkers();
     
     cout << "\nBenchmark complete!" << endl;
     return 0;
@@ -13,64 +13,178 @@
  * Corrected Makefile so that undefined reference link error will not occur.
  */
 
-#include <WH/gm3d_io.h>
-#include <WH/gm3d_tpl3d.h>
-#include <WH/mg3d.h>
+#include "advcad.h"
+#include <WH/mg3d_mesh_snapshot.h>
 #include <WH/common.h>
-#include <WH/geometry_analyzer.h>
 #include <WH/debug_levels.h>
+#include <WH/arena.h>
+#include <WH/inout3d.h>
+#include <WH/gm3d_cache.h>
+#include <WH/binary_io.h>
 
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
 
-WH_GM3D_Body* TheSolidModel;
-WH_TPL3D_PolyBody* TheTopology;
-WH_MG3D_MeshGenerator* TheMeshGenerator;
+
+void ReportAllocations ()
+{
+  /* each temporary served by an arena is a heap allocation saved, and
+     the arenas allocate their chunks from the heap themselves.  the
+     heap allocations of the process are counted only when the library
+     is built with WH_HEAP_COUNTER_ENABLED */
+  long long nServed = WH_Arena::nTotalAllocations ();
+  long long nChunks = WH_Arena::nTotalHeapAllocations ();
+  long long nHeap = WH_nProcessHeapAllocations ();
+  if (nHeap < 0) {
+    WH_PRINTF_NORMAL("Allocations: %lld temporaries served by arenas "
+		     "from %lld chunks", nServed, nChunks);
+    return;
+  }
+  WH_PRINTF_NORMAL("Allocations: %lld from the heap, %lld temporaries "
+		   "served by arenas from %lld chunks (%.1f%% fewer)",
+		   nHeap, nServed, nChunks, 
+		   100.0 * (nServed - nChunks) / (nHeap + nServed - nChunks));
+}
+
+/* a checkpoint is the header, the solid model and the surface mesh */
+static const char* CHECKPOINT_MAGIC = "WHCK";
+
+static const int CHECKPOINT_VERSION = 1;
+
+/* MAGIC NUMBER : default size limit of the body cache */
+static const long long DEFAULT_CACHE_MEGABYTES = 256;
+
+void ReportBodyCache ()
+{
+  WH_GM3D_BodyCache* cache = WH_GM3D_IO::bodyCache ();
+  if (cache == WH_NULL) return;
+  WH_PRINTF_NORMAL("Body cache: %d hits, %d misses, %d stored, "
+		   "%d evicted, %lld bytes in %s",
+		   cache->nHits (), cache->nMisses (), cache->nStores (),
+		   cache->nEvictions (), cache->nBytes (), 
+		   cache->directory ().c_str ());
+}
+
+AdvcadJob
+::AdvcadJob ()
+  : context (),
+    solidModel (WH_NULL),
+    topology (WH_NULL),
+    meshGenerator (WH_NULL)
+{
+}
+
+VolumeMeshSettings
+::VolumeMeshSettings ()
+  : classifiesInOutByPropagation (false),
+    optimizesTetrahedrons (false),
+    releasesIntermediateData (false)
+{
+}
+
+bool ParseMeshRequest 
+(istream& in,
+ MeshRequest& request_OUT,
+ string& error_OUT)
+{
+  request_OUT.patchSize = 0;
+  request_OUT.toOutputPcm = false;
+  in >> request_OUT.geometryFileName 
+     >> request_OUT.patchFileName 
+     >> request_OUT.patchSize;
+  if (!in || !(0 < request_OUT.patchSize)) {
+    error_OUT = "usage : <geometry_file> <patch_file> <patch_size> [-pcm]";
+    return false;
+  }
+  string option;
+  if (in >> option) {
+    if (option != "-pcm") {
+      error_OUT = "unknown option " + option;
+      return false;
+    }
+    request_OUT.toOutputPcm = true;
+  }
+  return true;
+}
+
+void LoadModel 
+(AdvcadJob& job,
+ const string& geometryFileName)
+{
+  WH_PRINT_NORMAL("Loading geometry file...");
+  job.solidModel 
+    = WH_GM3D_IO::createBodyFromFile (geometryFileName);
+  
+  // Analyze geometry and validate mesh size
+  WH_PRINT_NORMAL("Analyzing geometry...");
+  job.metrics = WH_GeometryAnalyzer::analyze(*job.solidModel);
+  if (g_debugLevel >= WH_DEBUG_VERBOSE) {
+      job.metrics.print();
+  }
+}
+
+double ValidatePatchSize 
+(const AdvcadJob& job,
+ double patchSize)
+{
+  WH_PRINT_NORMAL("Validating mesh size...");
+  double adjustedPatchSize = WH_GeometryAnalyzer::adjustMeshSize(patchSize, job.metrics);
+  if (adjustedPatchSize != patchSize) {
+    WH_PRINTF_NORMAL("Mesh size adjusted from %g to %g", patchSize, adjustedPatchSize);
+    patchSize = adjustedPatchSize;
+  }
+  
+  if (!WH_GeometryAnalyzer::isMeshSizeAppropriate(patchSize, job.metrics)) {
+    WH_PRINT_WARNING("Mesh size may cause triangulation problems.");
+    WH_PRINTF_WARNING("Recommended mesh size range: [%g, %g]", 
+                     job.metrics.minimumSafeMeshSize, job.metrics.maximumUsefulMeshSize);
+  } else {
+    WH_PRINT_VERBOSE("Mesh size validation passed.");
+  }
+  return patchSize;
+}
+
+void ConvertModel 
+(AdvcadJob& job)
+{
+  WH_PRINT_NORMAL("Converting to topology...");
+  job.topology
+    = WH_TPL3D_Converter_GM3D::createBody (job.solidModel);
+}
+
+void GeneratePatch 
+(AdvcadJob& job,
+ double patchSize)
+{
+  WH_PRINT_VERBOSE("Creating mesh generator...");
+  job.meshGenerator 
+    = new WH_MG3D_MeshGenerator (job.topology->volume_s ()[0]);
+  WH_PRINT_VERBOSE("Setting tetrahedron size...");
+  job.meshGenerator->setTetrahedronSize (patchSize);
+  WH_PRINT_NORMAL("Generating patch...");
+  job.meshGenerator->generatePatch ();
+}
 
 void MakePatch 
-(const string& geometryFileName,
+(AdvcadJob& job,
+ const string& geometryFileName,
  double patchSize)
 {
   WH_PRINT_VERBOSE("MakePatch started");
   
   try {
-    WH_PRINT_NORMAL("Loading geometry file...");
-    TheSolidModel 
-      = WH_GM3D_IO::createBodyFromFile (geometryFileName);
-    
-    // Analyze geometry and validate mesh size
-    WH_PRINT_NORMAL("Analyzing geometry...");
-    WH_GeometryAnalyzer::GeometryMetrics metrics = WH_GeometryAnalyzer::analyze(*TheSolidModel);
-    if (g_debugLevel >= WH_DEBUG_VERBOSE) {
-        metrics.print();
-    }
-    
-    WH_PRINT_NORMAL("Validating mesh size...");
-    double adjustedPatchSize = WH_GeometryAnalyzer::adjustMeshSize(patchSize, metrics);
-    if (adjustedPatchSize != patchSize) {
-      WH_PRINTF_NORMAL("Mesh size adjusted from %g to %g", patchSize, adjustedPatchSize);
-      patchSize = adjustedPatchSize;
-    }
-    
-    if (!WH_GeometryAnalyzer::isMeshSizeAppropriate(patchSize, metrics)) {
-      WH_PRINT_WARNING("Mesh size may cause triangulation problems.");
-      WH_PRINTF_WARNING("Recommended mesh size range: [%g, %g]", 
-                       metrics.minimumSafeMeshSize, metrics.maximumUsefulMeshSize);
-    } else {
-      WH_PRINT_VERBOSE("Mesh size validation passed.");
-    }
-    
-    WH_PRINT_NORMAL("Converting to topology...");
-    TheTopology
-      = WH_TPL3D_Converter_GM3D::createBody (TheSolidModel);
-    WH_PRINT_VERBOSE("Creating mesh generator...");
-    TheMeshGenerator 
-      = new WH_MG3D_MeshGenerator (TheTopology->volume_s ()[0]);
-    WH_PRINT_VERBOSE("Setting tetrahedron size...");
-    TheMeshGenerator->setTetrahedronSize (patchSize);
-    WH_PRINT_NORMAL("Generating patch...");
-    TheMeshGenerator->generatePatch ();
+    LoadModel (job, geometryFileName);
+    patchSize = ValidatePatchSize (job, patchSize);
+    ConvertModel (job);
+    GeneratePatch (job, patchSize);
     if (g_debugLevel == WH_DEBUG_SILENT) {
       // For Level 0: Just report success with triangle count
-      cout << "Success: " << TheMeshGenerator->obfTri_s().size() << " triangles" << endl;
+      cout << "Success: " << job.meshGenerator->obfTri_s().size() << " triangles" << endl;
     } else {
       WH_PRINT_NORMAL("Patch generation completed successfully!");
     }
@@ -83,21 +197,78 @@ void MakePatch
       cerr << "  - Invalid geometry in model file" << endl;
       cerr << "  - Boolean operation complexity" << endl;
       cerr << "  - Mesh generation parameters (try mesh size in range [" 
-           << (TheSolidModel ? WH_GeometryAnalyzer::analyze(*TheSolidModel).minimumSafeMeshSize : 0.001)
-           << ", " << (TheSolidModel ? WH_GeometryAnalyzer::analyze(*TheSolidModel).maximumUsefulMeshSize : 1.0)
+           << (job.solidModel ? WH_GeometryAnalyzer::analyze(*job.solidModel).minimumSafeMeshSize : 0.001)
+           << ", " << (job.solidModel ? WH_GeometryAnalyzer::analyze(*job.solidModel).maximumUsefulMeshSize : 1.0)
            << "])" << endl;
     }
     throw;
   }
 }
 
+void MakeSurfaceMesh 
+(AdvcadJob& job,
+ const string& geometryFileName,
+ double tetrahedronSize)
+{
+  LoadModel (job, geometryFileName);
+  tetrahedronSize = ValidatePatchSize (job, tetrahedronSize);
+  ConvertModel (job);
+
+  job.meshGenerator 
+    = new WH_MG3D_MeshGenerator (job.topology->volume_s ()[0]);
+  job.meshGenerator->setTetrahedronSize (tetrahedronSize);
+  WH_PRINT_NORMAL("Generating surface mesh...");
+  job.meshGenerator->generateSurfaceMesh ();
+}
+
+void GenerateVolumeMesh 
+(AdvcadJob& job,
+ const VolumeMeshSettings& settings)
+{
+  job.meshGenerator->setClassifiesInOutByPropagation 
+    (settings.classifiesInOutByPropagation);
+  job.meshGenerator->setOptimizesTetrahedrons 
+    (settings.optimizesTetrahedrons);
+  job.meshGenerator->setReleasesIntermediateData 
+    (settings.releasesIntermediateData);
+  WH_PRINT_NORMAL("Generating volume mesh...");
+  job.meshGenerator->generateMesh ();
+  WH_PRINTF_NORMAL("Volume mesh : %d tetrahedrons, %d nodes",
+		   (int)job.meshGenerator->tetrahedron_s ().size (),
+		   (int)job.meshGenerator->node_s ().size ());
+}
+
+void MakeVolumeMesh 
+(AdvcadJob& job,
+ const string& geometryFileName,
+ double tetrahedronSize,
+ const VolumeMeshSettings& settings)
+{
+  MakeSurfaceMesh (job, geometryFileName, tetrahedronSize);
+  GenerateVolumeMesh (job, settings);
+}
+
+void WriteVolumeMesh 
+(AdvcadJob& job,
+ const string& meshFileName)
+{
+  ofstream out (meshFileName.c_str ());
+  if (!out) {
+    throw runtime_error ("cannot write " + meshFileName);
+  }
+  job.meshGenerator->writeMesh (out);
+}
+
 void WritePatch 
-(const string& patchFileName, bool toOutputPcm)//2006/03/19 A.Miyoshi
+(const AdvcadJob& job,
+ const string& patchFileName, bool toOutputPcm)//2006/03/19 A.Miyoshi
 {
   ofstream out (patchFileName.c_str ());
   WH_ASSERT(out);
 
-  int nNodes = TheMeshGenerator->node_s ().size ();
+  WH_MG3D_MeshSnapshot snapshot (job.meshGenerator);
+
+  int nNodes = snapshot.nNodes ();
   //Next 3 lines added 2006/03/19 A.Miyoshi
   if(toOutputPcm){
     out << nNodes << " 0 1" << endl;
@@ -105,44 +276,261 @@ void WritePatch
     out << nNodes << endl;
   }//Added 2006/03/19 A.Miyoshi
 
-  for (vector<WH_MG3D_Node*>::const_iterator 
-   i_node = TheMeshGenerator->node_s ().begin ();
-       i_node != TheMeshGenerator->node_s ().end ();
-       i_node++) {
-    WH_MG3D_Node* node_i = (*i_node);
-
-    WH_ASSERT(node_i->topologyType () == WH_MG3D_Node::ON_VERTEX
-        || node_i->topologyType () == WH_MG3D_Node::ON_EDGE
-        || node_i->topologyType () == WH_MG3D_Node::ON_FACE);
+  const double* coordinates = snapshot.coordinates ();
+  for (int iNode = 0; iNode < nNodes; iNode++) {
+    WH_ASSERT(snapshot.topologyTypes ()[iNode] == WH_MG3D_Node::ON_VERTEX
+        || snapshot.topologyTypes ()[iNode] == WH_MG3D_Node::ON_EDGE
+        || snapshot.topologyTypes ()[iNode] == WH_MG3D_Node::ON_FACE);
     
-    WH_Vector3D position = node_i->position ();
-    out << position.x << " " 
-      << position.y << " " 
-      << position.z << endl;
+    out << coordinates[iNode * 3 + 0] << " " 
+      << coordinates[iNode * 3 + 1] << " " 
+      << coordinates[iNode * 3 + 2] << endl;
   }
 
-  int nTriangles = TheMeshGenerator->obfTri_s ().size ();
+  int nTriangles = snapshot.nTriangles ();
   out << nTriangles << endl;
 
-  for (vector<WH_MG3D_OriginalBoundaryFaceTriangle*>::const_iterator 
-   i_obfTri = TheMeshGenerator->obfTri_s ().begin ();
-       i_obfTri != TheMeshGenerator->obfTri_s ().end ();
-       i_obfTri++) {
-    WH_MG3D_OriginalBoundaryFaceTriangle* obfTri_i = (*i_obfTri);
-
-    WH_MG3D_Node* node0 = obfTri_i->node0 ();
-    WH_MG3D_Node* node1 = obfTri_i->node1 ();
-    WH_MG3D_Node* node2 = obfTri_i->node2 ();
+  const int32_t* triangleNodes = snapshot.triangleNodes ();
+  for (int iTri = 0; iTri < nTriangles; iTri++) {
+    const int32_t* node_s = triangleNodes + iTri * snapshot.nNodesPerTriangle ();
     //2006/03/19 A.Miyoshi changed order nodes from node0, node1, node2 
     //to comform with pch/pcm format
-    out << node2->id () << " "  
-        << node1->id () << " "  
-        << node0->id () << endl;
+    out << node_s[2] << " "  
+        << node_s[1] << " "  
+        << node_s[0] << endl;
   }
 }
 
 
 
+void WriteCheckpoint 
+(const AdvcadJob& job,
+ const string& checkpointFileName)
+{
+  WH_PRINT_NORMAL("Writing checkpoint...");
+  ofstream out (checkpointFileName.c_str (), ios::binary);
+  WH_writeBinaryTag (out, CHECKPOINT_MAGIC);
+  WH_writeBinary (out, CHECKPOINT_VERSION);
+  WH_GM3D_IO::writeBody (out, job.solidModel);
+  job.meshGenerator->writeSurfaceMesh (out);
+  out.close ();
+  if (!out) {
+    throw runtime_error ("cannot write checkpoint " + checkpointFileName);
+  }
+}
+
+void LoadCheckpoint 
+(AdvcadJob& job,
+ const string& checkpointFileName)
+{
+  WH_PRINT_NORMAL("Loading checkpoint...");
+  ifstream in (checkpointFileName.c_str (), ios::binary);
+  int version;
+  if (!WH_readBinaryTag (in, CHECKPOINT_MAGIC)
+      || !WH_readBinary (in, version) || version != CHECKPOINT_VERSION) {
+    throw runtime_error ("not a checkpoint : " + checkpointFileName);
+  }
+  job.solidModel = WH_GM3D_IO::createBodyFromStream (in);
+  if (job.solidModel == WH_NULL) {
+    throw runtime_error ("broken checkpoint " + checkpointFileName);
+  }
+  job.metrics = WH_GeometryAnalyzer::analyze (*job.solidModel);
+
+  ConvertModel (job);
+  if (job.topology->volume_s ().size () == 0) {
+    throw runtime_error ("no volume in checkpoint " + checkpointFileName);
+  }
+  job.meshGenerator 
+    = new WH_MG3D_MeshGenerator (job.topology->volume_s ()[0]);
+  if (!job.meshGenerator->readSurfaceMesh (in)) {
+    throw runtime_error ("broken checkpoint " + checkpointFileName);
+  }
+}
+
+void ResumePatch 
+(AdvcadJob& job,
+ const string& checkpointFileName)
+{
+  chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+
+  LoadCheckpoint (job, checkpointFileName);
+  WH_PRINT_NORMAL("Generating patch...");
+  job.meshGenerator->generatePatch ();
+
+  WH_PRINTF_NORMAL("Resumed from checkpoint in %.1f ms", 
+		   chrono::duration<double, milli> 
+		   (chrono::steady_clock::now () - start).count ());
+}
+
+void ResumeSurfaceMesh 
+(AdvcadJob& job,
+ const string& checkpointFileName,
+ double tetrahedronSize)
+{
+  LoadCheckpoint (job, checkpointFileName);
+  tetrahedronSize = ValidatePatchSize (job, tetrahedronSize);
+  /* the surface mesh is as fine as the size it was made for */
+  if (tetrahedronSize != job.meshGenerator->tetrahedronSize ()) {
+    char message[128];
+    snprintf (message, sizeof (message),
+	      "tetrahedron size %g differs from %g of checkpoint ",
+	      tetrahedronSize, job.meshGenerator->tetrahedronSize ());
+    throw runtime_error (message + checkpointFileName);
+  }
+}
+
+void MeshModel 
+(AdvcadJob& job,
+ const MeshRequest& request,
+ int& nNodes_OUT,
+ int& nTriangles_OUT)
+{
+  GeneratePatch (job, ValidatePatchSize (job, request.patchSize));
+  WritePatch (job, request.patchFileName, request.toOutputPcm);
+  /* a patch has no tetrahedron */
+  nNodes_OUT = (int)job.meshGenerator->node_s ().size ();
+  nTriangles_OUT = (int)job.meshGenerator->obfTri_s ().size ();
+  delete job.meshGenerator;
+  job.meshGenerator = WH_NULL;
+}
+
+void DeleteModel 
+(AdvcadJob& job)
+{
+  /* each refers to the next */
+  delete job.meshGenerator;
+  job.meshGenerator = WH_NULL;
+  delete job.topology;
+  job.topology = WH_NULL;
+  delete job.solidModel;
+  job.solidModel = WH_NULL;
+}
+
+FILE* OpenResponseStream ()
+{
+  fflush (stdout);
+  int responseFd = dup (1);
+  dup2 (2, 1);
+  return fdopen (responseFd, "w");
+}
+
+#ifndef _WIN32
+
+/* MAGIC NUMBER : bound of the line of a child.  it fits in the buffer
+   of a pipe, so that a child never blocks on writing it */
+static const size_t MAX_CHILD_RESULT_LENGTH = 1024;
+
+pid_t StartChildProcess
+(const function<string ()>& task,
+ int& resultFd_OUT)
+{
+  resultFd_OUT = -1;
+
+  /* the buffers would be written by both processes */
+  fflush (WH_NULL);
+
+  int fd[2];
+  if (pipe (fd) != 0) return -1;
+  pid_t result = fork ();
+  if (result < 0) {
+    close (fd[0]);
+    close (fd[1]);
+    return -1;
+  }
+  if (result == 0) {
+    close (fd[0]);
+    string line = task ();
+    for (size_t i = 0; i < line.size (); i++) {
+      if (line[i] == '\n' || line[i] == '\r') line[i] = ' ';
+    }
+    if (MAX_CHILD_RESULT_LENGTH < line.size ()) {
+      line.resize (MAX_CHILD_RESULT_LENGTH);
+    }
+    ssize_t nWritten = write (fd[1], line.c_str (), line.size ());
+    close (fd[1]);
+    fflush (stderr);
+    /* without the destructors and the exit handlers of the parent */
+    _exit ((nWritten == (ssize_t)line.size ()) ? 0 : 1);
+  }
+  close (fd[1]);
+  resultFd_OUT = fd[0];
+  return result;
+}
+
+string ChildProcessResult
+(int resultFd,
+ int status)
+{
+  string result;
+  char buffer[256];
+  ssize_t nRead;
+  while ((nRead = read (resultFd, buffer, sizeof (buffer))) != 0) {
+    if (nRead < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    result.append (buffer, nRead);
+  }
+  close (resultFd);
+
+  char crash[256];
+  if (WIFSIGNALED(status)) {
+    int signalNumber = WTERMSIG(status);
+    snprintf (crash, sizeof (crash), "crashed signal %d (%s)",
+	      signalNumber, strsignal (signalNumber));
+    return crash;
+  } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    snprintf (crash, sizeof (crash), "crashed exit %d",
+	      WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+    return crash;
+  } else if (result.empty ()) {
+    return "crashed no result";
+  }
+  return result;
+}
+
+#endif
+
+
+
+static void PrintUsage ()
+{
+  cerr << " Usage : advcad [--debug=N] [--inout=bucket|bvh|winding] \n"
+       << "     [--cache=dir [--cache-size=MB]] [--checkpoint=file]\n"
+       << "     geometry_file_name patch_file_name patch_size [-pcm]\n"
+       << "   or  advcad [--debug=N] [--inout=...] --volume [--inout-propagation]\n"
+       << "     [--optimize] [--low-memory] geometry_file_name\n"
+       << "     mesh_file_name tetrahedron_size\n"
+       << "   or  advcad [--debug=N] [--inout=...] --serve[=socket_path]\n"
+       << "   or  advcad [--debug=N] [--inout=...] --batch job_file [-j N]\n"
+       << "   or  advcad [--debug=N] [--checkpoint=file]\n"
+       << "     --resume-from checkpoint_file patch_file_name [-pcm]\n"
+       << "   or  advcad [--debug=N] [--inout=...] [--checkpoint=file]\n"
+       << "     --volume [--inout-propagation] [--optimize] [--low-memory]\n"
+       << "     --resume-from checkpoint_file mesh_file_name\n"
+       << "     tetrahedron_size\n"
+       << "     Debug levels: 0=silent, 1=normal, 2=verbose, 3=trace\n"
+       << "     In-out check of solids: bucket (default), bvh, or\n"
+       << "     winding (winding number on BVH, robust to small gaps)\n"
+       << "     --serve answers the mesh requests of advcad.h on standard\n"
+       << "     input and output, or on a Unix domain socket\n"
+       << "     --batch runs the jobs of job_file, one mesh request per\n"
+       << "     line, N at a time (default 1), each in its own process\n"
+       << "     --cache=dir keeps the results of set operations in dir,\n"
+       << "     so that a script resumes after its last cached one;\n"
+       << "     --cache-size=MB limits it (default 256)\n"
+       << "     --checkpoint=file saves the solid model and its surface\n"
+       << "     mesh, and --resume-from writes the patch, or with --volume\n"
+       << "     the volume mesh of the same tetrahedron_size, from them\n"
+       << "     without the set operations and the surface meshing\n"
+       << "     --volume writes a mesh of 10 node tetrahedrons instead of\n"
+       << "     the patch; --inout-propagation classifies them by regions\n"
+       << "     across the boundary instead of a ray cast for each;\n"
+       << "     --optimize improves them by flips and smoothing, and\n"
+       << "     --low-memory frees the working data of the mesh\n"
+       << "     generator as soon as it is done with it\n";
+}
+
 int main (int argc, char* argv[])
 {
   // Initialize debug system
@@ -153,15 +541,167 @@ int main (int argc, char* argv[])
   // Parse arguments including debug level
   bool toOutputPcm = false;//Added 2006/03/19 A.Miyoshi
   int argOffset = 0;
+  bool serves = false;
+  string socketPath;
+  string jobFileName;
+  string cacheDirectory;
+  string checkpointFileName;
+  string resumedFileName;
+  bool makesVolumeMesh = false;
+  VolumeMeshSettings volumeMeshSettings;
+  double cacheMegabytes = DEFAULT_CACHE_MEGABYTES;
   
-  // Check for debug argument first
-  if (argc > 1 && strncmp(argv[1], "--debug=", 8) == 0) {
-    int debugLevel = atoi(argv[1] + 8);
-    WH_SetDebugLevel(debugLevel);
-    WH_PRINTF_VERBOSE("Debug level set to %d (%s)", debugLevel, WH_GetDebugLevelName(debugLevel));
-    argOffset = 1; // Skip debug argument
+  // Check for options first
+  while (argOffset + 1 < argc
+	 && strncmp(argv[1 + argOffset], "--", 2) == 0) {
+    const char* option = argv[1 + argOffset];
+    if (strncmp(option, "--debug=", 8) == 0) {
+      int debugLevel = atoi(option + 8);
+      WH_SetDebugLevel(debugLevel);
+      WH_PRINTF_VERBOSE("Debug level set to %d (%s)", debugLevel, WH_GetDebugLevelName(debugLevel));
+    } else if (strcmp(option, "--volume") == 0) {
+      makesVolumeMesh = true;
+    } else if (strcmp(option, "--inout-propagation") == 0) {
+      volumeMeshSettings.classifiesInOutByPropagation = true;
+    } else if (strcmp(option, "--optimize") == 0) {
+      volumeMeshSettings.optimizesTetrahedrons = true;
+    } else if (strcmp(option, "--low-memory") == 0) {
+      volumeMeshSettings.releasesIntermediateData = true;
+    } else if (strcmp(option, "--serve") == 0) {
+      serves = true;
+    } else if (strncmp(option, "--serve=", 8) == 0) {
+      serves = true;
+      socketPath = option + 8;
+    } else if (strcmp(option, "--batch") == 0 && argOffset + 2 < argc) {
+      jobFileName = argv[2 + argOffset];
+      argOffset++; // Skip job file
+    } else if (strncmp(option, "--checkpoint=", 13) == 0 
+	       && option[13] != '\0') {
+      checkpointFileName = option + 13;
+    } else if (strcmp(option, "--resume-from") == 0 && argOffset + 2 < argc) {
+      resumedFileName = argv[2 + argOffset];
+      argOffset++; // Skip checkpoint file
+    } else if (strncmp(option, "--cache=", 8) == 0 && option[8] != '\0') {
+      cacheDirectory = option + 8;
+    } else if (strncmp(option, "--cache-size=", 13) == 0
+	       && 0 < atof(option + 13)) {
+      cacheMegabytes = atof(option + 13);
+    } else if (strcmp(option, "--inout=bucket") == 0) {
+      WH_InOutChecker3D::setCheckerType 
+	(WH_InOutChecker3D::BUCKET_CHECKER);
+    } else if (strcmp(option, "--inout=bvh") == 0) {
+      WH_InOutChecker3D::setCheckerType 
+	(WH_InOutChecker3D::BVH_RAY_CHECKER);
+    } else if (strcmp(option, "--inout=winding") == 0) {
+      WH_InOutChecker3D::setCheckerType 
+	(WH_InOutChecker3D::BVH_WINDING_NUMBER_CHECKER);
+    } else {
+      cerr << "unknown option : " << option << "\n";
+      PrintUsage ();
+      exit (1);
+    }
+    argOffset++; // Skip option
   }
   
+  /* options which the chosen mode would ignore */
+  bool setsVolumeMeshOptions 
+    = volumeMeshSettings.classifiesInOutByPropagation
+    || volumeMeshSettings.optimizesTetrahedrons
+    || volumeMeshSettings.releasesIntermediateData;
+  bool servesOrBatches = serves || !jobFileName.empty ();
+  if ((setsVolumeMeshOptions && !makesVolumeMesh)
+      || (serves && !jobFileName.empty ())
+      || (servesOrBatches 
+	  && (makesVolumeMesh || !checkpointFileName.empty ()
+	      || !resumedFileName.empty ()))) {
+    PrintUsage ();
+    exit (1);
+  }
+
+  WH_GM3D_BodyCache* cache = WH_NULL;
+  if (!cacheDirectory.empty ()) {
+    cache = new WH_GM3D_BodyCache 
+      (cacheDirectory, (long long)(cacheMegabytes * 1024 * 1024));
+    WH_GM3D_IO::setBodyCache (cache);
+  }
+
+  if (serves) {
+    if (argOffset + 1 < argc) {
+      PrintUsage ();
+      exit (1);
+    }
+    int result = ServePatches (socketPath);
+    ReportBodyCache ();
+    delete cache;
+    return result;
+  }
+
+  if (!jobFileName.empty ()) {
+    int nWorkers = 1;
+    if (argOffset + 3 == argc && strcmp (argv[1 + argOffset], "-j") == 0) {
+      nWorkers = atoi (argv[2 + argOffset]);
+    } else if (argOffset + 1 != argc) {
+      PrintUsage ();
+      exit (1);
+    }
+    if (nWorkers < 1) {
+      PrintUsage ();
+      exit (1);
+    }
+    int nFailedJobs = RunBatch (jobFileName, nWorkers);
+    delete cache;
+    return (nFailedJobs == 0) ? 0 : 1;
+  }
+
+  if (!resumedFileName.empty () && makesVolumeMesh) {
+    if (argc - argOffset - 1 != 2) {
+      PrintUsage ();
+      exit (1);
+    }
+    string meshFileName = argv[1 + argOffset];
+    double tetrahedronSize = atof (argv[2 + argOffset]);
+    AdvcadJob job;
+    try {
+      ResumeSurfaceMesh (job, resumedFileName, tetrahedronSize);
+      if (!checkpointFileName.empty ()) {
+	WriteCheckpoint (job, checkpointFileName);
+      }
+      GenerateVolumeMesh (job, volumeMeshSettings);
+      WriteVolumeMesh (job, meshFileName);
+    } catch (const std::exception& e) {
+      cerr << "FATAL ERROR: " << e.what() << endl;
+      return 1;
+    }
+    DeleteModel (job);
+    delete cache;
+    return 0;
+  }
+
+  if (!resumedFileName.empty ()) {
+    int remainingArgs = argc - argOffset - 1;
+    if (remainingArgs == 2
+	&& strcmp (argv[2 + argOffset], "-pcm") == 0) {
+      toOutputPcm = true;
+    } else if (remainingArgs != 1) {
+      PrintUsage ();
+      exit (1);
+    }
+    AdvcadJob job;
+    try {
+      ResumePatch (job, resumedFileName);
+      if (!checkpointFileName.empty ()) {
+	WriteCheckpoint (job, checkpointFileName);
+      }
+      WritePatch (job, argv[1 + argOffset], toOutputPcm);
+    } catch (const std::exception& e) {
+      cerr << "FATAL ERROR: " << e.what() << endl;
+      return 1;
+    }
+    DeleteModel (job);
+    delete cache;
+    return 0;
+  }
+
   int effectiveArgc = argc - argOffset;
   
   // After debug parsing, we need 4 arguments: program + 3 args
@@ -174,24 +714,18 @@ int main (int argc, char* argv[])
       cerr << "advcad 0.12b\n";
       exit (0);
     } else {
-      cerr << " Usage : advcad [--debug=N] \n"
-           << "     geometry_file_name patch_file_name patch_size [-pcm]\n"
-           << "     Debug levels: 0=silent, 1=normal, 2=verbose, 3=trace\n";
+      PrintUsage ();
       exit (1);
     }
   } else if (remainingArgs == 4) {//Added 2006/03/19 A.Miyoshi
     if (strcmp (argv[4 + argOffset], "-pcm") == 0){
       toOutputPcm = true;
     }else{
-      cerr << " Usage : advcad [--debug=N] \n"
-           << "     geometry_file_name patch_file_name patch_size [-pcm]\n"
-           << "     Debug levels: 0=silent, 1=normal, 2=verbose, 3=trace\n";
+      PrintUsage ();
       exit (1);
     }
   } else if (remainingArgs != 3) {
-    cerr << " Usage : advcad [--debug=N] \n"
-         << "     geometry_file_name patch_file_name patch_size [-pcm]\n"
-         << "     Debug levels: 0=silent, 1=normal, 2=verbose, 3=trace\n";
+    PrintUsage ();
     exit (1);
   }
 
@@ -199,11 +733,41 @@ int main (int argc, char* argv[])
   string patchFileName = argv[2 + argOffset];
   double patchSize = atof (argv[3 + argOffset]);
 
+  if (makesVolumeMesh) {
+    if (toOutputPcm) {
+      PrintUsage ();
+      exit (1);
+    }
+    AdvcadJob job;
+    try {
+      MakeSurfaceMesh (job, geometryFileName, patchSize);
+      if (!checkpointFileName.empty ()) {
+	WriteCheckpoint (job, checkpointFileName);
+      }
+      GenerateVolumeMesh (job, volumeMeshSettings);
+      WriteVolumeMesh (job, patchFileName);
+    } catch (const std::exception& e) {
+      cerr << "FATAL ERROR: " << e.what() << endl;
+      cerr << "Processing aborted for model: " << geometryFileName << endl;
+      return 1;
+    }
+    DeleteModel (job);
+    ReportBodyCache ();
+    delete cache;
+    return 0;
+  }
+
+  AdvcadJob job;
   try {
     WH_PRINTF_VERBOSE("About to call MakePatch with file: %s size: %g", geometryFileName.c_str(), patchSize);
     cerr.flush();
-    MakePatch (geometryFileName, patchSize);
-    WritePatch (patchFileName, toOutputPcm);//2006/03/19 A.Miyoshi
+    MakePatch (job, geometryFileName, patchSize);
+    if (!checkpointFileName.empty ()) {
+      WriteCheckpoint (job, checkpointFileName);
+    }
+    WritePatch (job, patchFileName, toOutputPcm);//2006/03/19 A.Miyoshi
+    ReportAllocations ();
+    ReportBodyCache ();
   } catch (const std::exception& e) {
     cerr << "FATAL ERROR: " << e.what() << endl;
     cerr << "Processing aborted for model: " << geometryFileName << endl;
@@ -0,0 +1,184 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ Copyright (C) 2006-2007 ADVENTURE Project
+ All Rights Reserved
+ *********************************************************************/
+
+/* header file for advcad.cc, advcad_serve.cc and advcad_batch.cc */
+
+#pragma once
+#include <WH/gm3d_io.h>
+#include <WH/gm3d_tpl3d.h>
+#include <WH/mg3d.h>
+#include <WH/geometry_analyzer.h>
+#include <WH/context.h>
+
+#include <cstdio>
+#include <functional>
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+/* state of a job.  jobs on different threads share nothing */
+struct AdvcadJob {
+  AdvcadJob ();
+  /* in the context of the calling thread */
+
+  WH_Context context;
+
+  WH_GM3D_Body* solidModel;
+
+  WH_TPL3D_PolyBody* topology;
+  /* refers to <solidModel> */
+
+  WH_MG3D_MeshGenerator* meshGenerator;
+  /* refers to <topology> */
+
+  WH_GeometryAnalyzer::GeometryMetrics metrics;
+};
+
+/* arguments of a job, as on the command line */
+struct MeshRequest {
+  string geometryFileName;
+  string patchFileName;
+  double patchSize;
+  bool toOutputPcm;
+};
+
+/* settings of a volume mesh, as on the command line */
+struct VolumeMeshSettings {
+  VolumeMeshSettings ();
+  /* as WH_MG3D_MeshGenerator by default */
+
+  bool classifiesInOutByPropagation;
+  bool optimizesTetrahedrons;
+  bool releasesIntermediateData;
+};
+
+bool ParseMeshRequest (istream& in, MeshRequest& request_OUT,
+		       string& error_OUT);
+/* <geometry_file> <patch_file> <patch_size> [-pcm] */
+
+/* steps of MakePatch () */
+void LoadModel (AdvcadJob& job, const string& geometryFileName);
+/* solidModel and metrics */
+
+double ValidatePatchSize (const AdvcadJob& job, double patchSize);
+/* returns the size adjusted to the metrics */
+
+void ConvertModel (AdvcadJob& job);
+/* topology of solidModel */
+
+void GeneratePatch (AdvcadJob& job, double patchSize);
+/* new meshGenerator of topology */
+
+void MakePatch (AdvcadJob& job, const string& geometryFileName,
+		double patchSize);
+
+/* steps of MakeVolumeMesh () */
+void MakeSurfaceMesh (AdvcadJob& job, const string& geometryFileName,
+		      double tetrahedronSize);
+/* the steps of MakePatch (), up to the surface mesh of meshGenerator,
+   which WriteCheckpoint () can save */
+
+void GenerateVolumeMesh (AdvcadJob& job,
+			 const VolumeMeshSettings& settings);
+/* the tetrahedrons over the volume of meshGenerator */
+
+void MakeVolumeMesh (AdvcadJob& job, const string& geometryFileName,
+		     double tetrahedronSize,
+		     const VolumeMeshSettings& settings);
+/* the steps of MakePatch (), with the tetrahedrons over the volume in
+   place of the patch */
+
+void WriteVolumeMesh (AdvcadJob& job, const string& meshFileName);
+/* in the format of WH_MG3D_MeshGenerator::writeMesh () */
+
+void WritePatch (const AdvcadJob& job, const string& patchFileName,
+		 bool toOutputPcm);
+
+void WriteCheckpoint (const AdvcadJob& job, const string& checkpointFileName);
+/* solidModel and the surface mesh of meshGenerator, after
+   GeneratePatch () or MakeSurfaceMesh (), in a versioned binary file
+   local to the machine */
+
+void LoadCheckpoint (AdvcadJob& job, const string& checkpointFileName);
+/* solidModel, metrics, topology and meshGenerator with the surface
+   mesh from a checkpoint.  the topology is converted again, as it is
+   the same to the bit for the same B-rep.  throws runtime_error if
+   the file is not a checkpoint */
+
+void ResumePatch (AdvcadJob& job, const string& checkpointFileName);
+/* LoadCheckpoint () and the patch, in place of MakePatch () */
+
+void ResumeSurfaceMesh (AdvcadJob& job, const string& checkpointFileName,
+			double tetrahedronSize);
+/* LoadCheckpoint (), in place of MakeSurfaceMesh ().  throws
+   runtime_error unless the checkpoint was made for <tetrahedronSize> */
+
+void MeshModel (AdvcadJob& job, const MeshRequest& request,
+		int& nNodes_OUT, int& nTriangles_OUT);
+/* generate and write the patch of the loaded model, then delete
+   meshGenerator */
+
+void DeleteModel (AdvcadJob& job);
+/* meshGenerator, topology and solidModel */
+
+void ReportBodyCache ();
+/* counts of the body cache of this process, if there is one */
+
+FILE* OpenResponseStream ();
+/* moves the messages of the library to standard error, and returns a
+   stream on the former standard output */
+
+#ifndef _WIN32
+pid_t StartChildProcess
+(const function<string ()>& task,
+ int& resultFd_OUT);
+/* forks a child which runs <task>, writes the line it returns to a
+   pipe and exits.  <resultFd_OUT> is the read end of the pipe.
+   returns -1 if the child cannot be started.  fork only where no other
+   thread runs, since the child would inherit the locks held by them */
+
+string ChildProcessResult (int resultFd, int status);
+/* the line of a child, which ended with <status> of waitpid ().
+   closes <resultFd>.  a child which died on a signal, exited with a
+   failure or wrote nothing gives "crashed <reason>" */
+#endif
+
+int ServePatches (const string& socketPath);
+/* service mode in advcad_serve.cc.  serves requests on standard input
+   and output if <socketPath> is empty, or on a Unix domain socket.
+   one request per line, answered by one line :
+
+     mesh <geometry_file> <patch_file> <patch_size> [-pcm]
+       -> ok <nodes> <triangles> <hit|miss> <load ms> <mesh ms>
+     stats
+       -> stats <requests> <hits> <misses> <failures> <models>
+     quit      ends the connection
+     shutdown  ends the service
+
+   a failed request is answered by "error <message>".  parsed models
+   and their topology are kept by the contents of the geometry file,
+   so that a hit costs the meshing only.  each request is meshed in a
+   child process, which shares the kept models copy-on-write : a
+   request which aborts or crashes is answered by "error crashed
+   <reason>" and the service goes on.  on Windows the requests run in
+   the service itself, so that an abort in the library ends it */
+
+int RunBatch (const string& jobFileName, int nWorkers);
+/* batch mode in advcad_batch.cc.  runs the jobs of <jobFileName>, one
+   per line as in a mesh request, <nWorkers> at a time.  each job runs
+   in a child process, so that a job which aborts or crashes ends alone
+   (except on Windows, where the jobs run on <nWorkers> threads).
+   writes one line per job as it ends :
+
+     <job> <geometry_file> ok <nodes> <triangles> <load ms> <mesh ms>
+     <job> <geometry_file> error <message>
+     <job> <geometry_file> crashed <signal or exit status>
+
+   and a total line "total <jobs> <ok> <failed> <wall ms>", where the
+   crashed jobs count as failed.  returns the number of failed jobs.
+   each job reports the counts of its body cache (on Windows, the
+   batch reports them at the end) */
@@ -0,0 +1,316 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ Copyright (C) 2006-2007 ADVENTURE Project
+ All Rights Reserved
+ *********************************************************************/
+
+/* advcad_batch.cc */
+/* batch mode of advcad : independent jobs on a pool of processes
+   (of threads on Windows) */
+
+#include "advcad.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#ifdef _WIN32
+#include <deque>
+#include <thread>
+#else
+#include <cerrno>
+#include <cstring>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+
+struct BatchJob {
+  int index;
+  /* from 1, in the order of the job file */
+  MeshRequest request;
+  string error;
+  /* of a line which is not a request */
+};
+
+#ifdef _WIN32
+/* jobs of a worker.  the owner takes them from the front, and the
+   other workers steal them from the back when they run out */
+struct BatchWorker {
+  mutex lock;
+  deque<BatchJob*> job_s;
+};
+#endif
+
+struct BatchState {
+  vector<BatchJob> job_s;
+#ifdef _WIN32
+  vector<BatchWorker> worker_s;
+  WH_Context context;
+  /* of the main thread, for every job */
+#endif
+  mutex outputLock;
+  FILE* out;
+  int nSucceeded;
+  int nFailed;
+};
+
+static double MillisecondsSince
+(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double, milli>
+    (chrono::steady_clock::now () - start).count ();
+}
+
+static bool ReadJobs
+(const string& jobFileName,
+ vector<BatchJob>& job_s_OUT)
+{
+  ifstream in (jobFileName.c_str ());
+  if (!in) return false;
+  string line;
+  while (getline (in, line)) {
+    istringstream args (line);
+    string first;
+    if (!(args >> first) || first[0] == '#') continue;
+
+    BatchJob job;
+    job.index = (int)job_s_OUT.size () + 1;
+    istringstream requestArgs (line);
+    if (!ParseMeshRequest (requestArgs, job.request, job.error)) {
+      job.request.geometryFileName = first;
+    }
+    job_s_OUT.push_back (job);
+  }
+  return true;
+}
+
+static string RunJob
+(const MeshRequest& request)
+{
+  /* the parser takes a readable file */
+  if (!ifstream (request.geometryFileName.c_str ())) {
+    return "error cannot read " + request.geometryFileName;
+  }
+
+  AdvcadJob job;
+  try {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+    LoadModel (job, request.geometryFileName);
+    ConvertModel (job);
+    double loadMilliseconds = MillisecondsSince (start);
+
+    start = chrono::steady_clock::now ();
+    int nNodes = 0;
+    int nTriangles = 0;
+    MeshModel (job, request, nNodes, nTriangles);
+    double meshMilliseconds = MillisecondsSince (start);
+
+    DeleteModel (job);
+
+    char result[256];
+    snprintf (result, sizeof (result), "ok %d %d %.1f %.1f",
+	      nNodes, nTriangles, loadMilliseconds, meshMilliseconds);
+    return result;
+  } catch (const std::exception& e) {
+    /* the state after a failure is unknown, so that the model is
+       not deleted */
+    return string ("error ") + e.what ();
+  } catch (...) {
+    return "error unknown exception";
+  }
+}
+
+static string ResultOf
+(const BatchJob& job)
+{
+  string result;
+  if (job.error.empty ()) {
+    result = RunJob (job.request);
+  } else {
+    result = "error " + job.error;
+  }
+
+  /* a result is a single line */
+  for (size_t i = 0; i < result.size (); i++) {
+    if (result[i] == '\n' || result[i] == '\r') result[i] = ' ';
+  }
+  return result;
+}
+
+static void WriteResult
+(BatchState& state,
+ const BatchJob& job,
+ const string& result)
+{
+  lock_guard<mutex> guard (state.outputLock);
+  if (result.compare (0, 3, "ok ") == 0) {
+    state.nSucceeded++;
+  } else {
+    state.nFailed++;
+  }
+  fprintf (state.out, "%d %s %s\n", job.index,
+	   job.request.geometryFileName.c_str (), result.c_str ());
+  fflush (state.out);
+}
+
+#ifdef _WIN32
+
+static BatchJob* TakeJob
+(BatchState& state,
+ int iWorker)
+{
+  int nWorkers = (int)state.worker_s.size ();
+  for (int i = 0; i < nWorkers; i++) {
+    BatchWorker& worker = state.worker_s[(iWorker + i) % nWorkers];
+    lock_guard<mutex> guard (worker.lock);
+    if (worker.job_s.empty ()) continue;
+    BatchJob* result;
+    if (i == 0) {
+      result = worker.job_s.front ();
+      worker.job_s.pop_front ();
+    } else {
+      result = worker.job_s.back ();
+      worker.job_s.pop_back ();
+    }
+    return result;
+  }
+  return WH_NULL;
+}
+
+static void RunWorker
+(BatchState& state,
+ int iWorker)
+{
+  WH_ContextScope scope (state.context);
+
+  BatchJob* job;
+  while ((job = TakeJob (state, iWorker)) != WH_NULL) {
+    WriteResult (state, *job, ResultOf (*job));
+  }
+}
+
+static void RunJobs
+(BatchState& state,
+ int nWorkers)
+{
+  /* no processes to isolate the jobs in : an abort in a job ends the
+     batch */
+
+  /* round robin, so that each worker starts on its own jobs */
+  int nJobs = (int)state.job_s.size ();
+  state.worker_s = vector<BatchWorker> (nWorkers);
+  for (int iJob = 0; iJob < nJobs; iJob++) {
+    state.worker_s[iJob % nWorkers].job_s.push_back (&state.job_s[iJob]);
+  }
+
+  vector<thread> thread_s;
+  for (int iWorker = 0; iWorker < nWorkers; iWorker++) {
+    thread_s.push_back (thread (RunWorker, ref (state), iWorker));
+  }
+  for (int iWorker = 0; iWorker < nWorkers; iWorker++) {
+    thread_s[iWorker].join ();
+  }
+  ReportBodyCache ();
+}
+
+#else
+
+/* a job in its process */
+struct BatchProcess {
+  BatchJob* job;
+  int resultFd;
+  /* read end of the pipe of the result line */
+};
+
+static void RunJobs
+(BatchState& state,
+ int nWorkers)
+{
+  /* each job runs in a process of its own, so that an abort or a
+     crash in the library ends only that job.  the processes are
+     forked by this thread alone, since a child of a forking thread
+     would inherit the locks held by the others */
+  int nJobs = (int)state.job_s.size ();
+  map<pid_t, BatchProcess> process_s;
+  int iNextJob = 0;
+  while (iNextJob < nJobs || !process_s.empty ()) {
+    while (iNextJob < nJobs && (int)process_s.size () < nWorkers) {
+      BatchJob& job = state.job_s[iNextJob++];
+      BatchProcess process;
+      process.job = &job;
+      pid_t pid = StartChildProcess
+	([&job] () {
+	  string result = ResultOf (job);
+	  ReportBodyCache ();
+	  return result;
+	}, process.resultFd);
+      if (pid < 0) {
+	WriteResult (state, job,
+		     string ("error cannot start a process : ")
+		     + strerror (errno));
+      } else {
+	process_s[pid] = process;
+      }
+    }
+    if (process_s.empty ()) continue;
+
+    /* the result line is in the pipe once the child has ended */
+    int status = 0;
+    pid_t pid = waitpid (-1, &status, 0);
+    if (pid < 0) {
+      if (errno == EINTR) continue;
+      /* no child left to wait for */
+      for (map<pid_t, BatchProcess>::iterator i_process
+	     = process_s.begin ();
+	   i_process != process_s.end ();
+	   i_process++) {
+	close (i_process->second.resultFd);
+	WriteResult (state, *i_process->second.job, "crashed lost");
+      }
+      process_s.clear ();
+      continue;
+    }
+    map<pid_t, BatchProcess>::iterator i_process = process_s.find (pid);
+    if (i_process == process_s.end ()) continue;
+    string result = ChildProcessResult
+      (i_process->second.resultFd, status);
+    WriteResult (state, *i_process->second.job, result);
+    process_s.erase (i_process);
+  }
+}
+
+#endif
+
+int RunBatch
+(const string& jobFileName,
+ int nWorkers)
+{
+  /* PRE-CONDITION */
+  WH_ASSERT(0 < nWorkers);
+
+  BatchState state;
+  if (!ReadJobs (jobFileName, state.job_s)) {
+    cerr << "advcad: cannot read " << jobFileName << "\n";
+    return 1;
+  }
+  int nJobs = (int)state.job_s.size ();
+  if (nJobs < nWorkers) nWorkers = (nJobs < 1) ? 1 : nJobs;
+  state.nSucceeded = 0;
+  state.nFailed = 0;
+
+  /* standard output carries the results */
+  state.out = OpenResponseStream ();
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+  RunJobs (state, nWorkers);
+
+  fprintf (state.out, "total %d %d %d %.1f\n",
+	   nJobs, state.nSucceeded, state.nFailed, MillisecondsSince (start));
+  fclose (state.out);
+
+  return state.nFailed;
+}
@@ -0,0 +1,350 @@
+/********************************************************************
+ Copyright (C) 2002 Shinobu Yoshimura, University of Tokyo,
+ the Japan Society for the Promotion of Science (JSPS)
+ Copyright (C) 2006-2007 ADVENTURE Project
+ All Rights Reserved
+ *********************************************************************/
+
+/* advcad_serve.cc */
+/* service mode of advcad : meshing requests on warm models */
+
+#include "advcad.h"
+#include <WH/debug_levels.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <sstream>
+#include <unistd.h>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#endif
+
+
+/* MAGIC NUMBER : models kept warm.  the least recently used one is
+   dropped beyond this */
+static const int MAX_CACHED_MODELS = 16;
+
+/* parsed model and its topology, keyed by the contents of the
+   geometry file */
+struct CachedModel {
+  unsigned long long hash;
+  string content;
+  WH_GM3D_Body* solidModel;  /* own */
+  WH_TPL3D_PolyBody* topology;  /* own */
+  WH_GeometryAnalyzer::GeometryMetrics metrics;
+};
+
+/* most recently used first */
+static list<CachedModel> TheCachedModel_s;
+
+static long NRequests = 0;
+static long NHits = 0;
+static long NMisses = 0;
+static long NFailures = 0;
+
+static unsigned long long ContentHashOf
+(const string& content)
+{
+  /* FNV-1a */
+  unsigned long long result = 14695981039346656037ULL;
+  for (size_t i = 0; i < content.size (); i++) {
+    result ^= (unsigned char)content[i];
+    result *= 1099511628211ULL;
+  }
+  return result;
+}
+
+static bool ReadContent
+(const string& fileName,
+ string& content_OUT)
+{
+  ifstream in (fileName.c_str (), ios::binary);
+  if (!in) return false;
+  ostringstream buffer;
+  buffer << in.rdbuf ();
+  content_OUT = buffer.str ();
+  return true;
+}
+
+static void DropModel
+(CachedModel& model)
+{
+  /* the topology refers to the solid model */
+  delete model.topology;
+  delete model.solidModel;
+}
+
+static double MillisecondsSince
+(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double, milli>
+    (chrono::steady_clock::now () - start).count ();
+}
+
+static void CacheModel
+(const AdvcadJob& job,
+ unsigned long long hash,
+ const string& content)
+{
+  CachedModel model;
+  model.hash = hash;
+  model.content = content;
+  model.solidModel = job.solidModel;
+  model.topology = job.topology;
+  model.metrics = job.metrics;
+  TheCachedModel_s.push_front (model);
+  while ((int)TheCachedModel_s.size () > MAX_CACHED_MODELS) {
+    DropModel (TheCachedModel_s.back ());
+    TheCachedModel_s.pop_back ();
+  }
+}
+
+#ifdef _WIN32
+static void ForgetFailedModel
+(const AdvcadJob& job)
+{
+  /* the state after a failure is unknown, so that the model is
+     neither reused nor deleted */
+  for (list<CachedModel>::iterator
+	 i_model = TheCachedModel_s.begin ();
+       i_model != TheCachedModel_s.end ();
+       i_model++) {
+    if (i_model->topology == job.topology) {
+      TheCachedModel_s.erase (i_model);
+      break;
+    }
+  }
+}
+#endif
+
+static string MeshOnModel
+(AdvcadJob& job,
+ const MeshRequest& request,
+ const CachedModel* model)
+{
+  /* loads the model of <request> if <model> is null */
+  try {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+    if (model == WH_NULL) {
+      LoadModel (job, request.geometryFileName);
+      ConvertModel (job);
+    } else {
+      job.solidModel = model->solidModel;
+      job.topology = model->topology;
+      job.metrics = model->metrics;
+    }
+    double loadMilliseconds = MillisecondsSince (start);
+
+    start = chrono::steady_clock::now ();
+    int nNodes = 0;
+    int nTriangles = 0;
+    MeshModel (job, request, nNodes, nTriangles);
+    double meshMilliseconds = MillisecondsSince (start);
+
+    char response[256];
+    snprintf (response, sizeof (response), "ok %d %d %s %.1f %.1f",
+	      nNodes, nTriangles, (model != WH_NULL) ? "hit" : "miss",
+	      loadMilliseconds, meshMilliseconds);
+    return response;
+  } catch (const std::exception& e) {
+    return string ("error ") + e.what ();
+  } catch (...) {
+    return "error unknown exception";
+  }
+}
+
+static string HandleMeshRequest
+(istringstream& args)
+{
+  MeshRequest request;
+  string error;
+  if (!ParseMeshRequest (args, request, error)) {
+    return "error " + error;
+  }
+  const string& geometryFileName = request.geometryFileName;
+
+  string content;
+  if (!ReadContent (geometryFileName, content)) {
+    return "error cannot read " + geometryFileName;
+  }
+  unsigned long long hash = ContentHashOf (content);
+
+  list<CachedModel>::iterator i_model = TheCachedModel_s.begin ();
+  for (; i_model != TheCachedModel_s.end (); i_model++) {
+    if (i_model->hash == hash && i_model->content == content) break;
+  }
+  const CachedModel* model = WH_NULL;
+  if (i_model != TheCachedModel_s.end ()) {
+    NHits++;
+    TheCachedModel_s.splice
+      (TheCachedModel_s.begin (), TheCachedModel_s, i_model);
+    model = &TheCachedModel_s.front ();
+  } else {
+    NMisses++;
+  }
+
+#ifdef _WIN32
+  /* no process to isolate the request in : an abort in the library
+     ends the service */
+  AdvcadJob job;
+  string response = MeshOnModel (job, request, model);
+  if (response.compare (0, 3, "ok ") == 0) {
+    if (model == WH_NULL) {
+      CacheModel (job, hash, content);
+    }
+  } else if (job.topology != WH_NULL) {
+    ForgetFailedModel (job);
+  }
+  return response;
+#else
+  /* the request runs in a child, which shares the cached models
+     copy-on-write.  an abort or a crash in the library ends the child
+     alone, and whatever the meshing changes stays in it, so that the
+     models of the service stay intact even after a failure */
+  int resultFd = -1;
+  pid_t pid = StartChildProcess
+    ([&request, model] () {
+      AdvcadJob job;
+      return MeshOnModel (job, request, model);
+    }, resultFd);
+  if (pid < 0) {
+    return string ("error cannot start a process : ") + strerror (errno);
+  }
+  int status = 0;
+  while (waitpid (pid, &status, 0) < 0 && errno == EINTR) {}
+  string response = ChildProcessResult (resultFd, status);
+  if (response.compare (0, 8, "crashed ") == 0) {
+    response = "error " + response;
+  }
+
+  /* the model of a miss is loaded again for the service, as the child
+     has just loaded it without a failure */
+  if (model == WH_NULL && response.compare (0, 3, "ok ") == 0) {
+    AdvcadJob job;
+    try {
+      LoadModel (job, geometryFileName);
+      ConvertModel (job);
+      CacheModel (job, hash, content);
+    } catch (...) {
+      /* not kept, as after a failure */
+    }
+  }
+  return response;
+#endif
+}
+
+static bool ServeStream
+(FILE* in, FILE* out)
+{
+  /* returns false on shutdown */
+  char line[4096];
+  while (fgets (line, sizeof (line), in) != WH_NULL) {
+    istringstream args (line);
+    string command;
+    if (!(args >> command)) continue;
+
+    string response;
+    if (command == "mesh") {
+      NRequests++;
+      response = HandleMeshRequest (args);
+      if (response.compare (0, 6, "error ") == 0) {
+	NFailures++;
+      }
+    } else if (command == "stats") {
+      ostringstream stats;
+      stats << "stats " << NRequests << " " << NHits << " " << NMisses
+	    << " " << NFailures << " " << TheCachedModel_s.size ();
+      response = stats.str ();
+    } else if (command == "quit") {
+      return true;
+    } else if (command == "shutdown") {
+      return false;
+    } else {
+      response = "error unknown command " + command;
+    }
+
+    /* a response is a single line */
+    for (size_t i = 0; i < response.size (); i++) {
+      if (response[i] == '\n' || response[i] == '\r') response[i] = ' ';
+    }
+    fprintf (out, "%s\n", response.c_str ());
+    fflush (out);
+  }
+  return true;
+}
+
+int ServePatches
+(const string& socketPath)
+{
+  int result = 0;
+
+  if (socketPath.empty ()) {
+    /* standard output carries the responses */
+    FILE* out = OpenResponseStream ();
+    ServeStream (stdin, out);
+    fclose (out);
+  } else {
+#ifdef _WIN32
+    cerr << "advcad: --serve=<socket> is not supported on Windows, "
+	 << "use --serve\n";
+    result = 1;
+#else
+    sockaddr_un address;
+    memset (&address, 0, sizeof (address));
+    address.sun_family = AF_UNIX;
+    if (sizeof (address.sun_path) <= socketPath.size ()) {
+      cerr << "advcad: socket path too long : " << socketPath << "\n";
+      return 1;
+    }
+    strncpy (address.sun_path, socketPath.c_str (),
+	     sizeof (address.sun_path) - 1);
+
+    int listener = socket (AF_UNIX, SOCK_STREAM, 0);
+    unlink (socketPath.c_str ());
+    if (listener < 0
+	|| bind (listener, (sockaddr*)&address, sizeof (address)) != 0
+	|| listen (listener, 8) != 0) {
+      cerr << "advcad: cannot listen on " << socketPath
+	   << " : " << strerror (errno) << "\n";
+      if (0 <= listener) close (listener);
+      return 1;
+    }
+    cerr << "advcad: serving on " << socketPath << endl;
+
+    /* one connection at a time, since the cache is not locked */
+    bool continues = true;
+    while (continues) {
+      int connection = accept (listener, WH_NULL, WH_NULL);
+      if (connection < 0) {
+	if (errno == EINTR) continue;
+	cerr << "advcad: accept failed : " << strerror (errno) << "\n";
+	result = 1;
+	break;
+      }
+      FILE* in = fdopen (connection, "r");
+      FILE* out = fdopen (dup (connection), "w");
+      continues = ServeStream (in, out);
+      fclose (in);
+      fclose (out);
+    }
+    close (listener);
+    unlink (socketPath.c_str ());
+#endif
+  }
+
+  for (list<CachedModel>::iterator
+	 i_model = TheCachedModel_s.begin ();
+       i_model != TheCachedModel_s.end ();
+       i_model++) {
+    DropModel (*i_model);
+  }
+  TheCachedModel_s.clear ();
+
+  return result;
+}